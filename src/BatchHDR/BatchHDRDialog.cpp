@@ -43,7 +43,10 @@
 #include <memory>
 
 #include <Libpfs/frame.h>
+#include <Libpfs/io/framereaderfactory.h>
 
+#include <Core/BatchScheduler.h>
+#include <Core/FramePipeline.h>
 #include <Core/IOWorker.h>
 #include <Libpfs/pfs.h>
 #include <OsIntegration/osintegration.h>
@@ -60,14 +63,19 @@ BatchHDRDialog::BatchHDRDialog(QWidget *p)
       m_errors(false),
       m_loading_error(false),
       m_abort(false),
-      m_processing(false) {
+      m_processing(false),
+      m_currentJob(-1),
+      m_waitingForWrites(false) {
     m_Ui->setupUi(this);
 
     m_Ui->closeButton->hide();
     m_Ui->progressBar->hide();
 
     m_hdrCreationManager = new HdrCreationManager;
-    m_IO_Worker = new IOWorker;
+    m_memoryBudget.reset(new MemoryBudget(batchMemoryBudget()));
+    m_writeQueue.reset(new FrameWriteQueue(1, *m_memoryBudget));
+    connect(m_writeQueue.data(), &FrameWriteQueue::frameWritten, this,
+            &BatchHDRDialog::hdrWritten);
 
     connect(m_Ui->horizontalSlider, &QAbstractSlider::valueChanged, this,
             &BatchHDRDialog::num_bracketed_changed);
@@ -179,7 +187,6 @@ BatchHDRDialog::~BatchHDRDialog() {
     // DAVIDE _ HDR WIZARD
     m_hdrCreationManager->reset();
     delete m_hdrCreationManager;
-    delete m_IO_Worker;
 }
 
 void BatchHDRDialog::num_bracketed_changed(int value) {
@@ -332,6 +339,16 @@ void BatchHDRDialog::on_startButton_clicked() {
         m_Ui->startButton->setEnabled(false);
         m_total = m_bracketed.count() / m_Ui->spinBox->value();
         m_Ui->progressBar->setMaximum(m_total);
+
+        // one set at a time, in order (the output names are numbered)
+        m_scheduler.reset(new BatchScheduler(*m_memoryBudget, 1));
+        m_scheduler->setStartWhenIdle(false);
+        for (int i = 0; i < m_bracketed.count();
+             i += m_Ui->spinBox->value()) {
+            QStringList exposures =
+                m_bracketed.mid(i, m_Ui->spinBox->value());
+            m_scheduler->addJob(exposures, estimateFusionMemory(exposures));
+        }
         m_Ui->textEdit->append(tr("Started processing..."));
         // mouse pointer to busy
         QApplication::setOverrideCursor(QCursor(Qt::BusyCursor));
@@ -349,23 +366,57 @@ void BatchHDRDialog::batch_hdr() {
         // m_hdrCreationManager->reset();
         this->reject();
     }
-    if (!m_bracketed.isEmpty()) {
-        QFileInfo fi1(m_bracketed.at(0));
-        QFileInfo fi2(m_bracketed.at(m_Ui->spinBox->value() - 1));
+    finishCurrentJob();
+    if (m_scheduler->pending() > 0) {
+        m_currentJob = m_scheduler->tryStart();
+        if (m_currentJob < 0) {
+            // the HDRs being written take the memory: hdrWritten() gets
+            // back here
+            m_waitingForWrites = true;
+            return;
+        }
+        const QStringList toProcess = m_scheduler->inputs(m_currentJob);
+
+        QFileInfo fi1(toProcess.first());
+        QFileInfo fi2(toProcess.last());
         m_output_file_name_base =
             fi1.completeBaseName() + "-" + fi2.completeBaseName();
         m_Ui->textEdit->append(tr("Loading files..."));
         m_numProcessed++;
-        QStringList toProcess;
-        for (int i = 0; i < m_Ui->spinBox->value(); ++i) {
-            toProcess << m_bracketed.takeFirst();
-        }
         qDebug() << "BatchHDRDialog::batch_hdr() Files to process: "
                  << toProcess;
+
+        // EXIF data come from the headers: skip the set before decoding it
+        QStringList filesLackingExif;
+        foreach (const QString &fname, toProcess) {
+            try {
+                if (!pfs::io::FrameReaderFactory::probe(
+                         QFile::encodeName(fname).constData())
+                         .exifData.isValid()) {
+                    filesLackingExif.push_back(fname);
+                }
+            } catch (std::runtime_error &) {
+                // errors are reported by the actual loading
+            }
+        }
+        if (!filesLackingExif.isEmpty()) {
+            qDebug() << "BatchHDRDialog::batch_hdr Error: missing EXIF data";
+            m_Ui->textEdit->append(tr("Error: missing EXIF data"));
+            foreach (const QString &fname, filesLackingExif)
+                m_Ui->textEdit->append(fname);
+            m_errors = true;
+            batch_hdr();
+            return;
+        }
         // DAVIDE _ HDR CREATION
         QtConcurrent::run(boost::bind(&HdrCreationManager::loadFiles,
                                       m_hdrCreationManager, toProcess));
     } else {
+        if (m_writeQueue->pending() > 0) {
+            // hdrWritten() gets back here
+            m_waitingForWrites = true;
+            return;
+        }
         m_Ui->closeButton->show();
         m_Ui->cancelButton->hide();
         m_Ui->startButton->hide();
@@ -476,19 +527,45 @@ void BatchHDRDialog::createHdrFinished() {
                                            QChar('0')) +
                   "." + suffix;
     }
-    m_IO_Worker->write_hdr_frame(resultHDR.get(), outName,
-                                 m_formatHelper.getParams());
-    resultHDR.reset();
+    // the encoding overlaps with the loading of the next set: from now on
+    // the memory of the HDR is accounted by the write queue
+    finishCurrentJob();
+    const pfs::Params params(m_formatHelper.getParams());
+    m_writeQueue->submit(
+        pfs::FramePtr(resultHDR.release()), outName,
+        [params](pfs::Frame &frame, const QString &filename) {
+            return IOWorker().write_hdr_frame(&frame, filename, params);
+        });
 
     // DAVIDE _ HDR WIZARD
     m_hdrCreationManager->reset();
+    batch_hdr();
+}
+
+void BatchHDRDialog::hdrWritten(const QString &filename, bool success) {
+    if (success) {
+        m_Ui->textEdit->append(tr("Written ") + filename);
+    } else {
+        m_Ui->textEdit->append(tr("Error: cannot write ") + filename);
+        m_errors = true;
+    }
     int progressValue = m_Ui->progressBar->value() + 1;
     m_Ui->progressBar->setValue(progressValue);
     OsIntegration::getInstance().setProgress(
         progressValue,
         m_Ui->progressBar->maximum() - m_Ui->progressBar->minimum());
-    m_Ui->textEdit->append(tr("Written ") + outName);
-    batch_hdr();
+
+    if (m_waitingForWrites) {
+        m_waitingForWrites = false;
+        batch_hdr();
+    }
+}
+
+void BatchHDRDialog::finishCurrentJob() {
+    if (m_currentJob >= 0) {
+        m_scheduler->finish(m_currentJob);
+        m_currentJob = -1;
+    }
 }
 
 void BatchHDRDialog::error_while_loading(const QString &message) {
@@ -29,6 +29,7 @@
 #include <QDialog>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QScopedPointer>
 
 #include "Common/LuminanceOptions.h"
 #include "Common/ProgressHelper.h"
@@ -36,7 +37,9 @@
 #include "LibpfsAdditions/formathelper.h"
 
 // Forward declaration
-class IOWorker;
+class BatchScheduler;
+class MemoryBudget;
+class FrameWriteQueue;
 class HdrCreationManager;
 
 namespace Ui {
@@ -75,9 +78,13 @@ class BatchHDRDialog : public QDialog {
     void updateThresholdSpinBox(double);
     void ais_failed(QProcess::ProcessError);
     void createHdrFinished();
+    void hdrWritten(const QString &filename, bool success);
     void loadFilesAborted();
 
    protected:
+    //! \brief the current set is done (or skipped), its memory is released
+    void finishCurrentJob();
+
     // Application-wide settings, loaded via QSettings
     QString m_batchHdrInputDir;
     QString m_batchHdrOutputDir;
@@ -85,7 +92,13 @@ class BatchHDRDialog : public QDialog {
 
     QStringList m_bracketed;
     QString m_output_file_name_base;
-    IOWorker *m_IO_Worker;
+    // HDRs are written while the next set is loaded
+    QScopedPointer<MemoryBudget> m_memoryBudget;
+    QScopedPointer<FrameWriteQueue> m_writeQueue;
+    // a set is loaded when its memory fits next to the HDRs being written
+    QScopedPointer<BatchScheduler> m_scheduler;
+    int m_currentJob;
+    bool m_waitingForWrites;
     HdrCreationManager *m_hdrCreationManager;
     int m_numProcessed;
     int m_processed;
@@ -27,6 +27,7 @@
  *
  */
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
 
@@ -42,8 +43,12 @@
 #include <BatchTM/BatchTMJob.h>
 #include <Common/SavedParametersDialog.h>
 #include <Common/config.h>
+#include <Core/BatchScheduler.h>
+#include <Core/FramePipeline.h>
+#include <Core/IOWorker.h>
 #include <Core/TonemappingOptions.h>
 #include <Exif/ExifOperations.h>
+#include <Libpfs/utils/parallel.h>
 #include <OsIntegration/osintegration.h>
 
 BatchTMDialog::BatchTMDialog(QWidget *p, QSqlDatabase db)
@@ -53,7 +58,11 @@ BatchTMDialog::BatchTMDialog(QWidget *p, QSqlDatabase db)
     if (!QIcon::hasThemeIcon(QStringLiteral("vcs-added")))
         m_Ui->from_Database_Button->setIcon(QIcon(":/program-icons/vcs-added"));
 
-    m_max_num_threads = LuminanceOptions().getBatchTmNumThreads();
+    // more jobs than threads would only oversubscribe the processors
+    m_max_num_threads = std::max(
+        std::min(LuminanceOptions().getBatchTmNumThreads(),
+                 static_cast<int>(pfs::utils::getConcurrency())),
+        1);
 
     connect(m_Ui->add_dir_HDRs_Button, &QAbstractButton::clicked, this,
             &BatchTMDialog::add_dir_HDRs);
@@ -102,11 +111,20 @@ BatchTMDialog::BatchTMDialog(QWidget *p, QSqlDatabase db)
     m_available_threads = new bool[m_max_num_threads];
     for (int r = 0; r < m_max_num_threads; r++)
         m_available_threads[r] = true;  // reset to true
+    m_thread_job.fill(-1, m_max_num_threads);
 
-    m_next_hdr_file = 0;
     m_is_batch_running = false;
+    m_operators_per_job = 1;
+
+    m_memory_budget.reset(new MemoryBudget(batchMemoryBudget()));
+    m_write_queue.reset(
+        new FrameWriteQueue(m_max_num_threads, *m_memory_budget));
+    connect(m_write_queue.data(), &FrameWriteQueue::frameWritten, this,
+            &BatchTMDialog::frame_written);
 
     add_log_message(tr("Using %n thread(s)", "", m_max_num_threads));
+    add_log_message(tr("Memory budget: %1 MB")
+                        .arg(m_memory_budget->capacity() / (1024 * 1024)));
     // add_log_message(tr("Saving using file format:
     // %1").arg(m_Ui->comboBoxFormat->currentText()));
     m_Ui->overallProgressBar->hide();
@@ -371,6 +389,32 @@ void BatchTMDialog::batch_core() {
                          ->data(Qt::UserRole + 1)
                          .toString();
     }
+    // the largest jobs start first: the smaller ones fill the memory left at
+    // the end of the batch
+    m_scheduler.reset(new BatchScheduler(*m_memory_budget, m_max_num_threads));
+    // the threads left by the jobs go to the operators of each job
+    m_operators_per_job = batchTMOperatorsPerJob(
+        std::min(HDRs_list.size(), m_max_num_threads),
+        m_tm_options_list.size());
+    foreach (const QString &hdr, HDRs_list) {
+        m_scheduler->addJob(QStringList(hdr),
+                            estimateBatchTMJobMemory(hdr, m_tm_options_list,
+                                                     m_operators_per_job));
+    }
+    m_scheduler->sort(BatchScheduler::ORDER_LARGEST_FIRST);
+
+    // decode the next HDRs while the current ones are tonemapped
+    QStringList prefetch_list;
+    m_prefetch_index.fill(-1, HDRs_list.size());
+    foreach (int job_id, m_scheduler->queue()) {
+        m_prefetch_index[job_id] = prefetch_list.size();
+        prefetch_list << m_scheduler->inputs(job_id).first();
+    }
+    m_prefetcher.reset(new FramePrefetcher(
+        prefetch_list, m_max_num_threads, *m_memory_budget,
+        [](const QString &filename) {
+            return IOWorker().read_hdr_frame(filename);
+        }));
     start_batch_thread();  // kick off the conversion!
 }
 
@@ -384,11 +428,20 @@ void BatchTMDialog::start_batch_thread() {
         return;
     }
 
-    if (m_next_hdr_file == HDRs_list.size()) {
+    if (m_scheduler->pending() == 0) {
         m_class_data_mutex.unlock();
         emit stop_batch_tm_ui();
     } else {
         int t_id = get_available_thread_id();
+        int job_id = -1;
+        if (t_id != INT_MAX) {
+            job_id = m_scheduler->tryStart();
+            if (job_id < 0) {
+                // not enough memory: retry when a job or a write is done
+                release_thread_id(t_id);
+                t_id = INT_MAX;
+            }
+        }
         if (t_id != INT_MAX) {
             // at least one thread free!
             // start thread
@@ -396,11 +449,14 @@ void BatchTMDialog::start_batch_thread() {
             // don't
             // need to store its pointer somewhere
             QString fileExtension = m_formatHelper.getFileExtension();
+            m_thread_job[t_id] = job_id;
 
             BatchTMJob *job_thread = new BatchTMJob(
-                t_id, HDRs_list.at(m_next_hdr_file), &m_tm_options_list,
+                t_id, m_scheduler->inputs(job_id).first(), &m_tm_options_list,
                 m_Ui->out_folder_widgets->text(), fileExtension,
-                m_formatHelper.getParams());
+                m_formatHelper.getParams(), m_prefetcher.data(),
+                m_prefetch_index[job_id], m_write_queue.data(),
+                m_operators_per_job);
 
             // Thread deletes itself when it has done with its job
             connect(job_thread, &QThread::finished, job_thread,
@@ -415,7 +471,6 @@ void BatchTMDialog::start_batch_thread() {
                         increment_progress_bar);  //, Qt::DirectConnection);
 
             job_thread->start();
-            m_next_hdr_file++;
 
             m_class_data_mutex.unlock();
             emit start_batch_thread();
@@ -449,12 +504,18 @@ int BatchTMDialog::get_available_thread_id() {
         return INT_MAX;
 }
 
-void BatchTMDialog::release_thread(int t_id) {
+void BatchTMDialog::release_thread_id(int t_id) {
     m_thread_control_mutex.lock();
     m_available_threads[t_id] = true;
     m_thread_control_mutex.unlock();
 
     m_thread_slot.release();
+}
+
+void BatchTMDialog::release_thread(int t_id) {
+    m_scheduler->finish(m_thread_job[t_id]);
+    m_thread_job[t_id] = -1;
+    release_thread_id(t_id);
 
     emit start_batch_thread();
 }
@@ -492,7 +553,13 @@ void BatchTMDialog::init_batch_tm_ui() {
 }
 
 void BatchTMDialog::stop_batch_tm_ui() {
+    // wait for the last LDR files to be written
+    if (!m_is_batch_running || m_write_queue->pending() > 0) {
+        return;
+    }
     if (m_thread_slot.tryAcquire(m_max_num_threads)) {
+        m_prefetcher.reset();
+
         m_Ui->cancelbutton->setDisabled(false);
         m_Ui->cancelbutton->setText(tr("Close"));
 
@@ -528,6 +595,24 @@ void BatchTMDialog::increment_progress_bar(int inc) {
         m_Ui->overallProgressBar->maximum());
 }
 
+void BatchTMDialog::frame_written(const QString &filename, bool success) {
+    if (success) {
+        add_log_message(tr("Successfully saved LDR file: %1")
+                            .arg(QFileInfo(filename).fileName()));
+    } else {
+        add_log_message(tr("ERROR: Cannot save to file: %1")
+                            .arg(QFileInfo(filename).fileName()));
+    }
+    increment_progress_bar(1);
+
+    if (m_abort || m_scheduler->pending() == 0) {
+        stop_batch_tm_ui();
+    } else {
+        // the memory of the frame may let the next job start
+        start_batch_thread();
+    }
+}
+
 void BatchTMDialog::abort() {
     if (m_is_batch_running) {
         m_abort = true;
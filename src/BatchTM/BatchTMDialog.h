@@ -44,6 +44,10 @@
 
 // Forward declaration
 class TonemappingOptions;
+class BatchScheduler;
+class MemoryBudget;
+class FramePrefetcher;
+class FrameWriteQueue;
 
 namespace Ui {
 class BatchTMDialog;
@@ -82,6 +86,7 @@ class BatchTMDialog : public QDialog {
     void start_batch_thread();
     void stop_batch_tm_ui();
     void increment_progress_bar(int);
+    void frame_written(const QString &filename, bool success);
 
     void from_database();
 
@@ -110,6 +115,8 @@ class BatchTMDialog : public QDialog {
     // Davide Anastasia <davideanastasia@users.sourceforge.net>
     // Max number of threads allowed
     int m_max_num_threads;
+    // option sets tonemapped at the same time by each job
+    int m_operators_per_job;
     QSemaphore m_thread_slot;
     QMutex m_thread_control_mutex;
     QMutex m_class_data_mutex;
@@ -117,11 +124,22 @@ class BatchTMDialog : public QDialog {
     bool *m_available_threads;
     bool m_abort;
     QSqlDatabase m_db;
-    int m_next_hdr_file;
+    // job (index in HDRs_list) run by each thread
+    QVector<int> m_thread_job;
+
+    // read-ahead of the HDRs and write-behind of the LDRs; the jobs start
+    // when their memory fits in the same budget
+    QScopedPointer<MemoryBudget> m_memory_budget;
+    QScopedPointer<BatchScheduler> m_scheduler;
+    QScopedPointer<FramePrefetcher> m_prefetcher;
+    // position of the input of each job in the list of the prefetcher
+    QVector<int> m_prefetch_index;
+    QScopedPointer<FrameWriteQueue> m_write_queue;
 
     pfsadditions::FormatHelper m_formatHelper;
 
     int get_available_thread_id();
+    void release_thread_id(int t_id);
 
     void init_batch_tm_ui();
     // updates graphica widget (view) and data structure (model) for HDR list
@@ -27,7 +27,13 @@
 #include <QDebug>
 #include <QFileInfo>
 #include <QImage>
+#include <QRunnable>
 #include <QScopedPointer>
+#include <QThreadPool>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
 
 #include <BatchTM/BatchTMJob.h>
 #include <Exif/ExifOperations.h>
@@ -37,20 +43,45 @@
 #include <Libpfs/manip/resize.h>
 #include <Libpfs/progress.h>
 #include <Libpfs/tm/TonemapOperator.h>
+#include <Libpfs/utils/parallel.h>
 
 #include <Common/LuminanceOptions.h>
+#include <Core/FramePipeline.h>
 #include <Core/IOWorker.h>
 
+namespace {
+// one operator of the job, run by the pool of the job
+class OperatorTask : public QRunnable {
+   public:
+    explicit OperatorTask(const std::function<void()> &func) : m_func(func) {}
+
+    void run() {
+        // the operators running at the same time share the threads of the job
+        pfs::utils::ConcurrentJob job;
+        m_func();
+    }
+
+   private:
+    std::function<void()> m_func;
+};
+}
+
 BatchTMJob::BatchTMJob(int thread_id, const QString &filename,
                        const QList<TonemappingOptions *> *tm_options,
                        const QString &output_folder, const QString &format,
-                       pfs::Params params)
+                       pfs::Params params, FramePrefetcher *prefetcher,
+                       int prefetch_index, FrameWriteQueue *write_queue,
+                       int max_operators)
     : m_thread_id(thread_id),
       m_file_name(filename),
       m_tm_options(tm_options),
       m_output_folder(output_folder),
       m_ldr_output_format(format),
-      m_params(params) {
+      m_params(params),
+      m_prefetcher(prefetcher),
+      m_prefetch_index(prefetch_index),
+      m_write_queue(write_queue),
+      m_max_operators(std::max(max_operators, 1)) {
     // m_ldr_output_format = LuminanceOptions().getBatchTmLdrFormat();
 
     m_output_file_name_base =
@@ -60,94 +91,161 @@ BatchTMJob::BatchTMJob(int thread_id, const QString &filename,
 BatchTMJob::~BatchTMJob() {}
 
 void BatchTMJob::run() {
-    pfs::Progress prog_helper;
-    IOWorker io_worker;
-
     emit add_log_message(tr("[T%1] Start processing %2")
                              .arg(m_thread_id)
                              .arg(QFileInfo(m_file_name).fileName()));
 
-    // reference frame
+    // reference frame (most likely already decoded by the prefetcher)
     QScopedPointer<pfs::Frame> reference_frame(
-        io_worker.read_hdr_frame(m_file_name));
+        m_prefetcher->take(m_prefetch_index));
 
-    if (!reference_frame.isNull()) {
+    if (reference_frame.isNull()) {
         // update message box
-        emit add_log_message(tr("[T%1] Successfully load %2")
+        emit add_log_message(tr("[T%1] ERROR: Loading of %2 failed")
                                  .arg(m_thread_id)
                                  .arg(QFileInfo(m_file_name).fileName()));
 
         // update progress bar!
-        emit increment_progress_bar(1);
+        emit increment_progress_bar(m_tm_options->size() + 1);
+        emit done(m_thread_id);
+        return;
+    }
 
-        for (int idx = 0; idx < m_tm_options->size(); ++idx) {
-            TonemappingOptions *opts = m_tm_options->at(idx);
+    // update message box
+    emit add_log_message(tr("[T%1] Successfully load %2")
+                             .arg(m_thread_id)
+                             .arg(QFileInfo(m_file_name).fileName()));
+
+    // update progress bar!
+    emit increment_progress_bar(1);
+
+    // the options are shared with the other jobs: each job sets the size of
+    // its own frame on a copy
+    QVector<TonemappingOptions> options;
+    options.reserve(m_tm_options->size());
+    foreach (const TonemappingOptions *tm_options, *m_tm_options) {
+        TonemappingOptions opts(*tm_options);
+        opts.tonemapSelection = false;  // just to be sure!
+        opts.origxsize = reference_frame->getWidth();
+        opts.xsize = (int)opts.origxsize * opts.xsize_percent / 100;
+        options.push_back(opts);
+    }
 
-            opts->tonemapSelection = false;  // just to be sure!
-            opts->origxsize = reference_frame->getWidth();
+    // option sets with the same size and pre-gamma, in order of appearance
+    QVector<QVector<int> > groups;
+    for (int idx = 0; idx < options.size(); ++idx) {
+        int group = 0;
+        while (group < groups.size() &&
+               (options[groups[group].first()].xsize != options[idx].xsize ||
+                options[groups[group].first()].pregamma !=
+                    options[idx].pregamma)) {
+            ++group;
+        }
+        if (group == groups.size()) {
+            groups.push_back(QVector<int>());
+        }
+        groups[group].push_back(idx);
+    }
 
-            opts->xsize = (int)opts->origxsize * opts->xsize_percent / 100;
+    QThreadPool pool;
+    pool.setMaxThreadCount(m_max_operators);
 
-            QScopedPointer<pfs::Frame> temporary_frame;
-            if (opts->origxsize == opts->xsize) {
-                temporary_frame.reset(pfs::copy(reference_frame.data()));
+    foreach (const QVector<int> &group, groups) {
+        const TonemappingOptions &first = options[group.first()];
+
+        // input of the operators of the group: resized and gamma corrected
+        // once, then only read (every operator writes on its own copy)
+        QScopedPointer<pfs::Frame> input;
+        {
+            pfs::utils::ConcurrentJob job;
+            if (first.origxsize == first.xsize) {
+                input.reset(pfs::copy(reference_frame.data()));
             } else {
-                temporary_frame.reset(pfs::resize(reference_frame.data(),
-                                                  opts->xsize, BilinearInterp));
+                input.reset(pfs::resize(reference_frame.data(), first.xsize,
+                                        BilinearInterp));
             }
-
-            if (opts->pregamma != 1.0f) {
-                pfs::applyGamma(temporary_frame.data(), opts->pregamma);
+            if (first.pregamma != 1.0f) {
+                pfs::applyGamma(input.data(), first.pregamma);
             }
+            input->endWrite();
+        }
+        const pfs::Frame &shared_input = *input;
 
+        // the option sets reusing the intermediate results of each other run
+        // one after the other on the same operator, the others in parallel
+        QVector<QVector<const TonemappingOptions *> > sweeps;
+        foreach (int idx, group) {
+            const TonemappingOptions &opts = options[idx];
             QScopedPointer<TonemapOperator> tm_operator(
-                TonemapOperator::getTonemapOperator(opts->tmoperator));
-
-            try {
-                tm_operator->tonemapFrame(*temporary_frame, opts, prog_helper);
-            } catch (...) {
-                emit add_log_message(
-                    tr("[T%1] ERROR: Failed to tonemap file: %2")
-                        .arg(m_thread_id)
-                        .arg(QFileInfo(m_file_name).fileName()));
-                emit increment_progress_bar(m_tm_options->size() + 1);
-                emit done(m_thread_id);
-                return;
+                TonemapOperator::getTonemapOperator(opts.tmoperator));
+
+            int sweep = 0;
+            while (sweep < sweeps.size() &&
+                   !tm_operator->sharesIntermediates(*sweeps[sweep].first(),
+                                                     opts)) {
+                ++sweep;
+            }
+            if (sweep == sweeps.size()) {
+                sweeps.push_back(QVector<const TonemappingOptions *>());
             }
+            sweeps[sweep].push_back(&opts);
+        }
 
-            QString output_file_name = m_output_file_name_base + "_" +
-                                       opts->getPostfix() + "." +
-                                       m_ldr_output_format;
+        for (int sweep = 0; sweep < sweeps.size(); ++sweep) {
+            const QVector<const TonemappingOptions *> &sweep_options =
+                sweeps[sweep];
+            pool.start(new OperatorTask(
+                [this, &shared_input, &sweep_options]() {
+                    tonemap(shared_input, sweep_options);
+                }));
+        }
+        pool.waitForDone();
+    }
 
-            if (io_worker.write_ldr_frame(
-                    temporary_frame.data(), output_file_name,
-                    "FromHdrFile",  // inform we tonemapped an
-                                    // existing HDR with no exif
-                                    // data
-                    QVector<float>(), opts, m_params)) {
-                emit add_log_message(
-                    tr("[T%1] Successfully saved LDR file: %2")
-                        .arg(m_thread_id)
-                        .arg(QFileInfo(output_file_name).fileName()));
-            } else {
-                emit add_log_message(
-                    tr("[T%1] ERROR: Cannot save to file: %2")
-                        .arg(m_thread_id)
-                        .arg(QFileInfo(output_file_name).fileName()));
-            }
+    emit done(m_thread_id);
+}
+
+void BatchTMJob::tonemap(
+    const pfs::Frame &input,
+    const QVector<const TonemappingOptions *> &sweep_options) {
+    pfs::Progress prog_helper;
 
+    QScopedPointer<TonemapOperator> tm_operator(
+        TonemapOperator::getTonemapOperator(
+            sweep_options.first()->tmoperator));
+
+    foreach (const TonemappingOptions *opts, sweep_options) {
+        TonemappingOptions tm_options(*opts);
+
+        QScopedPointer<pfs::Frame> temporary_frame;
+        try {
+            temporary_frame.reset(
+                tm_operator->tonemapSweep(input, &tm_options, prog_helper));
+        } catch (...) {
+            emit add_log_message(tr("[T%1] ERROR: Failed to tonemap file: %2")
+                                     .arg(m_thread_id)
+                                     .arg(QFileInfo(m_file_name).fileName()));
             emit increment_progress_bar(1);
+            continue;
         }
-    } else {
-        // update message box
-        // emit add_log_message(error_message);
-        emit add_log_message(tr("[T%1] ERROR: Loading of %2 failed")
-                                 .arg(m_thread_id)
-                                 .arg(QFileInfo(m_file_name).fileName()));
 
-        // update progress bar!
-        emit increment_progress_bar(m_tm_options->size() + 1);
+        QString output_file_name = m_output_file_name_base + "_" +
+                                   tm_options.getPostfix() + "." +
+                                   m_ldr_output_format;
+
+        // encoding overlaps with the next operators
+        const pfs::Params write_params(m_params);
+        m_write_queue->submit(
+            pfs::FramePtr(temporary_frame.take()), output_file_name,
+            [tm_options, write_params](pfs::Frame &frame,
+                                       const QString &filename) {
+                TonemappingOptions tmopts(tm_options);
+                return IOWorker().write_ldr_frame(
+                    &frame, filename,
+                    "FromHdrFile",  // inform we tonemapped an
+                                    // existing HDR with no exif
+                                    // data
+                    QVector<float>(), &tmopts, write_params);
+            });
     }
-
-    emit done(m_thread_id);
 }
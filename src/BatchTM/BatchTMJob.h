@@ -32,19 +32,30 @@
 #include <QList>
 #include <QString>
 #include <QThread>
+#include <QVector>
 
 #include <Libpfs/params.h>
 
 // Forward declaration
+namespace pfs {
+class Frame;
+}
 class TonemappingOptions;
+class FramePrefetcher;
+class FrameWriteQueue;
 
 class BatchTMJob : public QThread {
     Q_OBJECT
    public:
+    //! \brief the option sets giving the same input to their operator (same
+    //! size and pre-gamma) share it, and up to \a max_operators of them are
+    //! tonemapped at the same time
     BatchTMJob(int thread_id, const QString &filename,
                const QList<TonemappingOptions *> *tm_options,
                const QString &output_folder, const QString &ldr_output_format,
-               pfs::Params params);
+               pfs::Params params, FramePrefetcher *prefetcher,
+               int prefetch_index, FrameWriteQueue *write_queue,
+               int max_operators = 1);
     virtual ~BatchTMJob();
    signals:
     void done(int thread_id);
@@ -56,6 +67,14 @@ class BatchTMJob : public QThread {
     void run();
 
    private:
+    //! \brief tonemap \a input with each of \a sweep_options in turn, and
+    //! queue the results for writing
+    //! \note a single operator sweeps the option sets, reusing the stages
+    //! they have in common (see \c TonemapOperator::tonemapSweep); \a input
+    //! is shared by the operators running at the same time
+    void tonemap(const pfs::Frame &input,
+                 const QVector<const TonemappingOptions *> &sweep_options);
+
     int m_thread_id;
     QString m_file_name;
     const QList<TonemappingOptions *> *m_tm_options;
@@ -63,6 +82,10 @@ class BatchTMJob : public QThread {
     QString m_output_file_name_base;
     QString m_ldr_output_format;
     pfs::Params m_params;
+    FramePrefetcher *m_prefetcher;
+    int m_prefetch_index;
+    FrameWriteQueue *m_write_queue;
+    int m_max_operators;
 };
 
 #endif  // BATCHTMJOB_H
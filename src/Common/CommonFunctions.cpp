@@ -31,11 +31,11 @@
 #include <valarray>
 
 #include <Core/IOWorker.h>
-#include <Exif/ExifOperations.h>
 #include <Libpfs/colorspace/colorspace.h>
 #include <Libpfs/colorspace/convert.h>
 #include <Libpfs/colorspace/normalizer.h>
 #include <Libpfs/frame.h>
+#include <Libpfs/histogram.h>
 #include <Libpfs/io/framereader.h>
 #include <Libpfs/io/framereaderfactory.h>
 #include <Libpfs/io/framewriter.h>
@@ -48,56 +48,29 @@
 #include <Libpfs/manip/shift.h>
 #include <Libpfs/params.h>
 #include <Libpfs/utils/msec_timer.h>
+#include <Libpfs/utils/parallel.h>
+#include <Libpfs/utils/trace.h>
 #include <Libpfs/utils/transform.h>
 #include <Libpfs/exif/exifdata.hpp>
 #include <Common/CommonFunctions.h>
 #include <Common/LuminanceOptions.h>
 
 #include <boost/algorithm/minmax_element.hpp>
-#include <omp.h>
 
 using namespace std;
 using namespace pfs;
 using namespace pfs::io;
 using namespace libhdr::fusion;
 
-static void build_histogram(valarray<float> &hist, const valarray<uint8_t> &src) {
-    const size_t size = src.size();
-
-    size_t numThreads = 1;
-
-#ifdef _OPENMP
-    // Because we have an overhead in the critical region of the main loop for each thread
-    // we make a rough calculation to reduce the number of threads for small data size.
-    const size_t maxThreads = omp_get_max_threads();
-    while (size > numThreads * numThreads * 16384 && numThreads < maxThreads) {
-        ++numThreads;
-    }
-#endif
-
-    // Original version used a valarray<float>
-    // We use a valarray<uint32_t>, because incrementing a float value of 0.f by 1.f saturates at 16777215.f
-    valarray<uint32_t> histInt(0u, hist.size());
-
-#pragma omp parallel num_threads(numThreads)
-{
-    valarray<uint32_t> histThr(0u, hist.size());
-
-    #pragma omp for nowait
-    for (size_t i = 0; i < size; i++) {
-        histThr[src[i]]++;
-    }
-
-    // add per thread histogram to global histogram
-    #pragma omp critical
-    for(size_t i = 0; i < hist.size(); i++) {
-        histInt[i] += histThr[i];
-    }
-}
+template <typename BinOf>
+static void build_histogram(valarray<float> &hist, size_t size,
+                            const BinOf &binOf) {
+    pfs::Histogram histogram(pfs::HistogramParams(hist.size()));
+    histogram.compute(size, binOf);
 
     // copy to float histogram
-    for(size_t i = 0; i < hist.size(); i++) {
-        hist[i] = histInt[i];
+    for (size_t i = 0; i < hist.size(); i++) {
+        hist[i] = histogram.getCount(i);
     }
 
     // find max
@@ -188,51 +161,33 @@ void computeAutolevels(const QImage *data, const float threshold,
     const QRgb *src = reinterpret_cast<const QRgb *>(data->bits());
     const int width = data->width();
     const int height = data->height();
-    const int ELEMENTS = width * height;
+    const size_t ELEMENTS = size_t(width) * height;
 
     float minL, maxL;
     float minR, maxR;
     float minG, maxG;
     float minB, maxB;
 
-    // Convert to lightness
-    valarray<uint8_t> lightness(ELEMENTS);
-
-    #pragma omp parallel for
-    for (int i = 0; i < ELEMENTS; i++) {
-        lightness[i] = QColor::fromRgb(src[i]).toHsl().lightness();
-    }
-
-    // Build histogram
+    // Build histograms straight from the pixels: no intermediate planes
     valarray<float> histL(0.f, COLOR_DEPTH);
-    build_histogram(histL, lightness);
+    build_histogram(histL, ELEMENTS, [src](size_t i) {
+        return size_t(QColor::fromRgb(src[i]).toHsl().lightness());
+    });
     compute_histogram_minmax(histL, threshold, minL, maxL);
 
-    // get Red, Gree, Blue
-    valarray<uint8_t> red(ELEMENTS);
-    valarray<uint8_t> green(ELEMENTS);
-    valarray<uint8_t> blue(ELEMENTS);
-
-    #pragma omp parallel for
-    for (int i = 0; i < ELEMENTS; i++) {
-        red[i] = qRed(src[i]);
-        green[i] = qGreen(src[i]);
-        blue[i] = qBlue(src[i]);
-    }
-
-    // Build histogram
     valarray<float> histR(0.f, COLOR_DEPTH);
-    build_histogram(histR, red);
+    build_histogram(histR, ELEMENTS,
+                    [src](size_t i) { return size_t(qRed(src[i])); });
     compute_histogram_minmax(histR, threshold, minR, maxR);
 
-    // Build histogram
     valarray<float> histG(0.f, COLOR_DEPTH);
-    build_histogram(histG, green);
+    build_histogram(histG, ELEMENTS,
+                    [src](size_t i) { return size_t(qGreen(src[i])); });
     compute_histogram_minmax(histG, threshold, minG, maxG);
 
-    // Build histogram
     valarray<float> histB(0.f, COLOR_DEPTH);
-    build_histogram(histB, blue);
+    build_histogram(histB, ELEMENTS,
+                    [src](size_t i) { return size_t(qBlue(src[i])); });
     compute_histogram_minmax(histB, threshold, minB, maxB);
 
     minHist = min(min(minL, minR), min(minG, minB));
@@ -269,25 +224,43 @@ void LoadFile::operator()(HdrCreationItem &currentItem) {
     if (currentItem.filename().isEmpty()) {
         return;
     }
+    PFS_TRACE_SPAN("LoadFile", "io");
 
     QFileInfo qfi(currentItem.alignedFilename());
 
+    // files are loaded concurrently (QtConcurrent::map)
+    pfs::utils::ConcurrentJob job;
     try {
         QByteArray filePath = QFile::encodeName(qfi.filePath());
 
         qDebug() << QStringLiteral("LoadFile: Loading data for %1")
                         .arg(filePath.constData());
 
+        pfs::Params params = getRawSettings();
+        if (m_scaleDenom > 1) {
+            // the frame and the preview built from it come out reduced
+            params.set("scale_denom", m_scaleDenom);
+        }
+
         FrameReaderPtr reader = FrameReaderFactory::open(filePath.constData());
-        reader->read(*currentItem.frame(), getRawSettings());
+        const size_t fileSize = reader->width() * reader->height();
+        reader->read(*currentItem.frame(), params);
+        // formats without reduced decoding ignore the scale
+        currentItem.setReduced(currentItem.frame()->size() < fileSize);
+
+        // EXIF data of the original file: aligned files carry a copy of it, so
+        // a single parsing is enough (shared with the reader when possible)
+        QByteArray originalPath = QFile::encodeName(currentItem.filename());
+        const pfs::exif::ExifData exifData =
+            (originalPath == filePath)
+                ? reader->exifData()
+                : FrameReaderFactory::probe(originalPath.constData()).exifData;
 
         // read Average Luminance
-        pfs::exif::ExifData exifData(currentItem.filename().toStdString());
         currentItem.setAverageLuminance(exifData.getAverageSceneLuminance());
 
         // read Exposure Time
-        currentItem.setExposureTime(
-            ExifOperations::getExposureTime(filePath.constData()));
+        currentItem.setExposureTime(exifData.getExposureTime());
 
         qDebug() << QStringLiteral("LoadFile: Average Luminance for %1 is %2")
                         .arg(currentItem.filename())
@@ -367,6 +340,7 @@ SaveFile::SaveFile(int mode, float minLum, float maxLum,
       m_deflateCompression(deflateCompression) {}
 
 void SaveFile::operator()(HdrCreationItem &currentItem) {
+    PFS_TRACE_SPAN("SaveFile", "io");
     QUuid uuid = QUuid::createUuid();
     QString inputFilename = currentItem.filename();
 
@@ -378,6 +352,8 @@ void SaveFile::operator()(HdrCreationItem &currentItem) {
     qDebug() << QStringLiteral("SaveFile: Saving data for %1 to %2 on %3")
                     .arg(inputFilename, outputFilename, tempdir);
 
+    pfs::utils::ConcurrentJob job;
+
     // save pfs::Frame as tiff 16bits or 32bits
     try {
         Params p;
@@ -401,6 +377,7 @@ void RefreshPreview::operator()(HdrCreationItem &currentItem) {
     qDebug() << QStringLiteral("RefreshPreview: Refresh preview for %1")
                     .arg(currentItem.filename());
 
+    pfs::utils::ConcurrentJob job;
     try {
         // build QImage
         QImage tempImage(currentItem.frame()->getWidth(),
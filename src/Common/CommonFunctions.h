@@ -132,7 +132,10 @@ struct ConvertToQRgb {
 };
 
 struct LoadFile {
-    explicit LoadFile(bool fromFITS = false) : m_datamax(0.f), m_datamin(0.f) {
+    //! \param scaleDenom decode JPEG and RAW files at about 1/scaleDenom of
+    //! their size (1, 2, 4 or 8), for callers that only need the preview
+    explicit LoadFile(bool fromFITS = false, int scaleDenom = 1)
+        : m_datamax(0.f), m_datamin(0.f), m_scaleDenom(scaleDenom) {
         m_fromFITS = fromFITS;
     }
     void operator()(HdrCreationItem &currentItem);
@@ -140,6 +143,7 @@ struct LoadFile {
     float m_datamax;
     float m_datamin;
     bool m_fromFITS;
+    int m_scaleDenom;
 };
 
 struct SaveFile {
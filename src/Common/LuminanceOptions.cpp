@@ -39,9 +39,13 @@
 #include <QMessageBox>
 #include <QString>
 #include <QStyleFactory>
+#include <QThreadPool>
+#include <algorithm>
 
 #include "Common/LuminanceOptions.h"
 #include "Common/config.h"
+#include "Libpfs/utils/parallel.h"
+#include "Libpfs/utils/trace.h"
 
 #if defined(Q_OS_WIN)
 const QString LuminanceOptions::LUMINANCE_HDR_HOME_FOLDER = "LuminanceHDR";
@@ -592,6 +596,64 @@ void LuminanceOptions::setBatchTmNumThreads(int v) {
     m_settingHolder->setValue(KEY_BATCH_TM_NUM_THREADS, v);
 }
 
+int LuminanceOptions::getBatchMemoryBudget() {
+    return m_settingHolder->value(KEY_BATCH_MEMORY_BUDGET, 1024).toInt();
+}
+
+void LuminanceOptions::setBatchMemoryBudget(int v) {
+    m_settingHolder->setValue(KEY_BATCH_MEMORY_BUDGET, v);
+}
+
+int LuminanceOptions::getTonemapCacheSize() {
+    return m_settingHolder->value(KEY_TONEMAP_CACHE_SIZE, 256).toInt();
+}
+
+void LuminanceOptions::setTonemapCacheSize(int v) {
+    m_settingHolder->setValue(KEY_TONEMAP_CACHE_SIZE, v);
+}
+
+bool LuminanceOptions::isProgressiveTonemapping() {
+    return m_settingHolder->value(KEY_TONEMAP_PROGRESSIVE, true).toBool();
+}
+
+void LuminanceOptions::setProgressiveTonemapping(bool b) {
+    m_settingHolder->setValue(KEY_TONEMAP_PROGRESSIVE, b);
+}
+
+int LuminanceOptions::getConcurrency() {
+    return m_settingHolder->value(KEY_CONCURRENCY, 0).toInt();
+}
+
+void LuminanceOptions::setConcurrency(int v) {
+    m_settingHolder->setValue(KEY_CONCURRENCY, v);
+}
+
+void LuminanceOptions::applyConcurrency() {
+    pfs::utils::setConcurrency(std::max(getConcurrency(), 0));
+    QThreadPool::globalInstance()->setMaxThreadCount(
+        static_cast<int>(pfs::utils::getConcurrency()));
+}
+
+QString LuminanceOptions::getTraceFile() {
+    return m_settingHolder->value(KEY_TRACE_FILE, QString()).toString();
+}
+
+void LuminanceOptions::setTraceFile(const QString &s) {
+    m_settingHolder->setValue(KEY_TRACE_FILE, s);
+}
+
+void LuminanceOptions::applyTracing() {
+    pfs::utils::trace::setEnabled(!getTraceFile().isEmpty());
+}
+
+bool LuminanceOptions::writeTrace() {
+    const QString traceFile = getTraceFile();
+    if (traceFile.isEmpty()) return true;
+
+    return pfs::utils::trace::writeChromeTrace(
+        QFile::encodeName(traceFile).constData());
+}
+
 namespace {
 #ifdef QT_DEBUG
 struct PrintTempDir {
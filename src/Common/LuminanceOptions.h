@@ -184,6 +184,32 @@ class LuminanceOptions : public QObject {
     int getNumThreads() { return getBatchTmNumThreads(); }
     void setNumThreads(int i) { setBatchTmNumThreads(i); }
 
+    // memory (in MB) for the frames in flight in the batch pipelines
+    int getBatchMemoryBudget();
+    void setBatchMemoryBudget(int);
+
+    // memory (in MB) for the tonemapped frames kept for reuse (0: disabled)
+    int getTonemapCacheSize();
+    void setTonemapCacheSize(int);
+
+    // show proxies of the frame being tonemapped before the full size one
+    bool isProgressiveTonemapping();
+    void setProgressiveTonemapping(bool);
+
+    // threads available to the whole process (0: one per processor)
+    int getConcurrency();
+    void setConcurrency(int);
+    // apply the limit to Libpfs and to the global Qt thread pool
+    void applyConcurrency();
+
+    // file the spans of the processing stages are written to (empty: off)
+    QString getTraceFile();
+    void setTraceFile(const QString &);
+    // start recording the spans if a trace file is set, stop otherwise
+    void applyTracing();
+    // write the spans recorded so far to the trace file, if any
+    bool writeTrace();
+
     // Default Paths
     // Path to save temporary cached files
     QString getTempDir();
@@ -26,7 +26,8 @@
 
 using namespace pfs;
 
-ProgressHelper::ProgressHelper(QObject *p) : QObject(p), Progress() {}
+ProgressHelper::ProgressHelper(QObject *p)
+    : QObject(p), Progress(), m_token(NULL), m_generation(0) {}
 
 void ProgressHelper::setValue(int value) {
     Progress::setValue(value);
@@ -48,4 +49,15 @@ void ProgressHelper::setRange(int minimum, int maximum) {
     emit qtSetRange(minimum, maximum);
 }
 
+void ProgressHelper::setGenerationToken(const QAtomicInt *token,
+                                        int generation) {
+    m_token = token;
+    m_generation = generation;
+}
+
+bool ProgressHelper::canceled() const {
+    return Progress::canceled() ||
+           (m_token != NULL && m_token->load() != m_generation);
+}
+
 void ProgressHelper::qtCancel(bool b) { Progress::cancel(b); }
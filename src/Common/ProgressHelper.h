@@ -27,6 +27,7 @@
 #ifndef PROGRESSHELPER_H
 #define PROGRESSHELPER_H
 
+#include <QAtomicInt>
 #include <QObject>
 #include "Libpfs/progress.h"
 
@@ -41,6 +42,13 @@ class ProgressHelper : public QObject, public pfs::Progress {
     void setMaximum(int maximum);
     void setMinimum(int minimum);
 
+    //! \brief consider the operation canceled as soon as \a token differs
+    //! from \a generation, so that work started for an outdated request
+    //! stops by itself (NULL: no token). \a token must outlive the operation
+    void setGenerationToken(const QAtomicInt *token, int generation);
+
+    bool canceled() const;
+
    public slots:
     void qtCancel(bool b = true);
 
@@ -49,6 +57,10 @@ class ProgressHelper : public QObject, public pfs::Progress {
     void qtSetRange(int minimum, int maximum);
     void qtSetMaximum(int max);
     void qtSetMinimum(int min);
+
+   private:
+    const QAtomicInt *m_token;
+    int m_generation;
 };
 
 #endif  // PROGRESSHELPER_H
@@ -20,11 +20,9 @@
 */
 
 #include <fftw3.h>
-#ifdef _OPENMP
-#include <omp.h>
-#endif
 
 #include <Common/init_fftw.h>
+#include <Libpfs/utils/parallel.h>
 
 using namespace std;
 
@@ -40,12 +38,10 @@ void init_fftw() {
     // activate parallel execution of fft routines
     if (!is_init_threads) {
         fftwf_init_threads();
-#ifdef _OPENMP
-        fftwf_plan_with_nthreads(omp_get_max_threads());
-#else
-        fftwf_plan_with_nthreads(2);
-#endif
         is_init_threads = true;
     }
+    // plans created from now on by the calling job use its share of threads
+    fftwf_plan_with_nthreads(
+        static_cast<int>(pfs::utils::getThreadsPerJob()));
     FFTW_MUTEX::fftw_mutex_global.unlock();
 }
@@ -0,0 +1,314 @@
+/**
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ *
+ * Original Work
+ * @author agent <agent@local>
+ *
+ */
+
+#include <Core/BatchScheduler.h>
+
+#include <QFile>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include <Core/FramePipeline.h>
+#include <Core/TonemappingOptions.h>
+#include <Libpfs/io/framereaderfactory.h>
+#include <Libpfs/utils/parallel.h>
+
+namespace {
+
+// working memory of the operators, in float planes of the size of the
+// frame they run on (buffers, pyramids and solvers at their peak)
+qint64 operatorPlanes(const TonemappingOptions &opts) {
+    switch (opts.tmoperator) {
+        case mantiuk06:
+            return 14;
+        case mantiuk08:
+            return 6;
+        case fattal:
+            return opts.operator_options.fattaloptions.fftsolver ? 10 : 14;
+        case ferradans:
+            return 12;
+        case drago:
+            return 2;
+        case durand:
+            return 8;
+        case reinhard02:
+            return opts.operator_options.reinhard02options.scales
+                       ? 2 + std::max(
+                                 opts.operator_options.reinhard02options.range,
+                                 1)
+                       : 2;
+        case reinhard05:
+            return 2;
+        case ashikhmin:
+            return opts.operator_options.ashikhminoptions.simple ? 2 : 6;
+        case pattanaik:
+            return opts.operator_options.pattanaikoptions.local ? 4 : 2;
+        case mai:
+            return 2;
+    }
+    return 6;
+}
+
+// bytes of a float plane of width x height
+qint64 planeSize(qint64 width, qint64 height) {
+    return width * height * static_cast<qint64>(sizeof(float));
+}
+
+struct LargerJob {
+    explicit LargerJob(const QVector<qint64> &memory) : m_memory(memory) {}
+
+    bool operator()(int a, int b) const { return m_memory[a] > m_memory[b]; }
+
+    const QVector<qint64> &m_memory;
+};
+
+struct InputOrder {
+    explicit InputOrder(const QVector<QString> &inputs) : m_inputs(inputs) {}
+
+    bool operator()(int a, int b) const { return m_inputs[a] < m_inputs[b]; }
+
+    const QVector<QString> &m_inputs;
+};
+}
+
+qint64 estimateTonemapMemory(qint64 width, qint64 height,
+                             const TonemappingOptions &opts) {
+    // the working copy (3 channels) plus the buffers of the operator
+    return (3 + operatorPlanes(opts)) * planeSize(width, height);
+}
+
+qint64 estimateBatchTMJobMemory(const QString &filename,
+                                const QList<TonemappingOptions *> &options,
+                                int operators) {
+    pfs::io::FrameInfo info;
+    try {
+        info = pfs::io::FrameReaderFactory::probe(
+            QFile::encodeName(filename).constData());
+    } catch (std::runtime_error &) {
+        // the actual read will report the error
+        return 0;
+    }
+    const qint64 width = info.width;
+    const qint64 height = info.height;
+
+    // the reference frame stays around for all the groups of operators
+    // sharing an input, which are processed one after the other
+    QVector<const TonemappingOptions *> done;
+    qint64 peak = 0;
+    foreach (const TonemappingOptions *opts, options) {
+        if (done.contains(opts)) {
+            continue;
+        }
+        const qint64 xsize =
+            std::max<qint64>(width * opts->xsize_percent / 100, 1);
+        const qint64 ysize =
+            std::max<qint64>(height * xsize / std::max<qint64>(width, 1), 1);
+
+        QVector<qint64> group;
+        foreach (const TonemappingOptions *other, options) {
+            if (other->xsize_percent == opts->xsize_percent &&
+                other->pregamma == opts->pregamma) {
+                done.push_back(other);
+                group.push_back(estimateTonemapMemory(xsize, ysize, *other));
+            }
+        }
+
+        // the largest operators of the group running at the same time
+        std::sort(group.begin(), group.end(), std::greater<qint64>());
+        qint64 memory = 0;
+        for (int idx = 0; idx < std::min(group.size(), std::max(operators, 1));
+             ++idx) {
+            memory += group[idx];
+        }
+        // the shared input
+        if (xsize != width || opts->pregamma != 1.0f) {
+            memory += 3 * planeSize(xsize, ysize);
+        }
+        peak = std::max(peak, memory);
+    }
+    return 3 * planeSize(width, height) + peak;
+}
+
+int batchTMOperatorsPerJob(int jobs, int optionSets) {
+    const int threads = static_cast<int>(pfs::utils::getConcurrency());
+    return std::max(std::min(threads / std::max(jobs, 1), optionSets), 1);
+}
+
+qint64 estimateFusionMemory(const QStringList &exposures) {
+    qint64 memory = 0;
+    qint64 frameSize = 0;
+    foreach (const QString &filename, exposures) {
+        const qint64 size = estimateFrameMemorySize(filename);
+        memory += size;
+        frameSize = std::max(frameSize, size);
+    }
+    // the output (3 channels), the sum of the weights and the buffers of a
+    // single exposure (response and weights)
+    return memory + 2 * frameSize;
+}
+
+// BatchScheduler -------------------------------------------------------------
+
+BatchScheduler::BatchScheduler(MemoryBudget &budget, int maxJobs)
+    : m_budget(budget),
+      m_maxJobs(std::max(maxJobs, 1)),
+      m_running(0),
+      m_startWhenIdle(true) {}
+
+BatchScheduler::~BatchScheduler() {
+    for (int id = 0; id < m_jobs.size(); ++id) {
+        if (m_jobs[id].state == JOB_RUNNING) {
+            m_budget.release(m_jobs[id].memory);
+        }
+    }
+}
+
+int BatchScheduler::addJob(const QStringList &inputs, qint64 memory) {
+    QMutexLocker lock(&m_mutex);
+
+    Job job;
+    job.inputs = inputs;
+    job.memory = memory;
+    m_jobs.push_back(job);
+    m_queue.push_back(m_jobs.size() - 1);
+
+    return m_jobs.size() - 1;
+}
+
+void BatchScheduler::sort(Order order) {
+    QMutexLocker lock(&m_mutex);
+
+    switch (order) {
+        case ORDER_AS_GIVEN: {
+            std::sort(m_queue.begin(), m_queue.end());
+        } break;
+        case ORDER_LARGEST_FIRST: {
+            QVector<qint64> memory(m_jobs.size());
+            for (int id = 0; id < m_jobs.size(); ++id) {
+                memory[id] = m_jobs[id].memory;
+            }
+            std::stable_sort(m_queue.begin(), m_queue.end(),
+                             LargerJob(memory));
+        } break;
+        case ORDER_BY_INPUT: {
+            QVector<QString> inputs(m_jobs.size());
+            for (int id = 0; id < m_jobs.size(); ++id) {
+                if (!m_jobs[id].inputs.isEmpty()) {
+                    inputs[id] = m_jobs[id].inputs.first();
+                }
+            }
+            std::stable_sort(m_queue.begin(), m_queue.end(),
+                             InputOrder(inputs));
+        } break;
+    }
+}
+
+void BatchScheduler::setStartWhenIdle(bool startWhenIdle) {
+    QMutexLocker lock(&m_mutex);
+    m_startWhenIdle = startWhenIdle;
+}
+
+QList<int> BatchScheduler::queue() const {
+    QMutexLocker lock(&m_mutex);
+    return m_queue;
+}
+
+QStringList BatchScheduler::inputs(int id) const {
+    QMutexLocker lock(&m_mutex);
+    return m_jobs[id].inputs;
+}
+
+qint64 BatchScheduler::memory(int id) const {
+    QMutexLocker lock(&m_mutex);
+    return m_jobs[id].memory;
+}
+
+int BatchScheduler::startLocked() {
+    if (m_queue.isEmpty() || m_running >= m_maxJobs) {
+        return -1;
+    }
+    const bool force = (m_running == 0) && m_startWhenIdle;
+
+    for (QList<int>::iterator it = m_queue.begin(); it != m_queue.end();
+         ++it) {
+        Job &job = m_jobs[*it];
+        if (force) {
+            m_budget.forceAcquire(job.memory);
+        } else if (!m_budget.tryAcquire(job.memory)) {
+            continue;
+        }
+
+        const int id = *it;
+        m_queue.erase(it);
+        job.state = JOB_RUNNING;
+        ++m_running;
+        return id;
+    }
+    return -1;
+}
+
+int BatchScheduler::tryStart() {
+    QMutexLocker lock(&m_mutex);
+    return startLocked();
+}
+
+int BatchScheduler::start() {
+    QMutexLocker lock(&m_mutex);
+    while (!m_queue.isEmpty()) {
+        const int id = startLocked();
+        if (id >= 0) {
+            return id;
+        }
+        // the budget is released by other threads too: poll it
+        lock.unlock();
+        m_budget.waitForRelease(100);
+        lock.relock();
+    }
+    return -1;
+}
+
+void BatchScheduler::finish(int id) {
+    QMutexLocker lock(&m_mutex);
+
+    Job &job = m_jobs[id];
+    Q_ASSERT(job.state == JOB_RUNNING);
+    job.state = JOB_DONE;
+    --m_running;
+
+    // wakes up the threads waiting in start()
+    m_budget.release(job.memory);
+}
+
+int BatchScheduler::pending() const {
+    QMutexLocker lock(&m_mutex);
+    return m_queue.size();
+}
+
+int BatchScheduler::running() const {
+    QMutexLocker lock(&m_mutex);
+    return m_running;
+}
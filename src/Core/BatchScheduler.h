@@ -0,0 +1,152 @@
+/**
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ *
+ * Original Work
+ * @author agent <agent@local>
+ *
+ */
+
+//! \brief Admission of the batch jobs against the memory budget, and cost
+//! model of the tonemapping and fusion jobs
+
+#ifndef BATCHSCHEDULER_H
+#define BATCHSCHEDULER_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class MemoryBudget;
+class TonemappingOptions;
+
+//! \brief peak memory (in bytes) of tonemapping a \a width x \a height frame
+//! with \a opts, the working copy of the frame included
+qint64 estimateTonemapMemory(qint64 width, qint64 height,
+                             const TonemappingOptions &opts);
+
+//! \brief peak memory of a batch job tonemapping \a filename with each of
+//! \a options, estimated from the header of the file
+//! \note the option sets with the same size and pre-gamma share their input,
+//! and up to \a operators of them run at the same time (see \c BatchTMJob)
+qint64 estimateBatchTMJobMemory(const QString &filename,
+                                const QList<TonemappingOptions *> &options,
+                                int operators = 1);
+
+//! \brief number of operators each of \a jobs batch jobs runs at the same
+//! time, so that the jobs together use all the threads of the process
+int batchTMOperatorsPerJob(int jobs, int optionSets);
+
+//! \brief peak memory of the fusion of the set of \a exposures into an HDR
+qint64 estimateFusionMemory(const QStringList &exposures);
+
+//! \brief Decides which batch job runs next
+//! Every job has an estimate of its peak memory: a job is started only when
+//! that memory is available in the budget (shared with the read-ahead and
+//! write-behind stages of \c FramePipeline.h) and less than \c maxJobs jobs
+//! are running. When the next job in order does not fit, the following ones
+//! that do are started in its place.
+//! \note by default a job is always started when no other job is running,
+//! whatever its estimate: the budget can only delay the jobs, never stop the
+//! batch (see \c setStartWhenIdle)
+class BatchScheduler {
+   public:
+    enum Order {
+        //! keep the order in which the jobs have been added
+        ORDER_AS_GIVEN,
+        //! largest estimates first, the small jobs fill the gaps at the end
+        ORDER_LARGEST_FIRST,
+        //! jobs sharing their first input one after the other (the frames
+        //! read ahead for a job are still around for the next one)
+        ORDER_BY_INPUT
+    };
+
+    BatchScheduler(MemoryBudget &budget, int maxJobs);
+    //! \brief release the memory of the jobs still running
+    ~BatchScheduler();
+
+    //! \brief add a job reading \a inputs, taking \a memory bytes at peak
+    //! \return id of the job, that is its index in the order of insertion
+    int addJob(const QStringList &inputs, qint64 memory);
+
+    //! \brief sort the jobs not started yet
+    void sort(Order order);
+
+    //! \brief whether a job starts when no other job is running, even if it
+    //! does not fit in the budget (default: true)
+    //! \note turn it off only when the memory not taken by the jobs is
+    //! eventually released (i.e. by a \c FrameWriteQueue), or the batch would
+    //! stop: the frames read ahead are released only by the jobs
+    void setStartWhenIdle(bool startWhenIdle);
+
+    //! \brief ids of the jobs not started yet, in the order they are going to
+    //! start
+    //! \note this is the order their inputs should be read ahead in
+    QList<int> queue() const;
+
+    QStringList inputs(int id) const;
+    qint64 memory(int id) const;
+
+    //! \brief start the first job (in order) that fits in the budget
+    //! \return id of the job, or -1 if no job can start now
+    int tryStart();
+
+    //! \brief start the next job, waiting for memory to be released if
+    //! needed (by \c finish, or by the other users of the budget)
+    //! \return id of the job, or -1 if all the jobs have been started
+    int start();
+
+    //! \brief the job \a id is done, its memory goes back to the budget
+    void finish(int id);
+
+    //! \brief number of jobs not started yet
+    int pending() const;
+    //! \brief number of jobs started and not finished
+    int running() const;
+
+   private:
+    Q_DISABLE_COPY(BatchScheduler)
+
+    enum JobState { JOB_PENDING, JOB_RUNNING, JOB_DONE };
+
+    struct Job {
+        Job() : memory(0), state(JOB_PENDING) {}
+
+        QStringList inputs;
+        qint64 memory;
+        JobState state;
+    };
+
+    // m_mutex must be held by the caller
+    int startLocked();
+
+    mutable QMutex m_mutex;
+    MemoryBudget &m_budget;
+    const int m_maxJobs;
+
+    QVector<Job> m_jobs;
+    //! \brief ids of the jobs not started yet, in order
+    QList<int> m_queue;
+    int m_running;
+    bool m_startWhenIdle;
+};
+
+#endif  // BATCHSCHEDULER_H
@@ -0,0 +1,300 @@
+/**
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ *
+ * Original Work
+ * @author agent <agent@local>
+ *
+ */
+
+#include <Core/FramePipeline.h>
+
+#include <QDebug>
+#include <QFile>
+#include <QMutexLocker>
+#include <QRunnable>
+
+#include <Common/LuminanceOptions.h>
+#include <Libpfs/io/framereaderfactory.h>
+#include <Libpfs/utils/parallel.h>
+
+// MemoryBudget ---------------------------------------------------------------
+
+MemoryBudget::MemoryBudget(qint64 capacity)
+    : m_capacity(capacity), m_used(0) {}
+
+bool MemoryBudget::isAvailable(qint64 bytes) const {
+    return (m_used == 0) || (m_used + bytes <= m_capacity);
+}
+
+bool MemoryBudget::tryAcquire(qint64 bytes) {
+    QMutexLocker lock(&m_mutex);
+    if (!isAvailable(bytes)) {
+        return false;
+    }
+    m_used += bytes;
+    return true;
+}
+
+void MemoryBudget::forceAcquire(qint64 bytes) {
+    QMutexLocker lock(&m_mutex);
+    m_used += bytes;
+}
+
+void MemoryBudget::release(qint64 bytes) {
+    QMutexLocker lock(&m_mutex);
+    m_used -= bytes;
+    Q_ASSERT(m_used >= 0);
+    m_released.wakeAll();
+}
+
+void MemoryBudget::waitForRelease(unsigned long msecs) {
+    QMutexLocker lock(&m_mutex);
+    m_released.wait(&m_mutex, msecs);
+}
+
+qint64 frameMemorySize(const pfs::Frame &frame) {
+    qint64 size = 0;
+    const pfs::ChannelContainer &channels = frame.getChannels();
+    for (pfs::ChannelContainer::const_iterator it = channels.begin(),
+                                               itEnd = channels.end();
+         it != itEnd; ++it) {
+        size += (*it)->size() * sizeof(float);
+    }
+    return size;
+}
+
+qint64 estimateFrameMemorySize(const QString &filename) {
+    try {
+        pfs::io::FrameInfo info = pfs::io::FrameReaderFactory::probe(
+            QFile::encodeName(filename).constData());
+        // frames are always decoded in (at least) three float channels
+        return static_cast<qint64>(info.width) * info.height * 3 *
+               sizeof(float);
+    } catch (std::runtime_error &) {
+        // the actual read will report the error
+        return 0;
+    }
+}
+
+qint64 batchMemoryBudget() {
+    return static_cast<qint64>(LuminanceOptions().getBatchMemoryBudget()) *
+           1024 * 1024;
+}
+
+// FramePrefetcher ------------------------------------------------------------
+
+class FramePrefetcher::ReadTask : public QRunnable {
+   public:
+    ReadTask(FramePrefetcher &owner, int idx, const QString &filename)
+        : m_owner(owner), m_idx(idx), m_filename(filename) {}
+
+    void run() {
+        pfs::utils::ConcurrentJob job;
+        pfs::Frame *frame = NULL;
+        try {
+            frame = m_owner.m_read(m_filename);
+        } catch (std::exception &ex) {
+            qDebug() << "FramePrefetcher: cannot read" << m_filename << ":"
+                     << ex.what();
+        }
+        m_owner.readDone(m_idx, frame);
+    }
+
+   private:
+    FramePrefetcher &m_owner;
+    const int m_idx;
+    const QString m_filename;
+};
+
+FramePrefetcher::FramePrefetcher(const QStringList &filenames, int readAhead,
+                                 MemoryBudget &budget, const ReadFunction &read)
+    : m_slots(filenames.size()),
+      m_nextRead(0),
+      m_inFlight(0),
+      m_readAhead(qMax(1, readAhead)),
+      m_budget(budget),
+      m_read(read) {
+    m_pool.setMaxThreadCount(m_readAhead);
+
+    for (int idx = 0; idx < filenames.size(); ++idx) {
+        m_slots[idx].filename = filenames[idx];
+    }
+
+    QMutexLocker lock(&m_mutex);
+    scheduleReads();
+}
+
+FramePrefetcher::~FramePrefetcher() {
+    {
+        // no new reads from now on
+        QMutexLocker lock(&m_mutex);
+        m_nextRead = m_slots.size();
+    }
+    m_pool.waitForDone();
+
+    for (int idx = 0; idx < m_slots.size(); ++idx) {
+        if (m_slots[idx].state == SLOT_READY) {
+            delete m_slots[idx].frame;
+            m_budget.release(m_slots[idx].reserved);
+        }
+    }
+}
+
+void FramePrefetcher::scheduleReads() {
+    while (m_inFlight < m_readAhead && m_nextRead < m_slots.size()) {
+        if (m_slots[m_nextRead].state != SLOT_IDLE) {
+            // already claimed by take()
+            ++m_nextRead;
+            continue;
+        }
+
+        const int idx = m_nextRead;
+        if (m_slots[idx].estimate < 0) {
+            // probing opens the file: take() must not wait for it
+            const QString filename = m_slots[idx].filename;
+            m_mutex.unlock();
+            const qint64 estimate = estimateFrameMemorySize(filename);
+            m_mutex.lock();
+            m_slots[idx].estimate = estimate;
+            // the slot might have been claimed meanwhile
+            continue;
+        }
+
+        if (!m_budget.tryAcquire(m_slots[idx].estimate)) {
+            // retry when a frame is taken
+            return;
+        }
+        startRead(idx, m_slots[idx].estimate);
+        ++m_nextRead;
+    }
+}
+
+void FramePrefetcher::startRead(int idx, qint64 reserved) {
+    Slot &slot = m_slots[idx];
+    slot.state = SLOT_READING;
+    slot.reserved = reserved;
+    ++m_inFlight;
+
+    m_pool.start(new ReadTask(*this, idx, slot.filename));
+}
+
+void FramePrefetcher::readDone(int idx, pfs::Frame *frame) {
+    QMutexLocker lock(&m_mutex);
+    m_slots[idx].frame = frame;
+    m_slots[idx].state = SLOT_READY;
+    m_ready.wakeAll();
+}
+
+pfs::Frame *FramePrefetcher::take(int idx) {
+    QMutexLocker lock(&m_mutex);
+    Q_ASSERT(idx >= 0 && idx < m_slots.size());
+
+    Slot &slot = m_slots[idx];
+    if (slot.state == SLOT_TAKEN) {
+        const QString filename = slot.filename;
+        lock.unlock();
+        return m_read(filename);
+    }
+    if (slot.state == SLOT_IDLE) {
+        // the consumer is ahead of the prefetching: read it now
+        startRead(idx, 0);
+    }
+    while (slot.state == SLOT_READING) {
+        m_ready.wait(&m_mutex);
+    }
+
+    pfs::Frame *frame = slot.frame;
+    slot.frame = NULL;
+    slot.state = SLOT_TAKEN;
+    --m_inFlight;
+    m_budget.release(slot.reserved);
+    slot.reserved = 0;
+
+    scheduleReads();
+    return frame;
+}
+
+// FrameWriteQueue ------------------------------------------------------------
+
+class FrameWriteQueue::WriteTask : public QRunnable {
+   public:
+    WriteTask(FrameWriteQueue &owner, const pfs::FramePtr &frame,
+              const QString &filename, const WriteFunction &write,
+              qint64 reserved)
+        : m_owner(owner),
+          m_frame(frame),
+          m_filename(filename),
+          m_write(write),
+          m_reserved(reserved) {}
+
+    void run() {
+        pfs::utils::ConcurrentJob job;
+        bool status = false;
+        try {
+            status = m_write(*m_frame, m_filename);
+        } catch (std::exception &ex) {
+            qDebug() << "FrameWriteQueue: cannot write" << m_filename << ":"
+                     << ex.what();
+        }
+        // release the frame before waking up the producer
+        m_frame.reset();
+        m_owner.m_budget.release(m_reserved);
+        m_owner.m_pending.deref();
+
+        emit m_owner.frameWritten(m_filename, status);
+    }
+
+   private:
+    FrameWriteQueue &m_owner;
+    pfs::FramePtr m_frame;
+    const QString m_filename;
+    const WriteFunction m_write;
+    const qint64 m_reserved;
+};
+
+FrameWriteQueue::FrameWriteQueue(int maxThreads, MemoryBudget &budget,
+                                 QObject *parent)
+    : QObject(parent), m_budget(budget), m_pending(0) {
+    m_pool.setMaxThreadCount(qMax(1, maxThreads));
+}
+
+FrameWriteQueue::~FrameWriteQueue() { waitForDone(); }
+
+void FrameWriteQueue::submit(const pfs::FramePtr &frame,
+                             const QString &filename,
+                             const WriteFunction &write) {
+    // wait for the encoders to catch up, but never for memory that only the
+    // caller can give back (frames it has prefetched, for example)
+    qint64 bytes = frameMemorySize(*frame);
+    while (!m_budget.tryAcquire(bytes)) {
+        if (pending() == 0) {
+            m_budget.forceAcquire(bytes);
+            break;
+        }
+        m_budget.waitForRelease(100);
+    }
+    m_pending.ref();
+
+    m_pool.start(new WriteTask(*this, frame, filename, write, bytes));
+}
+
+int FrameWriteQueue::pending() const { return m_pending.load(); }
+
+void FrameWriteQueue::waitForDone() { m_pool.waitForDone(); }
@@ -0,0 +1,179 @@
+/**
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ *
+ * Original Work
+ * @author agent <agent@local>
+ *
+ */
+
+//! \brief Asynchronous read-ahead and write-behind stages for batch jobs:
+//! decoding of the next inputs and encoding of the results overlap with the
+//! processing of the current frame, within a bounded amount of memory
+
+#ifndef FRAMEPIPELINE_H
+#define FRAMEPIPELINE_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <functional>
+
+#include <Libpfs/frame.h>
+
+//! \brief amount of memory (in bytes) the frames in flight can take
+class MemoryBudget {
+   public:
+    explicit MemoryBudget(qint64 capacity);
+
+    //! \brief take \a bytes if available, return false otherwise
+    //! \note a request larger than the whole budget is granted when nothing
+    //! else is in flight
+    bool tryAcquire(qint64 bytes);
+    //! \brief take \a bytes, even if that exceeds the budget
+    void forceAcquire(qint64 bytes);
+    void release(qint64 bytes);
+
+    //! \brief wait (at most \a msecs) for some memory to be released
+    void waitForRelease(unsigned long msecs);
+
+    qint64 capacity() const { return m_capacity; }
+
+   private:
+    bool isAvailable(qint64 bytes) const;
+
+    QMutex m_mutex;
+    QWaitCondition m_released;
+    const qint64 m_capacity;
+    qint64 m_used;
+};
+
+//! \brief memory used by the channels of \a frame
+qint64 frameMemorySize(const pfs::Frame &frame);
+
+//! \brief memory needed to decode \a filename, estimated from its header
+qint64 estimateFrameMemorySize(const QString &filename);
+
+//! \brief budget for the batch jobs, as set in the preferences
+qint64 batchMemoryBudget();
+
+//! \brief Reads ahead the frames of a list of files
+//! Up to \c readAhead files are decoded in background threads, in the order
+//! of the list, as long as the memory budget allows. The frames are taken by
+//! their position in the list, so a file can appear more than once.
+class FramePrefetcher {
+   public:
+    //! \brief decode the frame stored in \a filename (NULL on failure)
+    typedef std::function<pfs::Frame *(const QString &filename)> ReadFunction;
+
+    FramePrefetcher(const QStringList &filenames, int readAhead,
+                    MemoryBudget &budget, const ReadFunction &read);
+    //! \brief wait for the reads in flight, and drop the unclaimed frames
+    ~FramePrefetcher();
+
+    //! \brief return the frame decoded from the file at \a idx in the list,
+    //! waiting for it if needed. The caller takes ownership of the frame
+    //! (NULL on failure)
+    //! \note taking the same position again reads the file again
+    pfs::Frame *take(int idx);
+
+   private:
+    Q_DISABLE_COPY(FramePrefetcher)
+
+    enum SlotState { SLOT_IDLE, SLOT_READING, SLOT_READY, SLOT_TAKEN };
+
+    struct Slot {
+        Slot() : state(SLOT_IDLE), frame(NULL), estimate(-1), reserved(0) {}
+
+        QString filename;
+        SlotState state;
+        pfs::Frame *frame;
+        //! \brief memory needed by the frame (-1: not probed yet)
+        qint64 estimate;
+        qint64 reserved;
+    };
+
+    class ReadTask;
+    friend class ReadTask;
+
+    // m_mutex must be held by the caller of these functions
+    // (scheduleReads() releases it while probing a file)
+    void scheduleReads();
+    void startRead(int idx, qint64 reserved);
+
+    void readDone(int idx, pfs::Frame *frame);
+
+    QMutex m_mutex;
+    QWaitCondition m_ready;
+
+    QVector<Slot> m_slots;
+    int m_nextRead;
+    int m_inFlight;
+
+    const int m_readAhead;
+    MemoryBudget &m_budget;
+    const ReadFunction m_read;
+    QThreadPool m_pool;
+};
+
+//! \brief Encodes and writes frames in background threads
+//! \note \c submit blocks while the memory budget is exhausted, so the
+//! producer cannot run too far ahead of the encoders
+class FrameWriteQueue : public QObject {
+    Q_OBJECT
+   public:
+    //! \brief write \a frame to \a filename, returning the success status
+    typedef std::function<bool(pfs::Frame &frame, const QString &filename)>
+        WriteFunction;
+
+    FrameWriteQueue(int maxThreads, MemoryBudget &budget,
+                    QObject *parent = 0);
+    ~FrameWriteQueue();
+
+    //! \brief schedule the writing of \a frame (which must not be modified
+    //! until \c frameWritten is emitted for \a filename)
+    void submit(const pfs::FramePtr &frame, const QString &filename,
+                const WriteFunction &write);
+
+    //! \brief number of frames submitted and not written yet
+    int pending() const;
+
+    //! \brief block until all the submitted frames have been written
+    void waitForDone();
+
+   signals:
+    //! \brief emitted from the writing thread, after \a filename is closed
+    void frameWritten(const QString &filename, bool success);
+
+   private:
+    class WriteTask;
+    friend class WriteTask;
+
+    MemoryBudget &m_budget;
+    QAtomicInt m_pending;
+    QThreadPool m_pool;
+};
+
+#endif  // FRAMEPIPELINE_H
@@ -38,6 +38,7 @@
 
 #include <Core/IOWorker.h>
 #include <Libpfs/frame.h>
+#include <Libpfs/utils/trace.h>
 #include <Common/LuminanceOptions.h>
 #include <Core/TonemappingOptions.h>
 #include <Exif/ExifOperations.h>
@@ -81,6 +82,7 @@ bool IOWorker::write_hdr_frame(GenericViewer *hdr_viewer,
 
 bool IOWorker::write_hdr_frame(pfs::Frame *hdr_frame, const QString &filename,
                                const pfs::Params &params) {
+    PFS_TRACE_SPAN("IOWorker::write_hdr_frame", "io");
     bool status = true;
     emit IO_init();
 
@@ -148,6 +150,7 @@ bool IOWorker::write_ldr_frame(pfs::Frame *ldr_input, const QString &filename,
                                const QVector<float> &expoTimes,
                                TonemappingOptions *tmopts,
                                const pfs::Params &params) {
+    PFS_TRACE_SPAN("IOWorker::write_ldr_frame", "io");
     bool status = true;
     emit IO_init();
 
@@ -229,6 +232,7 @@ bool IOWorker::write_ldr_frame(pfs::Frame *ldr_input, const QString &filename,
 }
 
 pfs::Frame *IOWorker::read_hdr_frame(const QString &filename) {
+    PFS_TRACE_SPAN("IOWorker::read_hdr_frame", "io");
     emit IO_init();
 
     if (filename.isEmpty()) {
@@ -32,6 +32,7 @@
 #include <QVector>
 
 #include <Core/IOWorker.h>
+#include <Core/TonemapCache.h>
 #include <Libpfs/frame.h>
 #include <Libpfs/manip/copy.h>
 #include <Libpfs/manip/cut.h>
@@ -40,11 +41,13 @@
 #include <Libpfs/manip/saturation.h>
 #include <Libpfs/params.h>
 #include <Libpfs/tm/TonemapOperator.h>
+#include <Libpfs/utils/trace.h>
 #include <Common/ProgressHelper.h>
+#include <QScopedPointer>
 #include <Core/TonemappingOptions.h>
 
 TMWorker::TMWorker(QObject *parent)
-    : QObject(parent), m_Callback(new ProgressHelper) {
+    : QObject(parent), m_Callback(new ProgressHelper), m_cache(NULL) {
 #ifdef QT_DEBUG
     qDebug() << "TMWorker::TMWorker() ctor";
 #endif
@@ -73,26 +76,125 @@ pfs::Frame *TMWorker::computeTonemap(/* const */ pfs::Frame *in_frame,
     qDebug() << "TMWorker::getTonemappedFrame()";
 #endif
 
+    m_Callback->cancel(false);
+
+    QString error;
+    pfs::Frame *working_frame = computeFrame(in_frame, tm_options, m, error);
+    if (working_frame == NULL) {
+        if (!error.isEmpty()) emit tonemapFailed(error);
+        return NULL;
+    }
+
+    emit tonemapSuccess(working_frame, tm_options, 0);
+    return working_frame;
+}
+
+namespace {
+// proxies narrower than this are not worth displaying
+const int MIN_PROXY_WIDTH = 256;
+}
+
+void TMWorker::computeTonemapProgressive(/* const */ pfs::Frame *in_frame,
+                                         TonemappingOptions *tm_options,
+                                         InterpolationMethod m, int request) {
+    if (request != m_request.load()) return;  // superseded while queued
+
+    // a cancel left by a previous request; the ones arriving from now on
+    // stop this request, at whatever level it is
+    m_Callback->cancel(false);
+    if (request != m_request.load()) return;
+
+    // 1/8, 1/4, 1/2 and full size (or the size asked for)
+    const int width = tm_options->xsize;
+    QList<int> widths;
+    if (!tm_options->tonemapSelection) {
+        for (int div = 8; div > 1; div /= 2) {
+            if (width / div >= MIN_PROXY_WIDTH) widths.append(width / div);
+        }
+    }
+    widths.append(width);
+
+    for (int level = 0; level < widths.size(); ++level) {
+        const bool last = (level == widths.size() - 1);
+
+        // the operators scale their size dependent parameters on
+        // xsize / origxsize (see the detail level of Fattal)
+        TonemappingOptions level_options(*tm_options);
+        level_options.xsize = widths[level];
+
+        // flag the refinement before checking the request: a newRequest()
+        // after the check sees the flag and cancels it
+        m_refining.fetchAndStoreOrdered(level > 0);
+        if (request != m_request.loadAcquire()) {
+            m_refining.fetchAndStoreOrdered(0);
+            return;
+        }
+        QString error;
+        pfs::Frame *working_frame =
+            computeFrame(in_frame, &level_options, m, error);
+        m_refining.fetchAndStoreOrdered(0);
+
+        if (working_frame == NULL) {
+            // a superseded request leaves the reporting to the newer one
+            if (!error.isEmpty() && request == m_request.load())
+                emit tonemapFailed(error);
+            return;
+        }
+        if (request != m_request.loadAcquire()) {
+            // superseded while computing this level
+            delete working_frame;
+            return;
+        }
+        if (last) {
+            emit tonemapSuccess(working_frame, tm_options, request);
+            return;
+        }
+        emit tonemapRefined(working_frame, tm_options, request);
+    }
+}
+
+void TMWorker::setGenerationToken(const QAtomicInt *token, int generation) {
+    m_Callback->setGenerationToken(token, generation);
+}
+
+int TMWorker::newRequest() {
+    const int request = m_request.fetchAndAddOrdered(1) + 1;
+    // the refinement in progress is not needed anymore
+    if (m_refining.load()) m_Callback->cancel(true);
+    return request;
+}
+
+pfs::Frame *TMWorker::computeFrame(pfs::Frame *in_frame,
+                                   TonemappingOptions *tm_options,
+                                   InterpolationMethod m, QString &error) {
+    QString key;
+    if (m_cache) {
+        key = TonemapCache::key(*in_frame, *tm_options, m);
+        pfs::Frame *cached_frame = m_cache->find(key);
+        if (cached_frame != NULL) return cached_frame;
+    }
+
     pfs::Frame *working_frame = preprocessFrame(in_frame, tm_options, m);
     if (working_frame == NULL) return NULL;
     try {
         tonemapFrame(working_frame, tm_options);
     } catch (...) {
-        emit tonemapFailed(QStringLiteral("Tonemap failed!"));
+        error = QStringLiteral("Tonemap failed!");
         delete working_frame;
         return NULL;
     }
 
     if (m_Callback->canceled()) {
-        emit tonemapFailed(QStringLiteral("Canceled"));
+        error = QStringLiteral("Canceled");
         m_Callback->cancel(false);  // double check this
         delete working_frame;
         return NULL;
     }
 
     postprocessFrame(working_frame, tm_options);
-
-    emit tonemapSuccess(working_frame, tm_options);
+    if (m_cache) {
+        m_cache->insert(key, *working_frame);
+    }
     return working_frame;
 }
 
@@ -102,6 +204,8 @@ void TMWorker::computeTonemapAndExport(/* const */ pfs::Frame *in_frame,
                                        QString hdrName, QString inputfname,
                                        QVector<float> inputExpoTimes,
                                        InterpolationMethod m) {
+    m_Callback->cancel(false);
+
     pfs::Frame *working_frame = preprocessFrame(in_frame, tm_options, m);
     if (working_frame == NULL) return;
     try {
@@ -160,8 +264,6 @@ void TMWorker::computeTonemapAndExport(/* const */ pfs::Frame *in_frame,
 
 void TMWorker::tonemapFrame(pfs::Frame *working_frame,
                             TonemappingOptions *tm_options) {
-    m_Callback->cancel(false);
-
     emit tonemapBegin();
     // build tonemap object
     TonemapOperator *tmEngine =
@@ -174,9 +276,53 @@ void TMWorker::tonemapFrame(pfs::Frame *working_frame,
     delete tmEngine;
 }
 
+bool TMWorker::computeTonemapSweep(/* const */ pfs::Frame *in_frame,
+                                   const QList<TonemappingOptions *> &tm_options,
+                                   InterpolationMethod m,
+                                   const SweepOutput &output) {
+    if (tm_options.isEmpty()) return true;
+
+    QScopedPointer<pfs::Frame> input(
+        preprocessFrame(in_frame, tm_options.first(), m));
+    if (input.isNull()) return false;
+    // every sweep step starts from a copy sharing the channels of input
+    input->endWrite();
+
+    m_Callback->cancel(false);
+
+    QScopedPointer<TonemapOperator> tmEngine;
+    foreach (TonemappingOptions *opts, tm_options) {
+        if (tmEngine.isNull() || tmEngine->getType() != opts->tmoperator) {
+            tmEngine.reset(TonemapOperator::getTonemapOperator(opts->tmoperator));
+        }
+
+        emit tonemapBegin();
+        QScopedPointer<pfs::Frame> working_frame;
+        try {
+            working_frame.reset(
+                tmEngine->tonemapSweep(*input, opts, *m_Callback));
+        } catch (...) {
+            emit tonemapFailed(QStringLiteral("Tonemap failed!"));
+            return false;
+        }
+        emit tonemapEnd();
+
+        if (m_Callback->canceled()) {
+            emit tonemapFailed(QStringLiteral("Canceled"));
+            m_Callback->cancel(false);
+            return false;
+        }
+
+        postprocessFrame(working_frame.data(), opts);
+        output(working_frame.data(), opts);
+    }
+    return true;
+}
+
 pfs::Frame *TMWorker::preprocessFrame(pfs::Frame *input_frame,
                                       TonemappingOptions *tm_options,
                                       InterpolationMethod m) {
+    PFS_TRACE_SPAN("TMWorker::preprocessFrame", "tonemap");
     pfs::Frame *working_frame = NULL;
 
     if (tm_options->tonemapSelection) {
@@ -205,6 +351,7 @@ pfs::Frame *TMWorker::preprocessFrame(pfs::Frame *input_frame,
 }
 
 void TMWorker::postprocessFrame(pfs::Frame *working_frame, TonemappingOptions *tm_options) {
+    PFS_TRACE_SPAN("TMWorker::postprocessFrame", "tonemap");
     // auto-level?
     // black-point?
     // white-point?
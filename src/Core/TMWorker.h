@@ -26,8 +26,11 @@
 #ifndef TMWORKER_H
 #define TMWORKER_H
 
+#include <QAtomicInt>
+#include <QList>
 #include <QObject>
 #include <QString>
+#include <functional>
 
 #include <Common/global.h>
 #include <Libpfs/params.h>
@@ -39,6 +42,7 @@ class Frame;
 
 class TonemappingOptions;
 class ProgressHelper;
+class TonemapCache;
 
 class TMWorker : public QObject {
     Q_OBJECT
@@ -55,6 +59,17 @@ class TMWorker : public QObject {
     pfs::Frame *computeTonemap(/* const */ pfs::Frame *, TonemappingOptions *,
                                InterpolationMethod m);
 
+    //!
+    //! Tonemap proxies of the input frame first (1/8, 1/4 and 1/2 of the
+    //! requested width, when at least 256 pixels wide), emitting
+    //! tonemapRefined for each of them, then the requested size, emitting
+    //! tonemapSuccess. The refinements stop, and nothing more is emitted, as
+    //! soon as \a request (see newRequest) is superseded by a newer one
+    //!
+    void computeTonemapProgressive(/* const */ pfs::Frame *,
+                                   TonemappingOptions *, InterpolationMethod m,
+                                   int request);
+
     void computeTonemapAndExport(/* const */ pfs::Frame *, TonemappingOptions *,
                                  pfs::Params, QString exportDir,
                                  QString hdrName, QString inputfname,
@@ -62,17 +77,56 @@ class TMWorker : public QObject {
                                  InterpolationMethod m);
 
     //!
-    //! This function tonemap the input frame
+    //! This function tonemap the input frame. It leaves the cancel flag
+    //! alone: the callers reset it when a request starts
     //!
     void tonemapFrame(pfs::Frame *, TonemappingOptions *);
 
+   public:
+    //! \brief supersede the previous requests, cancelling the refinement in
+    //! progress. Thread safe: to be called before queueing a new tonemapping
+    //! \return the id to pass to computeTonemapProgressive
+    int newRequest();
+
+    //! \brief look the results of \c computeTonemap up in \a cache before
+    //! tonemapping, and store them there (NULL, the default: no caching)
+    void setCache(TonemapCache *cache) { m_cache = cache; }
+
+    //! \brief the tonemapping is canceled as soon as \a token differs from
+    //! \a generation (see ProgressHelper::setGenerationToken)
+    void setGenerationToken(const QAtomicInt *token, int generation);
+
+    //! \brief called with each frame of a sweep and its options; the frame
+    //! is deleted when the callback returns
+    typedef std::function<void(pfs::Frame *, TonemappingOptions *)>
+        SweepOutput;
+
+    //! \brief tonemap the input frame once for each of \a tm_options,
+    //! which must only differ in the parameters of the operator: the
+    //! input is resized and gamma corrected once, and the stages that do
+    //! not depend on the changing parameters are computed once
+    //! (see TonemapOperator::tonemapSweep)
+    //! \return false if the sweep failed or was canceled
+    bool computeTonemapSweep(/* const */ pfs::Frame *,
+                             const QList<TonemappingOptions *> &tm_options,
+                             InterpolationMethod m, const SweepOutput &output);
+
    private:
+    //! \brief tonemapped (and post-processed) copy of the input frame, NULL
+    //! on failure, with the reason in \a error
+    pfs::Frame *computeFrame(pfs::Frame *, TonemappingOptions *,
+                             InterpolationMethod m, QString &error);
     pfs::Frame *preprocessFrame(pfs::Frame *, TonemappingOptions *,
                                 InterpolationMethod m);
     void postprocessFrame(pfs::Frame *, TonemappingOptions *);
 
    Q_SIGNALS:
-    void tonemapSuccess(pfs::Frame *, TonemappingOptions *);
+    //! \brief the frame tonemapped for \a request (0 for computeTonemap,
+    //! whose results are never superseded)
+    void tonemapSuccess(pfs::Frame *, TonemappingOptions *, int request);
+    //! \brief a proxy of the frame computeTonemapProgressive is working on
+    //! for \a request
+    void tonemapRefined(pfs::Frame *, TonemappingOptions *, int request);
     void tonemapFailed(QString);
 
     void tonemapBegin();
@@ -84,6 +138,9 @@ class TMWorker : public QObject {
 
    private:
     ProgressHelper *m_Callback;
+    TonemapCache *m_cache;
+    QAtomicInt m_request;
+    QAtomicInt m_refining;
 };
 
 #endif  // TMWORKER_H
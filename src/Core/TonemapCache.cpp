@@ -0,0 +1,131 @@
+/**
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ *
+ * Original Work
+ * @author agent <agent@local>
+ *
+ */
+
+#include <Core/TonemapCache.h>
+
+#include <QMutexLocker>
+
+#include <Common/LuminanceOptions.h>
+#include <Core/FramePipeline.h>
+#include <Core/TonemappingOptions.h>
+#include <Libpfs/manip/copy.h>
+
+TonemapCache::TonemapCache(qint64 capacity)
+    : m_capacity(capacity), m_size(0) {}
+
+TonemapCache &TonemapCache::instance() {
+    static TonemapCache s_cache(tonemapCacheCapacity());
+    return s_cache;
+}
+
+QString TonemapCache::key(const pfs::Frame &input, TonemappingOptions &options,
+                          InterpolationMethod m) {
+    QString key = QStringLiteral("%1_%2x%3_")
+                      .arg(static_cast<qulonglong>(input.getGeneration()))
+                      .arg(input.getWidth())
+                      .arg(input.getHeight());
+    if (options.tonemapSelection) {
+        key += QStringLiteral("crop_%1_%2_%3_%4_")
+                   .arg(options.selection_x_up_left)
+                   .arg(options.selection_y_up_left)
+                   .arg(options.selection_x_bottom_right)
+                   .arg(options.selection_y_bottom_right);
+    } else if (options.xsize != options.origxsize) {
+        key += QStringLiteral("resize_%1_%2_")
+                   .arg(options.xsize)
+                   .arg(static_cast<int>(m));
+    }
+    // the postfix holds every parameter of the operator
+    return key + options.getPostfix();
+}
+
+pfs::Frame *TonemapCache::find(const QString &key) {
+    QMutexLocker lock(&m_mutex);
+    QHash<QString, Entries::iterator>::iterator it = m_index.find(key);
+    if (it == m_index.end()) {
+        return NULL;
+    }
+    // move to the front of the list, the iterators stay valid
+    m_entries.splice(m_entries.begin(), m_entries, it.value());
+    return pfs::copy(m_entries.front().frame.get());
+}
+
+void TonemapCache::insert(const QString &key, const pfs::Frame &frame) {
+    Entry entry;
+    entry.key = key;
+    entry.frame.reset(pfs::copy(&frame));
+    entry.bytes = frameMemorySize(frame);
+
+    QMutexLocker lock(&m_mutex);
+    if (entry.bytes > m_capacity) {
+        return;
+    }
+    QHash<QString, Entries::iterator>::iterator it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_size -= it.value()->bytes;
+        m_entries.erase(it.value());
+    }
+    m_entries.push_front(entry);
+    m_index[key] = m_entries.begin();
+    m_size += entry.bytes;
+    trim();
+}
+
+void TonemapCache::clear() {
+    QMutexLocker lock(&m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_size = 0;
+}
+
+void TonemapCache::setCapacity(qint64 capacity) {
+    QMutexLocker lock(&m_mutex);
+    m_capacity = capacity;
+    trim();
+}
+
+qint64 TonemapCache::capacity() const {
+    QMutexLocker lock(&m_mutex);
+    return m_capacity;
+}
+
+qint64 TonemapCache::size() const {
+    QMutexLocker lock(&m_mutex);
+    return m_size;
+}
+
+void TonemapCache::trim() {
+    while (m_size > m_capacity && !m_entries.empty()) {
+        const Entry &last = m_entries.back();
+        m_size -= last.bytes;
+        m_index.remove(last.key);
+        m_entries.pop_back();
+    }
+}
+
+qint64 tonemapCacheCapacity() {
+    return static_cast<qint64>(LuminanceOptions().getTonemapCacheSize()) *
+           1024 * 1024;
+}
@@ -0,0 +1,108 @@
+/**
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ *
+ * Original Work
+ * @author agent <agent@local>
+ *
+ */
+
+//! \brief Cache of the frames tonemapped in the main window, so that going
+//! back to settings already tried (undo/redo, saved parameters, previews)
+//! does not tonemap again
+
+#ifndef TONEMAPCACHE_H
+#define TONEMAPCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <list>
+
+#include <Common/global.h>
+#include <Libpfs/frame.h>
+
+class TonemappingOptions;
+
+//! \brief Bounded LRU cache of tonemapped frames
+//! Results are keyed by the content of the input frame (see
+//! \c pfs::Frame::getGeneration()), the options and the size they are
+//! computed at. The least recently used ones are dropped when the cache
+//! exceeds its capacity.
+//! The cache shares the channels of the frames it stores and hands out (see
+//! \c pfs::copy()): storing a result or taking it again does not copy it,
+//! unless it is written into afterwards.
+class TonemapCache {
+   public:
+    //! \param capacity memory (in bytes) the cached frames can take. With
+    //! 0 nothing is cached
+    explicit TonemapCache(qint64 capacity);
+
+    //! \brief cache shared by the tonemapping of the main window and by the
+    //! preview panel, sized as in the preferences
+    static TonemapCache &instance();
+
+    //! \brief key of the result of tonemapping \a input with \a options
+    //! (resized with \a m when the options ask for a different width)
+    static QString key(const pfs::Frame &input, TonemappingOptions &options,
+                       InterpolationMethod m);
+
+    //! \brief a copy of the frame stored under \a key, NULL if there is none
+    //! \note the caller owns the returned frame
+    pfs::Frame *find(const QString &key);
+
+    //! \brief store a copy of \a frame under \a key
+    void insert(const QString &key, const pfs::Frame &frame);
+
+    void clear();
+
+    //! \brief drop the least recently used frames until the cache fits in
+    //! \a capacity
+    void setCapacity(qint64 capacity);
+    qint64 capacity() const;
+
+    //! \brief memory taken by the cached frames
+    qint64 size() const;
+
+   private:
+    Q_DISABLE_COPY(TonemapCache)
+
+    struct Entry {
+        QString key;
+        pfs::FramePtr frame;
+        qint64 bytes;
+    };
+    typedef std::list<Entry> Entries;
+
+    // m_mutex must be held by the caller
+    void trim();
+
+    mutable QMutex m_mutex;
+    // most recently used first
+    Entries m_entries;
+    QHash<QString, Entries::iterator> m_index;
+    qint64 m_capacity;
+    qint64 m_size;
+};
+
+//! \brief capacity of the tonemapping cache, as set in the preferences
+qint64 tonemapCacheCapacity();
+
+#endif  // TONEMAPCACHE_H
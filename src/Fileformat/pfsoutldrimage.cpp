@@ -41,11 +41,11 @@
 
 #include <boost/assign/list_of.hpp>
 
+#include <Libpfs/colorspace/kernels.h>
 #include <Libpfs/colorspace/rgbremapper.h>
 #include <Libpfs/exception.h>
 #include <Libpfs/frame.h>
-#include <Libpfs/utils/msec_timer.h>
-#include <Libpfs/utils/transform.h>
+#include <Libpfs/utils/trace.h>
 
 using namespace std;
 using namespace pfs;
@@ -65,10 +65,7 @@ void QRgbRemapper::operator()(float r, float g, float b, QRgb &qrgb) const {
 
 QImage *fromLDRPFStoQImage(pfs::Frame *in_frame, float min_luminance,
                            float max_luminance, RGBMappingType mapping_method) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
+    PFS_TRACE_SPAN("fromLDRPFStoQImage", "display");
 
     qDebug() << "Min Luminance: " << min_luminance;
     qDebug() << "Max Luminance: " << max_luminance;
@@ -83,15 +80,11 @@ QImage *fromLDRPFStoQImage(pfs::Frame *in_frame, float min_luminance,
     QImage *temp_qimage = new QImage(
         in_frame->getWidth(), in_frame->getHeight(), QImage::Format_RGB32);
 
-    QRgbRemapper remapper(min_luminance, max_luminance, mapping_method);
-    utils::transform(Xc->begin(), Xc->end(), Yc->begin(), Zc->begin(),
-                     reinterpret_cast<QRgb *>(temp_qimage->bits()), remapper);
-
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "fromLDRPFStoQImage() = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
+    // QImage::Format_RGB32 scanlines are never padded
+    colorspace::kernels::remapToRGB32(
+        Xc->data(), Yc->data(), Zc->data(),
+        reinterpret_cast<uint32_t *>(temp_qimage->bits()), min_luminance,
+        max_luminance, mapping_method, Xc->size());
 
     return temp_qimage;
 }
@@ -28,7 +28,6 @@
 
 #include "HdrCreation/debevec.h"
 #include <Libpfs/colorspace/normalizer.h>
-#include <Libpfs/utils/msec_timer.h>
 #include <Libpfs/utils/numeric.h>
 
 #include <QtGlobal>
@@ -42,9 +41,6 @@
 #include <vector>
 #include "../sleef.c"
 #include "../opthelper.h"
-#ifdef _OPENMP
-#include <omp.h>
-#endif
 
 #include "Libpfs/array2d.h"
 
@@ -66,12 +62,8 @@ namespace fusion {
 void DebevecOperator::computeFusion(ResponseCurve &response,
                                     WeightFunction &weight,
                                     const vector<FrameEnhanced> &images,
-                                    pfs::Frame &frame) {
-
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
+                                    pfs::Frame &frame,
+                                    pfs::Progress &progress) {
     assert(images.size() != 0);
 
     vector<float> times;
@@ -96,7 +88,7 @@ void DebevecOperator::computeFusion(ResponseCurve &response,
     Array2Df *resultCh[channels] = {Ch[0], Ch[1], Ch[2]};
 
 #ifdef _OPENMP
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 #endif
     for (int c = 0; c < channels; c++) {
         resultCh[c]->fill(0.f);
@@ -106,67 +98,64 @@ void DebevecOperator::computeFusion(ResponseCurve &response,
 
     int length = images.size();
 
-#ifdef _OPENMP
-    int numthreads = omp_get_max_threads();
-    int nestedthreads = std::max(numthreads / length, 1);
-    bool oldNested = omp_get_nested();
-    if(nestedthreads > 1) {
-        omp_set_nested(true);
-    }
-    #pragma omp parallel for
-#endif
+    // one exposure at a time: the pixel loops get all the threads of the
+    // budget (see utils/parallel.h), without nesting parallel regions
+    Array2Df response_img(W, H);
+    Array2Df w(W, H);
+
     for (int i = 0; i < length; i++) {
+        progress.setValue(90 * i / length);
+        if (progress.canceled()) {
+            return;
+        }
+
         Channel *Ch[channels];
         images[i].frame()->getXYZChannels(Ch[0], Ch[1], Ch[2]);
         Array2Df *imagesCh[channels] = {Ch[0], Ch[1], Ch[2]};
 
-        float cmax[3];
-        float cmin[3];
+        float Max = numeric_limits<float>::min();
+        float Min = numeric_limits<float>::max();
+        for (int c = 0; c < channels; c++) {
+            const Array2Df &imageCh = *imagesCh[c];
 #ifdef _OPENMP
-        #pragma omp parallel for num_threads(nestedthreads) if (nestedthreads>1)
+            #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) reduction(min:Min) reduction(max:Max)
 #endif
-        for (int c = 0; c < channels; c++) {
-            float minval = numeric_limits<float>::max();
-            float maxval = numeric_limits<float>::min();
             for (size_t k = 0; k < size; k++) {
-                minval = std::min(minval, (*imagesCh[c])(k));
-                maxval = std::max(maxval, (*imagesCh[c])(k));
+                Min = std::min(Min, imageCh(k));
+                Max = std::max(Max, imageCh(k));
             }
-            cmax[c] = maxval;
-            cmin[c] = minval;
         }
 
-        float Max = max(cmax[0], max(cmax[1], cmax[2]));
-        float Min = min(cmin[0], min(cmin[1], cmin[2]));
-
+        const Normalizer normalize(Min, Max);
+        for (int c = 0; c < channels; c++) {
+            Array2Df &imageCh = *imagesCh[c];
 #ifdef _OPENMP
-        #pragma omp parallel for num_threads(nestedthreads) if (nestedthreads>1)
+            #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 #endif
-        for (int c = 0; c < channels; c++) {
-            transform(Ch[c]->begin(), Ch[c]->end(), Ch[c]->begin(),
-                      Normalizer(Min, Max));
+            for (size_t k = 0; k < size; k++) {
+                imageCh(k) = normalize(imageCh(k));
+            }
         }
 
-        Array2Df response_img(W, H);
-        Array2Df w(W, H);
-
         float cmul = 1.f / channels;
 #ifdef _OPENMP
-        #pragma omp parallel for num_threads(nestedthreads) if (nestedthreads>1)
+        #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 #endif
         for (size_t k = 0; k < size; k++) {
             w(k) = cmul * (weight((*imagesCh[0])(k)) + weight((*imagesCh[1])(k)) + weight((*imagesCh[2])(k)));
         }
         float cadd = -logf(times.at((int)i));
         for (int c = 0; c < channels; c++) {
-            #pragma omp parallel for num_threads(nestedthreads) if (nestedthreads>1)
+#ifdef _OPENMP
+            #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
+#endif
             for (size_t k = 0; k < size; k++) {
                 (response_img)(k) = response((*imagesCh[c])(k));
             }
 #ifdef __SSE2__
             vfloat caddv = F2V(cadd);
 #ifdef _OPENMP
-            #pragma omp parallel for num_threads(nestedthreads) if (nestedthreads>1)
+            #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 #endif
             for (size_t k = 0; k < size - 3; k+=4) {
                 STVFU((response_img)(k), (xlogf(LVFU((response_img)(k))) + caddv) * LVFU(w(k)));
@@ -176,31 +165,23 @@ void DebevecOperator::computeFusion(ResponseCurve &response,
             }
 #else
 #ifdef _OPENMP
-            #pragma omp parallel for num_threads(nestedthreads) if (nestedthreads>1)
+            #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 #endif
             for (size_t k = 0; k < size; k++) {
                 (response_img)(k) = (xlogf((response_img)(k)) + cadd) * w(k);
             }
 #endif
 
-#ifdef _OPENMP
-            #pragma omp critical
-#endif
             vadd(resultCh[c], &response_img, resultCh[c], size);
         }
 
-#ifdef _OPENMP
-        #pragma omp critical
-#endif
         vadd(&weight_sum, &w, &weight_sum, size);
     }
-#ifdef _OPENMP
-    omp_set_nested(oldNested);
-#endif
+    progress.setValue(90);
 
     for (int c = 0; c < channels; c++) {
 #ifdef _OPENMP
-        #pragma omp parallel for
+        #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 #endif
         for(int y = 0; y < H; ++y) {
             int x = 0;
@@ -218,7 +199,7 @@ void DebevecOperator::computeFusion(ResponseCurve &response,
     for (int c = 0; c < channels; c++) {
         float max = numeric_limits<float>::min();
 #ifdef _OPENMP
-    #pragma omp parallel for reduction(max:max)
+    #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) reduction(max:max)
 #endif
         for (size_t k = 0; k < size; k++) {
             float val = (*resultCh[c])(k);
@@ -233,7 +214,7 @@ void DebevecOperator::computeFusion(ResponseCurve &response,
 
     for (int c = 0; c < channels; c++) {
 #ifdef _OPENMP
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 #endif
         for (size_t k = 0; k < size; k++) {
             float val = (*resultCh[c])(k);
@@ -242,12 +223,6 @@ void DebevecOperator::computeFusion(ResponseCurve &response,
             }
         }
     }
-
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    cout << "MergeDebevec = " << f_timer.get_time() << " msec"
-              << endl;
-#endif
 }
 
 
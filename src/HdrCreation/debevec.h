@@ -46,7 +46,7 @@ class DebevecOperator : public IFusionOperator {
    private:
     void computeFusion(ResponseCurve &response, WeightFunction &weight,
                        const std::vector<FrameEnhanced> &frames,
-                       pfs::Frame &frame);
+                       pfs::Frame &frame, pfs::Progress &progress);
 };
 
 }  // fusion
@@ -29,6 +29,7 @@
 
 #include <Libpfs/frame.h>
 #include <Libpfs/utils/string.h>
+#include <Libpfs/utils/trace.h>
 
 using namespace pfs;
 using namespace std;
@@ -43,8 +44,22 @@ IFusionOperator::IFusionOperator() {}
 pfs::Frame *IFusionOperator::computeFusion(
     ResponseCurve &response, WeightFunction &weight,
     const std::vector<FrameEnhanced> &frames) {
+    pfs::Progress progress;
+    return computeFusion(response, weight, frames, progress);
+}
+
+pfs::Frame *IFusionOperator::computeFusion(
+    ResponseCurve &response, WeightFunction &weight,
+    const std::vector<FrameEnhanced> &frames, pfs::Progress &progress) {
+    PFS_TRACE_SPAN("IFusionOperator::computeFusion", "fusion");
     pfs::Frame *frame = new pfs::Frame;
-    computeFusion(response, weight, frames, *frame);
+    progress.setValue(0);
+    computeFusion(response, weight, frames, *frame, progress);
+    if (progress.canceled()) {
+        delete frame;
+        return NULL;
+    }
+    progress.setValue(100);
     return frame;
 }
 
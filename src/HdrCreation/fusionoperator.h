@@ -32,6 +32,7 @@
 #include <HdrCreation/responses.h>
 #include <HdrCreation/weights.h>
 #include <Libpfs/frame.h>
+#include <Libpfs/progress.h>
 
 namespace libhdr {
 namespace fusion {
@@ -72,14 +73,24 @@ class IFusionOperator {
     pfs::Frame *computeFusion(ResponseCurve &response, WeightFunction &weight,
                               const std::vector<FrameEnhanced> &frames);
 
+    //! \brief as above, reporting to \a progress (from 0 to 100)
+    //! \return the merged frame, or NULL if the fusion has been canceled
+    pfs::Frame *computeFusion(ResponseCurve &response, WeightFunction &weight,
+                              const std::vector<FrameEnhanced> &frames,
+                              pfs::Progress &progress);
+
     virtual FusionOperator getType() const = 0;
 
    protected:
     IFusionOperator();
 
+    //! \note implementations check \c pfs::Progress::canceled() between
+    //! their passes: the content of \a outFrame is undefined when the fusion
+    //! is canceled
     virtual void computeFusion(ResponseCurve &response, WeightFunction &weight,
                                const std::vector<FrameEnhanced> &frames,
-                               pfs::Frame &outFrame) = 0;
+                               pfs::Frame &outFrame,
+                               pfs::Progress &progress) = 0;
 };
 
 typedef vector<float *> DataList;
@@ -35,8 +35,10 @@
 #include <Libpfs/colorspace/convert.h>
 #include <Libpfs/colorspace/xyz.h>
 #include <Libpfs/frame.h>
+#include <Libpfs/histogram.h>
 #include <Libpfs/manip/resize.h>
 #include <Libpfs/manip/shift.h>
+#include <Libpfs/utils/trace.h>
 #include <Libpfs/utils/transform.h>
 
 #include <Libpfs/io/jpegwriter.h>
@@ -56,14 +58,16 @@ typedef Array2D<bool> Array2Db;
 
 namespace libhdr {
 
-long XORimages(const Array2Db &img1, const Array2Db &mask1,
-               const Array2Db &img2, const Array2Db &mask2) {
+long XORimages(const Array2DView<const bool> &img1,
+               const Array2DView<const bool> &mask1,
+               const Array2DView<const bool> &img2,
+               const Array2DView<const bool> &mask2) {
     long err = 0;
     for (size_t i = 0; i < img1.getRows(); i++) {
-        Array2Db::const_iterator p1 = img1.row_begin(i);
-        Array2Db::const_iterator p2 = img2.row_begin(i);
-        Array2Db::const_iterator m1 = mask1.row_begin(i);
-        Array2Db::const_iterator m2 = mask2.row_begin(i);
+        const bool *p1 = img1.row_begin(i);
+        const bool *p2 = img2.row_begin(i);
+        const bool *m1 = mask1.row_begin(i);
+        const bool *m2 = mask2.row_begin(i);
 
         for (size_t j = 0; j < img1.getCols(); j++) {
             err += (long)((*p1++ xor *p2++) and *m1++ and *m2++);
@@ -129,20 +133,23 @@ void getExpShift(const Array2D8u &img1, const int median1,
     setThreshold(img1, median1, noise, img1threshold, img1mask);
     setThreshold(img2, median2, noise, img2threshold, img2mask);
 
-    Array2Db img2_shifted(img2.getCols(), img2.getRows());
-    Array2Db img2mask_shifted(img2.getCols(), img2.getRows());
-
     int minerr = img1.size();
     for (int i = -1; i <= 1; i++) {
         for (int j = -1; j <= 1; j++) {
             int dx = curr_x + i;
             int dy = curr_y + j;
 
-            pfs::shift(img2threshold, dx, dy, img2_shifted);
-            pfs::shift(img2mask, dx, dy, img2mask_shifted);
+            // the shifted image would be zero (masked out) outside of the
+            // overlap: compare the overlapping regions in place, instead of
+            // materializing the shifted image and mask
+            Array2DView<const bool> img2View(img2threshold);
+            Array2DView<const bool> img1View(img1threshold);
+            pfs::shiftOverlap(img2View, img1View, dx, dy);
+            Array2DView<const bool> mask2View(img2mask);
+            Array2DView<const bool> mask1View(img1mask);
+            pfs::shiftOverlap(mask2View, mask1View, dx, dy);
 
-            long err = XORimages(img1threshold, img1mask, img2_shifted,
-                                 img2mask_shifted);
+            long err = XORimages(img1View, mask1View, img2View, mask2View);
 
             if (err < minerr) {
                 minerr = err;
@@ -172,22 +179,12 @@ int getLum(const Frame &in, Array2D8u &out, double quantile) {
                      tempOut.begin(), colorspace::ConvertRGB2Y());
 
     // build histogram
-    vector<long> hist(256, 0);
-    assert(hist.size() == 256u);
-
-    for (Array2D8u::iterator it = tempOut.begin(); it != tempOut.end(); ++it) {
-        ++hist[*it];
-    }
+    const uint8_t *lum = tempOut.data();
+    Histogram hist(HistogramParams(256, 0.f, 255.f));
+    hist.compute(tempOut.size(), [lum](size_t i) { return size_t(lum[i]); });
 
     // find the quantile...
-    size_t relativeQuantile = in.size() * quantile;
-    size_t idx = 0;
-    size_t cdf = 0;
-    for (; idx < hist.size(); ++idx) {
-        cdf += hist[idx];
-
-        if (cdf >= relativeQuantile) break;
-    }
+    const int idx = static_cast<int>(hist.getQuantileBin(quantile));
 
     // return values...
     out.swap(tempOut);
@@ -217,6 +214,7 @@ static const int noise = 4;
 
 void mtb_alignment(std::vector<pfs::FramePtr> &framePtrList) {
     if (framePtrList.size() <= 1) return;
+    PFS_TRACE_SPAN("mtb_alignment", "align");
 
     int width = framePtrList[0]->getWidth();
     int height = framePtrList[0]->getHeight();
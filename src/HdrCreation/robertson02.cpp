@@ -29,6 +29,7 @@
 #include "arch/math.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <iostream>
 #include <iterator>
@@ -40,6 +41,7 @@
 #include <boost/numeric/conversion/bounds.hpp>
 
 #include <Libpfs/array2d.h>
+#include <Libpfs/utils/parallel.h>
 
 #ifndef NDEBUG
 #define PRINT_DEBUG(str) std::cerr << "Robertson: " << str << std::endl
@@ -56,80 +58,88 @@ namespace fusion {
 void RobertsonOperator::applyResponse(
     ResponseCurve &response, WeightFunction &weight, ResponseChannel channel,
     const DataList &inputData, float *outputData, size_t width, size_t height,
-    float minAllowedValue, float maxAllowedValue, const float *arrayofexptime) {
+    float minAllowedValue, float maxAllowedValue, const float *arrayofexptime,
+    pfs::Progress &progress, int fromValue, int toValue) {
     assert(inputData.size());
 
-    size_t saturatedPixels = 0;
-
-    int numPixels = (int)width * height;
-    for (int j = 0; j < numPixels; ++j) {
-        // all exposures for each pixel
-        float sum = 0.0f;
-        float div = 0.0f;
-        float maxti = -1e6f;
-        float minti = +1e6f;
+    std::atomic<size_t> saturatedPixels(0);
+
+    const ptrdiff_t numPixels = width * height;
+    utils::parallelFor(
+        0, numPixels, 16384, progress, fromValue, toValue,
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            size_t saturatedChunk = 0;
+            for (ptrdiff_t j = begin; j < end; ++j) {
+                // all exposures for each pixel
+                float sum = 0.0f;
+                float div = 0.0f;
+                float maxti = -1e6f;
+                float minti = +1e6f;
+
+                // for all exposures
+                for (int i = 0; i < (int)inputData.size(); ++i) {
+                    float m = inputData[i][j];
+                    float ti = arrayofexptime[i];
+
+                    float w = weight(m);
+                    float r = response(m, channel);
+                    // --- anti saturation: observe minimum exposure time at which
+                    // saturated value is present, and maximum exp time at which
+                    // black value is present
+                    if (m > maxAllowedValue) {
+                        minti = std::min(minti, ti);
+                    }
+                    if (m < minAllowedValue) {
+                        maxti = std::max(maxti, ti);
+                    }
+
+                    // --- anti-ghosting: monotonous increase in time should result
+                    // in monotonous increase in intensity; make forward and
+                    // backward check, ignore value if condition not satisfied
+                    //            int m_lower = inputData.getSample(i_lower[i], j);
+                    //            int m_upper = inputData.getSample(i_upper[i], j);
+
+                    //            if ( N > 1) {
+                    //                if ( m_lower > m || m_upper < m ) {
+                    //                    continue;
+                    //                }
+                    //            }
+
+                    sum += w * ti * r;
+                    div += w * ti * ti;
+                }
 
-        // for all exposures
-        for (int i = 0; i < (int)inputData.size(); ++i) {
-            float m = inputData[i][j];
-            float ti = arrayofexptime[i];
+                // --- anti saturation: if a meaningful representation of pixel
+                // was not found, replace it with information from observed data
+                if (div == 0.0f) {
+                    ++saturatedChunk;
+                }
+                if (div == 0.0f && maxti > -1e6f) {
+                    sum = minAllowedValue;
+                    div = maxti;
+                }
+                if (div == 0.0f && minti < +1e6f) {
+                    sum = maxAllowedValue;
+                    div = minti;
+                }
 
-            float w = weight(m);
-            float r = response(m, channel);
-            // --- anti saturation: observe minimum exposure time at which
-            // saturated value is present, and maximum exp time at which
-            // black value is present
-            if (m > maxAllowedValue) {
-                minti = std::min(minti, ti);
-            }
-            if (m < minAllowedValue) {
-                maxti = std::max(maxti, ti);
+                if (div != 0.0f) {
+                    outputData[j] = sum / div;
+                } else {
+                    outputData[j] = 0.0f;
+                }
             }
+            saturatedPixels += saturatedChunk;
+        });
 
-            // --- anti-ghosting: monotonous increase in time should result
-            // in monotonous increase in intensity; make forward and
-            // backward check, ignore value if condition not satisfied
-            //            int m_lower = inputData.getSample(i_lower[i], j);
-            //            int m_upper = inputData.getSample(i_upper[i], j);
-
-            //            if ( N > 1) {
-            //                if ( m_lower > m || m_upper < m ) {
-            //                    continue;
-            //                }
-            //            }
-
-            sum += w * ti * r;
-            div += w * ti * ti;
-        }
-
-        // --- anti saturation: if a meaningful representation of pixel
-        // was not found, replace it with information from observed data
-        if (div == 0.0f) {
-            ++saturatedPixels;
-        }
-        if (div == 0.0f && maxti > -1e6f) {
-            sum = minAllowedValue;
-            div = maxti;
-        }
-        if (div == 0.0f && minti < +1e6f) {
-            sum = maxAllowedValue;
-            div = minti;
-        }
-
-        if (div != 0.0f) {
-            outputData[j] = sum / div;
-        } else {
-            outputData[j] = 0.0f;
-        }
-    }
-
-    PRINT_DEBUG("Saturated pixels: " << saturatedPixels);
+    PRINT_DEBUG("Saturated pixels: " << saturatedPixels.load());
 }
 
 void RobertsonOperator::computeFusion(ResponseCurve &response,
                                       WeightFunction &weight,
                                       const std::vector<FrameEnhanced> &frames,
-                                      pfs::Frame &frame) {
+                                      pfs::Frame &frame,
+                                      pfs::Progress &progress) {
     assert(frames.size());
 
     size_t numExposures = frames.size();
@@ -158,15 +168,18 @@ void RobertsonOperator::computeFusion(ResponseCurve &response,
     applyResponse(response, weight, RESPONSE_CHANNEL_RED, redChannels,
                   outputRed->data(), tempFrame.getWidth(),
                   tempFrame.getHeight(), minAllowedValue, maxAllowedValue,
-                  averageLuminances.data());  // red
+                  averageLuminances.data(), progress, 0, 30);  // red
+    if (progress.canceled()) return;
     applyResponse(response, weight, RESPONSE_CHANNEL_BLUE, blueChannels,
                   outputBlue->data(), tempFrame.getWidth(),
                   tempFrame.getHeight(), minAllowedValue, maxAllowedValue,
-                  averageLuminances.data());  // blue
+                  averageLuminances.data(), progress, 30, 60);  // blue
+    if (progress.canceled()) return;
     applyResponse(response, weight, RESPONSE_CHANNEL_GREEN, greenChannels,
                   outputGreen->data(), tempFrame.getWidth(),
                   tempFrame.getHeight(), minAllowedValue, maxAllowedValue,
-                  averageLuminances.data());  // green
+                  averageLuminances.data(), progress, 60, 90);  // green
+    if (progress.canceled()) return;
 
     float cmax[3];
     cmax[0] = *max_element(outputRed->begin(), outputRed->end());
@@ -266,7 +279,8 @@ namespace fusion {
 void RobertsonOperatorAuto::computeResponse(
     ResponseCurve &response, WeightFunction &weight, ResponseChannel channel,
     const DataList &inputData, float *outputData, size_t width, size_t height,
-    float minAllowedValue, float maxAllowedValue, const float *arrayofexptime) {
+    float minAllowedValue, float maxAllowedValue, const float *arrayofexptime,
+    pfs::Progress &progress, int fromValue, int toValue) {
     typedef ResponseCurve::ResponseContainer ResponseContainer;
 
     int N = inputData.size();
@@ -281,7 +295,8 @@ void RobertsonOperatorAuto::computeResponse(
     double pdelta = 0.0;
 
     applyResponse(response, weight, channel, inputData, outputData, width,
-                  height, minAllowedValue, maxAllowedValue, arrayofexptime);
+                  height, minAllowedValue, maxAllowedValue, arrayofexptime,
+                  progress, fromValue, fromValue);
 
     std::vector<long> cardEm(ResponseCurve::NUM_BINS);
     ResponseContainer sum;
@@ -291,6 +306,13 @@ void RobertsonOperatorAuto::computeResponse(
     assert(sum.size() == I.size());
 
     for (size_t cur_it = 0; cur_it < MAXIT; ++cur_it) {
+        // the iterations usually converge well before MAXIT: the progress
+        // jumps to the end of the range when they do
+        const int value = fromValue + (toValue - fromValue) * cur_it / MAXIT;
+        if (progress.canceled()) {
+            return;
+        }
+
         // reset buffers
         fill(cardEm.begin(), cardEm.end(), 0);
         fill(sum.begin(), sum.end(), 0.f);
@@ -330,7 +352,8 @@ void RobertsonOperatorAuto::computeResponse(
 
         // 3. Apply new response
         applyResponse(response, weight, channel, inputData, outputData, width,
-                      height, minAllowedValue, maxAllowedValue, arrayofexptime);
+                      height, minAllowedValue, maxAllowedValue, arrayofexptime,
+                      progress, value, value);
 
         // 4. Check stopping condition
         double delta = 0.0;
@@ -368,7 +391,8 @@ void RobertsonOperatorAuto::computeResponse(
 
 void RobertsonOperatorAuto::computeFusion(
     ResponseCurve &response, WeightFunction &weight,
-    const std::vector<FrameEnhanced> &frames, pfs::Frame &frame) {
+    const std::vector<FrameEnhanced> &frames, pfs::Frame &frame,
+    pfs::Progress &progress) {
     assert(frames.size());
 
     size_t numExposures = frames.size();
@@ -398,17 +422,20 @@ void RobertsonOperatorAuto::computeFusion(
     computeResponse(response, weight, RESPONSE_CHANNEL_RED, redChannels,
                     outputRed->data(), tempFrame.getWidth(),
                     tempFrame.getHeight(), minAllowedValue, maxAllowedValue,
-                    averageLuminances.data());
+                    averageLuminances.data(), progress, 0, 30);
+    if (progress.canceled()) return;
     // green
     computeResponse(response, weight, RESPONSE_CHANNEL_GREEN, greenChannels,
                     outputGreen->data(), tempFrame.getWidth(),
                     tempFrame.getHeight(), minAllowedValue, maxAllowedValue,
-                    averageLuminances.data());
+                    averageLuminances.data(), progress, 30, 60);
+    if (progress.canceled()) return;
     // blue
     computeResponse(response, weight, RESPONSE_CHANNEL_BLUE, blueChannels,
                     outputBlue->data(), tempFrame.getWidth(),
                     tempFrame.getHeight(), minAllowedValue, maxAllowedValue,
-                    averageLuminances.data());
+                    averageLuminances.data(), progress, 60, 90);
+    if (progress.canceled()) return;
 
     float cmax[3];
     cmax[0] = *max_element(outputRed->begin(), outputRed->end());
@@ -42,14 +42,15 @@ class RobertsonOperator : public IFusionOperator {
    private:
     void computeFusion(ResponseCurve &response, WeightFunction &weight,
                        const std::vector<FrameEnhanced> &frames,
-                       pfs::Frame &frame);
+                       pfs::Frame &frame, pfs::Progress &progress);
 
    protected:
     void applyResponse(ResponseCurve &response, WeightFunction &weight,
                        ResponseChannel channel, const DataList &inputData,
                        float *outputData, size_t width, size_t height,
                        float minAllowedValue, float maxAllowedValue,
-                       const float *arrayofexptime);
+                       const float *arrayofexptime, pfs::Progress &progress,
+                       int fromValue, int toValue);
 };
 
 class RobertsonOperatorAuto : public RobertsonOperator {
@@ -61,13 +62,14 @@ class RobertsonOperatorAuto : public RobertsonOperator {
    private:
     void computeFusion(ResponseCurve &response, WeightFunction &weight,
                        const std::vector<FrameEnhanced> &frames,
-                       pfs::Frame &outFrame);
+                       pfs::Frame &outFrame, pfs::Progress &progress);
 
     void computeResponse(ResponseCurve &response, WeightFunction &weight,
                          ResponseChannel channel, const DataList &inputData,
                          float *outputData, size_t width, size_t height,
                          float minAllowedValue, float maxAllowedValue,
-                         const float *arrayofexptime);
+                         const float *arrayofexptime, pfs::Progress &progress,
+                         int fromValue, int toValue);
 };
 
 }  // fusion
@@ -46,7 +46,7 @@
 using namespace hdrhtml;
 using namespace std;
 
-void generate_hdrhtml(pfs::Frame *frame, string page_name, string out_dir,
+void generate_hdrhtml(const pfs::Frame *frame, string page_name, string out_dir,
                       string image_dir, string object_output,
                       string html_output, int quality, bool verbose) {
 #if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
@@ -80,7 +80,7 @@ void generate_hdrhtml(pfs::Frame *frame, string page_name, string out_dir,
         throw pfs::Exception(QObject::tr("NULL frame passed.").toStdString());
     }
 
-    pfs::Channel *R, *G, *B;
+    const pfs::Channel *R, *G, *B;
     frame->getXYZChannels(R, G, B);
 
     int size = frame->getWidth() * frame->getHeight();
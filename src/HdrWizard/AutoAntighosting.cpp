@@ -38,7 +38,8 @@
 #include <Libpfs/frame.h>
 #include <Libpfs/manip/copy.h>
 #include <Libpfs/utils/minmax.h>
-#include <Libpfs/utils/msec_timer.h>
+#include <Libpfs/utils/parallel.h>
+#include <Libpfs/utils/trace.h>
 
 #include "AutoAntighosting.h"
 // --- LEGACY CODE ---
@@ -50,10 +51,7 @@ float max(const Array2Df &u) { return *std::max_element(u.begin(), u.end()); }
 float min(const Array2Df &u) { return *std::min_element(u.begin(), u.end()); }
 
 void solve_pde_dct(Array2Df &F, Array2Df &U) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
+    PFS_TRACE_SPAN("solve_pde_dct", "fusion");
     // activate parallel execution of fft routines
     init_fftw();
 
@@ -69,12 +67,12 @@ void solve_pde_dct(Array2Df &F, Array2Df &U) {
                               FFTW_ESTIMATE);
     FFTW_MUTEX::fftw_mutex_plan.unlock();
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int j = 0; j < height; j++) {
         fftwf_execute_r2r(p, F.data() + width * j, Ftr.data() + width * j);
     }
 
-#pragma omp parallel
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
     {
         vector<float> c(height);
 #pragma omp for
@@ -102,7 +100,7 @@ void solve_pde_dct(Array2Df &F, Array2Df &U) {
     }
 
     const float invDivisor = 1.0f / (2.0f * (width - 1));
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int j = 0; j < height; j++) {
         fftwf_execute_r2r(p, U.data() + width * j, U.data() + width * j);
 
@@ -114,11 +112,6 @@ void solve_pde_dct(Array2Df &F, Array2Df &U) {
     FFTW_MUTEX::fftw_mutex_destroy_plan.lock();
     fftwf_destroy_plan(p);
     FFTW_MUTEX::fftw_mutex_destroy_plan.unlock();
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "solve_pde_dct = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
 }
 
 int findIndex(const float *data, int size) {
@@ -352,36 +345,24 @@ bool comparePatches(const HdrCreationItem &item1, const HdrCreationItem &item2,
 }
 
 void computeIrradiance(Array2Df &irradiance, const Array2Df &in) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
+    PFS_TRACE_SPAN("computeIrradiance", "fusion");
 
     const int width = in.getCols();
     const int height = in.getRows();
 
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(static)
     for (int i = 0; i < width * height; ++i) {
         irradiance(i) = std::exp(in(i));
     }
-
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "computeIrradiance = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
 }
 
 void computeLogIrradiance(Array2Df &logIrradiance, const Array2Df &u) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
+    PFS_TRACE_SPAN("computeLogIrradiance", "fusion");
     const int width = u.getCols();
     const int height = u.getRows();
 
     float ir, logIr;
-#pragma omp parallel for private(ir, logIr) schedule(static)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) private(ir, logIr) schedule(static)
     for (int i = 0; i < width * height; i++) {
         ir = u(i);
         if (ir == 0.0f)
@@ -391,32 +372,23 @@ void computeLogIrradiance(Array2Df &logIrradiance, const Array2Df &u) {
 
         logIrradiance(i) = logIr;
     }
-
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "computeLogIrradiance = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
 }
 
 void computeGradient(Array2Df &gradientX, Array2Df &gradientY,
                      const Array2Df &in) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
+    PFS_TRACE_SPAN("computeGradient", "fusion");
 
     const int width = in.getCols();
     const int height = in.getRows();
 
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(static)
     for (int j = 1; j < height - 1; j++) {
         for (int i = 1; i < width - 1; i++) {
             gradientX(i, j) = 0.5f * (in(i + 1, j) - in(i - 1, j));
             gradientY(i, j) = 0.5f * (in(i, j + 1) - in(i, j - 1));
         }
     }
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(static)
     for (int i = 1; i < width - 1; i++) {
         gradientX(i, 0) = 0.5f * (in(i + 1, 0) - in(i - 1, 0));
         gradientX(i, height - 1) =
@@ -424,7 +396,7 @@ void computeGradient(Array2Df &gradientX, Array2Df &gradientY,
         gradientY(i, 0) = 0.0f;
         gradientY(i, height - 1) = 0.0f;
     }
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(static)
     for (int j = 1; j < height - 1; j++) {
         gradientX(0, j) = 0.0f;
         gradientX(width - 1, j) = 0.0f;
@@ -436,24 +408,16 @@ void computeGradient(Array2Df &gradientX, Array2Df &gradientY,
         gradientX(width - 1, height - 1) = 0.0f;
     gradientY(0, 0) = gradientY(0, height - 1) = gradientY(width - 1, 0) =
         gradientY(width - 1, height - 1) = 0.0f;
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "computeGradient = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
 }
 
 void computeDivergence(Array2Df &divergence, const Array2Df &gradientX,
                        const Array2Df &gradientY) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
+    PFS_TRACE_SPAN("computeDivergence", "fusion");
     const int width = gradientX.getCols();
     const int height = gradientX.getRows();
 
     divergence(0, 0) = gradientX(0, 0) + gradientY(0, 0);
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(static)
     for (int j = 1; j < height - 1; j++) {
         for (int i = 1; i < width - 1; i++) {
             divergence(i, j) =
@@ -461,7 +425,7 @@ void computeDivergence(Array2Df &divergence, const Array2Df &gradientX,
                 0.5f * (gradientY(i, j + 1) - gradientY(i, j - 1));
         }
     }
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(static)
     for (int j = 1; j < height - 1; j++) {
         divergence(0, j) = gradientX(1, j) - gradientX(0, j) +
                            0.5f * (gradientY(0, j + 1) - gradientY(0, j - 1));
@@ -469,7 +433,7 @@ void computeDivergence(Array2Df &divergence, const Array2Df &gradientX,
             gradientX(width - 1, j) - gradientX(width - 2, j) +
             0.5f * (gradientY(width - 1, j) - gradientY(width - 1, j - 1));
     }
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(static)
     for (int i = 1; i < width - 1; i++) {
         divergence(i, 0) =
             0.5f * (gradientX(i, 0) - gradientX(i - 1, 0)) + gradientY(i, 0);
@@ -478,11 +442,6 @@ void computeDivergence(Array2Df &divergence, const Array2Df &gradientX,
                 (gradientX(i + 1, height - 1) - gradientX(i - 1, height - 1)) +
             gradientY(i, height - 1) - gradientY(i, height - 2);
     }
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "computeDivergence = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
 }
 
 void blendGradients(Array2Df &gradientXBlended, Array2Df &gradientYBlended,
@@ -491,15 +450,12 @@ void blendGradients(Array2Df &gradientXBlended, Array2Df &gradientYBlended,
                     const Array2Df &gradientYGood,
                     bool patches[agGridSize][agGridSize], const int gridX,
                     const int gridY) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
+    PFS_TRACE_SPAN("blendGradients patches", "fusion");
     int width = gradientX.getCols();
     int height = gradientY.getRows();
 
     int x, y;
-#pragma omp parallel for private(x, y) schedule(static)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) private(x, y) schedule(static)
     for (int j = 0; j < height - 1; j++) {
         y = floor(static_cast<float>(j) / gridY);
         for (int i = 0; i < width; i++) {
@@ -533,25 +489,17 @@ void blendGradients(Array2Df &gradientXBlended, Array2Df &gradientYBlended,
             }
         }
     }
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "blendGradients = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
 }
 
 void blendGradients(Array2Df &gradientXBlended, Array2Df &gradientYBlended,
                     const Array2Df &gradientX, const Array2Df &gradientY,
                     const Array2Df &gradientXGood,
                     const Array2Df &gradientYGood, const QImage &agMask) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
+    PFS_TRACE_SPAN("blendGradients mask", "fusion");
     int width = gradientX.getCols();
     int height = gradientY.getRows();
 
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(static)
     for (int j = 0; j < height; j++) {
         for (int i = 0; i < width; i++) {
             if (qAlpha(agMask.pixel(i, j)) != 0) {
@@ -563,11 +511,6 @@ void blendGradients(Array2Df &gradientXBlended, Array2Df &gradientYBlended,
             }
         }
     }
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "blendGradients = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
 }
 
 void colorBalance(pfs::Array2Df &U, const pfs::Array2Df &F, const int x,
@@ -576,6 +519,6 @@ void colorBalance(pfs::Array2Df &U, const pfs::Array2Df &F, const int x,
     const int height = U.getRows();
 
     float sf = F(x, y) / U(x, y);
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(static)
     for (int i = 0; i < width * height; i++) U(i) *= sf;
 }
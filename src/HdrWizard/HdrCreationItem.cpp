@@ -37,7 +37,8 @@ HdrCreationItem::HdrCreationItem(const QString &filename)
       m_datamin(0.f),
       m_datamax(1.f),
       m_frame(std::make_shared<pfs::Frame>()),
-      m_thumbnail(new QImage()) {
+      m_thumbnail(new QImage()),
+      m_reduced(false) {
     // qDebug() << QString("Building HdrCreationItem for %1").arg(m_filename);
 }
 
@@ -51,7 +52,8 @@ HdrCreationItem::HdrCreationItem(const QString &filename,
       m_datamin(0.f),
       m_datamax(1.f),
       m_frame(std::make_shared<pfs::Frame>()),
-      m_thumbnail(new QImage()) {}
+      m_thumbnail(new QImage()),
+      m_reduced(false) {}
 
 HdrCreationItem::~HdrCreationItem() {
     // qDebug() << QString("Destroying HdrCreationItem for %1").arg(m_filename);
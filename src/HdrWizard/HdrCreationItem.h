@@ -70,6 +70,11 @@ class HdrCreationItem {
     QImage &qimage() { return *m_thumbnail; }
     const QImage &qimage() const { return *m_thumbnail; }
 
+    //! \brief true if the frame was decoded smaller than the file (see
+    //! \c LoadFile)
+    bool isReduced() const { return m_reduced; }
+    void setReduced(bool reduced) { m_reduced = reduced; }
+
    private:
     QString m_filename;
     QString m_convertedFilename;
@@ -80,6 +85,7 @@ class HdrCreationItem {
     float m_datamax;
     pfs::FramePtr m_frame;
     QSharedPointer<QImage> m_thumbnail;
+    bool m_reduced;
 };
 
 typedef std::vector<HdrCreationItem> HdrCreationItemContainer;
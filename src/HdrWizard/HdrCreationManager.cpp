@@ -54,12 +54,13 @@
 #include <Libpfs/io/framereaderfactory.h>
 #include <Libpfs/io/framewriter.h>
 #include <Libpfs/io/framewriterfactory.h>
+#include <Libpfs/io/lhcwriter.h>
 #include <Libpfs/io/tiffreader.h>
 #include <Libpfs/io/tiffwriter.h>
 #include <Libpfs/manip/copy.h>
 #include <Libpfs/manip/cut.h>
 #include <Libpfs/manip/shift.h>
-#include <Libpfs/utils/msec_timer.h>
+#include <Libpfs/utils/trace.h>
 #include <Libpfs/utils/transform.h>
 
 #include <Exif/ExifOperations.h>
@@ -120,6 +121,72 @@ static bool checkFileName(const HdrCreationItem &item, const QString &str) {
     return (item.filename().compare(str) == 0);
 }
 
+//! \brief check the size of the frames in \a data from the headers of their
+//! files, so the wrong set of files is refused before decoding any of them
+//! \note only files of the same format are compared, as RAW headers report the
+//! size of the sensor rather than the size of the processed image
+//! \brief preview sides are kept at least this long (see previewScale())
+static const size_t PREVIEW_MIN_SIZE = 1024;
+
+//! \brief scale denominator (see LoadFile) for the previews of \a data,
+//! from the header of the first file
+static int previewScale(const HdrCreationItemContainer &data) {
+    if (data.empty()) {
+        return 1;
+    }
+    try {
+        const FrameInfo info = FrameReaderFactory::probe(
+            QFile::encodeName(data.front().alignedFilename()).constData());
+        return static_cast<int>(
+            getScaleDenominator(std::min(info.width, info.height) /
+                                PREVIEW_MIN_SIZE));
+    } catch (std::runtime_error &) {
+        // errors are reported by the actual loading
+    }
+    return 1;
+}
+
+//! \brief load \a item at full size, if it was loaded reduced
+static void loadFullResolutionItem(HdrCreationItem &item) {
+    if (!item.isReduced()) {
+        return;
+    }
+    // the EV might have been edited meanwhile
+    const float averageLuminance = item.getAverageLuminance();
+    LoadFile()(item);
+    item.setAverageLuminance(averageLuminance);
+}
+
+static bool probedFramesHaveSameSize(const HdrCreationItemContainer &data) {
+    std::string format;
+    size_t width = 0;
+    size_t height = 0;
+    try {
+        for (const auto &item : data) {
+            const std::string filename =
+                QFile::encodeName(item.alignedFilename()).constData();
+            FrameInfo info = FrameReaderFactory::probe(filename);
+            short rotation = info.exifData.getOrientationDegree();
+            if (rotation == 90 || rotation == 270) {
+                std::swap(info.width, info.height);
+            }
+
+            if (format.empty()) {
+                format = utils::getFormat(filename);
+                width = info.width;
+                height = info.height;
+            } else if (utils::getFormat(filename) != format) {
+                return true;
+            } else if (info.width != width || info.height != height) {
+                return false;
+            }
+        }
+    } catch (std::runtime_error &) {
+        // errors are reported by the actual loading
+    }
+    return true;
+}
+
 void HdrCreationManager::loadFiles(const QStringList &filenames) {
     for (const auto &filename : filenames) {
         qDebug() << QStringLiteral(
@@ -143,13 +210,52 @@ void HdrCreationManager::loadFiles(const QStringList &filenames) {
         }
     }
 
+    if (!probedFramesHaveSameSize(m_tmpdata)) {
+        m_tmpdata.clear();
+        emit errorWhileLoading(
+            tr("HdrCreationManager::loadFiles(): The images have different "
+               "size."));
+        return;
+    }
+
     // parallel load of the data...
     connect(&m_futureWatcher, &QFutureWatcherBase::finished, this,
             &HdrCreationManager::loadFilesDone, Qt::DirectConnection);
 
+    // the files are decoded again at full size by loadFullResolution()
+    const int scaleDenom = m_reducedPreview ? previewScale(m_tmpdata) : 1;
+
     // Start the computation.
-    m_futureWatcher.setFuture(
-        QtConcurrent::map(m_tmpdata.begin(), m_tmpdata.end(), LoadFile()));
+    m_futureWatcher.setFuture(QtConcurrent::map(
+        m_tmpdata.begin(), m_tmpdata.end(), LoadFile(false, scaleDenom)));
+}
+
+bool HdrCreationManager::loadFullResolution() {
+    PFS_TRACE_SPAN("HdrCreationManager::loadFullResolution", "io");
+    QFutureWatcher<void> futureWatcher;
+    futureWatcher.setFuture(QtConcurrent::map(m_data.begin(), m_data.end(),
+                                              &loadFullResolutionItem));
+    bool failed = false;
+    try {
+        futureWatcher.waitForFinished();
+    } catch (...) {
+        // LoadFile() threw an exception
+        failed = true;
+    }
+
+    if (failed || futureWatcher.isCanceled()) {
+        emit errorWhileLoading(
+            tr("HdrCreationManager::loadFullResolution(): Error loading a "
+               "file."));
+        return false;
+    }
+    if (!framesHaveSameSize()) {
+        emit errorWhileLoading(
+            tr("HdrCreationManager::loadFullResolution(): The images have "
+               "different size."));
+        return false;
+    }
+    return true;
 }
 
 void HdrCreationManager::loadFilesDone() {
@@ -274,7 +380,8 @@ HdrCreationManager::HdrCreationManager(bool fromCommandLine)
       m_align(),
       m_ais_crop_flag(false),
       fromCommandLine(fromCommandLine),
-      m_isLoadResponseCurve(false) {
+      m_isLoadResponseCurve(false),
+      m_reducedPreview(false) {
     // setConfig(predef_confs[0]);
     setFusionOperator(predef_confs[0].fusionOperator);
 
@@ -331,6 +438,7 @@ bool HdrCreationManager::framesHaveSameSize() {
 }
 
 void HdrCreationManager::align_with_mtb() {
+    PFS_TRACE_SPAN("HdrCreationManager::align_with_mtb", "align");
     // build temporary container...
     vector<FramePtr> frames;
     for (size_t i = 0; i < m_data.size(); ++i) {
@@ -374,6 +482,7 @@ void HdrCreationManager::ais_failed_slot(QProcess::ProcessError error) {
 }
 
 pfs::Frame *HdrCreationManager::createHdr() {
+    PFS_TRACE_SPAN("HdrCreationManager::createHdr", "fusion");
     std::vector<FrameEnhanced> frames;
 
     for (size_t idx = 0; idx < m_data.size(); ++idx) {
@@ -437,11 +546,22 @@ HdrCreationManager::~HdrCreationManager() {
     delete m_agMask;
 }
 
-void HdrCreationManager::saveImages(const QString &prefix) {
+void HdrCreationManager::saveImages(const QString &prefix,
+                                    const QString &format) {
+    const bool scratchFormat = (format == QLatin1String("lhc"));
     int idx = 0;
     for (HdrCreationItemContainer::const_iterator it = m_data.begin(),
                                                   itEnd = m_data.end();
          it != itEnd; ++it) {
+        if (scratchFormat) {
+            QString filename =
+                prefix + QStringLiteral("_%1").arg(idx) + ".lhc";
+            pfs::io::LhcWriter writer(QFile::encodeName(filename).constData());
+            writer.write(*it->frame(), pfs::Params());
+            ++idx;
+            continue;
+        }
+
         QString filename = prefix + QStringLiteral("_%1").arg(idx) + ".tiff";
         pfs::io::TiffWriter writer(QFile::encodeName(filename).constData());
         writer.write(*it->frame(), pfs::Params("tiff_mode", 1));
@@ -461,12 +581,9 @@ int HdrCreationManager::computePatches(float threshold,
                                        bool patches[][agGridSize],
                                        float &percent,
                                        QList<QPair<int, int>> HV_offset) {
+    PFS_TRACE_SPAN("HdrCreationManager::computePatches", "fusion");
     qDebug() << "HdrCreationManager::computePatches";
     qDebug() << threshold;
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
     const int width = m_data[0].frame()->getWidth();
     const int height = m_data[0].frame()->getHeight();
     const int gridX = width / agGridSize;
@@ -517,22 +634,14 @@ int HdrCreationManager::computePatches(float threshold,
 
     memcpy(patches, m_patches, agGridSize * agGridSize);
 
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "computePatches = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
     return m_agGoodImageIndex;
 }
 
 pfs::Frame *HdrCreationManager::doAntiGhosting(bool patches[][agGridSize],
                                                int h0, bool manualAg,
                                                ProgressHelper *ph) {
+    PFS_TRACE_SPAN("HdrCreationManager::doAntiGhosting", "fusion");
     qDebug() << "HdrCreationManager::doAntiGhosting";
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
     const int width = m_data[0].frame()->getWidth();
     const int height = m_data[0].frame()->getHeight();
     const int gridX = width / agGridSize;
@@ -806,11 +915,6 @@ pfs::Frame *HdrCreationManager::doAntiGhosting(bool patches[][agGridSize],
 
     emit progressFinished();
     //this->reset();
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "doAntiGhosting = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
     return deghosted;
 }
 
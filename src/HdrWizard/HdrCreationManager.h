@@ -67,6 +67,16 @@ class HdrCreationManager : public QObject {
 
     void loadFiles(const QStringList &filenames);
     void removeFile(int idx);
+
+    //! \brief decode the JPEG and RAW files loaded from now on at a reduced
+    //! size, enough for their previews (see \c loadFullResolution())
+    void setReducedPreview(bool b) { m_reducedPreview = b; }
+    bool isReducedPreview() const { return m_reducedPreview; }
+
+    //! \brief decode again at full size the files loaded at a reduced size:
+    //! the alignment, the anti-ghosting and the fusion need every pixel
+    //! \return false (and emits \c errorWhileLoading) if a file fails
+    bool loadFullResolution();
     void clearFiles() {
         m_data.clear();
         m_tmpdata.clear();
@@ -138,7 +148,10 @@ class HdrCreationManager : public QObject {
     void cropItems(const QRect &ca);
     void cropAgMasks(const QRect &ca);
 
-    void saveImages(const QString &prefix);
+    //! \brief save the current (aligned) frames as \a prefix_N.format
+    //! \param format either "tiff" or "lhc" (fast scratch format, no EXIF)
+    void saveImages(const QString &prefix,
+                    const QString &format = QStringLiteral("tiff"));
     // void doAntiGhosting(int);
     int computePatches(float threshold, bool patches[][agGridSize],
                        float &percent, QList<QPair<int, int>> HV_offset);
@@ -200,6 +213,7 @@ class HdrCreationManager : public QObject {
     int m_agGoodImageIndex;
     bool m_patches[agGridSize][agGridSize];
     bool m_isLoadResponseCurve;
+    bool m_reducedPreview;
 
    private slots:
     void ais_failed_slot(QProcess::ProcessError);
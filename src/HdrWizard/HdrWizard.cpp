@@ -113,6 +113,10 @@ HdrWizard::HdrWizard(QWidget *p, const QStringList &files,
     setAcceptDrops(true);
     setupConnections();
 
+    // the brackets are shown as soon as they are decoded at a reduced size,
+    // and decoded at full size when the user moves on
+    m_hdrCreationManager->setReducedPreview(true);
+
     m_Ui->tableWidget->setHorizontalHeaderLabels(
         QStringList() << tr("Image Filename") << tr("Exposure"));
     m_Ui->tableWidget->horizontalHeader()->setSectionResizeMode(
@@ -661,6 +665,13 @@ void HdrWizard::NextFinishButtonClicked() {
     int currentpage = m_Ui->pagestack->currentIndex();
     switch (currentpage) {
         case 0: {
+            QApplication::setOverrideCursor(QCursor(Qt::BusyCursor));
+            if (!m_hdrCreationManager->loadFullResolution()) {
+                // errorWhileLoading() restores the cursor
+                return;
+            }
+            QApplication::restoreOverrideCursor();
+
             // now align, if requested
             if (m_Ui->alignCheckBox->isChecked()) {
                 QApplication::setOverrideCursor(QCursor(Qt::BusyCursor));
@@ -29,6 +29,8 @@
 #include <QPainter>
 #include <cassert>
 
+#include "Libpfs/utils/parallel.h"
+
 #include "Viewers/GenericViewer.h"
 #include "Viewers/IGraphicsPixmapItem.h"
 #include "Viewers/IGraphicsView.h"
@@ -178,7 +180,7 @@ void PreviewWidget::renderPreviewImage(
     QRgb *out = NULL;
 
 // for all the rows that we have to paint
-#pragma omp parallel for private(out, movVal, pivVal, movLine, pivLine)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) private(out, movVal, pivVal, movLine, pivLine)
     for (int i = originy; i < originy + H; i++) {
         out = (QRgb *)m_previewImage->scanLine(i);
 
@@ -6,80 +6,46 @@
 #include <iomanip>
 #include <numeric>
 
-#include <boost/algorithm/minmax_element.hpp>
-
 #include <Libpfs/colorspace/colorspace.h>
 #include <Libpfs/colorspace/normalizer.h>
+#include <Libpfs/histogram.h>
 #include <Libpfs/manip/copy.h>
 #include <Libpfs/utils/chain.h>
 #include <Libpfs/utils/clamp.h>
 #include <Libpfs/utils/numeric.h>
+#include <Libpfs/utils/parallel.h>
 #include <Libpfs/utils/transform.h>
-#include "Libpfs/utils/msec_timer.h"
+#include "Libpfs/utils/trace.h"
 
 using namespace pfs;
 using namespace pfs::colorspace;
 using namespace pfs::utils;
 
-void computeHistogram(const pfs::Array2Df &data, std::vector<size_t> &histogram,
-                      float min, float max) {
-    Normalizer norm(min, max);
-    for (pfs::Array2Df::const_iterator it = data.begin(), itEnd = data.end();
-         it != itEnd; ++it) {
-        // 1.0f -> histogram.size() - 1
-
-        size_t bin =
-            static_cast<size_t>(norm(*it) * (histogram.size() - 1) + 0.5f);
-        ++histogram[bin];
-    }
-}
-
 std::pair<float, float> quantiles(const pfs::Array2Df &data, float nb_min,
                                   float nb_max, float min, float max) {
     // compute histogram (less expensive than sorting the entire sequence...
-    std::vector<size_t> hist(65535, 0);
-    computeHistogram(data, hist, min, max);
+    // bins are centered on min + idx * (max - min) / (bins - 1)
+    const size_t bins = 65535;
+    const float halfBin = 0.5f * (max - min) / (bins - 1);
+    pfs::Histogram hist(
+        pfs::HistogramParams(bins, min - halfBin, max + halfBin));
+    hist.compute(data);
 
-    // normalize percentiles to image size...
-    size_t lb_percentile = static_cast<size_t>(nb_min * data.size() + 0.5f);
-    size_t ub_percentile = static_cast<size_t>(nb_max * data.size() + 0.5f);
-
-    size_t counter = 0;
-    std::pair<float, float> minmax;
-    for (size_t idx = 0; idx < hist.size(); ++idx) {
-        counter += hist[idx];
-        if (counter >= lb_percentile) {
-            minmax.first =
-                static_cast<float>(idx) / (hist.size() - 1) * (max - min) + min;
-            break;
-        }
-    }
-
-    counter = 0;
-    for (size_t idx = 0; idx < hist.size(); ++idx) {
-        counter += hist[idx];
-        if (counter >= ub_percentile) {
-            minmax.second =
-                static_cast<float>(idx) / (hist.size() - 1) * (max - min) + min;
-            break;
-        }
-    }
+    std::pair<float, float> minmax(
+        hist.getBinValue(hist.getQuantileBin(nb_min)),
+        hist.getBinValue(hist.getQuantileBin(nb_max)));
 
 #ifndef NDEBUG
-    std::cout << "([" << nb_min << ", " << min << ", " << lb_percentile << "]"
-                                                                           ", ["
-              << nb_max << ", " << max << ", " << ub_percentile << "])"
-              << std::endl;
+    std::cout << "([" << nb_min << ", " << min << ", " << minmax.first << "]"
+              << ", [" << nb_max << ", " << max << ", " << minmax.second
+              << "])" << std::endl;
 #endif
 
     return minmax;
 }
 
 std::pair<float, float> getMinMax(const pfs::Array2Df &data) {
-    std::pair<pfs::Array2Df::const_iterator, pfs::Array2Df::const_iterator>
-        minmax = boost::minmax_element(data.begin(), data.end());
-
-    return std::pair<float, float>(*minmax.first, *minmax.second);
+    return pfs::computeHistogramRange(data, pfs::HISTOGRAM_LINEAR);
 }
 
 void balance(pfs::Array2Df &data, float nb_min, float nb_max) {
@@ -108,7 +74,7 @@ void colorBalanceRGB(Array2Df &R, Array2Df &G, Array2Df &B, float nb_min,
                      float nb_max) {
     checkParameterValidity(nb_min, nb_max);
 
-#pragma omp parallel sections
+#pragma omp parallel sections num_threads(pfs::utils::getThreadsPerJob())
     {
 #pragma omp section
         {
@@ -129,10 +95,7 @@ void colorBalanceRGB(Array2Df &R, Array2Df &G, Array2Df &B, float nb_min,
 }
 
 void robustAWB(Array2Df *R_orig, Array2Df *G_orig, Array2Df *B_orig) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
+    PFS_TRACE_SPAN("robustAWB", "fusion");
     const int width = R_orig->getCols();
     const int height = R_orig->getRows();
     float u = 0.3f;
@@ -160,7 +123,7 @@ void robustAWB(Array2Df *R_orig, Array2Df *G_orig, Array2Df *B_orig) {
 
     for (int it = 0; it < iterMax; it++) {
         transformRGB2Yuv(&R, &G, &B, &Y, &U, &V);
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
         for (int i = 0; i < width * height; i++)
             F(i) = (abs(U(i)) + abs(V(i))) / Y(i);
         int sum = 0;
@@ -200,7 +163,7 @@ void robustAWB(Array2Df *R_orig, Array2Df *G_orig, Array2Df *B_orig) {
             delta = err * u;
         }
         gain[ch] -= delta;
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
         for (int i = 0; i < width * height; i++) {
             R(i) = (*R_orig)(i)*gain[0];
             B(i) = (*B_orig)(i)*gain[2];
@@ -209,11 +172,6 @@ void robustAWB(Array2Df *R_orig, Array2Df *G_orig, Array2Df *B_orig) {
     }
     copy(&R, R_orig);
     copy(&B, B_orig);
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "robustAWB = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
 }
 
 float computeAccumulation(const pfs::Array2Df &matrix) {
@@ -225,16 +183,13 @@ float computeAccumulation(const pfs::Array2Df &matrix) {
 }
 
 void shadesOfGrayAWB(Array2Df &R, Array2Df &G, Array2Df &B) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
+    PFS_TRACE_SPAN("shadesOfGrayAWB", "fusion");
 
     float eR = 0.f;
     float eG = 0.f;
     float eB = 0.f;
 
-#pragma omp parallel sections
+#pragma omp parallel sections num_threads(pfs::utils::getThreadsPerJob())
     {
 #pragma omp section
         {
@@ -261,7 +216,7 @@ void shadesOfGrayAWB(Array2Df &R, Array2Df &G, Array2Df &B) {
     float gainG = maximum / eG;
     float gainB = maximum / eB;
 
-#pragma omp parallel sections
+#pragma omp parallel sections num_threads(pfs::utils::getThreadsPerJob())
     {
 #pragma omp section
         {
@@ -279,12 +234,6 @@ void shadesOfGrayAWB(Array2Df &R, Array2Df &G, Array2Df &B) {
             pfs::utils::vsmul(B.data(), gainB, B.data(), B.size());
         }
     }
-
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "shadesOfGrayAWB = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
 }
 
 void whiteBalance(Frame &frame, WhiteBalanceType type) {
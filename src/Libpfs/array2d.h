@@ -23,8 +23,10 @@
 #define PFS_ARRAY2D_H
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 #include <Libpfs/strideiterator.h>
@@ -44,12 +46,25 @@ namespace pfs {
 //! order. Allows easy indexing and retrieving array dimensions.
 //! It offers an undirect access to the data (using (x)(y) or (elem) ) or a
 //! direct access to the data (using getRawData() or data()).
+//! The elements live in a reference counted \c DataBuffer, which is normally
+//! allocated by the class itself but can also be attached to memory owned by
+//! somebody else (i.e. a memory mapped file), see \c setBuffer()
+//! Several instances can share the same elements (copy-on-write, see
+//! \c share()). The non-const accessors hand out the elements for writing:
+//! they detach shared elements first, and from then on the instance is
+//! never shared, because pointers obtained from them can still be written
+//! through. \c endWrite() declares those pointers dead, so that the elements
+//! can be shared again. The const accessors never copy, and should be
+//! preferred by read-only code.
 //!
 template <typename Type>
 class Array2D {
    public:
-    typedef std::vector<Type> DataBuffer;
-    typedef typename DataBuffer::value_type value_type;
+    //! \brief handle to the memory holding the elements. Thanks to the
+    //! aliasing ctor of \c std::shared_ptr, it can point inside a larger block
+    //! while keeping the whole block alive
+    typedef std::shared_ptr<Type> DataBuffer;
+    typedef Type value_type;
     typedef Array2D<Type> self;
 
     //! \brief default constructor - empty \c Array2D
@@ -58,6 +73,10 @@ class Array2D {
     //! \brief init \c Array2D with a matrix of \a cols times \a rows
     Array2D(size_t cols, size_t rows);  // (width, height)
 
+    //! \brief init \c Array2D on top of \a buffer, which must hold at least
+    //! \a cols times \a rows elements. No copy is performed
+    Array2D(size_t cols, size_t rows, const DataBuffer &buffer);
+
     //! \brief copy ctor
     //! \note If you want to build an empty \c Array2D with the same size of the
     //! source, use the ctor that takes dimension and you will spare the copy
@@ -76,6 +95,8 @@ class Array2D {
     //! \param col number of a column (x) within the range [0, getCols()-1)
     //! \param row number of a row (y) within the range [0,getRows()-1)
     //!
+    //! \note the non-const element accessors take write access, see
+    //! \c beginWrite()
     Type &operator()(size_t cols, size_t rows);
     const Type &operator()(size_t cols, size_t rows) const;
 
@@ -96,14 +117,56 @@ class Array2D {
 
     size_t size() const { return m_rows * m_cols; }
 
+    //! \brief Change the size, preserving the elements that fit. Shared
+    //! elements are never written: the instance gets a buffer of its own
     void resize(size_t width, size_t height);
 
+    //! \brief Direct access to the raw data, for writing (see
+    //! \c beginWrite())
+    Type *data() {
+        prepareWrite();
+        return m_data.get();
+    }
     //! \brief Direct access to the raw data
-    Type *data() { return m_data.data(); }
-    //! \brief Direct access to the raw data
-    const Type *data() const { return m_data.data(); }
+    const Type *data() const { return m_data.get(); }
+
+    //! \brief Handle to the buffer holding the raw data
+    const DataBuffer &buffer() const { return m_data; }
+
+    //! \brief Drop the current content and use \a buffer (holding at least
+    //! \a width times \a height elements) as storage. No copy is performed
+    void setBuffer(size_t width, size_t height, const DataBuffer &buffer);
+
+    //! \brief Drop the current content and share the elements of \a other.
+    //! No copy is performed until one of the two instances is written,
+    //! unless \a other has write access (see \c beginWrite()): its elements
+    //! are copied then
+    //! \note can run while the thread owning \a other takes write access
+    void share(const self &other);
+
+    //! \brief true if the elements are shared with another instance
+    bool isShared() const { return m_data.use_count() > 1; }
+
+    //! \brief Make a private copy of the elements, if they are shared
+    void detach();
 
-    //! \brief fill the entire vector data to the value "value"
+    //! \brief Take write access: detach the elements and stop sharing them
+    //! until \c endWrite(). The non-const accessors do it on their first
+    //! call
+    //! \note not thread safe: must be called before handing the array to
+    //! several threads for writing
+    void beginWrite();
+
+    //! \brief Give up write access: pointers obtained from the non-const
+    //! accessors must not be written through any longer, and \c share() can
+    //! use the elements without copying them
+    void endWrite() { m_writeAccess.store(false); }
+
+    //! \brief true if pointers to the elements might be written through
+    bool hasWriteAccess() const { return m_writeAccess.load(); }
+
+    //! \brief fill the entire vector data to the value "value". Shared
+    //! elements are replaced by a new buffer, without copying them
     void fill(const Type &value);
     //! \brief fill the entire vector data with the default value for \c Type
     void reset();
@@ -111,25 +174,31 @@ class Array2D {
     //! \brief Swap the content of the current instance with \a other
     void swap(self &other);
 
+   protected:
+    //! \brief \c beginWrite(), unless write access was already taken
+    void prepareWrite() {
+        if (!m_writeAccess.load(std::memory_order_relaxed)) {
+            beginWrite();
+        }
+    }
+
    public:
     // element/row iterator
-    typedef typename DataBuffer::iterator iterator;
-    typedef typename DataBuffer::const_iterator const_iterator;
+    typedef Type *iterator;
+    typedef const Type *const_iterator;
 
-    iterator begin() { return m_data.begin(); }
-    iterator end() { return m_data.begin() + size(); }
+    iterator begin() { return data(); }
+    iterator end() { return data() + size(); }
 
-    const_iterator begin() const { return m_data.begin(); }
-    const_iterator end() const { return m_data.begin() + size(); }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size(); }
 
-    iterator row_begin(size_t r) { return m_data.begin() + r * m_cols; }
-    iterator row_end(size_t r) { return m_data.begin() + (r + 1) * m_cols; }
+    iterator row_begin(size_t r) { return data() + r * m_cols; }
+    iterator row_end(size_t r) { return data() + (r + 1) * m_cols; }
 
-    const_iterator row_begin(size_t r) const {
-        return m_data.begin() + r * m_cols;
-    }
+    const_iterator row_begin(size_t r) const { return data() + r * m_cols; }
     const_iterator row_end(size_t r) const {
-        return m_data.begin() + (r + 1) * m_cols;
+        return data() + (r + 1) * m_cols;
     }
 
     //! \brief subscript operators, returns the row \a n
@@ -137,8 +206,8 @@ class Array2D {
     const_iterator operator[](size_t n) const { return row_begin(n); }
 
     // column iterator
-    typedef StrideIterator<typename DataBuffer::iterator> col_iterator;
-    typedef StrideIterator<typename DataBuffer::iterator> const_col_iterator;
+    typedef StrideIterator<iterator> col_iterator;
+    typedef StrideIterator<const_iterator> const_col_iterator;
 
     col_iterator col_begin(size_t n) {
         return col_iterator(begin() + n, getCols());
@@ -154,9 +223,12 @@ class Array2D {
 
    private:
     DataBuffer m_data;
+    size_t m_capacity;
 
     size_t m_cols;
     size_t m_rows;
+
+    std::atomic<bool> m_writeAccess;
 };
 
 //! \brief typedef provided for backward compatibility with the old API
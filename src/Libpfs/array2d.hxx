@@ -37,19 +37,73 @@ using namespace std;
 
 namespace pfs {
 
+namespace detail {
+//! \brief allocate a value-initialized buffer of \a size elements
 template <typename Type>
-Array2D<Type>::Array2D() : m_data(), m_cols(0), m_rows(0) {}
+typename Array2D<Type>::DataBuffer allocateBuffer(size_t size) {
+    if (size == 0) {
+        return typename Array2D<Type>::DataBuffer();
+    }
+    return typename Array2D<Type>::DataBuffer(new Type[size](),
+                                              std::default_delete<Type[]>());
+}
+
+//! \brief deleter of the buffers given to \c Array2D from outside: it only
+//! keeps the owner of the memory alive
+template <typename Type>
+struct BufferReference {
+    explicit BufferReference(const typename Array2D<Type>::DataBuffer &owner)
+        : m_owner(owner) {}
+
+    void operator()(Type *) { m_owner.reset(); }
+
+    typename Array2D<Type>::DataBuffer m_owner;
+};
+
+//! \brief handle to \a buffer with a reference count of its own, so that
+//! arrays attached to different parts of the same block (i.e. the channels
+//! of a memory mapped file) are not considered shared by \c isShared()
+template <typename Type>
+typename Array2D<Type>::DataBuffer attachBuffer(
+    const typename Array2D<Type>::DataBuffer &buffer) {
+    if (!buffer) {
+        return buffer;
+    }
+    return typename Array2D<Type>::DataBuffer(buffer.get(),
+                                              BufferReference<Type>(buffer));
+}
+}
+
+template <typename Type>
+Array2D<Type>::Array2D()
+    : m_data(), m_capacity(0), m_cols(0), m_rows(0), m_writeAccess(false) {}
 
 template <typename Type>
 Array2D<Type>::Array2D(size_t cols, size_t rows)
-    : m_data(cols * rows), m_cols(cols), m_rows(rows) {
-    assert(m_data.size() >= m_cols * m_rows);
+    : m_data(detail::allocateBuffer<Type>(cols * rows)),
+      m_capacity(cols * rows),
+      m_cols(cols),
+      m_rows(rows),
+      m_writeAccess(false) {}
+
+template <typename Type>
+Array2D<Type>::Array2D(size_t cols, size_t rows, const DataBuffer &buffer)
+    : m_data(detail::attachBuffer<Type>(buffer)),
+      m_capacity(cols * rows),
+      m_cols(cols),
+      m_rows(rows),
+      m_writeAccess(false) {
+    assert(m_data || size() == 0);
 }
 
 template <typename Type>
 Array2D<Type>::Array2D(const self &rhs)
-    : m_data(rhs.m_data), m_cols(rhs.m_cols), m_rows(rhs.m_rows) {
-    assert(m_data.size() >= m_cols * m_rows);
+    : m_data(detail::allocateBuffer<Type>(rhs.size())),
+      m_capacity(rhs.size()),
+      m_cols(rhs.m_cols),
+      m_rows(rhs.m_rows),
+      m_writeAccess(false) {
+    std::copy(rhs.begin(), rhs.end(), m_data.get());
 }
 
 template <typename Type>
@@ -64,64 +118,117 @@ Array2D<Type> &Array2D<Type>::operator=(const Array2D<Type> &other) {
 
 template <typename Type>
 void Array2D<Type>::resize(size_t width, size_t height) {
-    m_data.resize(width * height);
+    // same semantic of std::vector::resize(): shrinking keeps the buffer,
+    // growing preserves the current content
+    const size_t newSize = width * height;
+    if (newSize > m_capacity || isShared()) {
+        DataBuffer newData(detail::allocateBuffer<Type>(newSize));
+        std::copy(m_data.get(), m_data.get() + std::min(size(), newSize),
+                  newData.get());
+        std::atomic_store(&m_data, newData);
+        m_capacity = newSize;
+    }
     m_cols = width;
     m_rows = height;
+}
 
-    assert(m_data.size() >= m_cols * m_rows);
+template <typename Type>
+void Array2D<Type>::setBuffer(size_t width, size_t height,
+                              const DataBuffer &buffer) {
+    assert(buffer || width * height == 0);
+
+    std::atomic_store(&m_data, detail::attachBuffer<Type>(buffer));
+    m_cols = width;
+    m_rows = height;
+    m_capacity = width * height;
+    m_writeAccess = false;
+}
+
+template <typename Type>
+void Array2D<Type>::share(const self &other) {
+    // the buffer is taken before looking at the write access of other, which
+    // takes it the other way round (see beginWrite()): either this instance
+    // sees the write access, or other sees the buffer shared and detaches
+    DataBuffer data = std::atomic_load(&other.m_data);
+    const size_t size = other.m_cols * other.m_rows;
+    if (other.m_writeAccess.load()) {
+        DataBuffer copied(detail::allocateBuffer<Type>(size));
+        std::copy(data.get(), data.get() + size, copied.get());
+        data.swap(copied);
+    }
+
+    std::atomic_store(&m_data, data);
+    m_cols = other.m_cols;
+    m_rows = other.m_rows;
+    m_capacity = size;
+    m_writeAccess = false;
+}
+
+template <typename Type>
+void Array2D<Type>::detach() {
+    if (!isShared()) {
+        return;
+    }
+    DataBuffer newData(detail::allocateBuffer<Type>(size()));
+    std::copy(m_data.get(), m_data.get() + size(), newData.get());
+    std::atomic_store(&m_data, newData);
+    m_capacity = size();
+}
+
+template <typename Type>
+void Array2D<Type>::beginWrite() {
+    m_writeAccess = true;
+    detach();
 }
 
 template <typename Type>
 void Array2D<Type>::swap(self &other) {
     std::swap(m_cols, other.m_cols);
     std::swap(m_rows, other.m_rows);
+    std::swap(m_capacity, other.m_capacity);
     std::swap(m_data, other.m_data);
+    // pointers handed out by either instance follow the elements
+    m_writeAccess = other.m_writeAccess.exchange(m_writeAccess.load());
 }
 
 template <typename Type>
 inline Type &Array2D<Type>::operator()(size_t cols, size_t rows) {
-#ifndef NDEBUG
-    return m_data.at(rows * m_cols + cols);
-#else
-    return m_data[rows * m_cols + cols];
-#endif
+    assert(cols < m_cols && rows < m_rows);
+    prepareWrite();
+    return m_data.get()[rows * m_cols + cols];
 }
 
 template <typename Type>
 inline const Type &Array2D<Type>::operator()(size_t cols, size_t rows) const {
-#ifndef NDEBUG
-    return m_data.at(rows * m_cols + cols);
-#else
-    return m_data[rows * m_cols + cols];
-#endif
+    assert(cols < m_cols && rows < m_rows);
+    return data()[rows * m_cols + cols];
 }
 
 template <typename Type>
 inline Type &Array2D<Type>::operator()(size_t index) {
-#ifndef NDEBUG
-    return m_data.at(index);
-#else
-    return m_data[index];
-#endif
+    assert(index < size());
+    prepareWrite();
+    return m_data.get()[index];
 }
 
 template <typename Type>
 inline const Type &Array2D<Type>::operator()(size_t index) const {
-#ifndef NDEBUG
-    return m_data.at(index);
-#else
-    return m_data[index];
-#endif
+    assert(index < size());
+    return data()[index];
 }
 
 template <typename Type>
 void Array2D<Type>::fill(const Type &value) {
-    std::fill(m_data.begin(), m_data.end(), value);
+    if (isShared()) {
+        std::atomic_store(&m_data, detail::allocateBuffer<Type>(size()));
+        m_capacity = size();
+    }
+    std::fill(m_data.get(), m_data.get() + size(), value);
 }
 
 template <typename Type>
 void Array2D<Type>::reset() {
-    std::fill(m_data.begin(), m_data.end(), Type());
+    fill(Type());
 }
 
 }  // Libpfs
@@ -0,0 +1,129 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Non owning, strided views over two dimensional arrays
+//! \author agent <agent@local>
+
+#ifndef PFS_ARRAY2DVIEW_H
+#define PFS_ARRAY2DVIEW_H
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+#include <Libpfs/array2d_fwd.h>
+
+namespace pfs {
+
+//! \brief Window of \c cols times \c rows samples over a buffer laid out by
+//! rows, \c stride samples apart
+//!
+//! A view does not own (nor keep alive) the samples: it is meant to hand a
+//! region of an \c Array2D to read-only consumers without copying it. Use
+//! \c pfs::copy to materialize it in an \c Array2D of its own.
+template <typename Type>
+class Array2DView {
+   public:
+    typedef Type value_type;
+    typedef typename std::remove_const<Type>::type NonConstType;
+    // row iterator
+    typedef Type *iterator;
+
+    Array2DView() : m_data(NULL), m_cols(0), m_rows(0), m_stride(0) {}
+
+    Array2DView(Type *data, size_t cols, size_t rows, size_t stride)
+        : m_data(data), m_cols(cols), m_rows(rows), m_stride(stride) {
+        assert(stride >= cols);
+    }
+
+    //! \brief view over the whole \a array
+    Array2DView(Array2D<NonConstType> &array);
+    Array2DView(const Array2D<NonConstType> &array);
+
+    Array2DView(const Array2DView &) = default;
+    Array2DView &operator=(const Array2DView &) = default;
+
+    //! \brief read-only view from a read-write one
+    //! \note a template, so that it never stands in for the copy constructor
+    //! of a read-write view
+    template <typename Other,
+              typename = typename std::enable_if<
+                  std::is_same<const Other, Type>::value &&
+                  !std::is_same<Other, Type>::value>::type>
+    Array2DView(const Array2DView<Other> &other)
+        : m_data(other.data()),
+          m_cols(other.getCols()),
+          m_rows(other.getRows()),
+          m_stride(other.getStride()) {}
+
+    size_t getCols() const { return m_cols; }
+    size_t getRows() const { return m_rows; }
+    //! \brief distance (in samples) between the beginning of two rows
+    size_t getStride() const { return m_stride; }
+    size_t size() const { return m_cols * m_rows; }
+    bool empty() const { return size() == 0; }
+
+    //! \brief true if rows follow each other without gaps (the view can be
+    //! walked as a single buffer of \c size() samples)
+    bool isContiguous() const { return m_stride == m_cols || m_rows <= 1; }
+
+    Type *data() const { return m_data; }
+
+    iterator row_begin(size_t r) const { return m_data + r * m_stride; }
+    iterator row_end(size_t r) const { return row_begin(r) + m_cols; }
+    iterator operator[](size_t r) const { return row_begin(r); }
+
+    Type &operator()(size_t x, size_t y) const {
+        assert(x < m_cols && y < m_rows);
+        return m_data[y * m_stride + x];
+    }
+
+    //! \brief view over the \a cols times \a rows samples starting at
+    //! (\a x, \a y)
+    Array2DView sub(size_t x, size_t y, size_t cols, size_t rows) const {
+        assert(x + cols <= m_cols && y + rows <= m_rows);
+        return Array2DView(m_data + y * m_stride + x, cols, rows, m_stride);
+    }
+
+   private:
+    Type *m_data;
+    size_t m_cols;
+    size_t m_rows;
+    size_t m_stride;
+};
+
+//! \brief read-write view over \a array
+template <typename Type>
+Array2DView<Type> makeView(Array2D<Type> &array) {
+    return Array2DView<Type>(array);
+}
+
+//! \brief read-only view over \a array
+template <typename Type>
+Array2DView<const Type> makeView(const Array2D<Type> &array) {
+    return Array2DView<const Type>(array);
+}
+
+}  // pfs
+
+#include <Libpfs/array2dview.hxx>
+
+#endif  // PFS_ARRAY2DVIEW_H
@@ -1,11 +1,7 @@
-#ifndef HISTOGRAM_H
-#define HISTOGRAM_H
-/**
- * @brief
- *
- * This file is a part of PFSTOOLS package.
+/*
+ * This file is a part of Luminance HDR package.
  * ----------------------------------------------------------------------
- * Copyright (C) 2003,2004 Rafal Mantiuk and Grzegorz Krawczyk
+ * Copyright (C) 2026 agent
  *
  *  This program is free software; you can redistribute it and/or modify
  *  it under the terms of the GNU General Public License as published by
@@ -21,35 +17,30 @@
  *  along with this program; if not, write to the Free Software
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  * ----------------------------------------------------------------------
- *
- * @author Rafal Mantiuk, <mantiuk@mpi-sb.mpg.de>
- *
- * $Id: histogram.h,v 1.2 2005/09/02 13:10:35 rafm Exp $
  */
 
-#include <assert.h>
-#include "Libpfs/array2d_fwd.h"
-
-class Histogram {
-    int bins;
-    int accuracy;
+#ifndef PFS_ARRAY2DVIEW_HXX
+#define PFS_ARRAY2DVIEW_HXX
 
-    float *P;
+#include <Libpfs/array2d.h>
+#include <Libpfs/array2dview.h>
 
-   public:
-    Histogram(int bins, int accuracy = 1);
-    ~Histogram();
+namespace pfs {
 
-    void computeLog(const pfs::Array2Df *image);
-    void computeLog(const pfs::Array2Df *image, float min, float max);
+template <typename Type>
+Array2DView<Type>::Array2DView(Array2D<NonConstType> &array)
+    : m_data(array.data()),
+      m_cols(array.getCols()),
+      m_rows(array.getRows()),
+      m_stride(array.getCols()) {}
 
-    int getBins() const { return bins; }
+template <typename Type>
+Array2DView<Type>::Array2DView(const Array2D<NonConstType> &array)
+    : m_data(array.data()),
+      m_cols(array.getCols()),
+      m_rows(array.getRows()),
+      m_stride(array.getCols()) {}
 
-    float getMaxP() const;
-    float getP(int bin) const {
-        assert(bin < bins);
-        return P[bin];
-    }
-};
+}  // pfs
 
-#endif
+#endif  // PFS_ARRAY2DVIEW_HXX
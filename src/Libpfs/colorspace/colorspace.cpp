@@ -38,8 +38,9 @@
 
 #include "Libpfs/array2d.h"
 #include "Libpfs/pfs.h"
-#include "Libpfs/utils/msec_timer.h"
+#include "Libpfs/utils/trace.h"
 
+#include "Libpfs/colorspace/kernels.h"
 #include "Libpfs/colorspace/rgb.h"
 #include "Libpfs/colorspace/xyz.h"
 #include "Libpfs/colorspace/yuv.h"
@@ -58,25 +59,16 @@ namespace pfs {
 void transformSRGB2XYZ(const Array2Df *inC1, const Array2Df *inC2,
                        const Array2Df *inC3, Array2Df *outC1, Array2Df *outC2,
                        Array2Df *outC3) {
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
-
-    utils::transform(inC1->begin(), inC1->end(), inC2->begin(), inC3->begin(),
-                     outC1->begin(), outC2->begin(), outC3->begin(),
-                     colorspace::ConvertSRGB2XYZ());
+    PFS_TRACE_SPAN("transformSRGB2XYZ", "colorspace");
 
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    std::cout << "transformSRGB2XYZ() = " << f_timer.get_time() << " msec"
-              << std::endl;
-#endif
+    colorspace::kernels::srgb2xyz(inC1->data(), inC2->data(), inC3->data(),
+                                  outC1->data(), outC2->data(), outC3->data(),
+                                  inC1->size());
 }
 void transformSRGB2Y(const Array2Df *inC1, const Array2Df *inC2,
                      const Array2Df *inC3, Array2Df *outC1) {
-    utils::transform(inC1->begin(), inC1->end(), inC2->begin(), inC3->begin(),
-                     outC1->begin(), colorspace::ConvertSRGB2Y());
+    colorspace::kernels::srgb2y(inC1->data(), inC2->data(), inC3->data(),
+                                outC1->data(), inC1->size());
 }
 
 //-----------------------------------------------------------
@@ -85,83 +77,47 @@ void transformSRGB2Y(const Array2Df *inC1, const Array2Df *inC2,
 void transformRGB2XYZ(const Array2Df *inC1, const Array2Df *inC2,
                       const Array2Df *inC3, Array2Df *outC1, Array2Df *outC2,
                       Array2Df *outC3) {
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
+    PFS_TRACE_SPAN("transformRGB2XYZ", "colorspace");
 
-    utils::transform(inC1->begin(), inC1->end(), inC2->begin(), inC3->begin(),
-                     outC1->begin(), outC2->begin(), outC3->begin(),
-                     colorspace::ConvertRGB2XYZ());
-
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    std::cout << "transformRGB2XYZ() = " << f_timer.get_time() << " msec"
-              << std::endl;
-#endif
+    colorspace::kernels::matrix3x3(colorspace::rgb2xyzD65Mat, inC1->data(),
+                                   inC2->data(), inC3->data(), outC1->data(),
+                                   outC2->data(), outC3->data(), inC1->size());
 }
 
 void transformRGB2Y(const Array2Df *inC1, const Array2Df *inC2,
                     const Array2Df *inC3, Array2Df *outC1) {
-    utils::transform(inC1->begin(), inC1->end(), inC2->begin(), inC3->begin(),
-                     outC1->begin(), colorspace::ConvertRGB2Y());
+    colorspace::kernels::rgb2y(inC1->data(), inC2->data(), inC3->data(),
+                               outC1->data(), inC1->size());
 }
 
 void transformRGB2Yuv(const Array2Df *inC1, const Array2Df *inC2,
                       const Array2Df *inC3, Array2Df *outC1, Array2Df *outC2,
                       Array2Df *outC3) {
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
+    PFS_TRACE_SPAN("transformRGB2Yuv", "colorspace");
 
     utils::transform(inC1->begin(), inC1->end(), inC2->begin(), inC3->begin(),
                      outC1->begin(), outC2->begin(), outC3->begin(),
                      colorspace::ConvertRGB2YUV());
-
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    std::cout << "transformRGB2Yuv() = " << f_timer.get_time() << " msec"
-              << std::endl;
-#endif
 }
 
 void transformXYZ2SRGB(const Array2Df *inC1, const Array2Df *inC2,
                        const Array2Df *inC3, Array2Df *outC1, Array2Df *outC2,
                        Array2Df *outC3) {
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
+    PFS_TRACE_SPAN("transformXYZ2SRGB", "colorspace");
 
-    utils::transform(inC1->begin(), inC1->end(), inC2->begin(), inC3->begin(),
-                     outC1->begin(), outC2->begin(), outC3->begin(),
-                     colorspace::ConvertXYZ2SRGB());
-
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    std::cout << "transformXYZ2SRGB() = " << f_timer.get_time() << " msec"
-              << std::endl;
-#endif
+    colorspace::kernels::xyz2srgb(inC1->data(), inC2->data(), inC3->data(),
+                                  outC1->data(), outC2->data(), outC3->data(),
+                                  inC1->size());
 }
 
 void transformXYZ2RGB(const Array2Df *inC1, const Array2Df *inC2,
                       const Array2Df *inC3, Array2Df *outC1, Array2Df *outC2,
                       Array2Df *outC3) {
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
+    PFS_TRACE_SPAN("transformXYZ2RGB", "colorspace");
 
-    utils::transform(inC1->begin(), inC1->end(), inC2->begin(), inC3->begin(),
-                     outC1->begin(), outC2->begin(), outC3->begin(),
-                     colorspace::ConvertXYZ2RGB());
-
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    std::cout << "transformXYZ2RGB() = " << f_timer.get_time() << " msec"
-              << std::endl;
-#endif
+    colorspace::kernels::matrix3x3(colorspace::xyz2rgbD65Mat, inC1->data(),
+                                   inC2->data(), inC3->data(), outC1->data(),
+                                   outC2->data(), outC3->data(), inC1->size());
 }
 
 void transformXYZ2Yuv(const Array2Df *inC1, const Array2Df *inC2,
@@ -204,20 +160,11 @@ void transformYuv2XYZ(const Array2Df *inC1, const Array2Df *inC2,
 void transformYuv2RGB(const Array2Df *inC1, const Array2Df *inC2,
                       const Array2Df *inC3, Array2Df *outC1, Array2Df *outC2,
                       Array2Df *outC3) {
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
+    PFS_TRACE_SPAN("transformYuv2RGB", "colorspace");
 
     utils::transform(inC1->begin(), inC1->end(), inC2->begin(), inC3->begin(),
                      outC1->begin(), outC2->begin(), outC3->begin(),
                      colorspace::ConvertYUV2RGB());
-
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    std::cout << "transformYuv2RGB() = " << f_timer.get_time() << " msec"
-              << std::endl;
-#endif
 }
 
 void transformYxy2XYZ(const Array2Df *inC1, const Array2Df *inC2,
@@ -0,0 +1,373 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Vectorized colour kernels working on planar channels
+//! \author agent <agent@local>
+
+#include <Libpfs/colorspace/kernels.h>
+#include <Libpfs/colorspace/rgbremapper.h>
+#include <Libpfs/colorspace/xyz.h>
+#include <Libpfs/utils/fastmath.h>
+#include <Libpfs/utils/parallel.h>
+
+#include <algorithm>
+#include <cmath>
+
+// The chunk kernels are compiled once per instruction set and the loader
+// resolves them (through an ifunc) to the best version for the running CPU.
+// Elsewhere they are built for the baseline of the compiler flags.
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 6) && \
+    defined(__ELF__) && (defined(__x86_64__) || defined(__i386__))
+#define PFS_TARGET_CLONES \
+    __attribute__((target_clones("avx512f", "avx2", "default")))
+#define PFS_HAVE_TARGET_CLONES
+#else
+#define PFS_TARGET_CLONES
+#endif
+
+namespace pfs {
+namespace colorspace {
+namespace kernels {
+
+namespace {
+
+//! \brief samples processed by a thread in one go: small enough to keep the
+//! three input and the three output channels in L1/L2
+const size_t CHUNK_SIZE = 4096;
+
+template <typename Func>
+void parallelChunks(size_t size, Func func) {
+    utils::parallelFor(0, size, CHUNK_SIZE,
+                       [&](ptrdiff_t begin, ptrdiff_t end) {
+                           func(begin, end - begin);
+                       });
+}
+
+//! \brief same as \c ConvertSRGB2RGB
+//! \note both branches are always evaluated, and the result selected
+inline float decodeSRGB(float sample) {
+    const float a = std::fabs(sample);
+    const float gamma = utils::fastPow((a + 0.055f) * (1.f / 1.055f), 2.4f);
+    const float linear = (a > 0.04045f) ? gamma : a * (1.f / 12.92f);
+    return (sample < 0.f) ? -linear : linear;
+}
+
+//! \brief same as \c ConvertRGB2SRGB
+inline float encodeSRGB(float sample) {
+    const float p = utils::fastPow(std::fabs(sample), 1.f / 2.4f);
+    const float positive = 1.055f * p - 0.055f;
+    const float negative = (0.055f - 1.f) * p - 0.055f;
+    const float linear = sample * 12.92f;
+    return (sample > 0.0031308f)
+               ? positive
+               : ((sample >= -0.0031308f) ? linear : negative);
+}
+
+// chunk kernels ----------------------------------------------------------
+
+PFS_TARGET_CLONES
+void matrixChunk(const float *mat, const float *i1, const float *i2,
+                 const float *i3, float *o1, float *o2, float *o3,
+                 size_t size) {
+    const float m00 = mat[0], m01 = mat[1], m02 = mat[2];
+    const float m10 = mat[3], m11 = mat[4], m12 = mat[5];
+    const float m20 = mat[6], m21 = mat[7], m22 = mat[8];
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        const float c1 = i1[idx], c2 = i2[idx], c3 = i3[idx];
+        o1[idx] = m00 * c1 + m01 * c2 + m02 * c3;
+        o2[idx] = m10 * c1 + m11 * c2 + m12 * c3;
+        o3[idx] = m20 * c1 + m21 * c2 + m22 * c3;
+    }
+}
+
+PFS_TARGET_CLONES
+void srgb2xyzChunk(const float *r, const float *g, const float *b, float *x,
+                   float *y, float *z, size_t size) {
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        const float c1 = decodeSRGB(r[idx]);
+        const float c2 = decodeSRGB(g[idx]);
+        const float c3 = decodeSRGB(b[idx]);
+        x[idx] = rgb2xyzD65Mat[0][0] * c1 + rgb2xyzD65Mat[0][1] * c2 +
+                 rgb2xyzD65Mat[0][2] * c3;
+        y[idx] = rgb2xyzD65Mat[1][0] * c1 + rgb2xyzD65Mat[1][1] * c2 +
+                 rgb2xyzD65Mat[1][2] * c3;
+        z[idx] = rgb2xyzD65Mat[2][0] * c1 + rgb2xyzD65Mat[2][1] * c2 +
+                 rgb2xyzD65Mat[2][2] * c3;
+    }
+}
+
+PFS_TARGET_CLONES
+void xyz2srgbChunk(const float *x, const float *y, const float *z, float *r,
+                   float *g, float *b, size_t size) {
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        const float c1 = x[idx], c2 = y[idx], c3 = z[idx];
+        r[idx] = encodeSRGB(xyz2rgbD65Mat[0][0] * c1 +
+                            xyz2rgbD65Mat[0][1] * c2 +
+                            xyz2rgbD65Mat[0][2] * c3);
+        g[idx] = encodeSRGB(xyz2rgbD65Mat[1][0] * c1 +
+                            xyz2rgbD65Mat[1][1] * c2 +
+                            xyz2rgbD65Mat[1][2] * c3);
+        b[idx] = encodeSRGB(xyz2rgbD65Mat[2][0] * c1 +
+                            xyz2rgbD65Mat[2][1] * c2 +
+                            xyz2rgbD65Mat[2][2] * c3);
+    }
+}
+
+PFS_TARGET_CLONES
+void rgb2yChunk(const float *r, const float *g, const float *b, float *y,
+                size_t size) {
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        y[idx] = rgb2xyzD65Mat[1][0] * r[idx] + rgb2xyzD65Mat[1][1] * g[idx] +
+                 rgb2xyzD65Mat[1][2] * b[idx];
+    }
+}
+
+PFS_TARGET_CLONES
+void srgb2yChunk(const float *r, const float *g, const float *b, float *y,
+                 size_t size) {
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        y[idx] = rgb2xyzD65Mat[1][0] * decodeSRGB(r[idx]) +
+                 rgb2xyzD65Mat[1][1] * decodeSRGB(g[idx]) +
+                 rgb2xyzD65Mat[1][2] * decodeSRGB(b[idx]);
+    }
+}
+
+PFS_TARGET_CLONES
+void srgb2rgbChunk(const float *in, float *out, size_t size) {
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        out[idx] = decodeSRGB(in[idx]);
+    }
+}
+
+PFS_TARGET_CLONES
+void rgb2srgbChunk(const float *in, float *out, size_t size) {
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        out[idx] = encodeSRGB(in[idx]);
+    }
+}
+
+PFS_TARGET_CLONES
+void saturationChunk(const float *r, const float *g, const float *b,
+                     float *outR, float *outG, float *outB, float multiplier,
+                     size_t size) {
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        const float c1 = r[idx], c2 = g[idx], c3 = b[idx];
+        const float v = std::max(std::max(c1, c2), c3);
+        const float m = std::min(std::min(c1, c2), c3);
+        const float l = (v + m) * 0.5f;
+
+        // hsl2rgb() gives back a grey sample when the lightness or the new
+        // maximum are not positive
+        const bool grey = (l <= 0.f) | (l + multiplier * (v - l) <= 0.f);
+        outR[idx] = grey ? l : l + multiplier * (c1 - l);
+        outG[idx] = grey ? l : l + multiplier * (c2 - l);
+        outB[idx] = grey ? l : l + multiplier * (c3 - l);
+    }
+}
+
+PFS_TARGET_CLONES
+void gammaChunk(const float *in, float *out, float exponent, float multiplier,
+                size_t size) {
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        const float sample = in[idx];
+        const float value = utils::fastPow(sample * multiplier, exponent);
+        out[idx] = (sample > 0.f) ? value : 0.f;
+    }
+}
+
+PFS_TARGET_CLONES
+void gammaAndLevelsChunk(const float *r, const float *g, const float *b,
+                         float *outR, float *outG, float *outB, float blackIn,
+                         float whiteIn, float blackOut, float whiteOut,
+                         float gamma, size_t size) {
+    const float inScale = 1.f / (whiteIn - blackIn);
+    const float outScale = whiteOut - blackOut;
+    // pow(0, gamma - 1)
+    const float zeroLuminance = (gamma == 1.f) ? 1.f : 0.f;
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        const float c1 = r[idx], c2 = g[idx], c3 = b[idx];
+        const float l = 0.2126f * c1 + 0.7152f * c2 + 0.0722f * c3;
+        const float value = utils::fastPow(l, gamma - 1.f);
+        const float scale = inScale * ((l > 0.f) ? value : zeroLuminance);
+
+        outR[idx] = std::min(
+            std::max(blackOut + (c1 - blackIn) * scale * outScale, 0.f), 1.f);
+        outG[idx] = std::min(
+            std::max(blackOut + (c2 - blackIn) * scale * outScale, 0.f), 1.f);
+        outB[idx] = std::min(
+            std::max(blackOut + (c3 - blackIn) * scale * outScale, 0.f), 1.f);
+    }
+}
+
+inline float normalize(float sample, float minValue, float range) {
+    return std::min(std::max((sample - minValue) / range, 0.f), 1.f);
+}
+
+inline uint32_t toRGB32(float r, float g, float b) {
+    return 0xff000000u | (static_cast<uint32_t>(r * 255.f + 0.5f) << 16) |
+           (static_cast<uint32_t>(g * 255.f + 0.5f) << 8) |
+           static_cast<uint32_t>(b * 255.f + 0.5f);
+}
+
+PFS_TARGET_CLONES
+void remapLinearChunk(const float *r, const float *g, const float *b,
+                      uint32_t *out, float minValue, float range,
+                      size_t size) {
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        out[idx] = toRGB32(normalize(r[idx], minValue, range),
+                           normalize(g[idx], minValue, range),
+                           normalize(b[idx], minValue, range));
+    }
+}
+
+PFS_TARGET_CLONES
+void remapPowChunk(const float *r, const float *g, const float *b,
+                   uint32_t *out, float minValue, float range,
+                   float exponent, size_t size) {
+#pragma omp simd
+    for (size_t idx = 0; idx < size; ++idx) {
+        out[idx] = toRGB32(
+            utils::fastPow(normalize(r[idx], minValue, range), exponent),
+            utils::fastPow(normalize(g[idx], minValue, range), exponent),
+            utils::fastPow(normalize(b[idx], minValue, range), exponent));
+    }
+}
+
+}  // anonymous namespace
+
+void matrix3x3(const float mat[3][3], const float *i1, const float *i2,
+               const float *i3, float *o1, float *o2, float *o3, size_t size) {
+    parallelChunks(size, [=](size_t begin, size_t count) {
+        matrixChunk(&mat[0][0], i1 + begin, i2 + begin, i3 + begin,
+                    o1 + begin, o2 + begin, o3 + begin, count);
+    });
+}
+
+void srgb2xyz(const float *r, const float *g, const float *b, float *x,
+              float *y, float *z, size_t size) {
+    parallelChunks(size, [=](size_t begin, size_t count) {
+        srgb2xyzChunk(r + begin, g + begin, b + begin, x + begin, y + begin,
+                      z + begin, count);
+    });
+}
+
+void xyz2srgb(const float *x, const float *y, const float *z, float *r,
+              float *g, float *b, size_t size) {
+    parallelChunks(size, [=](size_t begin, size_t count) {
+        xyz2srgbChunk(x + begin, y + begin, z + begin, r + begin, g + begin,
+                      b + begin, count);
+    });
+}
+
+void rgb2y(const float *r, const float *g, const float *b, float *y,
+           size_t size) {
+    parallelChunks(size, [=](size_t begin, size_t count) {
+        rgb2yChunk(r + begin, g + begin, b + begin, y + begin, count);
+    });
+}
+
+void srgb2y(const float *r, const float *g, const float *b, float *y,
+            size_t size) {
+    parallelChunks(size, [=](size_t begin, size_t count) {
+        srgb2yChunk(r + begin, g + begin, b + begin, y + begin, count);
+    });
+}
+
+void srgb2rgb(const float *in, float *out, size_t size) {
+    parallelChunks(size, [=](size_t begin, size_t count) {
+        srgb2rgbChunk(in + begin, out + begin, count);
+    });
+}
+
+void rgb2srgb(const float *in, float *out, size_t size) {
+    parallelChunks(size, [=](size_t begin, size_t count) {
+        rgb2srgbChunk(in + begin, out + begin, count);
+    });
+}
+
+void saturation(const float *r, const float *g, const float *b, float *outR,
+                float *outG, float *outB, float multiplier, size_t size) {
+    parallelChunks(size, [=](size_t begin, size_t count) {
+        saturationChunk(r + begin, g + begin, b + begin, outR + begin,
+                        outG + begin, outB + begin, multiplier, count);
+    });
+}
+
+void gamma(const float *in, float *out, float exponent, float multiplier,
+           size_t size) {
+    parallelChunks(size, [=](size_t begin, size_t count) {
+        gammaChunk(in + begin, out + begin, exponent, multiplier, count);
+    });
+}
+
+void gammaAndLevels(const float *r, const float *g, const float *b,
+                    float *outR, float *outG, float *outB, float blackIn,
+                    float whiteIn, float blackOut, float whiteOut, float gamma,
+                    size_t size) {
+    parallelChunks(size, [=](size_t begin, size_t count) {
+        gammaAndLevelsChunk(r + begin, g + begin, b + begin, outR + begin,
+                            outG + begin, outB + begin, blackIn, whiteIn,
+                            blackOut, whiteOut, gamma, count);
+    });
+}
+
+void remapToRGB32(const float *r, const float *g, const float *b,
+                  uint32_t *out, float minValue, float maxValue,
+                  RGBMappingType mappingType, size_t size) {
+    const float range = maxValue - minValue;
+    const float exponent = mappingExponent(mappingType);
+    parallelChunks(size, [=](size_t begin, size_t count) {
+        if (exponent == 1.f) {
+            remapLinearChunk(r + begin, g + begin, b + begin, out + begin,
+                             minValue, range, count);
+        } else {
+            remapPowChunk(r + begin, g + begin, b + begin, out + begin,
+                          minValue, range, exponent, count);
+        }
+    });
+}
+
+const char *simdLevel() {
+#ifdef PFS_HAVE_TARGET_CLONES
+    if (__builtin_cpu_supports("avx512f")) return "avx512f";
+    if (__builtin_cpu_supports("avx2")) return "avx2";
+#endif
+#ifdef __SSE2__
+    return "sse2";
+#else
+    return "generic";
+#endif
+}
+
+}  // kernels
+}  // colorspace
+}  // pfs
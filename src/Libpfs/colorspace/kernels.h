@@ -0,0 +1,101 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Vectorized colour kernels working on planar channels
+//! \author agent <agent@local>
+//!
+//! Every kernel processes the three channels of a pixel in a single pass and
+//! splits the work among the OpenMP threads. On x86 the inner loops are built
+//! for several instruction sets (SSE2, AVX2, AVX-512) and the best one for
+//! the running CPU is picked when the library is loaded.
+//! Input and output pointers can be the same (in-place conversion), but must
+//! not partially overlap.
+
+#ifndef PFS_COLORSPACE_KERNELS_H
+#define PFS_COLORSPACE_KERNELS_H
+
+#include <cstddef>
+#include <stdint.h>
+
+#include <Libpfs/colorspace/rgbremapper_fwd.h>
+
+namespace pfs {
+namespace colorspace {
+namespace kernels {
+
+//! \brief o = mat * i
+void matrix3x3(const float mat[3][3], const float *i1, const float *i2,
+               const float *i3, float *o1, float *o2, float *o3, size_t size);
+
+//! \brief sRGB -> linear RGB -> XYZ
+void srgb2xyz(const float *r, const float *g, const float *b, float *x,
+              float *y, float *z, size_t size);
+
+//! \brief XYZ -> linear RGB -> sRGB
+void xyz2srgb(const float *x, const float *y, const float *z, float *r,
+              float *g, float *b, size_t size);
+
+//! \brief luminance (Y) of linear RGB samples
+void rgb2y(const float *r, const float *g, const float *b, float *y,
+           size_t size);
+
+//! \brief luminance (Y) of sRGB samples
+void srgb2y(const float *r, const float *g, const float *b, float *y,
+            size_t size);
+
+//! \brief sRGB decoding (sRGB -> linear RGB) of a single channel
+void srgb2rgb(const float *in, float *out, size_t size);
+
+//! \brief sRGB encoding (linear RGB -> sRGB) of a single channel
+void rgb2srgb(const float *in, float *out, size_t size);
+
+//! \brief multiply the HSL saturation of the samples by \a multiplier
+//! \note same as a round trip through \c rgb2hsl and \c hsl2rgb, computed
+//! as an affine scaling around the lightness of the sample
+void saturation(const float *r, const float *g, const float *b, float *outR,
+                float *outG, float *outB, float multiplier, size_t size);
+
+//! \brief out = (in * multiplier)^exponent for the positive samples of
+//! \a in, 0 for the others
+void gamma(const float *in, float *out, float exponent, float multiplier,
+           size_t size);
+
+//! \brief black/white levels and gamma, scaled on the luminance of each
+//! pixel (see \c pfs::gammaAndLevels). The output is clamped to [0, 1]
+void gammaAndLevels(const float *r, const float *g, const float *b,
+                    float *outR, float *outG, float *outB, float blackIn,
+                    float whiteIn, float blackOut, float whiteOut, float gamma,
+                    size_t size);
+
+//! \brief map the samples in [\a minValue, \a maxValue] to 8 bits with
+//! \a mappingType, and pack them as 0xffRRGGBB (the layout of QRgb)
+void remapToRGB32(const float *r, const float *g, const float *b,
+                  uint32_t *out, float minValue, float maxValue,
+                  RGBMappingType mappingType, size_t size);
+
+//! \brief name of the instruction set used by the kernels on this CPU
+const char *simdLevel();
+
+}  // kernels
+}  // colorspace
+}  // pfs
+
+#endif  // PFS_COLORSPACE_KERNELS_H
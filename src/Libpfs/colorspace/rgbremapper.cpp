@@ -27,51 +27,51 @@
 
 #include <Libpfs/colorspace/rgbremapper.h>
 
-#include <algorithm>
 #include <cassert>
-#include <cmath>
-#include "arch/math.h"
+
+#include <Libpfs/utils/fastmath.h>
 
 namespace {
 const float GAMMA_1_4 = 1.0f / 1.4f;
 const float GAMMA_1_8 = 1.0f / 1.8f;
 const float GAMMA_2_2 = 1.0f / 2.2f;
 const float GAMMA_2_6 = 1.0f / 2.6f;
+const float LOGARITHMIC = 2.2f;
 }
 
+float mappingExponent(RGBMappingType mappingType) {
+    assert(mappingType >= 0);
+    assert(mappingType < 6);
+
+    static const float s_exponents[] = {1.f,       GAMMA_1_4, GAMMA_1_8,
+                                        GAMMA_2_2, GAMMA_2_6, LOGARITHMIC};
+    return s_exponents[mappingType];
+}
+
+// the (bounded) error of fastPow is far below the quantization step of the
+// 8 and 16 bits outputs these functions are used for
+
 float RemapperBase::toLinear(float sample) { return sample; }
 
 float RemapperBase::toGamma14(float sample) {
-    return std::pow(sample, GAMMA_1_4);
+    return pfs::utils::fastPow(sample, GAMMA_1_4);
 }
 
 float RemapperBase::toGamma18(float sample) {
-    return std::pow(sample, GAMMA_1_8);
+    return pfs::utils::fastPow(sample, GAMMA_1_8);
 }
 
 float RemapperBase::toGamma22(float sample) {
-    return std::pow(sample, GAMMA_2_2);
+    return pfs::utils::fastPow(sample, GAMMA_2_2);
 }
 
 float RemapperBase::toGamma26(float sample) {
-    return std::pow(sample, GAMMA_2_6);
+    return pfs::utils::fastPow(sample, GAMMA_2_6);
 }
 
 float RemapperBase::toLog(float sample) {
-    return std::pow(sample, 1.f / GAMMA_2_2);
+    return pfs::utils::fastPow(sample, LOGARITHMIC);
 }
 
 const RemapperBase::MappingFunc RemapperBase::s_callbacks[] = {
     &toLinear, &toGamma14, &toGamma18, &toGamma22, &toGamma26, &toLog};
-
-Remapper<uint8_t>::Remapper(RGBMappingType mappingMethod)
-    : m_mappingMethod(mappingMethod) {
-    assert(mappingMethod >= 0);
-    assert(mappingMethod < 6);
-
-    MappingFunc callback(s_callbacks[mappingMethod]);
-
-    for (int idx = 0; idx < 256; ++idx) {
-        m_lut[idx] = 255.f * callback(float(idx) / 255.f);
-    }
-}
@@ -32,12 +32,26 @@
 
 #include "channel.h"
 #include "frame.h"
+#include "histogram.h"
 
 using namespace std;
 
 namespace pfs {
+namespace {
+uint64_t nextGeneration() {
+    static std::atomic<uint64_t> s_generation(0);
+    return ++s_generation;
+}
+}
+
 Frame::Frame(size_t width, size_t height)
-    : m_width(width), m_height(height), m_X(NULL), m_Y(NULL), m_Z(NULL) {}
+    : m_width(width),
+      m_height(height),
+      m_X(NULL),
+      m_Y(NULL),
+      m_Z(NULL),
+      m_histograms(new HistogramCache),
+      m_generation(nextGeneration()) {}
 
 namespace {
 struct ChannelDeleter {
@@ -59,6 +73,8 @@ void Frame::resize(size_t width, size_t height) {
 
     m_width = width;
     m_height = height;
+
+    invalidateHistograms();
 }
 
 namespace {
@@ -134,6 +150,13 @@ void Frame::getXYZChannels(Channel *&X, Channel *&Y, Channel *&Z) {
     X = const_cast<Channel *>(X_);
     Y = const_cast<Channel *>(Y_);
     Z = const_cast<Channel *>(Z_);
+
+    if (X != NULL) {
+        X->beginWrite();
+        Y->beginWrite();
+        Z->beginWrite();
+        renewGeneration();
+    }
 }
 
 void Frame::createXYZChannels(Channel *&X, Channel *&Y, Channel *&Z) {
@@ -152,8 +175,13 @@ const Channel *Frame::getChannel(const string &name) const {
 }
 
 Channel *Frame::getChannel(const string &name) {
-    return const_cast<Channel *>(
+    Channel *ch = const_cast<Channel *>(
         static_cast<const Frame &>(*this).getChannel(name));
+    if (ch != NULL) {
+        ch->beginWrite();
+        renewGeneration();
+    }
+    return ch;
 }
 
 Channel *Frame::createChannel(const string &name) {
@@ -162,9 +190,12 @@ Channel *Frame::createChannel(const string &name) {
         find_if(m_channels.begin(), m_channels.end(), FindChannel(name));
     if (it != m_channels.end()) {
         ch = *it;
+        ch->beginWrite();
+        renewGeneration();
     } else {
         ch = new Channel(m_width, m_height, name);
         m_channels.push_back(ch);
+        invalidateHistograms();
     }
 
     // update the cache, if necessary
@@ -186,6 +217,7 @@ void Frame::removeChannel(const string &channel) {
         Channel *ch = *it;
         m_channels.erase(it);
         delete ch;
+        invalidateHistograms();
 
         if (channel == "X") {
             m_X = NULL;
@@ -197,7 +229,12 @@ void Frame::removeChannel(const string &channel) {
     }
 }
 
-ChannelContainer &Frame::getChannels() { return this->m_channels; }
+ChannelContainer &Frame::getChannels() {
+    for_each(m_channels.begin(), m_channels.end(),
+             boost::bind(&Channel::ChannelData::beginWrite, _1));
+    renewGeneration();
+    return this->m_channels;
+}
 
 const ChannelContainer &Frame::getChannels() const { return this->m_channels; }
 
@@ -216,6 +253,41 @@ void Frame::swap(Frame &other) {
     swap(m_X, other.m_X);
     swap(m_Y, other.m_Y);
     swap(m_Z, other.m_Z);
+    m_histograms.swap(other.m_histograms);
+
+    m_generation = other.m_generation.exchange(m_generation.load());
 }
 
+HistogramCache &Frame::getHistogramCache() const { return *m_histograms; }
+
+void Frame::invalidateHistograms() const {
+    m_histograms->clear();
+    renewGeneration();
+}
+
+void Frame::endWrite() {
+    if (hasWriteAccess()) {
+        // the last writes through the channels happened after the generation
+        // was renewed by the accessors
+        renewGeneration();
+    }
+    for_each(m_channels.begin(), m_channels.end(),
+             boost::bind(&Channel::ChannelData::endWrite, _1));
+}
+
+bool Frame::hasWriteAccess() const {
+    return find_if(m_channels.begin(), m_channels.end(),
+                   boost::bind(&Channel::ChannelData::hasWriteAccess, _1)) !=
+           m_channels.end();
+}
+
+uint64_t Frame::getGeneration() const {
+    if (hasWriteAccess()) {
+        renewGeneration();
+    }
+    return m_generation.load();
+}
+
+void Frame::renewGeneration() const { m_generation = nextGeneration(); }
+
 }  // namespace pfs
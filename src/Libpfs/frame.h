@@ -30,7 +30,9 @@
 #ifndef PFS_FRAME_H
 #define PFS_FRAME_H
 
+#include <atomic>
 #include <memory>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -41,10 +43,19 @@ namespace pfs {
 
 typedef std::vector<Channel *> ChannelContainer;
 
+class HistogramCache;
+
 //! Interface representing a single PFS frame. Frame may contain 0
 //! or more channels (e.g. color XYZ, depth channel, alpha
 //! channnel). All the channels are of the same size. Frame can
 //! also contain additional information in tags (see getTags).
+//!
+//! Channels can share their data with the channels of other frames (see
+//! \c pfs::copy()). The non-const accessors hand out channels for writing,
+//! so they detach shared channels first (\c Array2D::beginWrite()): the
+//! const ones never copy, and should be preferred by read-only code. A copy
+//! of the frame copies the channels handed out for writing, until the writer
+//! calls \c endWrite().
 class Frame {
    public:
     Frame(size_t width = 0, size_t height = 0);
@@ -70,6 +81,7 @@ class Frame {
     //! \param X [out] a pointer to store X channel in
     //! \param Y [out] a pointer to store Y channel in
     //! \param Z [out] a pointer to store Z channel in
+    //! \note the channels are taken for writing, see \c endWrite()
     void getXYZChannels(Channel *&X, Channel *&Y, Channel *&Z);
 
     void getXYZChannels(const Channel *&X, const Channel *&Y,
@@ -90,6 +102,7 @@ class Frame {
     //! \param name [in] name of the channel. Name must be 8 or less
     //! character long.
     //! \return channel or NULL if the channel does not exist
+    //! \note the channel is taken for writing, see \c endWrite()
     Channel *getChannel(const std::string &name);
     const Channel *getChannel(const std::string &name) const;
 
@@ -113,6 +126,7 @@ class Frame {
 
     //! \return \c ChannelContainer associated to the internal list of \c
     //! Channel
+    //! \note all the channels are taken for writing, see \c endWrite()
     ChannelContainer &getChannels();
 
     const ChannelContainer &getChannels() const;
@@ -127,7 +141,36 @@ class Frame {
 
     void swap(Frame &other);
 
+    //! \brief declare that the channels handed out for writing are not
+    //! written any longer, so that \c copy() can share them rather than
+    //! copying them (see \c Array2D::endWrite())
+    void endWrite();
+
+    //! \brief true if a channel was handed out for writing since the last
+    //! \c endWrite()
+    bool hasWriteAccess() const;
+
+    //! \brief histograms computed on the channels of the frame (see
+    //! histogram.h). Kept for the current generation of the frame only
+    HistogramCache &getHistogramCache() const;
+
+    //! \brief drop the cached histograms: to be called after writing into
+    //! the channels of a frame whose histograms might have been requested
+    //! \note renews the generation of the frame as well
+    void invalidateHistograms() const;
+
+    //! \brief identifies the content of the frame, unique in the process.
+    //! It is renewed whenever the channels are handed out for writing (the
+    //! non-const accessors), so results computed from a frame can be cached
+    //! under its generation. A copy gets a generation of its own
+    //! \note while a channel has write access (see \c endWrite()) every call
+    //! returns a new generation, as the channels can change any time
+    uint64_t getGeneration() const;
+
    private:
+    //! \brief the content of the frame is about to change
+    void renewGeneration() const;
+
     size_t m_width;
     size_t m_height;
 
@@ -138,6 +181,10 @@ class Frame {
     Channel *m_X;
     Channel *m_Y;
     Channel *m_Z;
+
+    std::unique_ptr<HistogramCache> m_histograms;
+
+    mutable std::atomic<uint64_t> m_generation;
 };
 
 typedef std::shared_ptr<pfs::Frame> FramePtr;
@@ -0,0 +1,96 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Non owning view over a rectangular region of a frame
+//! \author agent <agent@local>
+
+#include <Libpfs/frameview.h>
+
+#include <cassert>
+
+#include <Libpfs/frame.h>
+#include <Libpfs/manip/copy.h>
+
+namespace pfs {
+
+FrameView::FrameView(const Frame &frame)
+    : m_frame(&frame),
+      m_width(frame.getWidth()),
+      m_height(frame.getHeight()) {
+    const ChannelContainer &channels = frame.getChannels();
+    m_channels.reserve(channels.size());
+    for (ChannelContainer::const_iterator it = channels.begin();
+         it != channels.end(); ++it) {
+        ChannelView view;
+        view.name = (*it)->getName();
+        view.data = makeView(static_cast<const Array2Df &>(**it));
+        m_channels.push_back(view);
+    }
+}
+
+const Array2DView<const float> *FrameView::getChannel(
+    const std::string &name) const {
+    for (ChannelViewContainer::const_iterator it = m_channels.begin();
+         it != m_channels.end(); ++it) {
+        if (it->name == name) return &it->data;
+    }
+    return NULL;
+}
+
+bool FrameView::getXYZChannels(Array2DView<const float> &X,
+                               Array2DView<const float> &Y,
+                               Array2DView<const float> &Z) const {
+    const Array2DView<const float> *x = getChannel("X");
+    const Array2DView<const float> *y = getChannel("Y");
+    const Array2DView<const float> *z = getChannel("Z");
+    if (x == NULL || y == NULL || z == NULL) return false;
+
+    X = *x;
+    Y = *y;
+    Z = *z;
+    return true;
+}
+
+FrameView FrameView::sub(size_t x, size_t y, size_t width,
+                         size_t height) const {
+    assert(x + width <= m_width && y + height <= m_height);
+
+    FrameView view(*this);
+    view.m_width = width;
+    view.m_height = height;
+    for (ChannelViewContainer::iterator it = view.m_channels.begin();
+         it != view.m_channels.end(); ++it) {
+        it->data = it->data.sub(x, y, width, height);
+    }
+    return view;
+}
+
+Frame *FrameView::materialize() const {
+    Frame *frame = new Frame(m_width, m_height);
+    for (ChannelViewContainer::const_iterator it = m_channels.begin();
+         it != m_channels.end(); ++it) {
+        copy(it->data, frame->createChannel(it->name));
+    }
+    copyTags(m_frame, frame);
+    return frame;
+}
+
+}  // pfs
@@ -0,0 +1,83 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Non owning view over a rectangular region of a frame
+//! \author agent <agent@local>
+
+#ifndef PFS_FRAMEVIEW_H
+#define PFS_FRAMEVIEW_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <Libpfs/array2dview.h>
+
+namespace pfs {
+class Frame;
+
+//! \brief Read-only window over all the channels of a \c Frame
+//!
+//! The frame must outlive the view and must not be resized meanwhile.
+//! Read-only consumers can work on a region without copying it; operators
+//! working in place need a frame of their own: see \c materialize()
+class FrameView {
+   public:
+    struct ChannelView {
+        std::string name;
+        Array2DView<const float> data;
+    };
+    typedef std::vector<ChannelView> ChannelViewContainer;
+
+    //! \brief view over the whole \a frame
+    explicit FrameView(const Frame &frame);
+
+    size_t getWidth() const { return m_width; }
+    size_t getHeight() const { return m_height; }
+
+    const Frame &getFrame() const { return *m_frame; }
+    const ChannelViewContainer &getChannels() const { return m_channels; }
+
+    //! \return view over the channel \a name, or NULL if it does not exist
+    const Array2DView<const float> *getChannel(const std::string &name) const;
+
+    //! \brief views over X, Y and Z: false if the frame does not have them
+    bool getXYZChannels(Array2DView<const float> &X,
+                        Array2DView<const float> &Y,
+                        Array2DView<const float> &Z) const;
+
+    //! \brief view over the \a width times \a height pixels starting at
+    //! (\a x, \a y), relative to this view
+    FrameView sub(size_t x, size_t y, size_t width, size_t height) const;
+
+    //! \brief deep copy of the region, with the tags of the frame
+    Frame *materialize() const;
+
+   private:
+    const Frame *m_frame;
+    size_t m_width;
+    size_t m_height;
+    ChannelViewContainer m_channels;
+};
+
+}  // pfs
+
+#endif  // PFS_FRAMEVIEW_H
@@ -0,0 +1,267 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Histograms of the samples of a channel
+//! \author agent <agent@local>
+
+#include <Libpfs/histogram.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <Libpfs/array2d.h>
+#include <Libpfs/exception.h>
+#include <Libpfs/frame.h>
+#include <Libpfs/utils/fastmath.h>
+#include <Libpfs/utils/parallel.h>
+
+namespace pfs {
+
+HistogramParams::HistogramParams(size_t bins, float min, float max,
+                                 HistogramScale scale, size_t step)
+    : bins(bins), min(min), max(max), scale(scale), step(step) {}
+
+bool HistogramParams::operator<(const HistogramParams &other) const {
+    if (bins != other.bins) return bins < other.bins;
+    if (min != other.min) return min < other.min;
+    if (max != other.max) return max < other.max;
+    if (scale != other.scale) return scale < other.scale;
+    return step < other.step;
+}
+
+namespace {
+struct LinearBin {
+    LinearBin(const float *data, const HistogramParams &params)
+        : data(data),
+          min(params.min),
+          max(params.max),
+          scale(params.max > params.min
+                    ? params.bins / (params.max - params.min)
+                    : 0.f),
+          lastBin(params.bins - 1) {}
+
+    size_t operator()(size_t i) const { return bin(data[i]); }
+
+    // out of range samples (NaN included) get an invalid bin
+    size_t bin(float v) const {
+        if (!(v >= min && v <= max)) return lastBin + 1;
+        return std::min(static_cast<size_t>((v - min) * scale), lastBin);
+    }
+
+    const float *data;
+    float min;
+    float max;
+    float scale;
+    size_t lastBin;
+};
+
+struct Log10Bin {
+    Log10Bin(const float *data, const HistogramParams &params)
+        : data(data), linear(data, params) {}
+
+    size_t operator()(size_t i) const {
+        const float v = data[i];
+        if (!(v > 0.f)) return linear.lastBin + 1;
+        // log10(v) = log2(v) * log10(2)
+        return linear.bin(utils::fastLog2(v) * 0.301029996f);
+    }
+
+    const float *data;
+    LinearBin linear;
+};
+}
+
+Histogram::Histogram(const HistogramParams &params)
+    : m_params(params), m_counts(params.bins, 0), m_total(0) {}
+
+void Histogram::compute(const Array2Df &data) {
+    if (m_params.scale == HISTOGRAM_LOG10) {
+        compute(data.size(), Log10Bin(data.data(), m_params));
+    } else {
+        compute(data.size(), LinearBin(data.data(), m_params));
+    }
+}
+
+size_t Histogram::getMaxCount() const {
+    if (m_counts.empty()) return 0;
+    return *std::max_element(m_counts.begin(), m_counts.end());
+}
+
+float Histogram::getP(size_t bin) const {
+    if (m_total == 0) return 0.f;
+    return static_cast<float>(m_counts[bin]) / m_total;
+}
+
+float Histogram::getBinValue(size_t bin) const {
+    const float v = m_params.min + (bin + 0.5f) * (m_params.max - m_params.min) /
+                                       m_params.bins;
+    return (m_params.scale == HISTOGRAM_LOG10) ? std::pow(10.f, v) : v;
+}
+
+size_t Histogram::getQuantileBin(float p) const {
+    const float threshold = p * m_total;
+    size_t cumulative = 0;
+    for (size_t bin = 0; bin < m_counts.size(); ++bin) {
+        cumulative += m_counts[bin];
+        if (cumulative >= threshold) return bin;
+    }
+    return m_counts.empty() ? 0 : m_counts.size() - 1;
+}
+
+float Histogram::getQuantile(float p) const {
+    if (m_total == 0) return m_params.min;
+
+    const size_t bin = getQuantileBin(p);
+    size_t below = 0;
+    for (size_t b = 0; b < bin; ++b) below += m_counts[b];
+
+    // linear interpolation inside the bin
+    const float fraction =
+        m_counts[bin] > 0
+            ? std::min(std::max((p * m_total - below) / m_counts[bin], 0.f),
+                       1.f)
+            : 0.f;
+    const float v = m_params.min + (bin + fraction) *
+                                       (m_params.max - m_params.min) /
+                                       m_params.bins;
+    return (m_params.scale == HISTOGRAM_LOG10) ? std::pow(10.f, v) : v;
+}
+
+std::pair<float, float> computeHistogramRange(const Array2Df &data,
+                                              HistogramScale scale,
+                                              size_t step) {
+    const float *samples = data.data();
+    const long size = static_cast<long>(data.size());
+    const long increment = static_cast<long>(std::max<size_t>(step, 1));
+    const bool positiveOnly = (scale == HISTOGRAM_LOG10);
+
+    float minVal = std::numeric_limits<float>::max();
+    float maxVal = -std::numeric_limits<float>::max();
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) reduction(min : minVal) reduction(max : maxVal)
+    for (long i = 0; i < size; i += increment) {
+        const float v = samples[i];
+        if (positiveOnly && !(v > 0.f)) continue;
+        minVal = std::min(minVal, v);
+        maxVal = std::max(maxVal, v);
+    }
+
+    if (minVal > maxVal) return std::make_pair(0.f, 0.f);
+    if (positiveOnly) {
+        return std::make_pair(std::log10(minVal), std::log10(maxVal));
+    }
+    return std::make_pair(minVal, maxVal);
+}
+
+HistogramCache::HistogramCache() : m_generation(0) {}
+
+bool HistogramCache::sync(uint64_t generation) {
+    if (generation > m_generation) {
+        m_histograms.clear();
+        m_ranges.clear();
+        m_generation = generation;
+    }
+    return generation == m_generation;
+}
+
+std::shared_ptr<const Histogram> HistogramCache::getHistogram(
+    const Array2Df &data, uint64_t generation, const std::string &channel,
+    const HistogramParams &params) {
+    const HistogramKey key(channel, params);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (sync(generation)) {
+            std::map<HistogramKey,
+                     std::shared_ptr<const Histogram> >::iterator it =
+                m_histograms.find(key);
+            if (it != m_histograms.end()) return it->second;
+        }
+    }
+
+    // computed out of the lock: at worst, two threads asking for the same
+    // histogram compute it twice
+    std::shared_ptr<Histogram> histogram = std::make_shared<Histogram>(params);
+    histogram->compute(data);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (sync(generation)) m_histograms[key] = histogram;
+    return histogram;
+}
+
+std::pair<float, float> HistogramCache::getRange(const Array2Df &data,
+                                                 uint64_t generation,
+                                                 const std::string &channel,
+                                                 HistogramScale scale,
+                                                 size_t step) {
+    const RangeKey key(channel, std::make_pair(static_cast<int>(scale), step));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (sync(generation)) {
+            std::map<RangeKey, std::pair<float, float> >::iterator it =
+                m_ranges.find(key);
+            if (it != m_ranges.end()) return it->second;
+        }
+    }
+
+    const std::pair<float, float> range =
+        computeHistogramRange(data, scale, step);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (sync(generation)) m_ranges[key] = range;
+    return range;
+}
+
+void HistogramCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_histograms.clear();
+    m_ranges.clear();
+}
+
+namespace {
+const Channel &getHistogramChannel(const Frame &frame,
+                                   const std::string &channel) {
+    const Channel *data = frame.getChannel(channel);
+    if (data == NULL) {
+        throw pfs::Exception("Histogram: missing channel " + channel);
+    }
+    return *data;
+}
+}
+
+std::shared_ptr<const Histogram> getHistogram(const Frame &frame,
+                                              const std::string &channel,
+                                              const HistogramParams &params) {
+    // the generation is read first: if it is renewed while the histogram is
+    // computed, the result is not kept
+    const uint64_t generation = frame.getGeneration();
+    return frame.getHistogramCache().getHistogram(
+        getHistogramChannel(frame, channel), generation, channel, params);
+}
+
+std::pair<float, float> getHistogramRange(const Frame &frame,
+                                          const std::string &channel,
+                                          HistogramScale scale, size_t step) {
+    const uint64_t generation = frame.getGeneration();
+    return frame.getHistogramCache().getRange(
+        getHistogramChannel(frame, channel), generation, channel, scale, step);
+}
+
+}  // pfs
@@ -0,0 +1,173 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Histograms of the samples of a channel
+//! \author agent <agent@local>
+//!
+//! One engine for every histogram of the application: the samples are
+//! split among the OpenMP threads, each one filling its own sub-histogram,
+//! merged at the end. Optionally only one sample every \c step is binned.
+//! Histograms and ranges of the channels of a \c Frame are cached on the
+//! frame itself (see \c getHistogram), so several widgets looking at the same
+//! frame scan it once.
+
+#ifndef PFS_HISTOGRAM_H
+#define PFS_HISTOGRAM_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Libpfs/array2d_fwd.h>
+
+namespace pfs {
+class Frame;
+
+//! \brief how the samples are spread over the bins
+enum HistogramScale {
+    HISTOGRAM_LINEAR = 0,  //!< bins evenly spaced in the sample domain
+    HISTOGRAM_LOG10 = 1    //!< bins evenly spaced in log10, for luminance
+};
+
+//! \brief describes a histogram: \c min and \c max are in the domain of
+//! \c scale (log10 of the samples for \c HISTOGRAM_LOG10). Samples outside
+//! [min, max] (or not positive, in log scale) are not counted.
+struct HistogramParams {
+    HistogramParams(size_t bins = 256, float min = 0.f, float max = 1.f,
+                    HistogramScale scale = HISTOGRAM_LINEAR, size_t step = 1);
+
+    size_t bins;
+    float min;
+    float max;
+    HistogramScale scale;
+    //! \brief bin one sample every \c step
+    size_t step;
+
+    bool operator<(const HistogramParams &other) const;
+};
+
+class Histogram {
+   public:
+    explicit Histogram(const HistogramParams &params = HistogramParams());
+
+    //! \brief bin the samples of \a data, as described by the parameters
+    void compute(const Array2Df &data);
+
+    //! \brief bin \a size samples: \a binOf(i) returns the bin of the sample
+    //! \c i, or a value out of [0, bins) for samples not to count
+    //! \note \c min, \c max and \c scale are not used: they just describe
+    //! the binning performed by \a binOf
+    template <typename BinOf>
+    void compute(size_t size, const BinOf &binOf);
+
+    const HistogramParams &getParams() const { return m_params; }
+    size_t getBins() const { return m_counts.size(); }
+    size_t getCount(size_t bin) const { return m_counts[bin]; }
+    const std::vector<size_t> &getCounts() const { return m_counts; }
+
+    //! \brief number of samples counted
+    size_t getTotal() const { return m_total; }
+    size_t getMaxCount() const;
+
+    //! \brief fraction of the counted samples falling in \a bin
+    float getP(size_t bin) const;
+
+    //! \brief sample value at the center of \a bin
+    float getBinValue(size_t bin) const;
+
+    //! \brief first bin where the cumulative count reaches \a p times the
+    //! total (\a p in [0, 1])
+    size_t getQuantileBin(float p) const;
+
+    //! \brief sample value below which falls a fraction \a p of the samples,
+    //! interpolated inside the bin
+    float getQuantile(float p) const;
+
+   private:
+    HistogramParams m_params;
+    std::vector<size_t> m_counts;
+    size_t m_total;
+};
+
+//! \brief (min, max) of one sample every \a step of \a data. In
+//! \c HISTOGRAM_LOG10 scale, log10 of the smallest and largest positive
+//! samples. (0, 0) when there are no such samples.
+std::pair<float, float> computeHistogramRange(const Array2Df &data,
+                                              HistogramScale scale,
+                                              size_t step = 1);
+
+//! \brief histograms and ranges already computed on the channels of a frame
+//! The entries belong to one generation of the frame (see
+//! \c Frame::getGeneration): a request for a newer generation drops them,
+//! and results computed for an older one are returned but not kept.
+//! \note thread safe: entries are shared, and stay valid after a \c clear
+class HistogramCache {
+   public:
+    HistogramCache();
+
+    std::shared_ptr<const Histogram> getHistogram(
+        const Array2Df &data, uint64_t generation, const std::string &channel,
+        const HistogramParams &params);
+
+    std::pair<float, float> getRange(const Array2Df &data, uint64_t generation,
+                                     const std::string &channel,
+                                     HistogramScale scale, size_t step);
+
+    void clear();
+
+   private:
+    typedef std::pair<std::string, HistogramParams> HistogramKey;
+    typedef std::pair<std::string, std::pair<int, size_t> > RangeKey;
+
+    //! \brief move to \a generation if newer (call with m_mutex held)
+    //! \return true if the entries belong to \a generation
+    bool sync(uint64_t generation);
+
+    std::mutex m_mutex;
+    uint64_t m_generation;
+    std::map<HistogramKey, std::shared_ptr<const Histogram> > m_histograms;
+    std::map<RangeKey, std::pair<float, float> > m_ranges;
+};
+
+//! \brief histogram of \a channel of \a frame, computed on the first request
+//! and cached on the frame until the frame changes
+//! \note throws \c pfs::Exception if the channel does not exist
+std::shared_ptr<const Histogram> getHistogram(const Frame &frame,
+                                              const std::string &channel,
+                                              const HistogramParams &params);
+
+//! \brief range of \a channel of \a frame (see \c computeHistogramRange),
+//! cached on the frame like \c getHistogram
+std::pair<float, float> getHistogramRange(const Frame &frame,
+                                          const std::string &channel,
+                                          HistogramScale scale,
+                                          size_t step = 1);
+
+}  // pfs
+
+#include <Libpfs/histogram.hxx>
+
+#endif  // PFS_HISTOGRAM_H
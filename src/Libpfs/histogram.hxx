@@ -0,0 +1,81 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+#ifndef PFS_HISTOGRAM_HXX
+#define PFS_HISTOGRAM_HXX
+
+#include <Libpfs/histogram.h>
+
+#include <algorithm>
+#include <numeric>
+
+#include <Libpfs/utils/parallel.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pfs {
+
+template <typename BinOf>
+void Histogram::compute(size_t size, const BinOf &binOf) {
+    const size_t bins = m_params.bins;
+    const size_t step = std::max<size_t>(m_params.step, 1);
+    const long samples = static_cast<long>((size + step - 1) / step);
+
+    std::vector<size_t> counts(bins, 0);
+
+    int numThreads = 1;
+#ifdef _OPENMP
+    // merging the sub-histograms costs bins * threads: small inputs are not
+    // worth spreading over many threads
+    const int maxThreads =
+        static_cast<int>(pfs::utils::getThreadsPerJob());
+    while (static_cast<size_t>(samples) >
+               static_cast<size_t>(numThreads) * numThreads * 16384 &&
+           numThreads < maxThreads) {
+        ++numThreads;
+    }
+#endif
+
+#pragma omp parallel num_threads(numThreads)
+    {
+        std::vector<size_t> local(bins, 0);
+
+#pragma omp for nowait
+        for (long s = 0; s < samples; ++s) {
+            const size_t bin = binOf(static_cast<size_t>(s) * step);
+            if (bin < bins) ++local[bin];
+        }
+
+#pragma omp critical
+        for (size_t b = 0; b < bins; ++b) {
+            counts[b] += local[b];
+        }
+    }
+
+    m_counts.swap(counts);
+    m_total = std::accumulate(m_counts.begin(), m_counts.end(), size_t(0));
+}
+
+}  // pfs
+
+#endif  // PFS_HISTOGRAM_HXX
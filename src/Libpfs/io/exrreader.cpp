@@ -32,6 +32,7 @@
 #include <ImfStandardAttributes.h>
 #include <ImfStringAttribute.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
@@ -95,9 +96,15 @@ void EXRReader::open() {
     bool red = false;
     bool green = false;
     bool blue = false;
+    size_t channelCount = 0;
+    size_t bitDepth = 0;
     const ChannelList &channels = m_data->file_.header().channels();
     for (ChannelList::ConstIterator i = channels.begin(), iEnd = channels.end();
          i != iEnd; ++i) {
+        ++channelCount;
+        bitDepth = std::max<size_t>(bitDepth,
+                                    (i.channel().type == HALF) ? 16 : 32);
+
         if (!strcmp(i.name(), "R"))
             red = true;
         else if (!strcmp(i.name(), "G"))
@@ -126,6 +133,8 @@ void EXRReader::open() {
 
     setWidth(width);
     setHeight(height);
+    setChannels(channelCount);
+    setBitDepth(bitDepth);
 }
 
 void EXRReader::close() {
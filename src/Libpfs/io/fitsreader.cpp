@@ -96,6 +96,7 @@ void FitsReader::open() {
     }
     setWidth(naxes[0]);
     setHeight(naxes[1]);
+    setChannels(1);
 
     float bscale;
     float bzero;
@@ -23,19 +23,38 @@
 
 #include <Libpfs/frame.h>
 #include <Libpfs/manip/rotate.h>
-#include <Libpfs/exif/exifdata.hpp>
 
 namespace pfs {
 namespace io {
 
 FrameReader::FrameReader(const std::string &filename)
-    : m_filename(filename), m_width(0), m_height(0) {}
+    : m_filename(filename),
+      m_width(0),
+      m_height(0),
+      m_channels(0),
+      m_bitDepth(0) {}
 
 FrameReader::~FrameReader() {}
 
+const exif::ExifData &FrameReader::exifData() const {
+    if (!m_exifData) {
+        m_exifData.reset(new exif::ExifData(m_filename));
+    }
+    return *m_exifData;
+}
+
+FrameInfo FrameReader::probe() const {
+    FrameInfo info;
+    info.width = m_width;
+    info.height = m_height;
+    info.channels = m_channels;
+    info.bitDepth = m_bitDepth;
+    info.exifData = exifData();
+    return info;
+}
+
 void FrameReader::read(pfs::Frame &frame, const pfs::Params &params) {
-    pfs::exif::ExifData exifData(m_filename);
-    int rotation = exifData.getOrientationDegree();
+    int rotation = exifData().getOrientationDegree();
 
     if (rotation == 270 || rotation == 90 || rotation == 180) {
         Frame *rotatedHalf = pfs::rotate(&frame, rotation != 270);
@@ -28,6 +28,7 @@
 #include <memory>
 #include <string>
 
+#include <Libpfs/exif/exifdata.hpp>
 #include <Libpfs/params.h>
 
 namespace pfs {
@@ -35,6 +36,33 @@ class Frame;
 
 namespace io {
 
+//! \brief description of an image file, as read from its header
+struct FrameInfo {
+    FrameInfo() : width(0), height(0), channels(0), bitDepth(0) {}
+
+    size_t width;
+    size_t height;
+    //! \brief number of samples per pixel stored in the file (0 if unknown)
+    size_t channels;
+    //! \brief bits per sample stored in the file (0 if unknown)
+    size_t bitDepth;
+
+    exif::ExifData exifData;
+};
+
+//! \brief clamp the \c scale_denom read parameter to the reduced resolution
+//! factors supported by the readers: 1 (full resolution), 2, 4 or 8
+inline unsigned int getScaleDenominator(int scaleDenom) {
+    if (scaleDenom >= 8) return 8;
+    if (scaleDenom >= 4) return 4;
+    if (scaleDenom >= 2) return 2;
+    return 1;
+}
+
+//! \brief base class of all the readers
+//! \note readers supporting a fast, reduced resolution decoding (useful for
+//! previews) honour the \c scale_denom parameter, returning a frame roughly
+//! 1/scale_denom of the size of the file. Other readers ignore it.
 class FrameReader {
    public:
     FrameReader(const std::string &filename);
@@ -48,6 +76,14 @@ class FrameReader {
     //! \brief return the height of the file being read
     size_t height() const { return m_height; }
 
+    //! \brief EXIF data of the file being read, parsed on first access
+    const exif::ExifData &exifData() const;
+
+    //! \brief return the description of the file, without decoding it
+    //! \note all the readers parse the header of the file in \c open(), so
+    //! this call only adds the parsing of the EXIF data
+    FrameInfo probe() const;
+
     virtual void open() = 0;
     virtual bool isOpen() const = 0;
     virtual void close() = 0;
@@ -56,11 +92,17 @@ class FrameReader {
    protected:
     void setWidth(size_t width) { m_width = width; }
     void setHeight(size_t height) { m_height = height; }
+    void setChannels(size_t channels) { m_channels = channels; }
+    void setBitDepth(size_t bitDepth) { m_bitDepth = bitDepth; }
 
    private:
     std::string m_filename;
     size_t m_width;
     size_t m_height;
+    size_t m_channels;
+    size_t m_bitDepth;
+
+    mutable std::unique_ptr<exif::ExifData> m_exifData;
 };
 
 typedef std::shared_ptr<FrameReader> FrameReaderPtr;
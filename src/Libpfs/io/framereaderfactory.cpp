@@ -22,6 +22,9 @@
 #include <Libpfs/io/framereaderfactory.h>
 #include <boost/assign.hpp>
 
+#include <sys/stat.h>
+#include <mutex>
+
 using namespace boost::assign;
 using namespace std;
 
@@ -41,6 +44,46 @@ FrameReaderPtr FrameReaderFactory::open(const std::string &filename) {
     throw UnsupportedFormat("Cannot find the correct handler for " + filename);
 }
 
+namespace {
+struct ProbeCacheEntry {
+    time_t modificationTime;
+    off_t size;
+    FrameInfo info;
+};
+
+typedef std::map<std::string, ProbeCacheEntry> ProbeCache;
+
+std::mutex s_probeCacheMutex;
+ProbeCache s_probeCache;
+}
+
+FrameInfo FrameReaderFactory::probe(const std::string &filename) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) {
+        throw InvalidFile("Cannot open file " + filename);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_probeCacheMutex);
+        ProbeCache::const_iterator it = s_probeCache.find(filename);
+        if (it != s_probeCache.end() &&
+            it->second.modificationTime == st.st_mtime &&
+            it->second.size == st.st_size) {
+            return it->second.info;
+        }
+    }
+
+    // parse outside of the lock, so different files can be probed in parallel
+    ProbeCacheEntry entry;
+    entry.modificationTime = st.st_mtime;
+    entry.size = st.st_size;
+    entry.info = open(filename)->probe();
+
+    std::lock_guard<std::mutex> lock(s_probeCacheMutex);
+    s_probeCache[filename] = entry;
+    return entry.info;
+}
+
 void FrameReaderFactory::registerFormat(
     const std::string &format, FrameReaderFactory::FrameReaderCreator creator) {
     sm_registry.insert(FrameReaderCreatorMap::value_type(format, creator));
@@ -59,6 +102,7 @@ bool FrameReaderFactory::isSupported(const std::string &format) {
 
 #include <Libpfs/io/exrreader.h>
 #include <Libpfs/io/jpegreader.h>
+#include <Libpfs/io/lhcreader.h>
 #include <Libpfs/io/pfsreader.h>
 #include <Libpfs/io/rawreader.h>
 #include <Libpfs/io/rgbereader.h>
@@ -82,6 +126,8 @@ FrameReaderFactory::FrameReaderCreatorMap FrameReaderFactory::sm_registry =
     // HDR formats
     ("pfs", creator<PfsReader>)("exr", creator<EXRReader>)("hdr",
                                                            creator<RGBEReader>)
+    // scratch formats
+    ("lhc", creator<LhcReader>)
     // RAW formats
     (
         "crw", creator<RAWReader>)("cr2", creator<
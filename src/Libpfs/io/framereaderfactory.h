@@ -44,6 +44,12 @@ class FrameReaderFactory {
 
     static FrameReaderPtr open(const std::string &filename);
 
+    //! \brief return size, layout and EXIF data of \a filename, reading only
+    //! its header
+    //! \note results are cached per path, and refreshed when the size or the
+    //! modification time of the file change
+    static FrameInfo probe(const std::string &filename);
+
     static void registerFormat(const std::string &format,
                                FrameReaderCreator creator);
     static size_t numRegisteredFormats();
@@ -70,6 +70,7 @@ bool FrameWriterFactory::isSupported(const std::string &format) {
 
 #include <Libpfs/io/exrwriter.h>
 #include <Libpfs/io/jpegwriter.h>
+#include <Libpfs/io/lhcwriter.h>
 #include <Libpfs/io/pfswriter.h>
 #include <Libpfs/io/pngwriter.h>
 #include <Libpfs/io/rgbewriter.h>
@@ -92,7 +93,9 @@ FrameWriterFactory::FrameWriterCreatorMap FrameWriterFactory::sm_registry =
     ("tiff", creator<TiffWriter>)("tif", creator<TiffWriter>)
     // HDR formats
     ("pfs", creator<PfsWriter>)("exr", creator<EXRWriter>)("hdr",
-                                                           creator<RGBEWriter>);
+                                                           creator<RGBEWriter>)
+    // scratch formats
+    ("lhc", creator<LhcWriter>);
 
 }  // io
 }  // pfs
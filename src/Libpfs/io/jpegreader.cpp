@@ -260,6 +260,8 @@ void JpegReader::open() {
 
     setWidth(m_data->cinfo()->image_width);
     setHeight(m_data->cinfo()->image_height);
+    setChannels(m_data->cinfo()->num_components);
+    setBitDepth(BITS_IN_JSAMPLE);
 }
 
 static cmsHTRANSFORM getColorSpaceTransform(j_decompress_ptr cinfo) {
@@ -326,8 +328,8 @@ static void read3Components(j_decompress_ptr cinfo, Frame &frame,
 
     frame.createXYZChannels(red, green, blue);
 
-    std::vector<JSAMPLE> scanLineBuffer(cinfo->image_width *
-                                        cinfo->num_components);
+    std::vector<JSAMPLE> scanLineBuffer(cinfo->output_width *
+                                        cinfo->output_components);
     JSAMPROW scanLineBufferArray[1] = {scanLineBuffer.data()};
 
     for (int i = 0; cinfo->output_scanline < cinfo->output_height; ++i) {
@@ -336,7 +338,7 @@ static void read3Components(j_decompress_ptr cinfo, Frame &frame,
         utils::transform(
             FixedStrideIterator<JSAMPLE *, 3>(scanLineBuffer.data()),
             FixedStrideIterator<JSAMPLE *, 3>(scanLineBuffer.data() +
-                                              cinfo->image_width * 3),
+                                              cinfo->output_width * 3),
             FixedStrideIterator<JSAMPLE *, 3>(scanLineBuffer.data() + 1),
             FixedStrideIterator<JSAMPLE *, 3>(scanLineBuffer.data() + 2),
             red->row_begin(i), green->row_begin(i), blue->row_begin(i), conv);
@@ -353,8 +355,8 @@ static void read4Components(j_decompress_ptr cinfo, Frame &frame,
 
     frame.createXYZChannels(red, green, blue);
 
-    std::vector<JSAMPLE> scanLineBuffer(cinfo->image_width *
-                                        cinfo->num_components);
+    std::vector<JSAMPLE> scanLineBuffer(cinfo->output_width *
+                                        cinfo->output_components);
     JSAMPROW scanLineBufferArray[1] = {scanLineBuffer.data()};
 
     for (int i = 0; cinfo->output_scanline < cinfo->output_height; ++i) {
@@ -363,7 +365,7 @@ static void read4Components(j_decompress_ptr cinfo, Frame &frame,
         utils::transform(
             FixedStrideIterator<JSAMPLE *, 4>(scanLineBuffer.data()),  // C
             FixedStrideIterator<JSAMPLE *, 4>(scanLineBuffer.data() +
-                                              cinfo->image_width * 4),  // end C
+                                              cinfo->output_width * 4),  // end C
             FixedStrideIterator<JSAMPLE *, 4>(scanLineBuffer.data() + 1),  // M
             FixedStrideIterator<JSAMPLE *, 4>(scanLineBuffer.data() + 2),  // Y
             FixedStrideIterator<JSAMPLE *, 4>(scanLineBuffer.data() + 3),  // K
@@ -375,7 +377,16 @@ static void read4Components(j_decompress_ptr cinfo, Frame &frame,
 
 void JpegReader::read(Frame &frame, const Params &params) {
     try {
-        Frame tempFrame(width(), height());
+        // reduced resolution decoding: let libjpeg scale the DCT blocks, so
+        // the discarded coefficients are never decoded at all
+        int scaleDenom = 1;
+        params.get("scale_denom", scaleDenom);
+        m_data->cinfo()->scale_num = 1;
+        m_data->cinfo()->scale_denom = getScaleDenominator(scaleDenom);
+        if (scaleDenom > 1) {
+            m_data->cinfo()->dct_method = JDCT_IFAST;
+            m_data->cinfo()->do_fancy_upsampling = false;
+        }
 
         jpeg_start_decompress(m_data->cinfo());
 
@@ -383,8 +394,9 @@ void JpegReader::read(Frame &frame, const Params &params) {
         assert(m_data->cinfo()->image_width != 0);
         assert(m_data->cinfo()->output_height != 0);
         assert(m_data->cinfo()->output_width != 0);
-        assert(m_data->cinfo()->image_height == m_data->cinfo()->output_height);
-        assert(m_data->cinfo()->image_width == m_data->cinfo()->output_width);
+
+        Frame tempFrame(m_data->cinfo()->output_width,
+                        m_data->cinfo()->output_height);
 
         utils::ScopedCmsTransform xform(
             getColorSpaceTransform(m_data->cinfo()));
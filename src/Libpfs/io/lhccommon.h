@@ -0,0 +1,107 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Luminance HDR Cache (LHC) file format common definitions
+//! \author agent <agent@local>
+//!
+//! LHC is an uncompressed, planar container meant for intermediate results,
+//! where the cost of encoding matters far more than the size of the file.
+//! All values are stored in the native byte order.
+//! - \c LhcHeader
+//! - directory: the frame tags, followed by name and tags of each channel
+//!   (same text encoding of the PFS file format)
+//! - padding up to \c LHC_DATA_ALIGNMENT
+//! - for each level of the preview pyramid (level 0 is the full resolution
+//!   frame, each level halves the size of the previous one) the planes of all
+//!   the channels, in directory order. Each plane starts at a multiple of
+//!   \c LHC_PLANE_ALIGNMENT
+
+#ifndef PFS_IO_LHCCOMMON_H
+#define PFS_IO_LHCCOMMON_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdint.h>
+
+#define LHC_MAGIC "LHDRCACH"
+#define LHC_VERSION 1
+
+#define LHC_DATA_ALIGNMENT 4096
+#define LHC_PLANE_ALIGNMENT 64
+
+#define LHC_MAX_LEVELS 16
+
+namespace pfs {
+namespace io {
+
+enum LhcSampleType { LHC_FLOAT32 = 0, LHC_HALF = 1 };
+
+struct LhcHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint32_t sampleType;
+    //! \brief number of stored levels (at least 1, the full resolution one)
+    uint32_t levels;
+    uint64_t directorySize;
+    //! \brief offset of the first plane from the beginning of the file
+    uint64_t dataOffset;
+    uint8_t reserved[16];
+};
+
+inline size_t lhcSampleSize(uint32_t sampleType) {
+    return (sampleType == LHC_HALF) ? 2 : 4;
+}
+
+inline size_t lhcAlign(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+//! \brief size of \a level, given the size of the full resolution frame
+inline size_t lhcLevelSize(size_t size, size_t level) {
+    return std::max<size_t>(1, size >> level);
+}
+
+//! \brief size in bytes of a plane of \a width times \a height samples,
+//! including the padding
+inline size_t lhcPlaneBytes(size_t width, size_t height, uint32_t sampleType) {
+    return lhcAlign(width * height * lhcSampleSize(sampleType),
+                    LHC_PLANE_ALIGNMENT);
+}
+
+//! \brief offset of the first plane of \a level
+inline uint64_t lhcLevelOffset(const LhcHeader &header, size_t level) {
+    uint64_t offset = header.dataOffset;
+    for (size_t l = 0; l < level; ++l) {
+        offset += header.channels *
+                  lhcPlaneBytes(lhcLevelSize(header.width, l),
+                                lhcLevelSize(header.height, l),
+                                header.sampleType);
+    }
+    return offset;
+}
+
+}  // io
+}  // pfs
+
+#endif  // PFS_IO_LHCCOMMON_H
@@ -0,0 +1,188 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include <Libpfs/frame.h>
+#include <Libpfs/io/lhcreader.h>
+#include <Libpfs/utils/half.h>
+#include <Libpfs/utils/mappedfile.h>
+
+namespace pfs {
+namespace io {
+
+namespace {
+const uint32_t MAX_LHC_CHANNELS = 1024;
+const uint32_t MAX_LHC_RES = 1 << 20;
+const uint64_t MAX_LHC_DIRECTORY = 1 << 24;
+
+void readLhcTags(TagContainer &tags, std::istream &in) {
+    size_t tagCount = 0;
+    std::string line;
+    if (!std::getline(in, line) ||
+        !(std::istringstream(line) >> tagCount)) {
+        throw ReadException("Corrupted LHC directory: missing tag count");
+    }
+    for (size_t i = 0; i < tagCount; ++i) {
+        if (!std::getline(in, line)) {
+            throw ReadException("Corrupted LHC directory: missing tag");
+        }
+        size_t found = line.find_first_of('=');
+        if (found == std::string::npos) {
+            throw ReadException("Corrupted LHC directory ('=' sign missing)");
+        }
+        tags.setTag(line.substr(0, found), line.substr(found + 1));
+    }
+}
+}
+
+LhcReader::LhcReader(const std::string &filename) : FrameReader(filename) {
+    memset(&m_header, 0, sizeof(m_header));
+    LhcReader::open();
+}
+
+void LhcReader::open() {
+    m_file.reset(fopen(filename().c_str(), "rb"));
+    if (!m_file) {
+        throw InvalidFile("Cannot open file " + filename());
+    }
+
+    if (fread(&m_header, sizeof(m_header), 1, m_file.data()) != 1) {
+        throw InvalidHeader("LHC: cannot read header");
+    }
+    if (memcmp(m_header.magic, LHC_MAGIC, sizeof(m_header.magic)) != 0 ||
+        m_header.version != LHC_VERSION) {
+        throw InvalidHeader("Incorrect LHC file header");
+    }
+    if (m_header.width == 0 || m_header.width > MAX_LHC_RES ||
+        m_header.height == 0 || m_header.height > MAX_LHC_RES ||
+        m_header.channels > MAX_LHC_CHANNELS || m_header.levels == 0 ||
+        m_header.levels > LHC_MAX_LEVELS ||
+        m_header.directorySize > MAX_LHC_DIRECTORY ||
+        (m_header.sampleType != LHC_FLOAT32 &&
+         m_header.sampleType != LHC_HALF)) {
+        throw InvalidHeader("Corrupted LHC file header");
+    }
+
+    setWidth(m_header.width);
+    setHeight(m_header.height);
+    setChannels(m_header.channels);
+    setBitDepth(lhcSampleSize(m_header.sampleType) * 8);
+}
+
+void LhcReader::close() {
+    setWidth(0);
+    setHeight(0);
+    m_file.reset();
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+void LhcReader::read(Frame &frame, const Params &params) {
+    if (!isOpen()) open();
+
+    int level = 0;
+    params.get("lhc.level", level);
+    level = std::max(0, std::min<int>(level, m_header.levels - 1));
+
+    const size_t levelWidth = lhcLevelSize(m_header.width, level);
+    const size_t levelHeight = lhcLevelSize(m_header.height, level);
+    const size_t planeSize = levelWidth * levelHeight;
+    const size_t planeBytes =
+        lhcPlaneBytes(levelWidth, levelHeight, m_header.sampleType);
+    const uint64_t levelOffset = lhcLevelOffset(m_header, level);
+
+    // directory
+    std::string directory(m_header.directorySize, '\0');
+    if (fseek(m_file.data(), sizeof(m_header), SEEK_SET) != 0 ||
+        fread(&directory[0], 1, directory.size(), m_file.data()) !=
+            directory.size()) {
+        throw ReadException("Corrupted LHC file: missing directory");
+    }
+    std::istringstream in(directory);
+
+    // channels are attached to the mapping or allocated later on
+    Frame tempFrame;
+    readLhcTags(tempFrame.getTags(), in);
+
+    std::vector<Channel *> channels;
+    for (uint32_t c = 0; c < m_header.channels; ++c) {
+        std::string name;
+        if (!std::getline(in, name) || name.empty()) {
+            throw ReadException("Corrupted LHC directory: bad channel name");
+        }
+        Channel *ch = tempFrame.createChannel(name);
+        readLhcTags(ch->getTags(), in);
+        channels.push_back(ch);
+    }
+
+    utils::MappedFilePtr mapping = utils::MappedFile::map(m_file.data());
+    if (mapping &&
+        mapping->size() < levelOffset + channels.size() * planeBytes) {
+        throw ReadException("Corrupted LHC file: missing channel data");
+    }
+
+    for (size_t c = 0; c < channels.size(); ++c) {
+        const uint64_t offset = levelOffset + c * planeBytes;
+
+        if (mapping && m_header.sampleType == LHC_FLOAT32) {
+            channels[c]->setBuffer(
+                levelWidth, levelHeight,
+                Channel::DataBuffer(mapping, reinterpret_cast<float *>(
+                                                 mapping->data() + offset)));
+            continue;
+        }
+
+        channels[c]->resize(levelWidth, levelHeight);
+        if (mapping) {
+            utils::halfToFloat(reinterpret_cast<const utils::half_t *>(
+                                   mapping->data() + offset),
+                               channels[c]->data(), planeSize);
+            continue;
+        }
+
+        // not a regular file: plain buffered read
+        if (fseek(m_file.data(), offset, SEEK_SET) != 0) {
+            throw ReadException("Corrupted LHC file: missing channel data");
+        }
+        size_t read = 0;
+        if (m_header.sampleType == LHC_HALF) {
+            std::vector<utils::half_t> buffer(planeSize);
+            read = fread(buffer.data(), sizeof(utils::half_t), planeSize,
+                         m_file.data());
+            utils::halfToFloat(buffer.data(), channels[c]->data(), planeSize);
+        } else {
+            read = fread(channels[c]->data(), sizeof(float), planeSize,
+                         m_file.data());
+        }
+        if (read != planeSize) {
+            throw ReadException("Corrupted LHC file: missing channel data");
+        }
+    }
+
+    // no-op on the channels, they already have the right size
+    tempFrame.resize(levelWidth, levelHeight);
+    frame.swap(tempFrame);
+}
+
+}  // io
+}  // pfs
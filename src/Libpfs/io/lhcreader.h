@@ -0,0 +1,67 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Luminance HDR Cache (LHC) file format reader
+//! \author agent <agent@local>
+
+#ifndef PFS_IO_LHCREADER_H
+#define PFS_IO_LHCREADER_H
+
+#include <Libpfs/io/framereader.h>
+#include <Libpfs/io/ioexception.h>
+#include <Libpfs/io/lhccommon.h>
+#include <Libpfs/params.h>
+#include <Libpfs/utils/resourcehandlerstdio.h>
+#include <string>
+
+namespace pfs {
+class Frame;
+
+namespace io {
+
+//! \brief Reader for the LHC scratch format (see lhccommon.h)
+//! Single precision planes are used in place, straight from a private memory
+//! mapping of the file; half precision planes are converted on read.
+//! Accepted parameters:
+//! - "lhc.level" (int, default 0): level of the preview pyramid to read. The
+//! value is clamped to the available levels
+class LhcReader : public FrameReader {
+   public:
+    LhcReader(const std::string &filename);
+
+    bool isOpen() const { return m_file; }
+
+    void open();
+    void close();
+    void read(pfs::Frame &frame, const pfs::Params &params);
+
+    //! \brief number of levels stored in the file (at least 1)
+    size_t levels() const { return m_header.levels; }
+
+   private:
+    utils::ScopedStdIoFile m_file;
+    LhcHeader m_header;
+};
+
+}  // io
+}  // pfs
+
+#endif  // PFS_IO_LHCREADER_H
@@ -0,0 +1,164 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include <Libpfs/frame.h>
+#include <Libpfs/io/lhccommon.h>
+#include <Libpfs/io/lhcwriter.h>
+#include <Libpfs/manip/pyramid.h>
+#include <Libpfs/utils/half.h>
+#include <Libpfs/utils/resourcehandlerstdio.h>
+
+namespace pfs {
+namespace io {
+
+namespace {
+void writeLhcTags(const TagContainer &tags, std::ostream &out) {
+    out << tags.size() << "\n";
+    for (TagContainer::const_iterator it = tags.begin(); it != tags.end();
+         ++it) {
+        out << it->first << "=" << it->second << "\n";
+    }
+}
+
+std::string buildDirectory(const Frame &frame) {
+    std::ostringstream directory;
+    writeLhcTags(frame.getTags(), directory);
+
+    const ChannelContainer &channels = frame.getChannels();
+    for (ChannelContainer::const_iterator it = channels.begin();
+         it != channels.end(); ++it) {
+        directory << (*it)->getName() << "\n";
+        writeLhcTags((*it)->getTags(), directory);
+    }
+    return directory.str();
+}
+
+void writePadding(FILE *file, size_t size) {
+    static const char zeros[LHC_DATA_ALIGNMENT] = {0};
+    while (size > 0) {
+        size_t chunk = std::min<size_t>(size, sizeof(zeros));
+        if (fwrite(zeros, 1, chunk, file) != chunk) {
+            throw WriteException("LhcWriter: cannot write padding");
+        }
+        size -= chunk;
+    }
+}
+
+void writePlane(FILE *file, const Array2Df &plane, uint32_t sampleType) {
+    size_t written = 0;
+    if (sampleType == LHC_HALF) {
+        // convert in chunks, keeping each write large
+        const size_t chunkSize = 1 << 20;
+        std::vector<utils::half_t> buffer(std::min(chunkSize, plane.size()));
+        for (size_t offset = 0; offset < plane.size(); offset += chunkSize) {
+            size_t count = std::min(chunkSize, plane.size() - offset);
+            utils::floatToHalf(plane.data() + offset, buffer.data(), count);
+            written += fwrite(buffer.data(), sizeof(utils::half_t), count,
+                              file) * sizeof(utils::half_t);
+        }
+    } else {
+        written =
+            fwrite(plane.data(), sizeof(float), plane.size(), file) *
+            sizeof(float);
+    }
+    if (written != plane.size() * lhcSampleSize(sampleType)) {
+        throw WriteException("LhcWriter: cannot write channel data");
+    }
+    writePadding(file, lhcPlaneBytes(plane.getCols(), plane.getRows(),
+                                     sampleType) -
+                           written);
+}
+}
+
+LhcWriter::LhcWriter(const std::string &filename) : FrameWriter(filename) {}
+
+bool LhcWriter::write(const Frame &frame, const Params &params) {
+    bool useHalf = false;
+    params.get("lhc.half", useHalf);
+    int previewLevels = 0;
+    params.get("lhc.preview_levels", previewLevels);
+    previewLevels = std::max(0, std::min(previewLevels, LHC_MAX_LEVELS - 1));
+
+    utils::ScopedStdIoFile outputStream(fopen(filename().c_str(), "wb"));
+    if (!outputStream) {
+        throw InvalidFile("LhcWriter: cannot open " + filename());
+    }
+
+    const std::string directory = buildDirectory(frame);
+    const ChannelContainer &channels = frame.getChannels();
+
+    LhcHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LHC_MAGIC, sizeof(header.magic));
+    header.version = LHC_VERSION;
+    header.width = frame.getWidth();
+    header.height = frame.getHeight();
+    header.channels = channels.size();
+    header.sampleType = useHalf ? LHC_HALF : LHC_FLOAT32;
+    header.levels = 1 + previewLevels;
+    header.directorySize = directory.size();
+    header.dataOffset =
+        lhcAlign(sizeof(header) + directory.size(), LHC_DATA_ALIGNMENT);
+
+    if (fwrite(&header, sizeof(header), 1, outputStream.data()) != 1) {
+        throw WriteException("LhcWriter: cannot write header");
+    }
+    if (fwrite(directory.data(), 1, directory.size(), outputStream.data()) !=
+        directory.size()) {
+        throw WriteException("LhcWriter: cannot write directory");
+    }
+    writePadding(outputStream.data(), header.dataOffset - sizeof(header) -
+                                          directory.size());
+
+    for (ChannelContainer::const_iterator it = channels.begin();
+         it != channels.end(); ++it) {
+        writePlane(outputStream.data(), **it, header.sampleType);
+    }
+
+    if (previewLevels > 0) {
+        std::vector<Array2Df> current(channels.size());
+        for (int level = 1; level <= previewLevels; ++level) {
+            for (size_t c = 0; c < current.size(); ++c) {
+                const Array2Df &previous =
+                    (level == 1) ? *channels[c] : current[c];
+                Array2Df next(lhcLevelSize(header.width, level),
+                              lhcLevelSize(header.height, level));
+                downsample(previous, next);
+                writePlane(outputStream.data(), next, header.sampleType);
+                current[c].swap(next);
+            }
+        }
+    }
+
+    // the buffered data is only written now
+    if (fflush(outputStream.data()) != 0) {
+        throw WriteException("LhcWriter: cannot write " + filename());
+    }
+    return true;
+}
+
+}  // io
+}  // pfs
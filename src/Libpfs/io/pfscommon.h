@@ -33,4 +33,10 @@
 #define MAX_TAG_STRING 1024
 #define MAX_CHANNEL_COUNT 1024
 
+//! \brief the writer pads the header (using a dummy frame tag) so that the
+//! channel data starts at a multiple of PFS_DATA_ALIGNMENT bytes. This allows
+//! the reader to use the data in place, straight from a memory mapped file
+#define PFS_DATA_ALIGNMENT 16
+#define PFS_PADDING_TAG "PFS_PADDING"
+
 #endif  // PFS_IO_PFSCOMMON_H
@@ -22,6 +22,7 @@
 #include <Libpfs/frame.h>
 #include <Libpfs/io/pfscommon.h>
 #include <Libpfs/io/pfsreader.h>
+#include <Libpfs/utils/mappedfile.h>
 
 #include <list>
 
@@ -101,6 +102,9 @@ void PfsReader::open() {
             "Corrupted PFS file: missing or wrong 'channelCount' tag");
     }
     m_channelCount = channelCount;
+
+    setChannels(channelCount);
+    setBitDepth(32);
 }
 
 void PfsReader::close() {
@@ -110,12 +114,44 @@ void PfsReader::close() {
     m_channelCount = 0;
 }
 
-void PfsReader::read(Frame &frame, const Params & /*params*/) {
+namespace {
+//! \brief attach the channels to the memory mapped file, avoiding any copy.
+//! \return false if the data section cannot be mapped
+bool mapChannels(FILE *file, size_t width, size_t height,
+                 const std::list<Channel *> &channels) {
+    long offset = ftell(file);
+    // pipes do not have a position, and misaligned floats cannot be used
+    if (offset < 0 || offset % sizeof(float) != 0) {
+        return false;
+    }
+
+    utils::MappedFilePtr mapping = utils::MappedFile::map(file);
+    if (!mapping ||
+        mapping->size() < offset + channels.size() * width * height *
+                                       sizeof(float)) {
+        return false;
+    }
+
+    float *data = reinterpret_cast<float *>(mapping->data() + offset);
+    for (std::list<Channel *>::const_iterator it = channels.begin();
+         it != channels.end(); ++it) {
+        // each channel shares the ownership of the whole mapping
+        (*it)->setBuffer(width, height, Channel::DataBuffer(mapping, data));
+        data += width * height;
+    }
+    return true;
+}
+}
+
+void PfsReader::read(Frame &frame, const Params &params) {
     if (!isOpen()) open();
 
-    Frame tempFrame(width(), height());
+    // channels are created empty: they are either attached to the memory
+    // mapped file or allocated when the frame gets its final size
+    Frame tempFrame;
 
     readTags(tempFrame.getTags(), m_file.data());
+    tempFrame.getTags().removeTag(PFS_PADDING_TAG);
 
     // read channel IDs and tags
     std::list<Channel *> orderedChannel;
@@ -145,15 +181,26 @@ void PfsReader::read(Frame &frame, const Params & /*params*/) {
             "Corrupted PFS file: missing end of header (ENDH) token");
     }
 
-    // Read channels
-    std::list<Channel *>::iterator it;
-    for (it = orderedChannel.begin(); it != orderedChannel.end(); ++it) {
-        Channel *ch = *it;
-        unsigned int size = tempFrame.getWidth() * tempFrame.getHeight();
-        read = fread(ch->data(), sizeof(float), size, m_file.data());
-        if (read != size) {
-            throw ReadException("Corrupted PFS file: missing channel data");
+    bool useMmap = true;
+    params.get("pfs.mmap", useMmap);
+
+    if (!useMmap ||
+        !mapChannels(m_file.data(), width(), height(), orderedChannel)) {
+        tempFrame.resize(width(), height());
+
+        // Read channels
+        std::list<Channel *>::iterator it;
+        for (it = orderedChannel.begin(); it != orderedChannel.end(); ++it) {
+            Channel *ch = *it;
+            unsigned int size = width() * height();
+            read = fread(ch->data(), sizeof(float), size, m_file.data());
+            if (read != size) {
+                throw ReadException("Corrupted PFS file: missing channel data");
+            }
         }
+    } else {
+        // no-op on the channels, they already have the right size
+        tempFrame.resize(width(), height());
     }
 #ifdef HAVE_SETMODE
     setmode(fileno(inputStream), old_mode);
@@ -37,6 +37,13 @@ class Frame;
 
 namespace io {
 
+//! \brief Reader for PFS files.
+//! When reading from a regular file, the channels are backed directly by a
+//! private (copy-on-write) memory mapping of the file, so opening a frame is
+//! almost free and pages are read on demand. Pipes, or files whose channel
+//! data is not aligned, are read through buffered I/O.
+//! Accepted parameters:
+//! - "pfs.mmap" (bool, default true): allow the memory mapped access
 class PfsReader : public FrameReader {
    public:
     PfsReader(const std::string &filename);
@@ -21,6 +21,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <sstream>
 
 #include <Libpfs/frame.h>
 #include <Libpfs/io/pfscommon.h>
@@ -33,15 +34,36 @@ namespace io {
 
 static const char *PFSFILEID = "PFS1\x0a";
 
-void writeTags(const TagContainer &tags, FILE *out) {
-    fprintf(out, "%d" PFSEOL, (int)tags.size());
+void writeTags(const TagContainer &tags, std::ostream &out) {
+    out << tags.size() << PFSEOL;
     for (TagContainer::const_iterator it = tags.begin(); it != tags.end();
          ++it) {
-        fprintf(out, "%s", std::string(it->first + "=" + it->second).c_str());
-        fprintf(out, PFSEOL);
+        out << it->first << "=" << it->second << PFSEOL;
     }
 }
 
+std::string buildHeader(const Frame &frame, const TagContainer &frameTags) {
+    const ChannelContainer &channels = frame.getChannels();
+
+    std::ostringstream header;
+    header << PFSFILEID;
+    header << frame.getWidth() << " " << frame.getHeight() << PFSEOL;
+    header << channels.size() << PFSEOL;
+
+    writeTags(frameTags, header);
+
+    // Write channel IDs and tags
+    for (ChannelContainer::const_iterator it = channels.begin();
+         it != channels.end(); ++it) {
+        header << (*it)->getName() << PFSEOL;
+        writeTags((*it)->getTags(), header);
+    }
+
+    header << "ENDH";
+
+    return header.str();
+}
+
 PfsWriter::PfsWriter(const std::string &filename) : FrameWriter(filename) {}
 
 bool PfsWriter::write(const Frame &frame, const Params & /*params*/) {
@@ -55,25 +77,20 @@ bool PfsWriter::write(const Frame &frame, const Params & /*params*/) {
     int old_mode = setmode(fileno(outputStream.data()), _O_BINARY);
 #endif
 
-    // Write header ID
-    fwrite(PFSFILEID, 1, 5, outputStream.data());
-
     const ChannelContainer &channels = frame.getChannels();
 
-    fprintf(outputStream.data(), "%d %d" PFSEOL, (int)frame.getWidth(),
-            (int)frame.getHeight());
-    fprintf(outputStream.data(), "%d" PFSEOL, (int)channels.size());
+    // pad the header with a dummy tag until the channel data is aligned
+    TagContainer frameTags(frame.getTags());
+    frameTags.removeTag(PFS_PADDING_TAG);
 
-    writeTags(frame.getTags(), outputStream.data());
-
-    // Write channel IDs and tags
-    for (ChannelContainer::const_iterator it = channels.begin();
-         it != channels.end(); ++it) {
-        fprintf(outputStream.data(), "%s" PFSEOL, (*it)->getName().c_str());
-        writeTags((*it)->getTags(), outputStream.data());
+    std::string header = buildHeader(frame, frameTags);
+    for (size_t padding = 0; header.size() % PFS_DATA_ALIGNMENT != 0;
+         ++padding) {
+        frameTags.setTag(PFS_PADDING_TAG, std::string(padding, ' '));
+        header = buildHeader(frame, frameTags);
     }
 
-    fprintf(outputStream.data(), "ENDH");
+    fwrite(header.data(), 1, header.size(), outputStream.data());
 
     // Write channels
     for (ChannelContainer::const_iterator it = channels.begin();
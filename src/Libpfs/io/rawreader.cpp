@@ -32,6 +32,7 @@
 #include <Libpfs/fixedstrideiterator.h>
 #include <Libpfs/frame.h>
 #include <Libpfs/io/rawreader.h>
+#include <Libpfs/io/rawscale.h>
 #include <Libpfs/utils/transform.h>
 
 using namespace pfs;
@@ -131,7 +132,8 @@ struct RAWReaderParams {
           chroma1_(1.0),
           chroma2_(1.0),
           chroma3_(1.0),
-          cameraProfile_() {}
+          cameraProfile_(),
+          scaleDenom_(1) {}
 
     void parse(const Params &params) {
         int tempInt;
@@ -212,6 +214,11 @@ struct RAWReaderParams {
                 cameraProfile_.swap(tempString);
             }
         }
+
+        // reduced resolution decoding
+        if (params.get("scale_denom", tempInt)) {
+            scaleDenom_ = getScaleDenominator(tempInt);
+        }
     }
 
     bool isBlackLevel() const {
@@ -260,6 +267,8 @@ struct RAWReaderParams {
     double chroma3_;
 
     std::string cameraProfile_;
+
+    unsigned int scaleDenom_;
 };
 
 ostream &operator<<(ostream &out, const RAWReaderParams &p) {
@@ -299,6 +308,7 @@ ostream &operator<<(ostream &out, const RAWReaderParams &p) {
         ss << ", Chroma {" << p.chroma0_ << ", " << p.chroma1_;
         ss << ", " << p.chroma2_ << ", " << p.chroma3_ << "}";
     }
+    ss << ", Scale: 1/" << p.scaleDenom_;
     ss << "]";
 
     return (out << ss.str());
@@ -321,6 +331,9 @@ static void setParams(LibRaw &processor, const RAWReaderParams &params) {
     outParams.user_qual = params.userQuality_;
     outParams.med_passes = params.medPasses_;
     outParams.user_flip = 0;  // exif orientation is done afterwards
+    // half size output skips the demosaicing altogether (each 2x2 Bayer
+    // block becomes one pixel): further reductions are done afterwards
+    outParams.half_size = RawScale(params.scaleDenom_).halfSize;
 
     switch (params.wbMethod_) {
         case 1:  // camera
@@ -415,6 +428,14 @@ void RAWReader::open() {
     }
     setWidth(S.width);
     setHeight(S.height);
+    setChannels(P1.colors);
+
+    // bits actually used by the sensor, from its white level
+    size_t bitDepth = 0;
+    for (unsigned int maximum = C.maximum; maximum; maximum >>= 1) {
+        ++bitDepth;
+    }
+    setBitDepth(bitDepth);
 }
 
 bool RAWReader::isOpen() const { return true; }
@@ -464,12 +485,20 @@ void RAWReader::read(Frame &frame, const Params &params) {
 
     assert(image->data_size == W * H * 3 * sizeof(uint16_t));
 
+    const uint16_t *raw_data = reinterpret_cast<const uint16_t *>(image->data);
+
+    std::vector<uint16_t> decimated;
+    const RawScale scale(p.scaleDenom_);
+    if (scale.decimation > 1) {
+        decimateRGB(raw_data, W, H, scale.decimation, decimated, W, H);
+        raw_data = decimated.data();
+    }
+
     pfs::Frame tempFrame(W, H);
 
     pfs::Channel *Xc, *Yc, *Zc;
     tempFrame.createXYZChannels(Xc, Yc, Zc);
 
-    const uint16_t *raw_data = reinterpret_cast<const uint16_t *>(image->data);
     utils::transform(
         FixedStrideIterator<const uint16_t *, 3>(raw_data),
         FixedStrideIterator<const uint16_t *, 3>(raw_data + H * W * 3),
@@ -478,8 +507,7 @@ void RAWReader::read(Frame &frame, const Params &params) {
         Yc->begin(), Zc->begin(),
         colorspace::Gamma<pfs::colorspace::Gamma1_8>());
 
-    PRINT_DEBUG("Data size: " << image->data_size << " "
-                              << W * H * 3 * sizeof(uint16_t));
+    PRINT_DEBUG("Data size: " << image->data_size);
     PRINT_DEBUG("W: " << W << " H: " << H);
 
     LibRaw::dcraw_clear_mem(image);
@@ -0,0 +1,72 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \author agent <agent@local>
+
+#include <Libpfs/io/rawscale.h>
+
+#include <algorithm>
+
+#include <Libpfs/io/framereader.h>
+#include <Libpfs/utils/parallel.h>
+
+namespace pfs {
+namespace io {
+
+RawScale::RawScale(int scaleDenom) {
+    const int denom = getScaleDenominator(scaleDenom);
+    halfSize = (denom >= 2);
+    decimation = halfSize ? denom / 2 : 1;
+}
+
+void decimateRGB(const uint16_t *data, int width, int height, int factor,
+                 std::vector<uint16_t> &out, int &outWidth, int &outHeight) {
+    outWidth = std::max(1, width / factor);
+    outHeight = std::max(1, height / factor);
+    out.resize(static_cast<size_t>(outWidth) * outHeight * 3);
+
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
+    for (int y = 0; y < outHeight; ++y) {
+        const int yEnd = std::min(height, (y + 1) * factor);
+        for (int x = 0; x < outWidth; ++x) {
+            const int xEnd = std::min(width, (x + 1) * factor);
+
+            uint32_t sum[3] = {0, 0, 0};
+            uint32_t count = 0;
+            for (int j = y * factor; j < yEnd; ++j) {
+                const uint16_t *in = data + (j * width + x * factor) * 3;
+                for (int i = x * factor; i < xEnd; ++i, in += 3) {
+                    sum[0] += in[0];
+                    sum[1] += in[1];
+                    sum[2] += in[2];
+                    ++count;
+                }
+            }
+
+            uint16_t *o = &out[(y * outWidth + x) * 3];
+            o[0] = static_cast<uint16_t>(sum[0] / count);
+            o[1] = static_cast<uint16_t>(sum[1] / count);
+            o[2] = static_cast<uint16_t>(sum[2] / count);
+        }
+    }
+}
+}
+}
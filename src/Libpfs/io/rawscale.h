@@ -0,0 +1,55 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Reduced resolution decoding of RAW files
+//! \author agent <agent@local>
+
+#ifndef PFS_IO_RAWSCALE_H
+#define PFS_IO_RAWSCALE_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace pfs {
+namespace io {
+
+//! \brief how the RAW reader reaches 1/scaleDenom of the sensor size (see
+//! \c getScaleDenominator()): LibRaw half size output, one pixel for each
+//! 2x2 Bayer block without demosaicing, then a box decimation by the
+//! remaining factor
+struct RawScale {
+    explicit RawScale(int scaleDenom);
+
+    //! \brief value of LibRaw \c half_size
+    bool halfSize;
+    //! \brief factor of \c decimateRGB() on the output of LibRaw (1: none)
+    int decimation;
+};
+
+//! \brief average blocks of \a factor x \a factor pixels of the interleaved
+//! RGB image \a data: the last rows and columns are dropped if \a factor does
+//! not divide the size
+void decimateRGB(const uint16_t *data, int width, int height, int factor,
+                 std::vector<uint16_t> &out, int &outWidth, int &outHeight);
+}
+}
+
+#endif  // PFS_IO_RAWSCALE_H
@@ -248,6 +248,9 @@ void RGBEReader::open() {
 
     setWidth(width);
     setHeight(height);
+    // 8 bits mantissa, with a shared exponent
+    setChannels(3);
+    setBitDepth(8);
     m_exposure = exposure;
 }
 
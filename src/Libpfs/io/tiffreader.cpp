@@ -476,6 +476,8 @@ void TiffReader::open() {
         throw pfs::io::InvalidHeader(
             "TiffReader: unspecified samples per pixel");
     }
+    setChannels(m_data->samplesPerPixel_);
+    setBitDepth(m_data->bitsPerSample_);
 
     // parse photometric type
     switch (m_data->photometricType_) {
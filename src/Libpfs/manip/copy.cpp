@@ -25,7 +25,7 @@
 #include "copy.h"
 
 #include "Libpfs/frame.h"
-#include "Libpfs/utils/msec_timer.h"
+#include "Libpfs/utils/trace.h"
 
 #include <algorithm>
 
@@ -33,10 +33,7 @@ namespace pfs {
 using namespace utils;
 
 pfs::Frame *copy(const pfs::Frame *inFrame) {
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
+    PFS_TRACE_SPAN("pfscopy", "manip");
 
     const int outWidth = inFrame->getWidth();
     const int outHeight = inFrame->getHeight();
@@ -47,19 +44,17 @@ pfs::Frame *copy(const pfs::Frame *inFrame) {
 
     for (ChannelContainer::const_iterator it = channels.begin();
          it != channels.end(); ++it) {
-        const pfs::Channel *inCh = *it;
-
-        pfs::Channel *outCh = outFrame->createChannel(inCh->getName());
-
-        copy(inCh, outCh);
+        outFrame->createChannel((*it)->getName());
     }
 
+    // tags first: copyTags() retrieves the channels for writing
     pfs::copyTags(inFrame, outFrame);
 
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    std::cout << "pfscopy() = " << f_timer.get_time() << " msec" << std::endl;
-#endif
+    const ChannelContainer &outChannels =
+        static_cast<const pfs::Frame *>(outFrame)->getChannels();
+    for (size_t idx = 0; idx < channels.size(); ++idx) {
+        outChannels[idx]->share(*channels[idx]);
+    }
 
     return outFrame;
 }
@@ -26,10 +26,14 @@
 #define PFS_COPY_H
 
 #include "Libpfs/array2d_fwd.h"
+#include "Libpfs/array2dview.h"
 
 namespace pfs {
 class Frame;
 
+//! \brief Copy of \a inFrame, sharing the data of its channels: they are
+//! copied only when either of the two frames retrieves them for writing
+//! (copy-on-write, see \c Frame)
 pfs::Frame *copy(const pfs::Frame *inFrame);
 
 //! \brief Copy data from one Array2D to another.
@@ -40,6 +44,10 @@ pfs::Frame *copy(const pfs::Frame *inFrame);
 template <typename Type>
 void copy(const Array2D<Type> *from, Array2D<Type> *to);
 
+//! \brief Materialize a view: \a to is resized to the size of \a from
+template <typename InType, typename Type>
+void copy(const Array2DView<InType> &from, Array2D<Type> *to);
+
 }  // pfs
 
 #include "copy.hxx"
@@ -30,6 +30,8 @@
 #include <algorithm>
 #include <cassert>
 
+#include <Libpfs/utils/parallel.h>
+
 namespace pfs {
 
 template <typename Type>
@@ -39,6 +41,22 @@ void copy(const Array2D<Type> *from, Array2D<Type> *to) {
 
     std::copy(from->begin(), from->end(), to->begin());
 }
+
+template <typename InType, typename Type>
+void copy(const Array2DView<InType> &from, Array2D<Type> *to) {
+    to->resize(from.getCols(), from.getRows());
+
+    if (from.isContiguous()) {
+        std::copy(from.data(), from.data() + from.size(), to->begin());
+        return;
+    }
+
+    const int rows = static_cast<int>(from.getRows());
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
+    for (int r = 0; r < rows; r++) {
+        std::copy(from.row_begin(r), from.row_end(r), to->row_begin(r));
+    }
+}
 }
 
 #endif  // #ifndef PFS_COPY_HXX
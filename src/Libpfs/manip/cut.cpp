@@ -36,48 +36,30 @@
 #include <iostream>
 
 #include "Libpfs/frame.h"
-#include "Libpfs/utils/msec_timer.h"
+#include "Libpfs/utils/trace.h"
 
 namespace pfs {
 
 pfs::Frame *cut(const pfs::Frame *inFrame, size_t x_ul, size_t y_ul,
                 size_t x_br, size_t y_br) {
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
+    PFS_TRACE_SPAN("pfscut", "manip");
 
-    // ----  Boundary Check!
-    // if (x_ul < 0) x_ul = 0;
-    // if (y_ul < 0) y_ul = 0;
-    if (x_br > inFrame->getWidth()) x_br = inFrame->getWidth();
-    if (y_br > inFrame->getHeight()) y_br = inFrame->getHeight();
-    // -----
-
-    pfs::Frame *outFrame = new pfs::Frame((x_br - x_ul), (y_br - y_ul));
-
-    const ChannelContainer &channels = inFrame->getChannels();
-
-    for (ChannelContainer::const_iterator it = channels.begin();
-         it != channels.end(); ++it) {
-        const pfs::Channel *inCh = *it;
-
-        pfs::Channel *outCh = outFrame->createChannel(inCh->getName());
+    pfs::Frame *outFrame =
+        cut(FrameView(*inFrame), x_ul, y_ul, x_br, y_br).materialize();
 
-        cut(inCh, outCh, x_ul, y_ul, x_br, y_br);
-    }
-
-    pfs::copyTags(inFrame, outFrame);
+    return outFrame;
+}
 
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    std::cout << "pfscut(";
-    std::cout << "[" << x_ul << ", " << y_ul << "],";
-    std::cout << "[" << x_br << ", " << y_br << "]";
-    std::cout << ") = " << f_timer.get_time() << " msec" << std::endl;
-#endif
+FrameView cut(const FrameView &in, size_t x_ul, size_t y_ul, size_t x_br,
+              size_t y_br) {
+    // ----  Boundary Check!
+    if (x_br > in.getWidth()) x_br = in.getWidth();
+    if (y_br > in.getHeight()) y_br = in.getHeight();
+    if (x_ul > x_br) x_ul = x_br;
+    if (y_ul > y_br) y_ul = y_br;
+    // -----
 
-    return outFrame;
+    return in.sub(x_ul, y_ul, x_br - x_ul, y_br - y_ul);
 }
 
 }  // pfs
@@ -25,6 +25,7 @@
 #define PFS_CUT_H
 
 #include <Libpfs/array2d_fwd.h>
+#include <Libpfs/frameview.h>
 #include <cstddef>
 
 //! \brief Cut a rectangle out of images in PFS stream
@@ -37,6 +38,11 @@ class Frame;
 Frame *cut(const Frame *inFrame, size_t x_ul, size_t y_ul, size_t x_br,
            size_t y_br);
 
+//! \brief zero copy cut: view over the rectangle [x_ul, x_br) x [y_ul, y_br)
+//! of \a in (clamped to its borders)
+FrameView cut(const FrameView &in, size_t x_ul, size_t y_ul, size_t x_br,
+              size_t y_br);
+
 template <typename Type>
 void cut(const Array2D<Type> *from, Array2D<Type> *to, size_t x_ul, size_t y_ul,
          size_t x_br, size_t y_br);
@@ -26,6 +26,7 @@
 //! \author Davide Anastasia <davideanastasia@users.sourceforge.net>
 
 #include "cut.h"
+#include "copy.h"
 
 #include <algorithm>
 #include <cassert>
@@ -49,14 +50,7 @@ void cut(const Array2D<Type> *from, Array2D<Type> *to, size_t x_ul, size_t y_ul,
     if (x_br > from->getCols()) x_br = from->getCols();
     if (y_br > from->getRows()) y_br = from->getRows();
 
-    // update right border
-    x_br = from->getCols() - x_br;
-    int rEnd = (int)to->getRows();
-#pragma omp parallel for shared(rEnd)
-    for (int r = 0; r < rEnd; r++) {
-        std::copy(from->row_begin(r + y_ul) + x_ul,
-                  from->row_end(r + y_ul) - x_br, to->row_begin(r));
-    }
+    copy(makeView(*from).sub(x_ul, y_ul, x_br - x_ul, y_br - y_ul), to);
 }
 
 }  // pfs
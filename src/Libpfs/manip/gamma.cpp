@@ -32,8 +32,9 @@
 
 #include "Libpfs/array2d.h"
 #include "Libpfs/colorspace/colorspace.h"
+#include "Libpfs/colorspace/kernels.h"
 #include "Libpfs/frame.h"
-#include "Libpfs/utils/msec_timer.h"
+#include "Libpfs/utils/trace.h"
 
 namespace pfs {
 
@@ -52,27 +53,9 @@ void applyGamma(pfs::Frame *frame, float gamma) {
 
 void applyGamma(pfs::Array2Df *array, const float exponent,
                 const float multiplier) {
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
+    PFS_TRACE_SPAN("applyGamma", "manip");
 
-    float *Vin = array->data();
-
-    int V_ELEMS = array->getRows() * array->getCols();
-#pragma omp parallel for
-    for (int idx = 0; idx < V_ELEMS; idx++) {
-        if (Vin[idx] > 0.0f) {
-            Vin[idx] = powf(Vin[idx] * multiplier, exponent);
-        } else {
-            Vin[idx] = 0.0f;
-        }
-    }
-
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    std::cout << "applyGamma() = " << f_timer.get_time() << " msec"
-              << std::endl;
-#endif
+    colorspace::kernels::gamma(array->data(), array->data(), exponent,
+                               multiplier, array->size());
 }
 }
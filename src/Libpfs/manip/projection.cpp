@@ -26,12 +26,15 @@
 
 #include <boost/math/constants/constants.hpp>
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <cstring>
 // #include <stdio.h>
 // #include <stdlib.h>
 
 #include "Libpfs/array2d.h"
+#include "Libpfs/utils/parallel.h"
 #include "arch/math.h"
 
 using namespace std;
@@ -45,86 +48,64 @@ MirrorBallProjection MirrorBallProjection::singleton(true);
 
 const double EPSILON = 1e-7;
 
-class Vector3D {
-   public:
-    double x, y, z;
-
-    Vector3D(double phi, double theta) {
-        x = cos(phi) * sin(theta);
-        y = sin(phi) * sin(theta);
-        z = cos(theta);
-    }
+Vector3D::Vector3D(double phi, double theta)
+    : x(cos(phi) * sin(theta)), y(sin(phi) * sin(theta)), z(cos(theta)) {}
 
-    Vector3D(double x, double y, double z) {
-        this->x = x;
-        this->y = y;
-        this->z = z;
-
-        normalize();
-    }
-
-    double magnitude(void) { return sqrt(x * x + y * y + z * z); }
-
-    void normalize(void) {
-        double len = magnitude();
-
-        x = x / len;
-        y = y / len;
-        z = z / len;
-    }
-
-    double dot(Vector3D *v) { return x * v->x + y * v->y + z * v->z; }
-
-    // TODO: optimize rotations by precomputing sines and cosines
-    void rotateX(double angle) {
-        angle *= boost::math::double_constants::degree;
-
-        double c = cos(angle);
-        double s = sin(angle);
-
-        double y2 = c * y + -s * z;
-        double z2 = s * y + c * z;
-
-        y = y2;
-        z = z2;
-    }
+Vector3D::Vector3D(double x, double y, double z) : x(x), y(y), z(z) {
+    normalize();
+}
 
-    void rotateY(double angle) {
-        angle *= boost::math::double_constants::degree;
+double Vector3D::magnitude() const { return sqrt(x * x + y * y + z * z); }
 
-        double c = cos(angle);
-        double s = sin(angle);
+void Vector3D::normalize() {
+    double len = magnitude();
 
-        double x2 = c * x + s * z;
-        double z2 = -s * x + c * z;
+    x = x / len;
+    y = y / len;
+    z = z / len;
+}
 
-        x = x2;
-        z = z2;
+namespace {
+//! \brief rotation around the X, Y and Z axis (in this order), with sines
+//! and cosines computed once
+class Rotation {
+   public:
+    Rotation(double xAngle, double yAngle, double zAngle) {
+        const double deg = boost::math::double_constants::degree;
+        const double cx = cos(xAngle * deg), sx = sin(xAngle * deg);
+        const double cy = cos(yAngle * deg), sy = sin(yAngle * deg);
+        const double cz = cos(zAngle * deg), sz = sin(zAngle * deg);
+
+        // Rz * Ry * Rx
+        m[0][0] = cz * cy;
+        m[0][1] = cz * sy * sx - sz * cx;
+        m[0][2] = cz * sy * cx + sz * sx;
+        m[1][0] = sz * cy;
+        m[1][1] = sz * sy * sx + cz * cx;
+        m[1][2] = sz * sy * cx - cz * sx;
+        m[2][0] = -sy;
+        m[2][1] = cy * sx;
+        m[2][2] = cy * cx;
+
+        identity = (xAngle == 0 && yAngle == 0 && zAngle == 0);
     }
 
-    void rotateZ(double angle) {
-        angle *= boost::math::double_constants::degree;
-
-        double c = cos(angle);
-        double s = sin(angle);
-
-        double x2 = c * x + -s * y;
-        double y2 = s * x + c * y;
+    void apply(Vector3D &v) const {
+        if (identity) return;
 
-        x = x2;
-        y = y2;
+        const double x = m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z;
+        const double y = m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z;
+        const double z = m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z;
+        v.x = x;
+        v.y = y;
+        v.z = z;
     }
-};
 
-class Point2D {
-   public:
-    double x, y;
-
-    Point2D(double x, double y) {
-        this->x = x;
-        this->y = y;
-    }
+   private:
+    double m[3][3];
+    bool identity;
 };
+}
 
 /// PROJECTIONFACTORY
 ProjectionFactory::ProjectionFactory(bool) {}
@@ -183,7 +164,7 @@ const char *MirrorBallProjection::getName(void) { return name; }
 
 double MirrorBallProjection::getSizeRatio(void) { return 1; }
 
-bool MirrorBallProjection::isValidPixel(double u, double v) {
+bool MirrorBallProjection::isValidPixel(double u, double v) const {
     // check if we are not in a boundary region (outside a circle)
     if ((u - 0.5) * (u - 0.5) + (v - 0.5) * (v - 0.5) > 0.25)
         return false;
@@ -191,39 +172,43 @@ bool MirrorBallProjection::isValidPixel(double u, double v) {
         return true;
 }
 
-Vector3D *MirrorBallProjection::uvToDirection(double u, double v) {
+Vector3D MirrorBallProjection::uvToDirection(double u, double v) const {
     u = 2 * u - 1;
     v = 2 * v - 1;
 
-    double phi = atan2(v, u);
-    double theta = 2 * asin(sqrt(u * u + v * v));
+    // phi = atan2(v, u), theta = 2 * asin(r): sines and cosines are
+    // computed algebraically. Oversampled border pixels can fall slightly
+    // outside of the ball
+    double r2 = std::min(1., u * u + v * v);
+    double sinThetaOverR = 2 * sqrt(1 - r2);
 
-    Vector3D *direction = new Vector3D(phi, theta);
-    //     double t;
-
-    direction->y = -direction->y;
+    Vector3D direction;
+    direction.x = u * sinThetaOverR;
+    direction.y = -v * sinThetaOverR;
+    direction.z = 1 - 2 * r2;
 
     return direction;
 }
 
-Point2D *MirrorBallProjection::directionToUV(Vector3D *direction) {
+Point2D MirrorBallProjection::directionToUV(Vector3D direction) const {
     double u, v;
 
-    direction->y = -direction->y;
+    direction.y = -direction.y;
 
-    if (fabs(direction->x) > 0 || fabs(direction->y) > 0) {
+    if (fabs(direction.x) > 0 || fabs(direction.y) > 0) {
         double distance =
-            sqrt(direction->x * direction->x + direction->y * direction->y);
+            sqrt(direction.x * direction.x + direction.y * direction.y);
 
-        double r = 0.5 * (sin(acos(direction->z) / 2)) / distance;
+        // sin(acos(z) / 2)
+        double r = 0.5 * sqrt(std::max(0., (1 - direction.z) / 2)) / distance;
 
-        u = direction->x * r + 0.5;
-        v = direction->y * r + 0.5;
+        u = direction.x * r + 0.5;
+        v = direction.y * r + 0.5;
     } else {
         u = v = 0.5;
     }
 
-    return new Point2D(u, v);
+    return Point2D(u, v);
 }
 /// END MIRRORBALL
 
@@ -271,7 +256,7 @@ const char *AngularProjection::getName(void) { return name; }
 
 double AngularProjection::getSizeRatio(void) { return 1; }
 
-bool AngularProjection::isValidPixel(double u, double v) {
+bool AngularProjection::isValidPixel(double u, double v) const {
     // check if we are not in a boundary region (outside a circle)
     if ((u - 0.5) * (u - 0.5) + (v - 0.5) * (v - 0.5) > 0.25)
         return false;
@@ -279,7 +264,7 @@ bool AngularProjection::isValidPixel(double u, double v) {
         return true;
 }
 
-Vector3D *AngularProjection::uvToDirection(double u, double v) {
+Vector3D AngularProjection::uvToDirection(double u, double v) const {
     u = 2 * u - 1;
     v = 2 * v - 1;
 
@@ -289,91 +274,82 @@ Vector3D *AngularProjection::uvToDirection(double u, double v) {
     double phi = atan2(v, u);
     double theta = boost::math::double_constants::pi * sqrt(u * u + v * v);
 
-    Vector3D *direction = new Vector3D(phi, theta);
-    //     double t;
+    Vector3D direction(phi, theta);
 
-    direction->y = -direction->y;
+    direction.y = -direction.y;
 
     return direction;
 }
 
-Point2D *AngularProjection::directionToUV(Vector3D *direction) {
+Point2D AngularProjection::directionToUV(Vector3D direction) const {
     double u, v;
 
-    direction->y = -direction->y;
+    direction.y = -direction.y;
 
-    if (fabs(direction->x) > 0 || fabs(direction->y) > 0) {
+    if (fabs(direction.x) > 0 || fabs(direction.y) > 0) {
         double distance =
-            sqrt(direction->x * direction->x + direction->y * direction->y);
+            sqrt(direction.x * direction.x + direction.y * direction.y);
 
         double r =
-            (boost::math::double_constants::one_div_two_pi)*acos(direction->z) /
+            (boost::math::double_constants::one_div_two_pi)*acos(direction.z) /
             distance;
 
-        u = direction->x * r + 0.5;
-        v = direction->y * r + 0.5;
+        u = direction.x * r + 0.5;
+        v = direction.y * r + 0.5;
     } else {
         u = v = 0.5;
     }
 
-    return new Point2D(u, v);
+    return Point2D(u, v);
 }
 /// END ANGULAR
 
 /// CYLINDRICAL
-CylindricalProjection::CylindricalProjection(bool initialization) {
+CylindricalProjection::CylindricalProjection(bool initialization)
+    : pole(0, 1, 0), equator(0, 0, -1), cross(1, 0, 0) {
     name = "cylindrical";
 
     if (initialization)
         ProjectionFactory::registerProjection(name, this->create);
-
-    pole = new Vector3D(0, 1, 0);
-    equator = new Vector3D(0, 0, -1);
-    cross = new Vector3D(1, 0, 0);
 }
 
 Projection *CylindricalProjection::create() {
     return new CylindricalProjection(false);
 }
 
-CylindricalProjection::~CylindricalProjection() {
-    delete pole;
-    delete equator;
-    delete cross;
-}
-
 double CylindricalProjection::getSizeRatio(void) { return 2; }
 
-bool CylindricalProjection::isValidPixel(double /*u*/, double /*v*/) {
+bool CylindricalProjection::isValidPixel(double /*u*/, double /*v*/) const {
     return true;
 }
 
-Vector3D *CylindricalProjection::uvToDirection(double u, double v) {
+Vector3D CylindricalProjection::uvToDirection(double u, double v) const {
     u = 0.75 - u;
 
     u *= boost::math::double_constants::two_pi;
 
     v = acos(1 - 2 * v);
 
-    Vector3D *direction = new Vector3D(u, v);
+    Vector3D direction(u, v);
 
-    double temp = direction->z;
-    direction->z = direction->y;
-    direction->y = temp;
+    double temp = direction.z;
+    direction.z = direction.y;
+    direction.y = temp;
 
     return direction;
 }
 
-Point2D *CylindricalProjection::directionToUV(Vector3D *direction) {
+Point2D CylindricalProjection::directionToUV(Vector3D direction) const {
     double u, v;
-    double lat = direction->dot(pole);
+    double lat = direction.dot(pole);
 
     v = (1 - lat) / 2;
 
     if (v < EPSILON || fabs(1 - v) < EPSILON)
         u = 0;
     else {
-        double ratio = equator->dot(direction) / sin(acos(lat));
+        double ratio =
+            equator.dot(direction) / sqrt(std::max(0., 1 - lat * lat));
 
         if (ratio < -1)
             ratio = -1;
@@ -382,7 +358,7 @@ Point2D *CylindricalProjection::directionToUV(Vector3D *direction) {
 
         double lon = acos(ratio) / (boost::math::double_constants::two_pi);
 
-        if (cross->dot(direction) < 0)
+        if (cross.dot(direction) < 0)
             u = lon;
         else
             u = 1 - lon;
@@ -396,59 +372,54 @@ Point2D *CylindricalProjection::directionToUV(Vector3D *direction) {
     //  direction->x, direction->y, direction->z);
     //  assert ( -0. <= u && u < 1 );
     //  assert ( -0. <= v && v < 1 );
-    return new Point2D(u, v);
+    return Point2D(u, v);
 }
 /// END CYLINDRICAL
 
 /// POLAR
-PolarProjection::PolarProjection(bool initialization) {
+PolarProjection::PolarProjection(bool initialization)
+    : pole(0, 1, 0), equator(0, 0, -1), cross(1, 0, 0) {
     name = "polar";
 
     if (initialization)
         ProjectionFactory::registerProjection(name, this->create);
-
-    pole = new Vector3D(0, 1, 0);
-    equator = new Vector3D(0, 0, -1);
-    cross = new Vector3D(1, 0, 0);
 }
 
 Projection *PolarProjection::create() { return new PolarProjection(false); }
 
-PolarProjection::~PolarProjection() {
-    delete pole;
-    delete equator;
-    delete cross;
-}
-
 double PolarProjection::getSizeRatio(void) { return 2; }
 
-bool PolarProjection::isValidPixel(double /*u*/, double /*v*/) { return true; }
+bool PolarProjection::isValidPixel(double /*u*/, double /*v*/) const {
+    return true;
+}
 
-Vector3D *PolarProjection::uvToDirection(double u, double v) {
+Vector3D PolarProjection::uvToDirection(double u, double v) const {
     u = 0.75 - u;
 
     u *= boost::math::double_constants::two_pi;
     v *= boost::math::double_constants::pi;
 
-    Vector3D *direction = new Vector3D(u, v);
+    Vector3D direction(u, v);
 
-    double temp = direction->z;
-    direction->z = direction->y;
-    direction->y = temp;
+    double temp = direction.z;
+    direction.z = direction.y;
+    direction.y = temp;
 
     return direction;
 }
 
-Point2D *PolarProjection::directionToUV(Vector3D *direction) {
+Point2D PolarProjection::directionToUV(Vector3D direction) const {
     double u, v;
-    double lat = acos(direction->dot(pole));
+    double cosLat = std::min(1., std::max(-1., direction.dot(pole)));
+    double lat = acos(cosLat);
 
     v = lat * (1 / boost::math::double_constants::pi);
 
     if (v < EPSILON || fabs(1 - v) < EPSILON)
         u = 0;
     else {
-        double ratio = equator->dot(direction) / sin(lat);
+        double ratio =
+            equator.dot(direction) / sqrt(1 - cosLat * cosLat);  // sin(lat)
 
         if (ratio < -1)
             ratio = -1;
@@ -457,7 +428,7 @@ Point2D *PolarProjection::directionToUV(Vector3D *direction) {
 
         double lon = acos(ratio) / (boost::math::double_constants::two_pi);
 
-        if (cross->dot(direction) < 0)
+        if (cross.dot(direction) < 0)
             u = lon;
         else
             u = 1 - lon;
@@ -471,97 +442,143 @@ Point2D *PolarProjection::directionToUV(Vector3D *direction) {
     //  direction->x, direction->y, direction->z);
     //  assert ( -0. <= u && u < 1 );
     //  assert ( -0. <= v && v < 1 );
-    return new Point2D(u, v);
+    return Point2D(u, v);
 }
 /// END POLAR
 
-void transformArray(const pfs::Array2Df *in, pfs::Array2Df *out,
-                    TransformInfo *transformInfo) {
-    const double delta = 1. / transformInfo->oversampleFactor;
-    const double offset = 0.5 / transformInfo->oversampleFactor;
-    const double scaler = 1. / (transformInfo->oversampleFactor *
-                                transformInfo->oversampleFactor);
-
-    const int outRows = out->getRows();
-    const int outCols = out->getCols();
-
-    const int inRows = in->getRows();
-    const int inCols = in->getCols();
-
-    for (int y = 0; y < outRows; y++)
-        for (int x = 0; x < outCols; x++) {
-            double pixVal = 0;
-
-            if (transformInfo->dstProjection->isValidPixel(
-                    (x + 0.5) / outCols, (y + 0.5) / outCols) == true) {
-                for (double sy = 0, oy = 0;
-                     oy < transformInfo->oversampleFactor; sy += delta, oy++)
-                    for (double sx = 0, ox = 0;
-                         ox < transformInfo->oversampleFactor;
-                         sx += delta, ox++) {
-                        Vector3D *direction =
-                            transformInfo->dstProjection->uvToDirection(
-                                (x + offset + sx) / outCols,
-                                (y + offset + sy) / outRows);
-
-                        if (direction == NULL) continue;
-
-                        // angles below are negated, because we want to rotate
-                        // the environment around us, not us within the
-                        // environment.
-                        if (transformInfo->xRotate != 0)
-                            direction->rotateX(-transformInfo->xRotate);
-
-                        if (transformInfo->yRotate != 0)
-                            direction->rotateY(-transformInfo->yRotate);
-
-                        if (transformInfo->zRotate != 0)
-                            direction->rotateZ(-transformInfo->zRotate);
-
-                        Point2D *p =
-                            transformInfo->srcProjection->directionToUV(
-                                direction);
-
-                        p->x *= inCols;
-                        p->y *= inRows;
-
-                        if (transformInfo->interpolate == true) {
-                            int ix = (int)floor(p->x);
-                            int iy = (int)floor(p->y);
-
-                            double i = p->x - ix;
-                            double j = p->y - iy;
-
-                            // compute pixel weights for interpolation
-                            double w1 = i * j;
-                            double w2 = (1 - i) * j;
-                            double w3 = (1 - i) * (1 - j);
-                            double w4 = i * (1 - j);
-
-                            int dx = ix + 1;
-                            if (dx >= inCols) dx = inCols - 1;
-
-                            int dy = iy + 1;
-                            if (dy >= inRows) dy = inRows - 1;
-
-                            pixVal += w3 * (*in)(ix, iy) + w4 * (*in)(dx, iy) +
-                                      w1 * (*in)(dx, dy) + w2 * (*in)(ix, dy);
-                        } else {
-                            int ix = (int)floor(p->x + 0.5);
-                            int iy = (int)floor(p->y + 0.5);
-
-                            if (ix >= inCols) ix = inCols - 1;
-
-                            if (iy >= inRows) iy = inRows - 1;
+namespace {
+//! \brief bilinear (or nearest neighbour) sampling of the source arrays
+struct WarpTap {
+    int idx[4];
+    float weight[4];
+};
 
-                            pixVal += (*in)(ix, iy);
-                        }
+//! \brief compute the taps of all the samples of the row \a y of the
+//! output (oversampleFactor^2 taps per pixel). Pixels outside the
+//! destination projection are marked in \a valid, and get no taps
+void computeWarpRow(int y, int outCols, int outRows, int inCols, int inRows,
+                    const TransformInfo &info, const Rotation &rotation,
+                    std::vector<WarpTap> &taps, std::vector<char> &valid) {
+    const int oversample = info.oversampleFactor;
+    const double delta = 1. / oversample;
+    const double offset = 0.5 / oversample;
+    const int samples = oversample * oversample;
+
+    for (int x = 0; x < outCols; x++) {
+        valid[x] = info.dstProjection->isValidPixel((x + 0.5) / outCols,
+                                                    (y + 0.5) / outRows);
+        if (!valid[x]) continue;
+
+        WarpTap *tap = &taps[x * samples];
+        for (int oy = 0; oy < oversample; oy++) {
+            for (int ox = 0; ox < oversample; ox++, tap++) {
+                Vector3D direction = info.dstProjection->uvToDirection(
+                    (x + offset + ox * delta) / outCols,
+                    (y + offset + oy * delta) / outRows);
+                rotation.apply(direction);
+
+                Point2D p = info.srcProjection->directionToUV(direction);
+
+                const float px = static_cast<float>(p.x * inCols);
+                const float py = static_cast<float>(p.y * inRows);
+
+                if (info.interpolate) {
+                    int ix = static_cast<int>(std::floor(px));
+                    int iy = static_cast<int>(std::floor(py));
+
+                    const float i = px - ix;
+                    const float j = py - iy;
+
+                    ix = std::min(std::max(ix, 0), inCols - 1);
+                    iy = std::min(std::max(iy, 0), inRows - 1);
+                    const int dx = std::min(ix + 1, inCols - 1);
+                    const int dy = std::min(iy + 1, inRows - 1);
+
+                    tap->idx[0] = iy * inCols + ix;
+                    tap->idx[1] = iy * inCols + dx;
+                    tap->idx[2] = dy * inCols + dx;
+                    tap->idx[3] = dy * inCols + ix;
+                    tap->weight[0] = (1 - i) * (1 - j);
+                    tap->weight[1] = i * (1 - j);
+                    tap->weight[2] = i * j;
+                    tap->weight[3] = (1 - i) * j;
+                } else {
+                    int ix = static_cast<int>(std::floor(px + 0.5f));
+                    int iy = static_cast<int>(std::floor(py + 0.5f));
+
+                    ix = std::min(std::max(ix, 0), inCols - 1);
+                    iy = std::min(std::max(iy, 0), inRows - 1);
+
+                    tap->idx[0] = tap->idx[1] = tap->idx[2] = tap->idx[3] =
+                        iy * inCols + ix;
+                    tap->weight[0] = 1.f;
+                    tap->weight[1] = tap->weight[2] = tap->weight[3] = 0.f;
+                }
+            }
+        }
+    }
+}
+}
 
-                        delete direction;
-                        delete p;
+void transformArrays(const std::vector<const pfs::Array2Df *> &in,
+                     const std::vector<pfs::Array2Df *> &out,
+                     const TransformInfo &transformInfo) {
+    assert(in.size() == out.size());
+    if (in.empty()) return;
+
+    const int samples =
+        transformInfo.oversampleFactor * transformInfo.oversampleFactor;
+    const float scaler = 1.f / samples;
+
+    const int outRows = out[0]->getRows();
+    const int outCols = out[0]->getCols();
+
+    const int inRows = in[0]->getRows();
+    const int inCols = in[0]->getCols();
+
+    // angles are negated, because we want to rotate the environment around
+    // us, not us within the environment.
+    const Rotation rotation(-transformInfo.xRotate, -transformInfo.yRotate,
+                            -transformInfo.zRotate);
+
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
+    {
+        // warp map of one row, shared by all the channels
+        std::vector<WarpTap> taps(outCols * samples);
+        std::vector<char> valid(outCols);
+
+#pragma omp for schedule(dynamic)
+        for (int y = 0; y < outRows; y++) {
+            computeWarpRow(y, outCols, outRows, inCols, inRows, transformInfo,
+                           rotation, taps, valid);
+
+            for (size_t c = 0; c < in.size(); ++c) {
+                const float *src = in[c]->data();
+                float *dst = out[c]->data() + y * outCols;
+
+                for (int x = 0; x < outCols; x++) {
+                    if (!valid[x]) {
+                        dst[x] = 0.f;
+                        continue;
+                    }
 
-                        (*out)(x, y) = pixVal * scaler;
+                    const WarpTap *tap = &taps[x * samples];
+                    float pixVal = 0.f;
+                    for (int s = 0; s < samples; s++, tap++) {
+                        pixVal += tap->weight[0] * src[tap->idx[0]] +
+                                  tap->weight[1] * src[tap->idx[1]] +
+                                  tap->weight[2] * src[tap->idx[2]] +
+                                  tap->weight[3] * src[tap->idx[3]];
                     }
+                    dst[x] = pixVal * scaler;
+                }
             }
         }
+    }
+}
+
+void transformArray(const pfs::Array2Df *in, pfs::Array2Df *out,
+                    TransformInfo *transformInfo) {
+    transformArrays(std::vector<const pfs::Array2Df *>(1, in),
+                    std::vector<pfs::Array2Df *>(1, out), *transformInfo);
 }
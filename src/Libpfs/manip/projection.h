@@ -31,20 +31,42 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "Libpfs/array2d_fwd.h"
 
-class Vector3D;
-class Point2D;
+//! \brief unit vector, pointing in the direction of a sample on the sphere
+class Vector3D {
+   public:
+    double x, y, z;
+
+    Vector3D() : x(0.), y(0.), z(1.) {}
+    //! \brief direction from spherical coordinates
+    Vector3D(double phi, double theta);
+    //! \brief normalized direction of (x, y, z)
+    Vector3D(double x, double y, double z);
+
+    double magnitude() const;
+    void normalize();
+    double dot(const Vector3D &v) const { return x * v.x + y * v.y + z * v.z; }
+};
+
+class Point2D {
+   public:
+    double x, y;
+
+    Point2D() : x(0.), y(0.) {}
+    Point2D(double x, double y) : x(x), y(y) {}
+};
 
 class Projection {
    protected:
     const char *name;
 
    public:
-    virtual Vector3D *uvToDirection(double u, double v) = 0;
-    virtual Point2D *directionToUV(Vector3D *direction) = 0;
-    virtual bool isValidPixel(double u, double v) = 0;
+    virtual Vector3D uvToDirection(double u, double v) const = 0;
+    virtual Point2D directionToUV(Vector3D direction) const = 0;
+    virtual bool isValidPixel(double u, double v) const = 0;
     virtual double getSizeRatio(void) = 0;
     virtual ~Projection() {}
 
@@ -73,9 +95,9 @@ class MirrorBallProjection : public Projection {
     static Projection *create();
     const char *getName(void);
     double getSizeRatio(void);
-    bool isValidPixel(double u, double v);
-    Vector3D *uvToDirection(double u, double v);
-    Point2D *directionToUV(Vector3D *direction);
+    bool isValidPixel(double u, double v) const;
+    Vector3D uvToDirection(double u, double v) const;
+    Point2D directionToUV(Vector3D direction) const;
 };
 
 class AngularProjection : public Projection {
@@ -88,42 +110,40 @@ class AngularProjection : public Projection {
     void setOptions(char *opts);
     const char *getName(void);
     double getSizeRatio(void);
-    bool isValidPixel(double u, double v);
-    Vector3D *uvToDirection(double u, double v);
-    Point2D *directionToUV(Vector3D *direction);
+    bool isValidPixel(double u, double v) const;
+    Vector3D uvToDirection(double u, double v) const;
+    Point2D directionToUV(Vector3D direction) const;
     void setAngle(double v) { totalAngle = v; }
 };
 
 class CylindricalProjection : public Projection {
-    Vector3D *pole;
-    Vector3D *equator;
-    Vector3D *cross;
+    Vector3D pole;
+    Vector3D equator;
+    Vector3D cross;
     explicit CylindricalProjection(bool initialization);
 
    public:
     static CylindricalProjection singleton;
     static Projection *create();
-    ~CylindricalProjection();
     double getSizeRatio(void);
-    bool isValidPixel(double /*u*/, double /*v*/);
-    Vector3D *uvToDirection(double u, double v);
-    Point2D *directionToUV(Vector3D *direction);
+    bool isValidPixel(double /*u*/, double /*v*/) const;
+    Vector3D uvToDirection(double u, double v) const;
+    Point2D directionToUV(Vector3D direction) const;
 };
 
 class PolarProjection : public Projection {
-    Vector3D *pole;
-    Vector3D *equator;
-    Vector3D *cross;
+    Vector3D pole;
+    Vector3D equator;
+    Vector3D cross;
     explicit PolarProjection(bool initialization);
 
    public:
     static PolarProjection singleton;
     static Projection *create();
-    ~PolarProjection();
     double getSizeRatio(void);
-    bool isValidPixel(double /*u*/, double /*v*/);
-    Vector3D *uvToDirection(double u, double v);
-    Point2D *directionToUV(Vector3D *direction);
+    bool isValidPixel(double /*u*/, double /*v*/) const;
+    Vector3D uvToDirection(double u, double v) const;
+    Point2D directionToUV(Vector3D direction) const;
 };
 
 class TransformInfo {
@@ -144,7 +164,15 @@ class TransformInfo {
     }
 };
 
+//! \brief apply \a transformInfo to \a in, writing the result in \a out
 void transformArray(const pfs::Array2Df *in, pfs::Array2Df *out,
                     TransformInfo *transformInfo);
 
+//! \brief apply \a transformInfo to all the channels of an image at once
+//! \note the geometry is computed once for all the channels: \a in and \a out
+//! must have the same number of arrays, all of the same size
+void transformArrays(const std::vector<const pfs::Array2Df *> &in,
+                     const std::vector<pfs::Array2Df *> &out,
+                     const TransformInfo &transformInfo);
+
 #endif  // PFS_PROJECTION_H
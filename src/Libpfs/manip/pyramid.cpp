@@ -0,0 +1,110 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Mip pyramid of the colour channels of a frame
+//! \author agent <agent@local>
+
+#include "pyramid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Libpfs/array2d.h"
+#include "Libpfs/exception.h"
+#include "Libpfs/frame.h"
+#include "Libpfs/utils/parallel.h"
+
+namespace pfs {
+
+void downsample(const Array2Df &in, Array2Df &out) {
+    const size_t inCols = in.getCols();
+    const size_t inRows = in.getRows();
+    const size_t outCols = out.getCols();
+    const long outRows = out.getRows();
+
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
+    for (long y = 0; y < outRows; ++y) {
+        const size_t y0 = std::min<size_t>(2 * y, inRows - 1);
+        const size_t y1 = std::min<size_t>(2 * y + 1, inRows - 1);
+        for (size_t x = 0; x < outCols; ++x) {
+            const size_t x0 = std::min(2 * x, inCols - 1);
+            const size_t x1 = std::min(2 * x + 1, inCols - 1);
+            out(x, y) = 0.25f * (in(x0, y0) + in(x1, y0) + in(x0, y1) +
+                                 in(x1, y1));
+        }
+    }
+}
+
+FramePyramid::FramePyramid(const Frame &frame, size_t minSize) {
+    const Channel *X, *Y, *Z;
+    frame.getXYZChannels(X, Y, Z);
+    if (!X || !Y || !Z) {
+        throw pfs::Exception("Missing X, Y, Z channels in the PFS stream");
+    }
+
+    const size_t width = frame.getWidth();
+    const size_t height = frame.getHeight();
+    minSize = std::max<size_t>(minSize, 1);
+
+    size_t levels = 1;
+    while (pyramidLevelSize(width, levels - 1) > minSize ||
+           pyramidLevelSize(height, levels - 1) > minSize) {
+        ++levels;
+    }
+
+    // allocate everything up front: the pointers into m_storage must stay
+    // valid
+    m_storage.resize(3 * levels);
+    m_levels.resize(levels);
+
+    // level 0 shares the channels: writing into the frame detaches them
+    const Channel *channels[] = {X, Y, Z};
+    for (size_t c = 0; c < 3; ++c) {
+        m_storage[c].share(*channels[c]);
+        m_levels[0].push_back(&m_storage[c]);
+    }
+    for (size_t l = 1; l < levels; ++l) {
+        for (size_t c = 0; c < 3; ++c) {
+            Array2Df &plane = m_storage[3 * l + c];
+            plane.resize(pyramidLevelSize(width, l),
+                         pyramidLevelSize(height, l));
+            downsample(*m_levels[l - 1][c], plane);
+            m_levels[l].push_back(&plane);
+        }
+    }
+}
+
+size_t FramePyramid::getWidth(size_t level) const {
+    return m_levels[level][0]->getCols();
+}
+
+size_t FramePyramid::getHeight(size_t level) const {
+    return m_levels[level][0]->getRows();
+}
+
+size_t FramePyramid::levelForScale(double scale) const {
+    if (!(scale < 1.0)) return 0;
+    if (scale <= 0.0) return getLevels() - 1;
+
+    const double level = std::floor(std::log(1.0 / scale) / std::log(2.0));
+    return std::min(static_cast<size_t>(level), getLevels() - 1);
+}
+}
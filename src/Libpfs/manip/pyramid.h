@@ -0,0 +1,80 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Mip pyramid of the colour channels of a frame
+//! \author agent <agent@local>
+
+#ifndef PFS_PYRAMID_H
+#define PFS_PYRAMID_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Libpfs/array2d_fwd.h"
+
+namespace pfs {
+class Frame;
+
+//! \brief 2x2 box filter: \a out must be half the size of \a in (rounded
+//! down, but at least 1 sample per side)
+void downsample(const Array2Df &in, Array2Df &out);
+
+//! \brief size of \a level of a pyramid, given the size of its full
+//! resolution level
+inline size_t pyramidLevelSize(size_t size, size_t level) {
+    return (size >> level) > 0 ? (size >> level) : 1;
+}
+
+//! \brief Stack of box filtered copies of the X, Y and Z channels of a frame,
+//! each level half the size of the previous one
+//!
+//! Level 0 shares the channels of the frame (see \c Array2D::share()): the
+//! pyramid is a snapshot, that stays valid while the frame is written or
+//! destroyed. Further levels are added until both sides fit in \a minSize:
+//! the whole pyramid costs a third of the frame in memory.
+class FramePyramid {
+   public:
+    explicit FramePyramid(const Frame &frame, size_t minSize = 256);
+
+    size_t getLevels() const { return m_levels.size(); }
+    size_t getWidth(size_t level) const;
+    size_t getHeight(size_t level) const;
+
+    //! \brief channel \a c (0 = X, 1 = Y, 2 = Z) of \a level
+    const Array2Df &getChannel(size_t level, size_t c) const {
+        return *m_levels[level][c];
+    }
+
+    //! \brief the coarsest level with at least \a scale samples for each
+    //! pixel of the frame (\a scale <= 1), that is the one to draw a view
+    //! zoomed by \a scale from
+    size_t levelForScale(double scale) const;
+
+   private:
+    FramePyramid(const FramePyramid &);
+    FramePyramid &operator=(const FramePyramid &);
+
+    std::vector<std::vector<const Array2Df *> > m_levels;
+    std::vector<Array2Df> m_storage;
+};
+}
+
+#endif  // PFS_PYRAMID_H
@@ -32,17 +32,159 @@
 
 #include "resize.h"
 
-#include "Libpfs/utils/msec_timer.h"
+#include "Libpfs/utils/trace.h"
 
 #include "Libpfs/frame.h"
 
+#include <boost/math/constants/constants.hpp>
+
 namespace pfs {
 
-Frame *resize(Frame *frame, int xSize, InterpolationMethod m) {
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
+namespace {
+//! \author Franco Comida <fcomida@users.sourceforge.net>
+//! \note Code derived from RawTherapee
+//! https://github.com/Beep6581/RawTherapee/blob/dev/rtengine/ipresize.cc
+inline float Lanc(float x, float a) {
+    if (x * x < 1e-6f) {
+        return 1.0f;
+    } else if (x * x > a * a) {
+        return 0.0f;
+    } else {
+        x = static_cast<float>(boost::math::double_constants::pi) * x;
+        return a * std::sin(x) * std::sin(x / a) / (x * x);
+    }
+}
+
+// below this factor a Lanczos reduction is split in two stages
+const size_t LANCZOS_MAX_REDUCTION = 4;
+}
+
+ResampleWeights::ResampleWeights(size_t srcSize, size_t dstSize,
+                                 Kernel kernel)
+    : m_srcSize(srcSize),
+      m_dstSize(dstSize),
+      m_first(dstSize),
+      m_count(dstSize) {
+    const int W = static_cast<int>(srcSize);
+    const float delta =
+        static_cast<float>(srcSize) / static_cast<float>(dstSize);
+
+    switch (kernel) {
+        case LANCZOS3: {
+            const float a = 3.0f;
+            const float sc = std::min(1.0f / delta, 1.0f);
+
+            m_support = static_cast<size_t>(2.0f * a / sc) + 1;
+            m_weights.assign(m_support * dstSize, 0.f);
+
+            for (size_t j = 0; j < dstSize; j++) {
+                // x coord of the center of pixel on src image
+                const float x0 = (static_cast<float>(j) + 0.5f) * delta - 0.5f;
+
+                const int jj0 =
+                    std::max(0, static_cast<int>(floorf(x0 - a / sc)) + 1);
+                const int jj1 =
+                    std::min(W, static_cast<int>(floorf(x0 + a / sc)) + 1);
+
+                m_first[j] = jj0;
+                m_count[j] = jj1 - jj0;
+
+                float *w = &m_weights[j * m_support];
+                float ws = 0.0f;
+                for (int jj = jj0; jj < jj1; jj++) {
+                    w[jj - jj0] = Lanc(sc * (x0 - static_cast<float>(jj)), a);
+                    ws += w[jj - jj0];
+                }
+                for (int k = 0; k < m_count[j]; k++) {
+                    w[k] /= ws;
+                }
+            }
+        } break;
+        case BOX: {
+            m_support = static_cast<size_t>(std::ceil(delta)) + 1;
+            m_weights.assign(m_support * dstSize, 0.f);
+
+            for (size_t j = 0; j < dstSize; j++) {
+                // area of src image covered by the pixel
+                const double x0 = static_cast<double>(j) * srcSize / dstSize;
+                const double x1 =
+                    static_cast<double>(j + 1) * srcSize / dstSize;
+
+                const int jj0 = std::min(W - 1, static_cast<int>(x0));
+                const int jj1 =
+                    std::min(W, static_cast<int>(std::ceil(x1 - 1e-6)));
+
+                m_first[j] = jj0;
+                m_count[j] = std::max(1, jj1 - jj0);
+
+                float *w = &m_weights[j * m_support];
+                double ws = 0.0;
+                for (int k = 0; k < m_count[j]; k++) {
+                    const double jj = jj0 + k;
+                    w[k] = static_cast<float>(std::min(jj + 1, x1) -
+                                              std::max(jj, x0));
+                    ws += w[k];
+                }
+                for (int k = 0; k < m_count[j]; k++) {
+                    w[k] = (ws > 0.) ? static_cast<float>(w[k] / ws) : 1.f;
+                }
+            }
+        } break;
+    }
+}
+
+Resampler::Resampler(size_t srcCols, size_t srcRows, size_t dstCols,
+                     size_t dstRows, InterpolationMethod m)
+    : m_srcCols(srcCols),
+      m_srcRows(srcRows),
+      m_dstCols(dstCols),
+      m_dstRows(dstRows),
+      m_mode(RESAMPLE_SEPARABLE),
+      m_reducedCols(srcCols),
+      m_reducedRows(srcRows) {
+    if (srcCols == dstCols && srcRows == dstRows) {
+        m_mode = RESAMPLE_COPY;
+        return;
+    }
+
+    switch (m) {
+        case BilinearInterp: {
+            if (dstCols * 2 > srcCols || dstRows * 2 > srcRows) {
+                m_mode = RESAMPLE_BILINEAR;
+                return;
+            }
+            // bilinear interpolation skips most of the samples of a large
+            // reduction: average them instead
+            m_horizontal.reset(
+                new ResampleWeights(srcCols, dstCols, ResampleWeights::BOX));
+            m_vertical.reset(
+                new ResampleWeights(srcRows, dstRows, ResampleWeights::BOX));
+        } break;
+        case LanczosInterp: {
+            if (dstCols * LANCZOS_MAX_REDUCTION <= srcCols &&
+                dstRows * LANCZOS_MAX_REDUCTION <= srcRows) {
+                // the support of the filter grows with the reduction factor:
+                // average down to about twice the final size first
+                const size_t factor =
+                    std::min(srcCols / dstCols, srcRows / dstRows) / 2;
+
+                m_reducedCols = srcCols / factor;
+                m_reducedRows = srcRows / factor;
+                m_reduceHorizontal.reset(new ResampleWeights(
+                    srcCols, m_reducedCols, ResampleWeights::BOX));
+                m_reduceVertical.reset(new ResampleWeights(
+                    srcRows, m_reducedRows, ResampleWeights::BOX));
+            }
+            m_horizontal.reset(new ResampleWeights(
+                m_reducedCols, dstCols, ResampleWeights::LANCZOS3));
+            m_vertical.reset(new ResampleWeights(m_reducedRows, dstRows,
+                                                 ResampleWeights::LANCZOS3));
+        } break;
+    }
+}
+
+Frame *resize(const Frame *frame, int xSize, InterpolationMethod m) {
+    PFS_TRACE_SPAN("resizeFrame", "manip");
 
     int new_x = xSize;
     int new_y = (int)((float)frame->getHeight() * (float)xSize /
@@ -50,21 +192,19 @@ Frame *resize(Frame *frame, int xSize, InterpolationMethod m) {
 
     pfs::Frame *resizedFrame = new pfs::Frame(new_x, new_y);
 
+    // same filter weights for all the channels
+    const Resampler resampler(frame->getWidth(), frame->getHeight(), new_x,
+                              new_y, m);
+
     const ChannelContainer &channels = frame->getChannels();
     for (ChannelContainer::const_iterator it = channels.begin();
          it != channels.end(); ++it) {
         pfs::Channel *newCh = resizedFrame->createChannel((*it)->getName());
 
-        resize(*it, newCh, m);
+        resampler(**it, *newCh);
     }
     pfs::copyTags(frame, resizedFrame);
 
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    std::cout << "resizeFrame() = " << f_timer.get_time() << " msec"
-              << std::endl;
-#endif
-
     return resizedFrame;
 }
 
@@ -31,11 +31,87 @@
 #include "Common/global.h"
 #include "Libpfs/array2d.h"
 
+#include <cstddef>
+#include <memory>
+#include <vector>
+
 namespace pfs {
 // forward declaration
 class Frame;
 
-Frame *resize(Frame *frame, int xSize, InterpolationMethod m);
+//! \brief Filter weights to resample a line of \c srcSize samples into a line
+//! of \c dstSize samples. They only depend on the geometry, so they are
+//! computed once and shared by all the lines (and channels) of an image
+class ResampleWeights {
+   public:
+    enum Kernel {
+        //! \brief Lanczos filter (a = 3)
+        LANCZOS3,
+        //! \brief exact area average, for downscaling
+        BOX
+    };
+
+    ResampleWeights(size_t srcSize, size_t dstSize, Kernel kernel);
+
+    size_t srcSize() const { return m_srcSize; }
+    size_t dstSize() const { return m_dstSize; }
+
+    //! \brief first source sample of the output sample \a idx
+    int first(size_t idx) const { return m_first[idx]; }
+    //! \brief number of source samples of the output sample \a idx
+    int count(size_t idx) const { return m_count[idx]; }
+    //! \brief normalized weights of the output sample \a idx
+    const float *weights(size_t idx) const {
+        return &m_weights[idx * m_support];
+    }
+
+   private:
+    size_t m_srcSize;
+    size_t m_dstSize;
+    size_t m_support;
+    std::vector<int> m_first;
+    std::vector<int> m_count;
+    std::vector<float> m_weights;
+};
+
+//! \brief Resamples arrays of \c srcCols x \c srcRows samples into arrays of
+//! \c dstCols x \c dstRows samples
+//! \note build it once and use it on all the channels of a frame
+class Resampler {
+   public:
+    Resampler(size_t srcCols, size_t srcRows, size_t dstCols, size_t dstRows,
+              InterpolationMethod m);
+
+    template <typename Type>
+    void operator()(const Array2D<Type> &in, Array2D<Type> &out) const;
+
+   private:
+    enum Mode { RESAMPLE_COPY, RESAMPLE_BILINEAR, RESAMPLE_SEPARABLE };
+
+    //! \brief apply the separable filter of \a horizontal and \a vertical
+    template <typename Type>
+    static void separable(const Type *src, Type *dst,
+                          const ResampleWeights &horizontal,
+                          const ResampleWeights &vertical);
+
+    size_t m_srcCols;
+    size_t m_srcRows;
+    size_t m_dstCols;
+    size_t m_dstRows;
+    Mode m_mode;
+
+    // large Lanczos reductions: an exact area average by an integer factor
+    // first, then the Lanczos filter on the reduced image
+    size_t m_reducedCols;
+    size_t m_reducedRows;
+    std::shared_ptr<ResampleWeights> m_reduceHorizontal;
+    std::shared_ptr<ResampleWeights> m_reduceVertical;
+
+    std::shared_ptr<ResampleWeights> m_horizontal;
+    std::shared_ptr<ResampleWeights> m_vertical;
+};
+
+Frame *resize(const Frame *frame, int xSize, InterpolationMethod m);
 
 template <typename Type>
 void resize(const Array2D<Type> *from, Array2D<Type> *to,
@@ -22,146 +22,20 @@
 #ifndef PFS_RESIZE_HXX
 #define PFS_RESIZE_HXX
 
-#include <boost/math/constants/constants.hpp>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <boost/numeric/conversion/bounds.hpp>
+
+#include <Libpfs/utils/parallel.h>
+
 #include "copy.h"
 #include "resize.h"
-#include "../../sleef.c"
 
 namespace pfs {
 namespace detail {
 
-//! \author Franco Comida <fcomida@users.sourceforge.net>
-//! \note Code derived from RawTherapee
-//! https://github.com/Beep6581/RawTherapee/blob/dev/rtengine/ipresize.cc
-
-static inline float Lanc(float x, float a) {
-    if (x * x < 1e-6f) {
-        return 1.0f;
-    } else if (x * x > a * a) {
-        return 0.0f;
-    } else {
-        x = static_cast<float>(boost::math::double_constants::pi) * x;
-        return a * xsinf(x) * xsinf(x / a) / (x * x);
-    }
-}
-
-template <typename Type>
-void Lanczos(const Type *src, Type *dst, int W, int H, int W2, int H2)
-
-{
-    const float scale = static_cast<float>(W2) / static_cast<float>(W);
-    const float delta = 1.0f / scale;
-    const float a = 3.0f;
-    const float sc = std::min(scale, 1.0f);
-    const int support = static_cast<int>(2.0f * a / sc) + 1;
-
-    const Type zero = static_cast<Type>(0);
-
-#pragma omp parallel
-    {
-        // storage for precomputed parameters for horisontal interpolation
-        float *wwh = new float[support * W2];
-        int *jj0 = new int[W2];
-        int *jj1 = new int[W2];
-
-        // temporal storage for vertically-interpolated row of pixels
-        float *l = new float[W];
-
-        // Phase 1: precompute coefficients for horisontal interpolation
-
-        for (int j = 0; j < W2; j++) {
-            // x coord of the center of pixel on src image
-            float x0 = (static_cast<float>(j) + 0.5f) * delta - 0.5f;
-
-            // weights for interpolation in horisontal direction
-            float *w = wwh + j * support;
-
-            // sum of weights used for normalization
-            float ws = 0.0f;
-
-            jj0[j] = std::max(0, static_cast<int>(floorf(x0 - a / sc)) + 1);
-            jj1[j] = std::min(W, static_cast<int>(floorf(x0 + a / sc)) + 1);
-
-            // calculate weights
-            for (int jj = jj0[j]; jj < jj1[j]; jj++) {
-                int k = jj - jj0[j];
-                float z = sc * (x0 - static_cast<float>(jj));
-                w[k] = Lanc(z, a);
-                ws += w[k];
-            }
-
-            // normalize weights
-            for (int k = 0; k < support; k++) {
-                w[k] /= ws;
-            }
-        }
-
-        // Phase 2: do actual interpolation
-        // weights for interpolation in y direction
-        float *w = new float[support];
-#pragma omp for
-        for (int i = 0; i < H2; i++) {
-            // y coord of the center of pixel on src image
-            float y0 = (static_cast<float>(i) + 0.5f) * delta - 0.5f;
-
-            // sum of weights used for normalization
-            float ws = 0.0f;
-
-            int ii0 = std::max(0, static_cast<int>(floorf(y0 - a / sc)) + 1);
-            int ii1 = std::min(H, static_cast<int>(floorf(y0 + a / sc)) + 1);
-
-            // calculate weights for vertical interpolation
-            for (int ii = ii0; ii < ii1; ii++) {
-                int k = ii - ii0;
-                float z = sc * (y0 - static_cast<float>(ii));
-                w[k] = Lanc(z, a);
-                ws += w[k];
-            }
-
-            // normalize weights
-            for (int k = 0; k < support; k++) {
-                w[k] /= ws;
-            }
-
-            // Do vertical interpolation. Store results.
-            for (int j = 0; j < W; j++) {
-                float o = 0.0f;
-
-                for (int ii = ii0; ii < ii1; ii++) {
-                    int k = ii - ii0;
-
-                    o += w[k] * static_cast<float>(src[ii * W + j]);
-                }
-
-                l[j] = o;
-            }
-
-            // Do horizontal interpolation
-            for (int j = 0; j < W2; j++) {
-                float *wh = wwh + support * j;
-
-                float o = 0.0f;
-
-                for (int jj = jj0[j]; jj < jj1[j]; jj++) {
-                    int k = jj - jj0[j];
-
-                    o += wh[k] * l[jj];
-                }
-
-                dst[i * W2 + j] =
-                    max(zero, min(static_cast<Type>(o),
-                                  boost::numeric::bounds<Type>::highest()));
-            }
-        }
-
-        delete[] w;
-        delete[] wwh;
-        delete[] jj0;
-        delete[] jj1;
-        delete[] l;
-    }
-}
-
 const size_t BLOCK_FACTOR = 96;
 
 //! \author Davide Anastasia <davideanastasia@users.sourceforge.net>
@@ -183,7 +57,7 @@ void resizeBilinearGray(const Type *pixels, Type *output, size_t w, size_t h,
     float x_diff = 0.0f;
     float y_diff = 0.0f;
 
-#pragma omp parallel shared(pixels, output, w, h, w2, h2) private( \
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob()) shared(pixels, output, w, h, w2, h2) private( \
     x_diff, y_diff, x, y, index, outputPixel, A, B, C, D)
     {
 #pragma omp for schedule(static, 1)
@@ -221,31 +95,90 @@ void resizeBilinearGray(const Type *pixels, Type *output, size_t w, size_t h,
     }  // end parallel region
 }
 
+}  // anonymous
+
 template <typename Type>
-void resample(const ::pfs::Array2D<Type> *in, ::pfs::Array2D<Type> *out,
-              InterpolationMethod m) {
-    switch (m) {
-        case LanczosInterp:
-            Lanczos(in->data(), out->data(), in->getCols(), in->getRows(),
-                    out->getCols(), out->getRows());
+void Resampler::separable(const Type *src, Type *dst,
+                          const ResampleWeights &horizontal,
+                          const ResampleWeights &vertical) {
+    const int W = static_cast<int>(horizontal.srcSize());
+    const int W2 = static_cast<int>(horizontal.dstSize());
+    const int H2 = static_cast<int>(vertical.dstSize());
+
+    const Type zero = static_cast<Type>(0);
+
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
+    {
+        // temporal storage for vertically-interpolated row of pixels
+        std::vector<float> l(W);
+
+#pragma omp for
+        for (int i = 0; i < H2; i++) {
+            const float *wv = vertical.weights(i);
+            const Type *row = src + static_cast<size_t>(vertical.first(i)) * W;
+
+            // Do vertical interpolation (one source row at the time)
+            std::fill(l.begin(), l.end(), 0.f);
+            for (int k = 0, kEnd = vertical.count(i); k < kEnd;
+                 k++, row += W) {
+                const float w = wv[k];
+                for (int j = 0; j < W; j++) {
+                    l[j] += w * static_cast<float>(row[j]);
+                }
+            }
+
+            // Do horizontal interpolation
+            Type *out = dst + static_cast<size_t>(i) * W2;
+            for (int j = 0; j < W2; j++) {
+                const float *wh = horizontal.weights(j);
+                const float *in = &l[horizontal.first(j)];
+
+                float o = 0.0f;
+                for (int k = 0, kEnd = horizontal.count(j); k < kEnd; k++) {
+                    o += wh[k] * in[k];
+                }
+
+                out[j] = std::max(
+                    zero, std::min(static_cast<Type>(o),
+                                   boost::numeric::bounds<Type>::highest()));
+            }
+        }
+    }
+}
+
+template <typename Type>
+void Resampler::operator()(const Array2D<Type> &in, Array2D<Type> &out) const {
+    assert(in.getCols() == m_srcCols && in.getRows() == m_srcRows);
+    assert(out.getCols() == m_dstCols && out.getRows() == m_dstRows);
+
+    switch (m_mode) {
+        case RESAMPLE_COPY:
+            pfs::copy(&in, &out);
             break;
-        case BilinearInterp:
-            resizeBilinearGray(in->data(), out->data(), in->getCols(),
-                               in->getRows(), out->getCols(), out->getRows());
+        case RESAMPLE_BILINEAR:
+            detail::resizeBilinearGray(in.data(), out.data(), m_srcCols,
+                                       m_srcRows, m_dstCols, m_dstRows);
+            break;
+        case RESAMPLE_SEPARABLE:
+            if (m_reduceHorizontal) {
+                Array2D<Type> reduced(m_reducedCols, m_reducedRows);
+                separable(in.data(), reduced.data(), *m_reduceHorizontal,
+                          *m_reduceVertical);
+                separable(reduced.data(), out.data(), *m_horizontal,
+                          *m_vertical);
+            } else {
+                separable(in.data(), out.data(), *m_horizontal, *m_vertical);
+            }
             break;
     }
 }
 
-}  // anonymous
-
 template <typename Type>
 void resize(const Array2D<Type> *in, Array2D<Type> *out,
             InterpolationMethod m) {
-    if (in->getCols() == out->getCols() && in->getRows() == out->getRows()) {
-        pfs::copy(in, out);
-    } else {
-        detail::resample(in, out, m);
-    }
+    Resampler resampler(in->getCols(), in->getRows(), out->getCols(),
+                        out->getRows(), m);
+    resampler(*in, *out);
 }
 
 }  // pfs
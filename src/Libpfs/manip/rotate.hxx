@@ -24,34 +24,32 @@
 
 #include "rotate.h"
 
+#include <cstddef>
+
+#include "Libpfs/utils/transpose.h"
+
 namespace pfs {
 
 template <typename Type>
 void rotate(const pfs::Array2D<Type> *in, pfs::Array2D<Type> *out,
             bool clockwise) {
-    const Type *Vin = in->data();
-    Type *Vout = out->data();
-
-    const int I_ROWS = in->getRows();
-    const int I_COLS = in->getCols();
+    const std::ptrdiff_t I_ROWS = in->getRows();
+    const std::ptrdiff_t I_COLS = in->getCols();
 
-    // const int O_ROWS = out->getRows();
-    const int O_COLS = out->getCols();
+    const std::ptrdiff_t O_ROWS = out->getRows();
+    const std::ptrdiff_t O_COLS = out->getCols();
 
+    // a rotation is a transposition, reading the rows of the input (clockwise)
+    // or writing the rows of the output (counter clockwise) bottom up
     if (clockwise) {
-#pragma omp parallel for
-        for (int j = 0; j < I_ROWS; j++) {
-            for (int i = 0; i < I_COLS; i++) {
-                Vout[(i + 1) * O_COLS - 1 - j] = Vin[j * I_COLS + i];
-            }
-        }
+        // Vout[i * O_COLS + (O_COLS - 1 - j)] = Vin[j * I_COLS + i]
+        utils::transpose(in->data() + (I_ROWS - 1) * I_COLS, -I_COLS,
+                         out->data(), O_COLS, I_COLS, I_ROWS);
     } else {
-#pragma omp parallel for
-        for (int j = 0; j < I_ROWS; j++) {
-            for (int i = 0; i < I_COLS; i++) {
-                Vout[(I_COLS - i - 1) * O_COLS + j] = Vin[j * I_COLS + i];
-            }
-        }
+        // Vout[(I_COLS - i - 1) * O_COLS + j] = Vin[j * I_COLS + i]
+        utils::transpose(in->data(), I_COLS,
+                         out->data() + (O_ROWS - 1) * O_COLS, -O_COLS, I_COLS,
+                         I_ROWS);
     }
 }
 }
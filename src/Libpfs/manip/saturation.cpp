@@ -32,10 +32,9 @@
 
 #include "Libpfs/array2d.h"
 #include "Libpfs/colorspace/colorspace.h"
-#include "Libpfs/colorspace/saturation.h"
-#include "Libpfs/utils/transform.h"
+#include "Libpfs/colorspace/kernels.h"
 #include "Libpfs/frame.h"
-#include "Libpfs/utils/msec_timer.h"
+#include "Libpfs/utils/trace.h"
 
 using namespace pfs;
 using namespace colorspace;
@@ -55,17 +54,10 @@ void applySaturation(pfs::Frame *frame, float multiplier) {
 
 void applySaturation(pfs::Array2Df *R, pfs::Array2Df *G, pfs::Array2Df *B,
                 const float multiplier) {
-#ifdef TIMER_PROFILING
-    msec_timer f_timer;
-    f_timer.start();
-#endif
+    PFS_TRACE_SPAN("applySaturation", "manip");
 
-    utils::transform(R->begin(), R->end(), G->begin(), B->begin(), R->begin(), G->begin(), B->begin(), ChangeSaturation(multiplier));
-
-#ifdef TIMER_PROFILING
-    f_timer.stop_and_update();
-    std::cout << "applySaturation() = " << f_timer.get_time() << " msec"
-              << std::endl;
-#endif
+    colorspace::kernels::saturation(R->data(), G->data(), B->data(), R->data(),
+                                    G->data(), B->data(), multiplier,
+                                    R->size());
 }
 }
@@ -23,6 +23,7 @@
 #define PFS_SHIFT_H
 
 #include <Libpfs/array2d_fwd.h>
+#include <Libpfs/array2dview.h>
 #include <Libpfs/frame.h>
 
 namespace pfs {
@@ -30,6 +31,18 @@ namespace pfs {
 template <typename Type>
 void shift(const Array2D<Type> &in, int dx, int dy, Array2D<Type> &out);
 
+//! \brief shift a view by \a dx \a dy: \a out must have the same size
+template <typename InType, typename Type>
+void shift(const Array2DView<InType> &in, int dx, int dy, Array2D<Type> &out);
+
+//! \brief the samples that \c shift(in, dx, dy, out) copies: \a in is
+//! restricted to the samples landing inside \a out, \a out to where they
+//! land. Everything else in the output of \c shift is zero.
+//! \note both views must have the same size
+template <typename InType, typename OutType>
+void shiftOverlap(Array2DView<InType> &in, Array2DView<OutType> &out, int dx,
+                  int dy);
+
 //! \brief shift image by \a dx \a dy
 pfs::Frame *shift(const pfs::Frame &in, int dx, int dy);
 
@@ -24,74 +24,58 @@
 
 #include <Libpfs/array2d.h>
 #include <Libpfs/manip/shift.h>
-#include <Libpfs/utils/msec_timer.h>
+#include <Libpfs/utils/trace.h>
 
 #include <algorithm>
+#include <cassert>
+#include <cstdlib>
 #include <iostream>
 #include <iterator>
 #include <numeric>
 
 namespace pfs {
 
-template <typename Type>
-void shift(const Array2D<Type> &in, int dx, int dy, Array2D<Type> &out) {
-    typedef Array2D<Type> Array2DType;
+template <typename InType, typename OutType>
+void shiftOverlap(Array2DView<InType> &in, Array2DView<OutType> &out, int dx,
+                  int dy) {
+    assert(in.getCols() == out.getCols());
+    assert(in.getRows() == out.getRows());
 
-    using namespace std;
+    // out(x, y) = in(x + dx, y + dy)
+    const int cols = static_cast<int>(in.getCols());
+    const int rows = static_cast<int>(in.getRows());
+    const int width = std::max(0, cols - std::abs(dx));
+    const int height = std::max(0, rows - std::abs(dy));
+    const int outX = std::min(std::max(0, -dx), cols);
+    const int outY = std::min(std::max(0, -dy), rows);
 
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
+    in = in.sub(outX + dx < 0 ? 0 : std::min(outX + dx, cols),
+                outY + dy < 0 ? 0 : std::min(outY + dy, rows), width, height);
+    out = out.sub(outX, outY, width, height);
+}
 
-    // fill first row... if any!
-    for (int idx = 0; idx < -dy; idx++) {
-        fill(out.row_begin(idx), out.row_end(idx), Type());
-    }
+template <typename InType, typename Type>
+void shift(const Array2DView<InType> &in, int dx, int dy, Array2D<Type> &out) {
+    assert(in.getCols() == out.getCols());
+    assert(in.getRows() == out.getRows());
 
-    // fill middle portion
-    if (dx < 0) {
-        for (int row = max(0, -dy), rowEnd = in.getRows() - max(0, dy);
-             row < rowEnd; row++) {
-            // Begin output line
-            typename Array2DType::iterator itBegin = out.row_begin(row);
-            // Pivot iterator
-            typename Array2DType::iterator itTh = itBegin - dx;
+    PFS_TRACE_SPAN("shift Array2D", "manip");
 
-            // fill zero at the begin of the line
-            fill(itBegin, itTh, Type());
-            // copy data
-            copy(in.row_begin(row + dy), in.row_end(row + dy) + dx, itTh);
-        }
-    } else if (dx > 0) {
-        for (int row = max(0, -dy), rowEnd = in.getRows() - max(0, dy);
-             row < rowEnd; row++) {
-            // copy data
-            copy(in.row_begin(row + dy) + dx, in.row_end(row + dy),
-                 out.row_begin(row));
-            // fill zero
-            fill(out.row_end(row) - dx, out.row_end(row), Type());
-        }
-    } else {
-        for (int row = max(0, -dy), rowEnd = in.getRows() - max(0, dy);
-             row < rowEnd; row++) {
-            // copy data
-            copy(in.row_begin(row + dy), in.row_end(row + dy),
-                 out.row_begin(row));
-        }
-    }
+    Array2DView<InType> src(in);
+    Array2DView<Type> dst(out);
+    shiftOverlap(src, dst, dx, dy);
 
-    // fill last rows... if any!
-    for (int idx = dy; idx > 0; idx--) {
-        fill(out.row_begin(out.getRows() - idx),
-             out.row_end(out.getRows() - idx), Type());
+    if (src.size() != out.size()) {
+        out.reset();
     }
+    for (size_t row = 0; row < dst.getRows(); row++) {
+        std::copy(src.row_begin(row), src.row_end(row), dst.row_begin(row));
+    }
+}
 
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << "shift Array2D = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
+template <typename Type>
+void shift(const Array2D<Type> &in, int dx, int dy, Array2D<Type> &out) {
+    shift(makeView(in), dx, dy, out);
 }
 
 }  // pfs
@@ -25,6 +25,8 @@
 #ifndef LIBPFS_PROGRESS_H
 #define LIBPFS_PROGRESS_H
 
+#include <atomic>
+
 namespace pfs {
 
 //! \brief This class is a virtual interface for a status callback. It allows
@@ -33,6 +35,10 @@ namespace pfs {
 //! \note All the functions have an empty implementation, so it not necessary
 //! to pass a concrete instance to routine that require the presence of this
 //! class
+//! \note The state is held in atomics: the value can be set and the
+//! cancellation checked from any thread, i.e. from inside parallel loops
+//! (see \c utils::parallelFor()), and \c cancel() can be called from the
+//! GUI thread while the operation is running
 class Progress {
    public:
     Progress();
@@ -60,12 +66,12 @@ class Progress {
     virtual bool canceled() const;
 
    private:
-    int m_maximum;
-    int m_minimum;
+    std::atomic<int> m_maximum;
+    std::atomic<int> m_minimum;
 
-    int m_value;
+    std::atomic<int> m_value;
 
-    bool m_canceled;
+    std::atomic<bool> m_canceled;
 };
 }
 
@@ -30,6 +30,7 @@
 #endif
 
 #include "rt_algo.h"
+#include "Libpfs/utils/parallel.h"
 
 namespace lhdrengine
 {
@@ -57,7 +58,7 @@ void findMinMaxPercentile(const float* data, size_t size, float minPrct, float&
     // we make a rough calculation to reduce the number of threads for small data size.
     // This also works fine for the minmax loop.
     if (multithread) {
-        const size_t maxThreads = omp_get_max_threads();
+        const size_t maxThreads = pfs::utils::getThreadsPerJob();
         while (size > numThreads * numThreads * 16384 && numThreads < maxThreads) {
             ++numThreads;
         }
@@ -33,14 +33,20 @@
 #include <boost/assign.hpp>
 #include <boost/thread/mutex.hpp>
 #include <map>
+#include <memory>
 
+#include "TonemappingOperators/durand02/tmo_durand02.h"
+#include "TonemappingOperators/fattal02/tmo_fattal02.h"
 #include "TonemappingOperators/pfstmo.h"
+#include "TonemappingOperators/reinhard02/tmo_reinhard02.h"
 
 #include "Libpfs/channel.h"
 #include "Libpfs/colorspace/colorspace.h"
 #include "Libpfs/frame.h"
+#include "Libpfs/manip/copy.h"
 #include "Libpfs/progress.h"
 #include "Libpfs/tm/TonemapOperator.h"
+#include "Libpfs/utils/trace.h"
 
 using namespace boost::assign;
 
@@ -56,6 +62,7 @@ class TonemapOperatorMantiuk06
    public:
     void tonemapFrame(pfs::Frame &workingFrame, TonemappingOptions *opts,
                       pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Mantiuk06", "tonemap");
         ph.setMaximum(100);
 
         try {
@@ -76,6 +83,7 @@ struct TonemapOperatorMantiuk08
     : public TonemapOperatorRegister<mantiuk08, TonemapOperatorMantiuk08> {
     void tonemapFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
                       pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Mantiuk08", "tonemap");
         ph.setMaximum(100);
 
         // Convert to CS_XYZ: tm operator now use this colorspace
@@ -102,6 +110,36 @@ struct TonemapOperatorFattal02
     : public TonemapOperatorRegister<fattal, TonemapOperatorFattal02> {
     void tonemapFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
                       pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Fattal02", "tonemap");
+        tonemap(workingframe, opts, NULL, ph);
+    }
+
+    void clearSweep() {
+        m_pyramid.reset();
+        TonemapOperator::clearSweep();
+    }
+
+    // the gradient pyramid depends on the solver only
+    bool sharesIntermediates(const TonemappingOptions &a,
+                             const TonemappingOptions &b) const {
+        return a.tmoperator == fattal && b.tmoperator == fattal &&
+               a.operator_options.fattaloptions.fftsolver ==
+                   b.operator_options.fattaloptions.fftsolver;
+    }
+
+   protected:
+    void tonemapSweepFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
+                           pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Fattal02", "tonemap");
+        if (!m_pyramid) {
+            m_pyramid.reset(new Fattal02Pyramid);
+        }
+        tonemap(workingframe, opts, m_pyramid.get(), ph);
+    }
+
+   private:
+    void tonemap(pfs::Frame &workingframe, TonemappingOptions *opts,
+                 Fattal02Pyramid *pyramid, pfs::Progress &ph) {
         ph.setMaximum(100);
 
         int detail_level = 0;
@@ -126,17 +164,20 @@ struct TonemapOperatorFattal02
                             opts->operator_options.fattaloptions.noiseredux,
                             opts->operator_options.fattaloptions.newfattal,
                             opts->operator_options.fattaloptions.fftsolver,
-                            detail_level, ph);
+                            detail_level, pyramid, ph);
         } catch (...) {
             throw std::runtime_error("Fattal: Tonemap Failed");
         }
     }
+
+    std::unique_ptr<Fattal02Pyramid> m_pyramid;
 };
 
 struct TonemapOperatorFerradans11
     : public TonemapOperatorRegister<ferradans, TonemapOperatorFerradans11> {
     void tonemapFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
                       pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Ferradans11", "tonemap");
         ph.setMaximum(100);
 
         try {
@@ -153,6 +194,7 @@ struct TonemapOperatorMai11
     : public TonemapOperatorRegister<mai, TonemapOperatorMai11> {
     void tonemapFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
                       pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Mai11", "tonemap");
         ph.setMaximum(100);
 
         try {
@@ -167,6 +209,7 @@ struct TonemapOperatorDrago03
     : public TonemapOperatorRegister<drago, TonemapOperatorDrago03> {
     void tonemapFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
                       pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Drago03", "tonemap");
         ph.setMaximum(100);  // this guy should not be here!
 
         try {
@@ -182,23 +225,88 @@ class TonemapOperatorDurand02
     : public TonemapOperatorRegister<durand, TonemapOperatorDurand02> {
     void tonemapFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
                       pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Durand02", "tonemap");
+        tonemap(workingframe, opts, NULL, ph);
+    }
+
+    void clearSweep() {
+        m_baseLayer.reset();
+        TonemapOperator::clearSweep();
+    }
+
+    // the base layer depends on the bilateral filter only
+    bool sharesIntermediates(const TonemappingOptions &a,
+                             const TonemappingOptions &b) const {
+        return a.tmoperator == durand && b.tmoperator == durand &&
+               a.operator_options.durandoptions.spatial ==
+                   b.operator_options.durandoptions.spatial &&
+               a.operator_options.durandoptions.range ==
+                   b.operator_options.durandoptions.range;
+    }
+
+    void tonemapSweepFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
+                           pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Durand02", "tonemap");
+        if (!m_baseLayer) {
+            m_baseLayer.reset(new Durand02BaseLayer);
+        }
+        tonemap(workingframe, opts, m_baseLayer.get(), ph);
+    }
+
+    void tonemap(pfs::Frame &workingframe, TonemappingOptions *opts,
+                 Durand02BaseLayer *baseLayer, pfs::Progress &ph) {
         ph.setMaximum(100);
 
         try {
             pfstmo_durand02(workingframe,
                             opts->operator_options.durandoptions.spatial,
                             opts->operator_options.durandoptions.range,
-                            opts->operator_options.durandoptions.base, ph);
+                            opts->operator_options.durandoptions.base,
+                            baseLayer, ph);
         } catch (...) {
             throw std::runtime_error("Durand: Tonemap Failed");
         }
     }
+
+    std::unique_ptr<Durand02BaseLayer> m_baseLayer;
 };
 
 struct TonemapOperatorReinhard02
     : public TonemapOperatorRegister<reinhard02, TonemapOperatorReinhard02> {
     void tonemapFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
                       pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Reinhard02", "tonemap");
+        tonemap(workingframe, opts, NULL, ph);
+    }
+
+    void clearSweep() {
+        m_convolutions.reset();
+        TonemapOperator::clearSweep();
+    }
+
+    // the convolutions of the local version depend on the scales only
+    bool sharesIntermediates(const TonemappingOptions &a,
+                             const TonemappingOptions &b) const {
+        const auto &ra = a.operator_options.reinhard02options;
+        const auto &rb = b.operator_options.reinhard02options;
+        return a.tmoperator == reinhard02 && b.tmoperator == reinhard02 &&
+               ra.scales && rb.scales && ra.range == rb.range &&
+               ra.lower == rb.lower && ra.upper == rb.upper;
+    }
+
+   protected:
+    void tonemapSweepFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
+                           pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Reinhard02", "tonemap");
+        if (!m_convolutions) {
+            m_convolutions.reset(new Reinhard02Convolutions);
+        }
+        tonemap(workingframe, opts, m_convolutions.get(), ph);
+    }
+
+   private:
+    void tonemap(pfs::Frame &workingframe, TonemappingOptions *opts,
+                 Reinhard02Convolutions *convolutions, pfs::Progress &ph) {
         ph.setMaximum(100);
 
         // Convert to CS_XYZ: tm operator now use this colorspace
@@ -213,19 +321,23 @@ struct TonemapOperatorReinhard02
                 opts->operator_options.reinhard02options.range,
                 opts->operator_options.reinhard02options.lower,
                 opts->operator_options.reinhard02options.upper,
-                opts->operator_options.reinhard02options.scales, ph);
+                opts->operator_options.reinhard02options.scales,
+                convolutions, ph);
         } catch (...) {
             throw std::runtime_error("Reinhard02: Tonemap Failed");
         }
 
         pfs::transformColorSpace(pfs::CS_XYZ, X, Y, Z, pfs::CS_RGB, X, Y, Z);
     }
+
+    std::unique_ptr<Reinhard02Convolutions> m_convolutions;
 };
 
 struct TonemapOperatorReinhard05
     : public TonemapOperatorRegister<reinhard05, TonemapOperatorReinhard05> {
     void tonemapFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
                       pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Reinhard05", "tonemap");
         ph.setMaximum(100);
 
         try {
@@ -244,6 +356,7 @@ struct TonemapOperatorAshikhmin02
     : public TonemapOperatorRegister<ashikhmin, TonemapOperatorAshikhmin02> {
     void tonemapFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
                       pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Ashikhmin02", "tonemap");
         ph.setMaximum(100);
 
         try {
@@ -261,6 +374,7 @@ struct TonemapOperatorPattanaik00
     : public TonemapOperatorRegister<pattanaik, TonemapOperatorPattanaik00> {
     void tonemapFrame(pfs::Frame &workingframe, TonemappingOptions *opts,
                       pfs::Progress &ph) {
+        PFS_TRACE_SPAN("Pattanaik00", "tonemap");
         ph.setMaximum(100);
 
         // Convert to CS_XYZ: tm operator now use this colorspace
@@ -319,10 +433,40 @@ inline const TonemapOperatorCreatorMap &registry() {
     return reg;
 }
 
-TonemapOperator::TonemapOperator() {}
+TonemapOperator::TonemapOperator()
+    : m_sweepGeneration(0) {}
 
 TonemapOperator::~TonemapOperator() {}
 
+pfs::Frame *TonemapOperator::tonemapSweep(const pfs::Frame &input,
+                                          TonemappingOptions *opts,
+                                          pfs::Progress &ph) {
+    if (input.getGeneration() != m_sweepGeneration) {
+        clearSweep();
+        m_sweepGeneration = input.getGeneration();
+    }
+
+    // the channels are shared with the input until the operator writes them
+    std::unique_ptr<pfs::Frame> workingFrame(pfs::copy(&input));
+    tonemapSweepFrame(*workingFrame, opts, ph);
+    return workingFrame.release();
+}
+
+void TonemapOperator::clearSweep() {
+    m_sweepGeneration = 0;
+}
+
+bool TonemapOperator::sharesIntermediates(const TonemappingOptions &,
+                                          const TonemappingOptions &) const {
+    return false;
+}
+
+void TonemapOperator::tonemapSweepFrame(pfs::Frame &workingFrame,
+                                        TonemappingOptions *opts,
+                                        pfs::Progress &ph) {
+    tonemapFrame(workingFrame, opts, ph);
+}
+
 TonemapOperator *TonemapOperator::getTonemapOperator(const TMOperator tmo) {
     TonemapOperatorCreatorMap::const_iterator it = registry().find(tmo);
     if (it != registry().end()) {
@@ -32,7 +32,9 @@
 #ifndef TONEMAPOPERATOR_H
 #define TONEMAPOPERATOR_H
 
+#include <cstddef>
 #include <stdexcept>
+#include <stdint.h>
 
 #include "Core/TonemappingOptions.h"
 
@@ -60,8 +62,46 @@ class TonemapOperator {
     virtual void tonemapFrame(pfs::Frame &, TonemappingOptions *,
                               pfs::Progress &ph) = 0;
 
+    //!
+    //! Tonemap a copy of \a input, as one step of a sweep over several option
+    //! sets on the same input. The stages of the operator that do not depend
+    //! on the swept parameters (the gradient pyramid of Fattal, the base layer
+    //! of Durand, the convolutions of Reinhard02) run once: their results are
+    //! kept and reused by the next calls, as long as the input and the
+    //! parameters they depend on do not change.
+    //! \note \a input is not modified. It is recognized by its generation
+    //! (see \c pfs::Frame::getGeneration): a different frame, or the same
+    //! one handed out for writing meanwhile, starts the sweep over
+    //! \return the tonemapped frame
+    //!
+    pfs::Frame *tonemapSweep(const pfs::Frame &input, TonemappingOptions *opts,
+                             pfs::Progress &ph);
+
+    //!
+    //! Drop the intermediate results kept by \c tonemapSweep
+    //!
+    virtual void clearSweep();
+
+    //!
+    //! \return true if \c tonemapSweep reuses for \a b the intermediate
+    //! results computed for \a a
+    //!
+    virtual bool sharesIntermediates(const TonemappingOptions &a,
+                                     const TonemappingOptions &b) const;
+
    protected:
     TonemapOperator();
+
+    //!
+    //! Tonemap \a workingFrame, a copy of the input of the sweep, keeping the
+    //! intermediate results for the next call (the default does not keep any)
+    //!
+    virtual void tonemapSweepFrame(pfs::Frame &workingFrame,
+                                   TonemappingOptions *opts, pfs::Progress &ph);
+
+   private:
+    // generation of the input of the sweep in progress (0: none)
+    uint64_t m_sweepGeneration;
 };
 
 #endif  // TONEMAPOPERATOR_H
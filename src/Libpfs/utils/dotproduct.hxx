@@ -25,6 +25,7 @@
 #define PFS_UTILS_DOTPRODUCT_HXX
 
 #include <Libpfs/utils/dotproduct.h>
+#include <Libpfs/utils/parallel.h>
 
 namespace pfs {
 namespace utils {
@@ -32,7 +33,7 @@ namespace utils {
 template <typename _Type>
 _Type dotProduct(const _Type *v1, const _Type *v2, size_t N) {
     double dotProd = _Type();
-#pragma omp parallel for reduction(+ : dotProd)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) reduction(+ : dotProd)
     for (int idx = 0; idx < static_cast<int>(N); idx++) {
         dotProd = dotProd + (v1[idx] * v2[idx]);
     }
@@ -42,7 +43,7 @@ _Type dotProduct(const _Type *v1, const _Type *v2, size_t N) {
 template <typename _Type>
 _Type dotProduct(const _Type *v1, size_t N) {
     double dotProd = _Type();
-#pragma omp parallel for reduction(+ : dotProd)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) reduction(+ : dotProd)
     for (int idx = 0; idx < static_cast<int>(N); idx++) {
         dotProd = dotProd + (v1[idx] * v1[idx]);
     }
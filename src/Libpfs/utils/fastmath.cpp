@@ -0,0 +1,50 @@
+/*
+ * This file is a part of Luminance HDR package
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Branch free approximations of log2, exp2 and pow
+//! \author agent <agent@local>
+
+#include <Libpfs/utils/fastmath.h>
+
+#include <cmath>
+
+namespace pfs {
+namespace utils {
+
+float fastPowMaxError(float p, float lo, float hi, size_t samples) {
+    double maxError = 0.0;
+    for (size_t idx = 0; idx < samples; ++idx) {
+        const double x =
+            lo + (hi - lo) * idx / static_cast<double>(std::max<size_t>(
+                                        samples - 1, 1));
+        const double exact = std::pow(x, static_cast<double>(p));
+        if (exact < 1e-30) {
+            // outside the range of the relative error bound
+            continue;
+        }
+        const double approx = fastPow(static_cast<float>(x), p);
+        maxError = std::max(maxError, std::fabs(approx - exact) / exact);
+    }
+    return static_cast<float>(maxError);
+}
+
+}  // utils
+}  // pfs
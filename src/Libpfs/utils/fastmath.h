@@ -0,0 +1,105 @@
+/*
+ * This file is a part of Luminance HDR package
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Branch free approximations of log2, exp2 and pow
+//! \author agent <agent@local>
+//!
+//! Meant for the inner loops of the image kernels: they only use arithmetic
+//! and selects, so the loops calling them get vectorized. The relative error
+//! of \c fastPow is below 2e-6 for results in the normal float range, well
+//! under the quantization step of a 16 bits output.
+
+#ifndef PFS_UTILS_FASTMATH_H
+#define PFS_UTILS_FASTMATH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+
+namespace pfs {
+namespace utils {
+
+namespace detail {
+inline int32_t floatToInt32Bits(float f) {
+    int32_t i;
+    std::memcpy(&i, &f, sizeof(i));
+    return i;
+}
+
+inline float int32BitsToFloat(int32_t i) {
+    float f;
+    std::memcpy(&f, &i, sizeof(f));
+    return f;
+}
+}
+
+//! \brief log2(x), for x > 0 (absolute error below 1e-7)
+//! \note x = 0 returns about -127
+inline float fastLog2(float x) {
+    // x = 2^e * m, with m in [sqrt(0.5), sqrt(2))
+    const int32_t bits = detail::floatToInt32Bits(x);
+    const int32_t e = (bits - 0x3f3504f3) >> 23;
+    const float m = detail::int32BitsToFloat(bits - e * (1 << 23));
+
+    // ln(m) = 2 atanh(t)
+    const float t = (m - 1.f) / (m + 1.f);
+    const float t2 = t * t;
+    const float lnm =
+        t * (2.f +
+             t2 * (2.f / 3.f +
+                   t2 * (2.f / 5.f + t2 * (2.f / 7.f + t2 * (2.f / 9.f)))));
+    return static_cast<float>(e) + lnm * 1.44269504f;
+}
+
+//! \brief 2^y, with y clamped to [-126, 127] (relative error below 1e-7)
+inline float fastExp2(float y) {
+    y = std::min(std::max(y, -126.f), 127.f);
+
+    // y = n + f, with f in [-0.5, 0.5]: adding 1.5 * 2^23 rounds y to the
+    // nearest integer, which ends up in the low bits of the mantissa
+    const int32_t n = detail::floatToInt32Bits(y + 12582912.f) - 0x4b400000;
+    const float g = (y - static_cast<float>(n)) * 0.693147181f;
+    const float expg =
+        1.f +
+        g * (1.f +
+             g * (1.f / 2.f +
+                  g * (1.f / 6.f +
+                       g * (1.f / 24.f +
+                            g * (1.f / 120.f +
+                                 g * (1.f / 720.f + g * (1.f / 5040.f)))))));
+    return expg * detail::int32BitsToFloat((n + 127) << 23);
+}
+
+//! \brief x^p, for x >= 0
+//! \note x = 0 gives about 2^(-127 p) rather than 0: negligible after the
+//! quantization to 8 or 16 bits, but callers needing an exact 0 must select
+inline float fastPow(float x, float p) { return fastExp2(p * fastLog2(x)); }
+
+//! \brief largest relative error of \c fastPow(x, \a p) against \c std::pow,
+//! for \a samples values of x evenly spaced in [\a lo, \a hi]
+//! \note validation of the approximation, too slow for anything else
+float fastPowMaxError(float p, float lo, float hi, size_t samples);
+
+}  // utils
+}  // pfs
+
+#endif  // PFS_UTILS_FASTMATH_H
@@ -0,0 +1,127 @@
+/*
+ * This file is a part of Luminance HDR package
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+#include <Libpfs/utils/half.h>
+#include <Libpfs/utils/parallel.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define PFS_HAVE_F16C
+#endif
+
+namespace pfs {
+namespace utils {
+
+namespace {
+
+//! \brief values converted by a thread in one go
+const size_t CHUNK_SIZE = 16384;
+
+void floatToHalfScalar(const float *in, half_t *out, size_t size) {
+    for (size_t idx = 0; idx < size; ++idx) {
+        out[idx] = floatToHalf(in[idx]);
+    }
+}
+
+void halfToFloatScalar(const half_t *in, float *out, size_t size) {
+    for (size_t idx = 0; idx < size; ++idx) {
+        out[idx] = halfToFloat(in[idx]);
+    }
+}
+
+#ifdef PFS_HAVE_F16C
+__attribute__((target("avx,f16c"))) void floatToHalfF16C(const float *in,
+                                                          half_t *out,
+                                                          size_t size) {
+    size_t idx = 0;
+    for (; idx + 8 <= size; idx += 8) {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + idx),
+                                          _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + idx), h);
+    }
+    floatToHalfScalar(in + idx, out + idx, size - idx);
+}
+
+__attribute__((target("avx,f16c"))) void halfToFloatF16C(const half_t *in,
+                                                          float *out,
+                                                          size_t size) {
+    size_t idx = 0;
+    for (; idx + 8 <= size; idx += 8) {
+        const __m128i h =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + idx));
+        _mm256_storeu_ps(out + idx, _mm256_cvtph_ps(h));
+    }
+    halfToFloatScalar(in + idx, out + idx, size - idx);
+}
+
+bool detectF16C() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    // AVX also checks that the OS saves the YMM registers
+    __builtin_cpu_init();
+    return (ecx & bit_F16C) && __builtin_cpu_supports("avx");
+}
+
+const bool s_hasF16C = detectF16C();
+#endif
+
+template <typename In, typename Out>
+void convertChunks(const In *in, Out *out, size_t size,
+                   void (*convertRow)(const In *, Out *, size_t)) {
+    parallelFor(0, size, CHUNK_SIZE, [&](ptrdiff_t begin, ptrdiff_t end) {
+        convertRow(in + begin, out + begin, end - begin);
+    });
+}
+}
+
+void floatToHalfRow(const float *in, half_t *out, size_t size) {
+#ifdef PFS_HAVE_F16C
+    if (s_hasF16C) {
+        floatToHalfF16C(in, out, size);
+        return;
+    }
+#endif
+    floatToHalfScalar(in, out, size);
+}
+
+void halfToFloatRow(const half_t *in, float *out, size_t size) {
+#ifdef PFS_HAVE_F16C
+    if (s_hasF16C) {
+        halfToFloatF16C(in, out, size);
+        return;
+    }
+#endif
+    halfToFloatScalar(in, out, size);
+}
+
+void floatToHalf(const float *in, half_t *out, size_t size) {
+    convertChunks(in, out, size, &floatToHalfRow);
+}
+
+void halfToFloat(const half_t *in, float *out, size_t size) {
+    convertChunks(in, out, size, &halfToFloatRow);
+}
+
+}  // utils
+}  // pfs
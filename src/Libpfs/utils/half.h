@@ -0,0 +1,122 @@
+/*
+ * This file is a part of Luminance HDR package
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief IEEE 754 half precision conversion routines
+//! \author agent <agent@local>
+//! \note Scalar conversions derived from the public domain code of
+//! Fabian Giesen (https://gist.github.com/rygorous/2156668)
+
+#ifndef PFS_UTILS_HALF_H
+#define PFS_UTILS_HALF_H
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+
+namespace pfs {
+namespace utils {
+
+//! \brief raw bits of an IEEE 754 half precision number
+typedef uint16_t half_t;
+
+namespace detail {
+inline uint32_t floatBits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bitsFloat(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+}
+
+//! \brief convert \a value to half, rounding to nearest even
+inline half_t floatToHalf(float value) {
+    const uint32_t f32infty = 255u << 23;
+    const uint32_t f16max = (127u + 16u) << 23;
+    const uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+    uint32_t f = detail::floatBits(value);
+    const uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+
+    uint16_t o;
+    if (f >= f16max) {
+        // overflow to Inf, NaN stays NaN
+        o = (f > f32infty) ? 0x7e00 : 0x7c00;
+    } else if (f < (113u << 23)) {
+        // denormalized half: let the FPU do the rounding
+        o = static_cast<uint16_t>(
+            detail::floatBits(detail::bitsFloat(f) +
+                              detail::bitsFloat(denormMagic)) -
+            denormMagic);
+    } else {
+        const uint32_t mantOdd = (f >> 13) & 1u;
+        f += (static_cast<uint32_t>(15 - 127) << 23) + 0xfffu;
+        f += mantOdd;
+        o = static_cast<uint16_t>(f >> 13);
+    }
+    return static_cast<half_t>(o | (sign >> 16));
+}
+
+//! \brief convert \a value to float (exact)
+inline float halfToFloat(half_t value) {
+    const uint32_t shiftedExp = 0x7c00u << 13;
+    const float magic = detail::bitsFloat(113u << 23);
+
+    uint32_t o = (value & 0x7fffu) << 13;
+    const uint32_t exp = shiftedExp & o;
+    o += (127u - 15u) << 23;
+
+    if (exp == shiftedExp) {
+        // Inf/NaN
+        o += (128u - 16u) << 23;
+    } else if (exp == 0) {
+        // zero/denormal
+        o += 1u << 23;
+        o = detail::floatBits(detail::bitsFloat(o) - magic);
+    }
+    o |= (value & 0x8000u) << 16;
+    return detail::bitsFloat(o);
+}
+
+//! \brief convert \a size values from \a in into \a out
+void floatToHalf(const float *in, half_t *out, size_t size);
+
+//! \brief convert \a size values from \a in into \a out
+void halfToFloat(const half_t *in, float *out, size_t size);
+
+//! \brief convert a row (or a tile) of \a size values in the calling thread
+//! \note meant for loops that are already split among threads. On x86 the
+//! F16C instructions are used when the CPU has them
+void floatToHalfRow(const float *in, half_t *out, size_t size);
+
+//! \brief convert a row (or a tile) of \a size values in the calling thread
+//! \note see \c floatToHalfRow()
+void halfToFloatRow(const half_t *in, float *out, size_t size);
+
+}  // utils
+}  // pfs
+
+#endif  // PFS_UTILS_HALF_H
@@ -0,0 +1,94 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+#include <Libpfs/utils/mappedfile.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pfs {
+namespace utils {
+
+MappedFile::MappedFile(char *data, size_t size) : m_data(data), m_size(size) {}
+
+#if defined(_WIN32)
+
+MappedFilePtr MappedFile::map(FILE *file) {
+    HANDLE hFile = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+    if (hFile == INVALID_HANDLE_VALUE || GetFileType(hFile) != FILE_TYPE_DISK) {
+        return MappedFilePtr();
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart <= 0) {
+        return MappedFilePtr();
+    }
+
+    HANDLE hMapping =
+        CreateFileMapping(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (hMapping == NULL) {
+        return MappedFilePtr();
+    }
+    void *data = MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+    // the view keeps a reference to the mapping object
+    CloseHandle(hMapping);
+    if (data == NULL) {
+        return MappedFilePtr();
+    }
+
+    return MappedFilePtr(new MappedFile(static_cast<char *>(data),
+                                        static_cast<size_t>(fileSize.QuadPart)));
+}
+
+MappedFile::~MappedFile() { UnmapViewOfFile(m_data); }
+
+#else
+
+MappedFilePtr MappedFile::map(FILE *file) {
+    int fd = fileno(file);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        return MappedFilePtr();
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                      fd, 0);
+    if (data == MAP_FAILED) {
+        return MappedFilePtr();
+    }
+
+    return MappedFilePtr(
+        new MappedFile(static_cast<char *>(data), st.st_size));
+}
+
+MappedFile::~MappedFile() { munmap(m_data, m_size); }
+
+#endif
+
+}  // utils
+}  // pfs
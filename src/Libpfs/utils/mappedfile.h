@@ -0,0 +1,69 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+#ifndef PFS_UTILS_MAPPEDFILE_H
+#define PFS_UTILS_MAPPEDFILE_H
+
+//! \file mappedfile.h
+//! \brief Memory mapping of regular files
+//! \author agent <agent@local>
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+
+namespace pfs {
+namespace utils {
+
+class MappedFile;
+typedef std::shared_ptr<MappedFile> MappedFilePtr;
+
+//! \brief Private (copy-on-write) memory mapping of a whole regular file.
+//! Pages are loaded on demand when first touched; pages that get written are
+//! duplicated by the OS, so the file on disk is never modified.
+class MappedFile {
+   public:
+    //! \brief map the file behind \a file
+    //! \return an empty pointer if \a file cannot be mapped (i.e. pipes,
+    //! terminals, empty files or platforms without mmap support)
+    static MappedFilePtr map(FILE *file);
+
+    ~MappedFile();
+
+    char *data() { return m_data; }
+    const char *data() const { return m_data; }
+
+    size_t size() const { return m_size; }
+
+   private:
+    MappedFile(char *data, size_t size);
+
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    char *m_data;
+    size_t m_size;
+};
+
+}  // utils
+}  // pfs
+
+#endif  // PFS_UTILS_MAPPEDFILE_H
@@ -28,6 +28,8 @@
 #include <functional>
 #include <numeric>
 
+#include <Libpfs/utils/parallel.h>
+
 namespace pfs {
 namespace utils {
 
@@ -36,7 +38,7 @@ namespace detail {
 template <typename _Type, typename _Op>
 inline void op(const _Type *A, const _Type *B, _Type *C, size_t size,
                const _Op &currOp) {
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < static_cast<int>(size); idx++) {
         C[idx] = currOp(A[idx], B[idx]);
     }
@@ -47,7 +49,7 @@ inline void op(const _Type *A, const _Type *B, _Type *C, size_t size,
 template <typename _Type>
 void vmul(const _Type *A, const _Type *B, _Type *C, size_t size) {
 // detail::op(A, B, C, size, std::multiplies<_Type>());
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < static_cast<int>(size); idx++) {
         (*C)(idx) = (*A)(idx) * (*B)(idx);
     }
@@ -61,7 +63,7 @@ void vdiv(const _Type *A, const _Type *B, _Type *C, size_t size) {
 template <typename _Type>
 void vadd(const _Type *A, const _Type *B, _Type *C, size_t size) {
 // detail::op(A, B, C, size, std::plus<_Type>());
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < static_cast<int>(size); idx++) {
         (*C)(idx) = (*A)(idx) + (*B)(idx);
     }
@@ -69,7 +71,7 @@ void vadd(const _Type *A, const _Type *B, _Type *C, size_t size) {
 
 template <typename _Type>
 void vsadd(const _Type *A, const float s, _Type *B, size_t size) {
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < static_cast<int>(size); idx++) {
         B[idx] = A[idx] + s;
     }
@@ -94,7 +96,7 @@ void vsubs(const _Type *A, const _Type &s, const _Type *B, _Type *C,
 
 template <typename _Type>
 void vsmul(const _Type *I, const float c, _Type *O, size_t size) {
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < static_cast<int>(size); idx++) {
         O[idx] = c * I[idx];
     }
@@ -102,7 +104,7 @@ void vsmul(const _Type *I, const float c, _Type *O, size_t size) {
 
 template <typename _Type>
 void vsum_scalar(const _Type *I, const float c, _Type *O, size_t size) {
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < static_cast<int>(size); idx++) {
         (*O)(idx) = c + (*I)(idx);
     }
@@ -110,7 +112,7 @@ void vsum_scalar(const _Type *I, const float c, _Type *O, size_t size) {
 
 template <typename _Type>
 void vmul_scalar(const _Type *I, const float c, _Type *O, size_t size) {
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < static_cast<int>(size); idx++) {
         (*O)(idx) = c * (*I)(idx);
     }
@@ -118,7 +120,7 @@ void vmul_scalar(const _Type *I, const float c, _Type *O, size_t size) {
 
 template <typename _Type>
 void vdiv_scalar(const _Type *I, const float c, _Type *O, size_t size) {
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < static_cast<int>(size); idx++) {
         (*O)(idx) = c / (*I)(idx);
     }
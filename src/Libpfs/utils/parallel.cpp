@@ -0,0 +1,72 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+#include <Libpfs/utils/parallel.h>
+
+#include <atomic>
+#include <thread>
+
+namespace pfs {
+namespace utils {
+
+namespace {
+size_t processors() {
+#ifdef _OPENMP
+    return static_cast<size_t>(omp_get_num_procs());
+#else
+    return std::max(std::thread::hardware_concurrency(), 1u);
+#endif
+}
+
+std::atomic<size_t> s_concurrency(processors());
+std::atomic<size_t> s_jobs(0);
+}
+
+size_t getConcurrency() { return s_concurrency.load(); }
+
+void setConcurrency(size_t threads) {
+    s_concurrency = (threads == 0) ? processors() : threads;
+    applyConcurrency();
+}
+
+size_t getThreadsPerJob() {
+    const size_t jobs = std::max<size_t>(s_jobs.load(), 1);
+    return std::max<size_t>(s_concurrency.load() / jobs, 1);
+}
+
+void applyConcurrency() {
+#ifdef _OPENMP
+    omp_set_num_threads(static_cast<int>(getThreadsPerJob()));
+#endif
+}
+
+ConcurrentJob::ConcurrentJob() {
+    ++s_jobs;
+    applyConcurrency();
+}
+
+ConcurrentJob::~ConcurrentJob() {
+    --s_jobs;
+    applyConcurrency();
+}
+
+}  // utils
+}  // pfs
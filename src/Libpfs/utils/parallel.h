@@ -0,0 +1,218 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Process-wide concurrency limit and parallel loops
+//! \author agent <agent@local>
+//!
+//! OpenMP does the work, but every parallel region is sized against a
+//! single budget of threads. Concurrent jobs (batch tonemapping threads,
+//! files loaded in parallel) declare themselves with \c ConcurrentJob and
+//! split the budget among them, so that job-level and pixel-level
+//! parallelism do not multiply. \c parallelFor called from inside another
+//! parallel loop does not start a new team: its chunks become tasks run by
+//! the threads of the enclosing one.
+//! The overloads taking a \c Progress check it before each chunk: once the
+//! operation is canceled, the chunks not started yet are skipped.
+
+#ifndef PFS_UTILS_PARALLEL_H
+#define PFS_UTILS_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include <Libpfs/progress.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pfs {
+namespace utils {
+
+//! \brief number of threads available to the whole process
+size_t getConcurrency();
+
+//! \brief set the number of threads available to the whole process
+//! (0 means one per processor)
+void setConcurrency(size_t threads);
+
+//! \brief number of threads a parallel region started now by the calling
+//! thread should use: the budget split among the running jobs
+size_t getThreadsPerJob();
+
+//! \brief size the default OpenMP team of the calling thread to
+//! \c getThreadsPerJob()
+//! \note the setting is per thread and is not refreshed when other jobs
+//! start: \c "omp parallel" regions pass
+//! \c num_threads(pfs::utils::getThreadsPerJob()) explicitly
+void applyConcurrency();
+
+//! \brief declares that the calling thread runs one of several concurrent
+//! jobs for the lifetime of the object
+class ConcurrentJob {
+   public:
+    ConcurrentJob();
+    ~ConcurrentJob();
+
+   private:
+    ConcurrentJob(const ConcurrentJob &);
+    ConcurrentJob &operator=(const ConcurrentJob &);
+};
+
+//! \brief call \a func(chunkBegin, chunkEnd) on chunks of at most \a grain
+//! elements covering [\a begin, \a end), in parallel
+template <typename Func>
+void parallelFor(ptrdiff_t begin, ptrdiff_t end, ptrdiff_t grain, Func func) {
+    grain = std::max<ptrdiff_t>(grain, 1);
+    const ptrdiff_t chunks = (end - begin + grain - 1) / grain;
+    if (chunks <= 1) {
+        if (end > begin) {
+            func(begin, end);
+        }
+        return;
+    }
+
+#ifdef _OPENMP
+    if (omp_in_parallel()) {
+#if _OPENMP >= 201511
+        // nested call: the threads of the enclosing team pick up the chunks
+        // while they wait at its barriers
+#pragma omp taskloop grainsize(1)
+        for (ptrdiff_t c = 0; c < chunks; ++c) {
+            const ptrdiff_t first = begin + c * grain;
+            func(first, std::min(first + grain, end));
+        }
+        return;
+#endif
+    } else {
+        const int threads =
+            static_cast<int>(std::min<size_t>(chunks, getThreadsPerJob()));
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+        for (ptrdiff_t c = 0; c < chunks; ++c) {
+            const ptrdiff_t first = begin + c * grain;
+            func(first, std::min(first + grain, end));
+        }
+        return;
+    }
+#endif
+
+    for (ptrdiff_t c = 0; c < chunks; ++c) {
+        const ptrdiff_t first = begin + c * grain;
+        func(first, std::min(first + grain, end));
+    }
+}
+
+//! \brief \c parallelFor() reporting to \a progress, whose value goes from
+//! \a fromValue to \a toValue as the chunks complete
+//! \return false if the operation has been canceled: some chunks may not
+//! have been processed
+template <typename Func>
+bool parallelFor(ptrdiff_t begin, ptrdiff_t end, ptrdiff_t grain,
+                 Progress &progress, int fromValue, int toValue, Func func) {
+    grain = std::max<ptrdiff_t>(grain, 1);
+    const ptrdiff_t chunks =
+        std::max<ptrdiff_t>((end - begin + grain - 1) / grain, 1);
+
+    // the chunks are counted and reported under the same lock, so that the
+    // value never goes backwards; it is only set when it changes
+    std::mutex reportMutex;
+    ptrdiff_t done = 0;
+    int reported = fromValue;
+    progress.setValue(fromValue);
+
+    parallelFor(begin, end, grain, [&](ptrdiff_t first, ptrdiff_t last) {
+        if (progress.canceled()) {
+            return;
+        }
+        func(first, last);
+
+        std::lock_guard<std::mutex> lock(reportMutex);
+        const int value = static_cast<int>(
+            fromValue + (toValue - fromValue) * (++done) / chunks);
+        if (value != reported) {
+            reported = value;
+            progress.setValue(value);
+        }
+    });
+    return !progress.canceled();
+}
+
+//! \brief reduce [\a begin, \a end): \a func(chunkBegin, chunkEnd) returns
+//! the partial result of a chunk, \a reduce(a, b) combines two of them
+//! \note the partial results are combined in order, so the result does not
+//! depend on the number of threads
+template <typename Type, typename Func, typename Reduce>
+Type parallelReduce(ptrdiff_t begin, ptrdiff_t end, ptrdiff_t grain,
+                    const Type &identity, Func func, Reduce reduce) {
+    grain = std::max<ptrdiff_t>(grain, 1);
+    const ptrdiff_t chunks =
+        std::max<ptrdiff_t>((end - begin + grain - 1) / grain, 0);
+
+    std::vector<Type> partial(chunks, identity);
+    parallelFor(0, chunks, 1, [&](ptrdiff_t first, ptrdiff_t last) {
+        for (ptrdiff_t c = first; c < last; ++c) {
+            const ptrdiff_t from = begin + c * grain;
+            partial[c] = func(from, std::min(from + grain, end));
+        }
+    });
+
+    Type result = identity;
+    for (ptrdiff_t c = 0; c < chunks; ++c) {
+        result = reduce(result, partial[c]);
+    }
+    return result;
+}
+
+//! \brief \c parallelReduce() reporting to \a progress, whose value goes
+//! from \a fromValue to \a toValue as the chunks complete
+//! \note once the operation is canceled the chunks not started yet are
+//! skipped, and count as \a identity: check \a progress before using the
+//! result
+template <typename Type, typename Func, typename Reduce>
+Type parallelReduce(ptrdiff_t begin, ptrdiff_t end, ptrdiff_t grain,
+                    Progress &progress, int fromValue, int toValue,
+                    const Type &identity, Func func, Reduce reduce) {
+    grain = std::max<ptrdiff_t>(grain, 1);
+    const ptrdiff_t chunks =
+        std::max<ptrdiff_t>((end - begin + grain - 1) / grain, 0);
+
+    std::vector<Type> partial(chunks, identity);
+    parallelFor(0, chunks, 1, progress, fromValue, toValue,
+                [&](ptrdiff_t first, ptrdiff_t last) {
+                    for (ptrdiff_t c = first; c < last; ++c) {
+                        const ptrdiff_t from = begin + c * grain;
+                        partial[c] = func(from, std::min(from + grain, end));
+                    }
+                });
+
+    Type result = identity;
+    for (ptrdiff_t c = 0; c < chunks; ++c) {
+        result = reduce(result, partial[c]);
+    }
+    return result;
+}
+
+}  // utils
+}  // pfs
+
+#endif  // PFS_UTILS_PARALLEL_H
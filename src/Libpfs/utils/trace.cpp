@@ -0,0 +1,242 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Runtime tracing of the processing stages
+//! \author agent <agent@local>
+
+#include <Libpfs/utils/trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+namespace pfs {
+namespace utils {
+namespace trace {
+
+namespace detail {
+std::atomic<bool> s_enabled(false);
+}
+
+namespace {
+//! \brief events kept per thread: about 32 MB, well above what a session
+//! produces, but a bound for a trace left enabled
+const size_t MAX_EVENTS_PER_THREAD = 1 << 20;
+
+const std::chrono::steady_clock::time_point s_origin =
+    std::chrono::steady_clock::now();
+
+struct ThreadBuffer {
+    explicit ThreadBuffer(int id_) : id(id_) {}
+
+    std::mutex mutex;
+    std::vector<Event> events;
+    const int id;
+};
+
+typedef std::shared_ptr<ThreadBuffer> ThreadBufferPtr;
+
+//! \brief the buffers of all the threads that recorded a span, kept after
+//! the threads exit
+struct Registry {
+    Registry() : dropped(0) {}
+
+    std::mutex mutex;
+    std::vector<ThreadBufferPtr> buffers;
+    std::atomic<size_t> dropped;
+};
+
+Registry &registry() {
+    // never destroyed: the trace is usually written by an exit handler
+    static Registry *s_registry = new Registry;
+    return *s_registry;
+}
+
+ThreadBuffer &localBuffer() {
+    thread_local ThreadBufferPtr s_buffer;
+    if (!s_buffer) {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        s_buffer = std::make_shared<ThreadBuffer>(
+            static_cast<int>(r.buffers.size()));
+        r.buffers.push_back(s_buffer);
+    }
+    return *s_buffer;
+}
+
+bool beginsBefore(const Event &a, const Event &b) { return a.begin < b.begin; }
+
+void writeEscaped(std::ostream &out, const char *str) {
+    out << '"';
+    for (; *str; ++str) {
+        const unsigned char c = static_cast<unsigned char>(*str);
+        if (c == '"' || c == '\\') {
+            out << '\\' << *str;
+        } else if (c < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                << static_cast<int>(c) << std::dec << std::setfill(' ');
+        } else {
+            out << *str;
+        }
+    }
+    out << '"';
+}
+
+struct Stats {
+    Stats() : category(""), count(0), total(0), max(0) {}
+
+    const char *category;
+    size_t count;
+    int64_t total;
+    int64_t max;
+};
+
+typedef std::pair<std::string, Stats> NamedStats;
+
+bool moreExpensive(const NamedStats &a, const NamedStats &b) {
+    return a.second.total > b.second.total;
+}
+}
+
+namespace detail {
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - s_origin)
+        .count();
+}
+
+void record(const char *name, const char *category, int64_t begin,
+            int64_t end) {
+    ThreadBuffer &buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() >= MAX_EVENTS_PER_THREAD) {
+        ++registry().dropped;
+        return;
+    }
+    Event event = {name, category, begin, end - begin, buffer.id};
+    buffer.events.push_back(event);
+}
+}
+
+void setEnabled(bool enabled) { detail::s_enabled = enabled; }
+
+void clear() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (size_t idx = 0; idx < r.buffers.size(); ++idx) {
+        std::lock_guard<std::mutex> bufferLock(r.buffers[idx]->mutex);
+        r.buffers[idx]->events.clear();
+    }
+    r.dropped = 0;
+}
+
+int threadId() { return localBuffer().id; }
+
+std::vector<Event> events() {
+    std::vector<Event> all;
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (size_t idx = 0; idx < r.buffers.size(); ++idx) {
+            std::lock_guard<std::mutex> bufferLock(r.buffers[idx]->mutex);
+            all.insert(all.end(), r.buffers[idx]->events.begin(),
+                       r.buffers[idx]->events.end());
+        }
+    }
+    std::stable_sort(all.begin(), all.end(), beginsBefore);
+    return all;
+}
+
+size_t dropped() { return registry().dropped.load(); }
+
+void writeChromeTrace(std::ostream &out) {
+    const std::vector<Event> all = events();
+
+    // timestamps in microseconds, as the format requires
+    out << "{\"traceEvents\":[" << std::fixed << std::setprecision(3);
+    for (size_t idx = 0; idx < all.size(); ++idx) {
+        const Event &e = all[idx];
+        out << (idx ? ",\n" : "\n") << "{\"name\":";
+        writeEscaped(out, e.name);
+        out << ",\"cat\":";
+        writeEscaped(out, e.category);
+        out << ",\"ph\":\"X\",\"ts\":" << e.begin / 1000.0
+            << ",\"dur\":" << e.duration / 1000.0
+            << ",\"pid\":1,\"tid\":" << e.thread << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":"
+        << dropped() << "}}\n";
+}
+
+bool writeChromeTrace(const std::string &filename) {
+    std::ofstream out(filename.c_str());
+    if (!out) {
+        return false;
+    }
+    writeChromeTrace(out);
+    return static_cast<bool>(out);
+}
+
+void writeSummary(std::ostream &out) {
+    const std::vector<Event> all = events();
+
+    std::map<std::string, Stats> byName;
+    for (size_t idx = 0; idx < all.size(); ++idx) {
+        Stats &stats = byName[all[idx].name];
+        stats.category = all[idx].category;
+        ++stats.count;
+        stats.total += all[idx].duration;
+        stats.max = std::max(stats.max, all[idx].duration);
+    }
+    std::vector<NamedStats> sorted(byName.begin(), byName.end());
+    std::stable_sort(sorted.begin(), sorted.end(), moreExpensive);
+
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::left << std::setw(32) << "span" << std::setw(12)
+        << "category" << std::right << std::setw(8) << "count"
+        << std::setw(12) << "total ms" << std::setw(12) << "mean ms"
+        << std::setw(12) << "max ms" << "\n";
+    out << std::fixed << std::setprecision(3);
+    for (size_t idx = 0; idx < sorted.size(); ++idx) {
+        const Stats &stats = sorted[idx].second;
+        out << std::left << std::setw(32) << sorted[idx].first
+            << std::setw(12) << stats.category << std::right
+            << std::setw(8) << stats.count << std::setw(12)
+            << stats.total / 1e6 << std::setw(12)
+            << stats.total / 1e6 / stats.count << std::setw(12)
+            << stats.max / 1e6 << "\n";
+    }
+    if (dropped()) {
+        out << dropped() << " events dropped\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+}  // trace
+}  // utils
+}  // pfs
@@ -0,0 +1,135 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+//! \brief Runtime tracing of the processing stages
+//! \author agent <agent@local>
+//!
+//! A \c Span measures the scope it lives in: when it goes out of scope, its
+//! name, category, start time, duration and thread are appended to a buffer
+//! owned by the calling thread. Tracing is off by default, and a disabled
+//! span costs a relaxed atomic load. The events recorded so far can be
+//! exported as Chrome trace-event JSON (chrome://tracing, Perfetto) or
+//! aggregated by name into a summary table.
+//! Names and categories are not copied: they must be string literals (or
+//! otherwise outlive the trace).
+
+#ifndef PFS_UTILS_TRACE_H
+#define PFS_UTILS_TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace pfs {
+namespace utils {
+namespace trace {
+
+namespace detail {
+extern std::atomic<bool> s_enabled;
+
+int64_t now();
+void record(const char *name, const char *category, int64_t begin,
+            int64_t end);
+}
+
+//! \brief one completed span, times in nanoseconds from the start of the
+//! process
+struct Event {
+    const char *name;
+    const char *category;
+    int64_t begin;
+    int64_t duration;
+    int thread;
+};
+
+//! \brief true if the spans are being recorded
+inline bool isEnabled() {
+    return detail::s_enabled.load(std::memory_order_relaxed);
+}
+
+//! \brief start or stop recording the spans (the events recorded so far are
+//! kept)
+void setEnabled(bool enabled);
+
+//! \brief discard the events recorded so far
+void clear();
+
+//! \brief sequential id of the calling thread, as written in the trace
+int threadId();
+
+//! \brief copy of the events recorded so far, sorted by start time
+std::vector<Event> events();
+
+//! \brief number of events discarded because the buffer of their thread was
+//! full
+size_t dropped();
+
+//! \brief write the events in the Chrome trace-event JSON format
+void writeChromeTrace(std::ostream &out);
+
+//! \brief write the events in the Chrome trace-event JSON format to
+//! \a filename
+//! \return false if the file could not be written
+bool writeChromeTrace(const std::string &filename);
+
+//! \brief write the count, total, mean and maximum duration of the spans,
+//! grouped by name, the most expensive first
+void writeSummary(std::ostream &out);
+
+//! \brief records the time spent in its scope
+class Span {
+   public:
+    Span(const char *name, const char *category)
+        : m_name(isEnabled() ? name : NULL),
+          m_category(category),
+          m_begin(m_name ? detail::now() : 0) {}
+
+    ~Span() {
+        if (m_name) {
+            detail::record(m_name, m_category, m_begin, detail::now());
+        }
+    }
+
+   private:
+    Span(const Span &);
+    Span &operator=(const Span &);
+
+    const char *m_name;
+    const char *m_category;
+    int64_t m_begin;
+};
+
+}  // trace
+}  // utils
+}  // pfs
+
+#define PFS_TRACE_CONCAT_(a, b) a##b
+#define PFS_TRACE_CONCAT(a, b) PFS_TRACE_CONCAT_(a, b)
+
+//! \brief trace the rest of the enclosing scope as \a name
+#define PFS_TRACE_SPAN(name, category) \
+    ::pfs::utils::trace::Span PFS_TRACE_CONCAT(pfsTraceSpan, __LINE__)( \
+        name, category)
+
+#endif  // PFS_UTILS_TRACE_H
@@ -25,6 +25,8 @@
 #ifndef PFS_COLORSPACE_TRANSFORM_H
 #define PFS_COLORSPACE_TRANSFORM_H
 
+#include <Libpfs/array2dview.h>
+
 namespace pfs {
 namespace utils {
 
@@ -52,6 +54,23 @@ void transform(InputIterator in1, InputIterator in1End, InputIterator in2,
                InputIterator in3, OutputIterator out1,
                ConversionOperator convOp);
 
+//! \brief 3 components to 3 components transform function over views
+//! (of the same size), processed row by row
+template <typename InputType, typename OutputType, typename ConversionOperator>
+void transform(const Array2DView<InputType> &in1,
+               const Array2DView<InputType> &in2,
+               const Array2DView<InputType> &in3,
+               const Array2DView<OutputType> &out1,
+               const Array2DView<OutputType> &out2,
+               const Array2DView<OutputType> &out3, ConversionOperator convOp);
+
+//! \brief 3 components to 1 component transform function over views
+template <typename InputType, typename OutputType, typename ConversionOperator>
+void transform(const Array2DView<InputType> &in1,
+               const Array2DView<InputType> &in2,
+               const Array2DView<InputType> &in3,
+               const Array2DView<OutputType> &out1, ConversionOperator convOp);
+
 }  // utils
 }  // pfs
 
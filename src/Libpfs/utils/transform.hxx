@@ -30,6 +30,8 @@
 #include <cassert>
 #include <iterator>
 
+#include <Libpfs/utils/parallel.h>
+
 namespace pfs {
 namespace utils {
 
@@ -58,7 +60,7 @@ void transform(InputIterator in1, InputIterator in1End, InputIterator in2,
                std::random_access_iterator_tag) {
     typename std::iterator_traits<InputIterator>::difference_type numElem =
         (in1End - in1);
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < numElem; ++idx) {
         convOp(in1[idx], in2[idx], in3[idx], out1[idx], out2[idx], out3[idx]);
     }
@@ -103,7 +105,7 @@ void transform(InputIterator in1, InputIterator in1End, InputIterator in2,
                std::random_access_iterator_tag) {
     typename std::iterator_traits<InputIterator>::difference_type numElem =
         (in1End - in1);
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < numElem; ++idx) {
         convOp(in1[idx], in2[idx], in3[idx], in4[idx], out1[idx], out2[idx],
                out3[idx]);
@@ -148,7 +150,7 @@ void transform(InputIterator in1, InputIterator in1End, InputIterator in2,
                std::random_access_iterator_tag) {
     typename std::iterator_traits<InputIterator>::difference_type numElem =
         (in1End - in1);
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < numElem; ++idx) {
         convOp(in1[idx], in2[idx], in3[idx], out[idx]);
     }
@@ -168,6 +170,54 @@ void transform(InputIterator in1, InputIterator in1End, InputIterator in2,
         typename std::iterator_traits<OutputIterator>::iterator_category());
 }
 
+template <typename InputType, typename OutputType, typename ConversionOperator>
+void transform(const Array2DView<InputType> &in1,
+               const Array2DView<InputType> &in2,
+               const Array2DView<InputType> &in3,
+               const Array2DView<OutputType> &out1,
+               const Array2DView<OutputType> &out2,
+               const Array2DView<OutputType> &out3, ConversionOperator convOp) {
+    assert(in1.getCols() == out1.getCols());
+    assert(in1.getRows() == out1.getRows());
+
+    const size_t cols = in1.getCols();
+    const int rows = static_cast<int>(in1.getRows());
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
+    for (int r = 0; r < rows; ++r) {
+        InputType *i1 = in1.row_begin(r);
+        InputType *i2 = in2.row_begin(r);
+        InputType *i3 = in3.row_begin(r);
+        OutputType *o1 = out1.row_begin(r);
+        OutputType *o2 = out2.row_begin(r);
+        OutputType *o3 = out3.row_begin(r);
+        for (size_t c = 0; c < cols; ++c) {
+            convOp(i1[c], i2[c], i3[c], o1[c], o2[c], o3[c]);
+        }
+    }
+}
+
+template <typename InputType, typename OutputType, typename ConversionOperator>
+void transform(const Array2DView<InputType> &in1,
+               const Array2DView<InputType> &in2,
+               const Array2DView<InputType> &in3,
+               const Array2DView<OutputType> &out1, ConversionOperator convOp) {
+    assert(in1.getCols() == out1.getCols());
+    assert(in1.getRows() == out1.getRows());
+
+    const size_t cols = in1.getCols();
+    const int rows = static_cast<int>(in1.getRows());
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
+    for (int r = 0; r < rows; ++r) {
+        InputType *i1 = in1.row_begin(r);
+        InputType *i2 = in2.row_begin(r);
+        InputType *i3 = in3.row_begin(r);
+        OutputType *o1 = out1.row_begin(r);
+        for (size_t c = 0; c < cols; ++c) {
+            convOp(i1[c], i2[c], i3[c], o1[c]);
+        }
+    }
+}
+
 }  // utils
 }  // pfs
 
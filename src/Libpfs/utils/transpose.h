@@ -0,0 +1,59 @@
+/*
+* This file is a part of Luminance HDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*  Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*/
+
+#ifndef PFS_UTILS_TRANSPOSE_H
+#define PFS_UTILS_TRANSPOSE_H
+
+#include <cstddef>
+
+//! \file transpose.h
+//! \brief Cache blocked transposition of 2D arrays
+//! \author agent <agent@local>
+//!
+//! Reading or writing an image along its columns touches a different cache
+//! line (and often a different memory page) for every sample. These
+//! functions move square tiles small enough to stay in cache instead, and
+//! transpose 4x4 blocks of floats inside SSE registers.
+
+namespace pfs {
+namespace utils {
+
+//! \brief side of the tiles, in samples
+const size_t TRANSPOSE_BLOCK = 64;
+
+//! \brief Write the transposition of the \c rows x \c cols matrix \c in into
+//! \c out (\c cols x \c rows), multithreaded:
+//! out[c * outStride + r] = in[r * inStride + c]
+//! \note strides are in samples and can be negative, so that the rows of the
+//! input or the output can be visited bottom up (which gives rotations)
+template <typename Type>
+void transpose(const Type *in, std::ptrdiff_t inStride, Type *out,
+               std::ptrdiff_t outStride, size_t cols, size_t rows);
+
+//! \brief Transpose the contiguous \c rows x \c cols matrix \c in into \c out
+template <typename Type>
+void transpose(const Type *in, Type *out, size_t cols, size_t rows);
+
+}  // utils
+}  // pfs
+
+#include <Libpfs/utils/transpose.hxx>
+#endif  // PFS_UTILS_TRANSPOSE_H
@@ -0,0 +1,122 @@
+/*
+* This file is a part of Luminance HDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*  Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*/
+
+//! \author agent <agent@local>
+
+#ifndef PFS_UTILS_TRANSPOSE_HXX
+#define PFS_UTILS_TRANSPOSE_HXX
+
+#include <Libpfs/utils/transpose.h>
+
+#include <algorithm>
+
+#include <Libpfs/utils/parallel.h>
+
+#ifdef __SSE2__
+#include <xmmintrin.h>
+#endif
+
+namespace pfs {
+namespace utils {
+namespace detail {
+
+//! \brief transposition of a tile (small enough to stay in cache)
+template <typename Type>
+inline void transposeTile(const Type *in, std::ptrdiff_t inStride, Type *out,
+                          std::ptrdiff_t outStride, size_t cols, size_t rows) {
+    for (std::ptrdiff_t r = 0; r < static_cast<std::ptrdiff_t>(rows); ++r) {
+        const Type *src = in + r * inStride;
+        for (std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t>(cols);
+             ++c) {
+            out[c * outStride + r] = src[c];
+        }
+    }
+}
+
+#ifdef __SSE2__
+inline void transposeTile(const float *in, std::ptrdiff_t inStride,
+                          float *out, std::ptrdiff_t outStride, size_t cols,
+                          size_t rows) {
+    const std::ptrdiff_t cols4 = static_cast<std::ptrdiff_t>(cols & ~size_t(3));
+    const std::ptrdiff_t rows4 = static_cast<std::ptrdiff_t>(rows & ~size_t(3));
+
+    for (std::ptrdiff_t r = 0; r < rows4; r += 4) {
+        const float *src = in + r * inStride;
+        for (std::ptrdiff_t c = 0; c < cols4; c += 4) {
+            __m128 row0 = _mm_loadu_ps(src + c);
+            __m128 row1 = _mm_loadu_ps(src + inStride + c);
+            __m128 row2 = _mm_loadu_ps(src + 2 * inStride + c);
+            __m128 row3 = _mm_loadu_ps(src + 3 * inStride + c);
+
+            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+            float *dst = out + c * outStride + r;
+            _mm_storeu_ps(dst, row0);
+            _mm_storeu_ps(dst + outStride, row1);
+            _mm_storeu_ps(dst + 2 * outStride, row2);
+            _mm_storeu_ps(dst + 3 * outStride, row3);
+        }
+    }
+
+    // borders
+    if (cols4 < static_cast<std::ptrdiff_t>(cols)) {
+        transposeTile<float>(in + cols4, inStride, out + cols4 * outStride,
+                             outStride, cols - cols4, rows);
+    }
+    if (rows4 < static_cast<std::ptrdiff_t>(rows)) {
+        transposeTile<float>(in + rows4 * inStride, inStride, out + rows4,
+                             outStride, cols4, rows - rows4);
+    }
+}
+#endif  // __SSE2__
+
+}  // detail
+
+template <typename Type>
+void transpose(const Type *in, std::ptrdiff_t inStride, Type *out,
+               std::ptrdiff_t outStride, size_t cols, size_t rows) {
+    const int rowTiles =
+        static_cast<int>((rows + TRANSPOSE_BLOCK - 1) / TRANSPOSE_BLOCK);
+    const int colTiles =
+        static_cast<int>((cols + TRANSPOSE_BLOCK - 1) / TRANSPOSE_BLOCK);
+
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(static)
+    for (int tile = 0; tile < rowTiles * colTiles; ++tile) {
+        const std::ptrdiff_t r = (tile / colTiles) * TRANSPOSE_BLOCK;
+        const std::ptrdiff_t c = (tile % colTiles) * TRANSPOSE_BLOCK;
+
+        detail::transposeTile(in + r * inStride + c, inStride,
+                              out + c * outStride + r, outStride,
+                              std::min(TRANSPOSE_BLOCK, cols - c),
+                              std::min(TRANSPOSE_BLOCK, rows - r));
+    }
+}
+
+template <typename Type>
+void transpose(const Type *in, Type *out, size_t cols, size_t rows) {
+    transpose(in, static_cast<std::ptrdiff_t>(cols), out,
+              static_cast<std::ptrdiff_t>(rows), cols, rows);
+}
+
+}  // utils
+}  // pfs
+
+#endif  // PFS_UTILS_TRANSPOSE_HXX
@@ -25,7 +25,14 @@
  *
  */
 
+#include <QAtomicInt>
 #include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
 #include <QTimer>
 #include <boost/program_options.hpp>
 #include <iostream>
@@ -34,6 +41,8 @@
 #include <Common/GitSHA1.h>
 #include <Common/LuminanceOptions.h>
 #include <Common/config.h>
+#include <Core/BatchScheduler.h>
+#include <Core/FramePipeline.h>
 #include <Core/IOWorker.h>
 #include <Core/TMWorker.h>
 #include <Exif/ExifOperations.h>
@@ -41,6 +50,8 @@
 #include <HdrHTML/pfsouthdrhtml.h>
 #include <Libpfs/manip/gamma_levels.h>
 #include <Libpfs/tm/TonemapOperator.h>
+#include <Libpfs/utils/parallel.h>
+#include <Libpfs/utils/trace.h>
 #include "commandline.h"
 
 #if defined(_MSC_VER)
@@ -53,6 +64,9 @@ using namespace libhdr::fusion;
 namespace {
 void printIfVerbose(const QString &str, bool verbose) {
     if (verbose) {
+        // the jobs of the batch mode print from several threads
+        static QMutex mutex;
+        QMutexLocker lock(&mutex);
 #if defined(_MSC_VER)
         // if the filemode isn't restored afterwards, a normal std::cout
         // segfaults
@@ -70,6 +84,149 @@ void printErrorAndExit(const QString &error_str) {
     exit(-1);
 }
 
+//! \brief file the spans are written to by --trace
+std::string s_traceFilename;
+
+//! \brief exit handler of --trace: the processing can end with exit() from
+//! several places
+void writeTrace() {
+    pfs::utils::trace::setEnabled(false);
+    if (!pfs::utils::trace::writeChromeTrace(s_traceFilename)) {
+        std::cerr << qPrintable(
+                         QObject::tr("Error: Cannot write the trace to %1")
+                             .arg(QString::fromStdString(s_traceFilename)))
+                  << std::endl;
+    }
+    pfs::utils::trace::writeSummary(std::cout);
+}
+
+//! \brief the parameter of \a opts set by the tone mapping option \a name,
+//! among the ones that can be swept (see --sweep), NULL for the others
+float *sweepParameterOf(TonemappingOptions &opts, const std::string &name) {
+    auto &o = opts.operator_options;
+    if (name == "tmoFatAlpha") return &o.fattaloptions.alpha;
+    if (name == "tmoFatBeta") return &o.fattaloptions.beta;
+    if (name == "tmoFatColor") return &o.fattaloptions.color;
+    if (name == "tmoFatNoise") return &o.fattaloptions.noiseredux;
+    if (name == "tmoFerRho") return &o.ferradansoptions.rho;
+    if (name == "tmoFerInvAlpha") return &o.ferradansoptions.inv_alpha;
+    if (name == "tmoM06Contrast") return &o.mantiuk06options.contrastfactor;
+    if (name == "tmoM06Saturation")
+        return &o.mantiuk06options.saturationfactor;
+    if (name == "tmoM06Detail") return &o.mantiuk06options.detailfactor;
+    if (name == "tmoM08ColorSaturation")
+        return &o.mantiuk08options.colorsaturation;
+    if (name == "tmoM08ConstrastEnh")
+        return &o.mantiuk08options.contrastenhancement;
+    if (name == "tmoM08LuminanceLvl")
+        return &o.mantiuk08options.luminancelevel;
+    if (name == "tmoDurSigmaS") return &o.durandoptions.spatial;
+    if (name == "tmoDurSigmaR") return &o.durandoptions.range;
+    if (name == "tmoDurBase") return &o.durandoptions.base;
+    if (name == "tmoDrgBias") return &o.dragooptions.bias;
+    if (name == "tmoR02Key") return &o.reinhard02options.key;
+    if (name == "tmoR02Phi") return &o.reinhard02options.phi;
+    if (name == "tmoR05Brightness") return &o.reinhard05options.brightness;
+    if (name == "tmoR05Chroma")
+        return &o.reinhard05options.chromaticAdaptation;
+    if (name == "tmoR05Lightness") return &o.reinhard05options.lightAdaptation;
+    if (name == "tmoAshLocal") return &o.ashikhminoptions.lct;
+    if (name == "tmoPatMultiplier") return &o.pattanaikoptions.multiplier;
+    if (name == "tmoPatCone") return &o.pattanaikoptions.cone;
+    if (name == "tmoPatRod") return &o.pattanaikoptions.rod;
+    return NULL;
+}
+
+//! \brief tonemaps and saves one HDR of the batch, then gives its memory
+//! back to the scheduler
+//! \note the HDR is taken from \a prefetcher at \a prefetchIndex, so that
+//! the next ones are decoded while this one is tonemapped
+class BatchTonemapTask : public QRunnable {
+   public:
+    BatchTonemapTask(BatchScheduler &scheduler, int job,
+                     FramePrefetcher &prefetcher, int prefetchIndex,
+                     const TonemappingOptions &options,
+                     const pfs::Params &params, const QString &output,
+                     bool autolevels, bool verbose, QAtomicInt &failures)
+        : m_scheduler(scheduler),
+          m_job(job),
+          m_prefetcher(prefetcher),
+          m_prefetchIndex(prefetchIndex),
+          m_options(options),
+          m_params(params),
+          m_output(output),
+          m_autolevels(autolevels),
+          m_verbose(verbose),
+          m_failures(failures) {}
+
+    void run() {
+        // the other jobs running in parallel share the threads of the process
+        pfs::utils::ConcurrentJob job;
+        if (!process(m_scheduler.inputs(m_job).first())) {
+            m_failures.ref();
+        }
+        m_scheduler.finish(m_job);
+    }
+
+   private:
+    bool process(const QString &input) {
+        QScopedPointer<pfs::Frame> hdr(m_prefetcher.take(m_prefetchIndex));
+        if (hdr.isNull()) {
+            printIfVerbose(QObject::tr("Load file %1 failed").arg(input), true);
+            return false;
+        }
+
+        TonemappingOptions options(m_options);
+        options.origxsize = hdr->getWidth();
+        if (options.xsize == -2) {
+            options.xsize = hdr->getWidth();
+        }
+
+        TMWorker tm_worker;
+        QScopedPointer<pfs::Frame> tm_frame(
+            tm_worker.computeTonemap(hdr.data(), &options, BilinearInterp));
+        hdr.reset();
+        if (tm_frame.isNull()) {
+            printIfVerbose(
+                QObject::tr("ERROR: Failed to tonemap file: %1").arg(input),
+                true);
+            return false;
+        }
+
+        if (m_autolevels) {
+            float minL, maxL, gammaL;
+            QScopedPointer<QImage> temp_qimage(
+                fromLDRPFStoQImage(tm_frame.data()));
+            computeAutolevels(temp_qimage.data(), 0.985f, minL, maxL, gammaL);
+            pfs::gammaAndLevels(tm_frame.data(), minL, maxL, 0.f, 1.f, gammaL);
+        }
+
+        if (!IOWorker().write_ldr_frame(tm_frame.data(), m_output,
+                                        QStringLiteral("FromHdrFile"),
+                                        QVector<float>(), &options,
+                                        m_params)) {
+            printIfVerbose(
+                QObject::tr("ERROR: Cannot save to file: %1").arg(m_output),
+                true);
+            return false;
+        }
+        printIfVerbose(
+            QObject::tr("Image %1 successfully saved").arg(m_output), m_verbose);
+        return true;
+    }
+
+    BatchScheduler &m_scheduler;
+    const int m_job;
+    FramePrefetcher &m_prefetcher;
+    const int m_prefetchIndex;
+    const TonemappingOptions m_options;
+    const pfs::Params m_params;
+    const QString m_output;
+    const bool m_autolevels;
+    const bool m_verbose;
+    QAtomicInt &m_failures;
+};
+
 float toFloatWithErrMsg(const QString &str) {
     bool ok;
     float ret = str.toFloat(&ok);
@@ -86,6 +243,7 @@ CommandLineInterfaceManager::CommandLineInterfaceManager(const int argc,
       argv(argv),
       operationMode(UNKNOWN_MODE),
       alignMode(NO_ALIGN),
+      hdrSaved(false),
       tmopts(TMOptionsOperations::getDefaultTMOptions()),
       tmofileparams(new pfs::Params()),
       verbose(false),
@@ -99,9 +257,11 @@ CommandLineInterfaceManager::CommandLineInterfaceManager(const int argc,
       htmlQuality(2),
       isProposedLdrName(false),
       isProposedHdrName(false),
+      isBatch(false),
       pageName(),
       imagesDir(),
-      saveAlignedImagesPrefix(QLatin1String("")) {
+      saveAlignedImagesPrefix(QLatin1String("")),
+      saveAlignedImagesFormat(QStringLiteral("tiff")) {
     hdrcreationconfig.weightFunction = WEIGHT_TRIANGULAR;
     hdrcreationconfig.responseCurve = RESPONSE_LINEAR;
     hdrcreationconfig.fusionOperator = DEBEVEC;
@@ -124,6 +284,10 @@ CommandLineInterfaceManager::CommandLineInterfaceManager(const int argc,
                        << "pfs";
 }
 
+CommandLineInterfaceManager::~CommandLineInterfaceManager() {
+    finishSaveHDR();
+}
+
 int CommandLineInterfaceManager::execCommandLineParams() {
     // Declare the supported options.
     namespace po = boost::program_options;
@@ -143,6 +307,8 @@ int CommandLineInterfaceManager::execCommandLineParams() {
             .toUtf8().constData())
         ("savealigned,d", po::value<std::string>(), tr("prefix Save aligned images to files which names start with prefix")
             .toUtf8().constData())
+        ("savealignedformat", po::value<std::string>(), tr("FORMAT Format of the aligned images: tiff (default) or lhc (fast, uncompressed scratch format)")
+            .toUtf8().constData())
         //
         ("load,l", po::value<std::string>(), tr("HDR_FILE Load an HDR instead of creating a new one.")
             .toUtf8().constData())
@@ -162,10 +328,22 @@ int CommandLineInterfaceManager::execCommandLineParams() {
             "given threshold. (0.0-1.0)").toUtf8().constData())
         ("autolevels,b", tr("Apply autolevels correction after tonemapping.").toUtf8().constData())
         ("createwebpage,w", tr("Enable generation of a webpage with embedded HDR viewer.").toUtf8().constData())
+        ("batch", tr("Tonemap each of the INPUTFILES, existing HDR files, on its own. Several files are processed at "
+                     "once, as long as they fit in the memory budget of the batch jobs. The LDR files are named as with "
+                     "--proposedldrname (jpg by default), with -2, -3, ... appended rather than overwriting a file, and "
+                     "written next to their HDR file or to --outdir.").toUtf8().constData())
+        ("outdir", po::value<std::string>(), tr("DIR   Directory the LDR files of --batch are written to.")
+            .toUtf8().constData())
         ("proposedldrname,p", po::value<std::string>(&ldrExtension), tr("FILE_EXTENSION   Save LDR file with a name of the form "
             "first-last_tmparameters.extension.").toUtf8().constData())
         ("proposedhdrname,z", po::value<std::string>(&hdrExtension), tr("FILE_EXTENSION   Save HDR file with a name of the form "
-            "first-last_HdrCreationModel.extension.").toUtf8().constData());
+            "first-last_HdrCreationModel.extension.").toUtf8().constData())
+        ("sweep", po::value<std::string>(), tr("PARAMETER=V1,V2,...   Tonemap once for each value of a tone mapping parameter "
+            "(e.g. tmoFatAlpha=0.5,1,1.5), saving one LDR file per value, named after the LDR file with _PARAMETER-VALUE "
+            "appended. The stages of the operator that do not depend on the parameter are computed once.")
+            .toUtf8().constData())
+        ("trace", po::value<std::string>(), tr("FILE   Record the time spent in each processing stage, write it to FILE "
+            "as Chrome trace-event JSON and print a summary when done.").toUtf8().constData());
 
     po::options_description hdr_desc(
         tr("HDR creation parameters  - you must either load an existing HDR "
@@ -443,6 +621,11 @@ directory must exist.  Useful to avoid clutter in the current directory. \
         if (vm.count("verbose")) {
             verbose = true;
         }
+        if (vm.count("trace")) {
+            s_traceFilename = vm["trace"].as<std::string>();
+            pfs::utils::trace::setEnabled(true);
+            atexit(writeTrace);
+        }
         if (vm.count("cameras")) {
             cout << tr("With LibRaw version ").toStdString()
                  << LibRaw::version() << endl;
@@ -459,6 +642,17 @@ directory must exist.  Useful to avoid clutter in the current directory. \
         if (vm.count("createwebpage")) {
             isHtml = true;
         }
+        if (vm.count("batch")) {
+            isBatch = true;
+        }
+        if (vm.count("outdir")) {
+            batchOutputDir =
+                QString::fromStdString(vm["outdir"].as<std::string>());
+            if (!QFileInfo(batchOutputDir).isDir())
+                printErrorAndExit(
+                    tr("Error: The directory %1 does not exist.")
+                        .arg(batchOutputDir));
+        }
         if (vm.count("proposedldrname")) {
             isProposedLdrName = true;
             if (!validLdrExtensions.contains(
@@ -603,6 +797,27 @@ directory must exist.  Useful to avoid clutter in the current directory. \
             }
         }
 
+        if (vm.count("sweep")) {
+            const QString sweep =
+                QString::fromStdString(vm["sweep"].as<std::string>());
+            sweepParameter = sweep.section('=', 0, 0).toStdString();
+            if (sweepParameterOf(*tmopts, sweepParameter) == NULL)
+                printErrorAndExit(
+                    tr("Error: Unknown or not sweepable tone mapping "
+                       "parameter: %1")
+                        .arg(QString::fromStdString(sweepParameter)));
+            foreach (const QString &value,
+                     sweep.section('=', 1).split(',', QString::SkipEmptyParts)) {
+                bool ok;
+                sweepValues.append(value.toFloat(&ok));
+                if (!ok)
+                    printErrorAndExit(
+                        tr("Error: Invalid value for the sweep: %1").arg(value));
+            }
+            if (sweepValues.isEmpty())
+                printErrorAndExit(tr("Error: The sweep has no values."));
+        }
+
         if (vm.count("ldrQuality")) {
             int quality = vm["ldrQuality"].as<int>();
             if (quality < 1 || quality > 100)
@@ -654,6 +869,14 @@ directory must exist.  Useful to avoid clutter in the current directory. \
         if (vm.count("savealigned"))
             saveAlignedImagesPrefix =
                 QString::fromStdString(vm["savealigned"].as<std::string>());
+        if (vm.count("savealignedformat")) {
+            saveAlignedImagesFormat = QString::fromStdString(
+                vm["savealignedformat"].as<std::string>());
+            if (saveAlignedImagesFormat != QLatin1String("tiff") &&
+                saveAlignedImagesFormat != QLatin1String("lhc"))
+                printErrorAndExit(
+                    tr("Error: Unsupported format for the aligned images."));
+        }
         if (threshold < 0.0f || threshold > 1.0f)
             printErrorAndExit(
                 tr("Error: Threshold must be in the range [0..1]."));
@@ -688,6 +911,10 @@ directory must exist.  Useful to avoid clutter in the current directory. \
 }
 
 void CommandLineInterfaceManager::execCommandLineParamsSlot() {
+    if (isBatch) {
+        runBatch();
+        return;
+    }
     if (!ev.isEmpty() && ev.count() != inputFiles.count()) {
         printErrorAndExit(
             tr("Error: The number of EV values specified is different from the "
@@ -797,7 +1024,8 @@ void CommandLineInterfaceManager::createHDR(int errorcode) {
 
     if (errorcode == 0 && alignMode != NO_ALIGN &&
         saveAlignedImagesPrefix != QLatin1String("")) {
-        hdrCreationManager->saveImages(saveAlignedImagesPrefix);
+        hdrCreationManager->saveImages(saveAlignedImagesPrefix,
+                                       saveAlignedImagesFormat);
     }
 
     if (threshold > 0) {
@@ -859,15 +1087,17 @@ void CommandLineInterfaceManager::saveHDR() {
 
         // write_hdr_frame by default saves to EXR, if it doesn't find a
         // supported
-        // file type
-        if (IOWorker().write_hdr_frame(HDR.data(), saveHdrFilename)) {
-            printIfVerbose(
-                tr("Image %1 saved successfully").arg(saveHdrFilename),
-                verbose);
-        } else {
-            printIfVerbose(tr("Could not save %1").arg(saveHdrFilename),
-                           verbose);
-        }
+        // file type. The HDR is only read from now on, so it can be
+        // written while it is tonemapped: HDR keeps the ownership
+        hdrWriteBudget.reset(new MemoryBudget(batchMemoryBudget()));
+        hdrWriteQueue.reset(new FrameWriteQueue(1, *hdrWriteBudget));
+        hdrSaved = false;
+        hdrWriteQueue->submit(
+            pfs::FramePtr(HDR.data(), [](pfs::Frame *) {}), saveHdrFilename,
+            [this](pfs::Frame &frame, const QString &filename) {
+                hdrSaved = IOWorker().write_hdr_frame(&frame, filename);
+                return hdrSaved;
+            });
     } else {
         printIfVerbose(
             tr("NOT Saving HDR image to file. %1").arg(saveHdrFilename),
@@ -881,6 +1111,22 @@ void CommandLineInterfaceManager::saveHDR() {
     startTonemap();
 }
 
+void CommandLineInterfaceManager::finishSaveHDR() {
+    if (hdrWriteQueue.isNull()) {
+        return;
+    }
+    hdrWriteQueue->waitForDone();
+    hdrWriteQueue.reset();
+    hdrWriteBudget.reset();
+
+    if (hdrSaved) {
+        printIfVerbose(tr("Image %1 saved successfully").arg(saveHdrFilename),
+                       verbose);
+    } else {
+        printIfVerbose(tr("Could not save %1").arg(saveHdrFilename), verbose);
+    }
+}
+
 void CommandLineInterfaceManager::generateHTML() {
     if (operationMode == LOAD_HDR_MODE) {
         if (pageName.empty()) pageName = loadHdrFilename.toStdString();
@@ -949,6 +1195,15 @@ void CommandLineInterfaceManager::startTonemap() {
             printIfVerbose(tr("Applying gamma %1.").arg(tmopts->pregamma),
                            verbose);
 
+        if (!sweepValues.isEmpty()) {
+            runSweep(inputfname);
+            if (isHtml && !isHtmlDone) {
+                generateHTML();
+            }
+            emit finishedParsing();
+            return;
+        }
+
         // Build TMWorker
         TMWorker tm_worker;
         connect(&tm_worker, &TMWorker::tonemapSetMaximum, this,
@@ -984,12 +1239,14 @@ void CommandLineInterfaceManager::startTonemap() {
                 hdrCreationManager.data() ? hdrCreationManager->getExpotimes()
                                           : QVector<float>(),
                 tmopts.data(), *tmofileparams)) {
+            finishSaveHDR();
             // File save successful
             printIfVerbose(
                 tr("\nImage %1 successfully saved").arg(saveLdrFilename),
                 verbose);
         } else {
             // File save failed
+            finishSaveHDR();
             printErrorAndExit(
                 tr("\nERROR: Cannot save to file: %1").arg(saveLdrFilename));
         }
@@ -1002,10 +1259,159 @@ void CommandLineInterfaceManager::startTonemap() {
         if (isHtml && !isHtmlDone) {
             generateHTML();
         }
+        finishSaveHDR();
         emit finishedParsing();
     }
 }
 
+void CommandLineInterfaceManager::runBatch() {
+    if (inputFiles.isEmpty() || !loadHdrFilename.isEmpty()) {
+        printErrorAndExit(
+            tr("Error: The batch mode takes the HDR files to tonemap as "
+               "INPUTFILES."));
+    }
+    const QString extension = isProposedLdrName
+                                  ? QString::fromStdString(ldrExtension)
+                                  : QStringLiteral("jpg");
+
+    // more jobs than threads would only oversubscribe the processors
+    const int maxJobs = std::max(
+        std::min(LuminanceOptions().getBatchTmNumThreads(),
+                 static_cast<int>(pfs::utils::getConcurrency())),
+        1);
+    MemoryBudget budget(batchMemoryBudget());
+    BatchScheduler scheduler(budget, maxJobs);
+
+    QList<TonemappingOptions *> options;
+    options << tmopts.data();
+    foreach (const QString &input, inputFiles) {
+        scheduler.addJob(QStringList(input),
+                         estimateBatchTMJobMemory(input, options));
+    }
+    scheduler.sort(BatchScheduler::ORDER_LARGEST_FIRST);
+
+    printIfVerbose(tr("Running in batch mode: %n job(s) at once, ", "",
+                      maxJobs) +
+                       tr("memory budget %1 MB")
+                           .arg(budget.capacity() / (1024 * 1024)),
+                   verbose);
+
+    // the names are chosen before any job starts, so that two jobs running
+    // at once never pick the same one
+    QVector<QString> outputs(inputFiles.size());
+    QSet<QString> taken;
+    const QString postfix = tmopts->getPostfix();
+    for (int job = 0; job < inputFiles.size(); ++job) {
+        const QFileInfo fi(inputFiles[job]);
+        const QDir dir(batchOutputDir.isEmpty() ? fi.absolutePath()
+                                                : batchOutputDir);
+        const QString firstPart = fi.completeBaseName() + "_" + postfix;
+        int idx = 1;
+        do {
+            outputs[job] = dir.filePath(
+                firstPart + (idx > 1 ? "-" + QString::number(idx) : QString()) +
+                "." + extension);
+            idx++;
+        } while (taken.contains(outputs[job]) || QFile::exists(outputs[job]));
+        taken.insert(outputs[job]);
+    }
+
+    // decode the next HDRs while the current ones are tonemapped
+    QStringList prefetchList;
+    QVector<int> prefetchIndex(inputFiles.size(), -1);
+    foreach (int job, scheduler.queue()) {
+        prefetchIndex[job] = prefetchList.size();
+        prefetchList << scheduler.inputs(job).first();
+    }
+    FramePrefetcher prefetcher(
+        prefetchList, maxJobs, budget, [](const QString &filename) {
+            pfs::Frame *frame = NULL;
+            try {
+                frame = IOWorker().read_hdr_frame(filename);
+            } catch (...) {
+            }
+            return frame;
+        });
+
+    QAtomicInt failures(0);
+    QThreadPool pool;
+    pool.setMaxThreadCount(maxJobs);
+    for (int job = scheduler.start(); job >= 0; job = scheduler.start()) {
+        printIfVerbose(tr("Tonemapping %1").arg(scheduler.inputs(job).first()),
+                       verbose);
+        pool.start(new BatchTonemapTask(scheduler, job, prefetcher,
+                                        prefetchIndex[job], *tmopts,
+                                        *tmofileparams, outputs[job],
+                                        isAutolevels, verbose, failures));
+    }
+    pool.waitForDone();
+
+    if (failures.load() > 0) {
+        printErrorAndExit(
+            tr("%n file(s) could not be tonemapped.", "", failures.load()));
+    }
+    emit finishedParsing();
+}
+
+void CommandLineInterfaceManager::runSweep(const QString &inputfname) {
+    // one set of options per value, the other parameters are the same
+    QList<TonemappingOptions *> options;
+    foreach (float value, sweepValues) {
+        TonemappingOptions *opts = new TonemappingOptions(*tmopts);
+        *sweepParameterOf(*opts, sweepParameter) = value;
+        options.append(opts);
+    }
+
+    const QFileInfo fi(saveLdrFilename);
+    const QString prefix = fi.dir().filePath(fi.completeBaseName()) + "_" +
+                           QString::fromStdString(sweepParameter) + "-";
+    const QVector<float> expotimes = hdrCreationManager.data()
+                                         ? hdrCreationManager->getExpotimes()
+                                         : QVector<float>();
+
+    printIfVerbose(tr("Sweeping %1 over %n value(s).", "", sweepValues.size())
+                       .arg(QString::fromStdString(sweepParameter)),
+                   verbose);
+
+    QStringList failed;
+    int index = 0;
+    TMWorker tm_worker;
+    connect(&tm_worker, &TMWorker::tonemapSetMaximum, this,
+            &CommandLineInterfaceManager::setProgressBar);
+    connect(&tm_worker, &TMWorker::tonemapSetValue, this,
+            &CommandLineInterfaceManager::updateProgressBar);
+    connect(&tm_worker, &TMWorker::tonemapFailed, this,
+            &CommandLineInterfaceManager::tonemapFailed);
+    tm_worker.computeTonemapSweep(
+        HDR.data(), options, BilinearInterp,
+        [&](pfs::Frame *frame, TonemappingOptions *opts) {
+            if (isAutolevels) {
+                float minL, maxL, gammaL;
+                QScopedPointer<QImage> temp_qimage(fromLDRPFStoQImage(frame));
+                computeAutolevels(temp_qimage.data(), 0.985f, minL, maxL,
+                                  gammaL);
+                pfs::gammaAndLevels(frame, minL, maxL, 0.f, 1.f, gammaL);
+            }
+            const QString filename =
+                prefix + QString::number(sweepValues[index++]) + "." +
+                fi.suffix();
+            if (IOWorker().write_ldr_frame(frame, filename, inputfname,
+                                           expotimes, opts, *tmofileparams)) {
+                printIfVerbose(tr("\nImage %1 successfully saved").arg(filename),
+                               verbose);
+            } else {
+                failed << filename;
+            }
+        });
+    qDeleteAll(options);
+
+    finishSaveHDR();
+    if (!failed.isEmpty()) {
+        printErrorAndExit(
+            tr("\nERROR: Cannot save to file: %1").arg(failed.join(", ")));
+    }
+}
+
 void CommandLineInterfaceManager::errorWhileLoading(
     const QString &errormessage) {
     printErrorAndExit(tr("Failed loading images: %1").arg(errormessage));
@@ -1047,5 +1453,6 @@ void CommandLineInterfaceManager::readData(const QByteArray &data) {
 }
 
 void CommandLineInterfaceManager::tonemapFailed(const QString &e) {
+    finishSaveHDR();
     printErrorAndExit(e);
 }
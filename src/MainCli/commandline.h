@@ -40,10 +40,14 @@
 #include <Libpfs/params.h>
 #include "ezETAProgressBar.hpp"
 
+class MemoryBudget;
+class FrameWriteQueue;
+
 class CommandLineInterfaceManager : public QObject {
     Q_OBJECT
    public:
     CommandLineInterfaceManager(const int argc, char **argv);
+    ~CommandLineInterfaceManager();
     int execCommandLineParams();
 
    private:
@@ -64,6 +68,12 @@ class CommandLineInterfaceManager : public QObject {
     QString saveLdrFilename;
     QScopedPointer<pfs::Frame> HDR;
     void saveHDR();
+    //! \brief wait for the HDR file written in background, and report
+    void finishSaveHDR();
+    // the HDR is written while it is tonemapped
+    QScopedPointer<MemoryBudget> hdrWriteBudget;
+    QScopedPointer<FrameWriteQueue> hdrWriteQueue;
+    bool hdrSaved;
     void printHelp(char *progname);
     QScopedPointer<TonemappingOptions> tmopts;
     QScopedPointer<pfs::Params> tmofileparams;
@@ -82,16 +92,28 @@ class CommandLineInterfaceManager : public QObject {
     int htmlQuality;
     bool isProposedLdrName;
     bool isProposedHdrName;
+    // tonemap each input HDR on its own
+    bool isBatch;
+    // directory the batch mode writes to (empty: next to each input)
+    QString batchOutputDir;
+    // the tone mapping option swept by --sweep, and its values
+    std::string sweepParameter;
+    QList<float> sweepValues;
     std::string pageName;
     std::string imagesDir;
     std::string ldrExtension;
     std::string hdrExtension;
     QString saveAlignedImagesPrefix;
+    QString saveAlignedImagesFormat;
     QStringList validLdrExtensions;
     QStringList validHdrExtensions;
 
     void generateHTML();
     void startTonemap();
+    //! \brief tonemap the input HDRs as batch jobs, within the memory budget
+    void runBatch();
+    //! \brief tonemap the HDR once for each value of the swept parameter
+    void runSweep(const QString &inputfname);
 
    private slots:
     void finishedLoadingInputFiles();
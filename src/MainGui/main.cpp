@@ -76,6 +76,12 @@ bool check_db() {
     }
     return ok;
 }
+
+//! \brief writes the spans recorded during the session when the program
+//! exits (see LuminanceOptions::applyTracing)
+struct TraceWriter {
+    ~TraceWriter() { LuminanceOptions().writeTrace(); }
+};
 }
 
 #if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
@@ -148,6 +154,9 @@ int main(int argc, char **argv) {
 
     LuminanceOptions::conditionallyDoUpgrade();
     TranslatorManager::setLanguage(LuminanceOptions().getGuiLang());
+    LuminanceOptions().applyConcurrency();
+    LuminanceOptions().applyTracing();
+    TraceWriter traceWriter;
 
     LuminanceOptions().applyTheme(true);
 
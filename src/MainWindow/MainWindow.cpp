@@ -94,6 +94,7 @@
 
 #include <Core/IOWorker.h>
 #include <Core/TMWorker.h>
+#include <Core/TonemapCache.h>
 #include <HdrWizard/AutoAntighosting.h>
 #include <HdrWizard/HdrWizard.h>
 #include <HdrWizard/WhiteBalance.h>
@@ -1547,6 +1548,8 @@ void MainWindow::setupTM() {
     connect(this, &QObject::destroyed, m_TMProgressBar, &QObject::deleteLater);
 
     m_TMWorker = new TMWorker;
+    m_TMWorker->setCache(&TonemapCache::instance());
+    m_tonemapRequest = 0;
     m_TMThread = new QThread;
 
     m_TMWorker->moveToThread(m_TMThread);
@@ -1558,6 +1561,8 @@ void MainWindow::setupTM() {
     // get back result!
     connect(m_TMWorker, &TMWorker::tonemapSuccess, this,
             &MainWindow::addLdrFrame);
+    connect(m_TMWorker, &TMWorker::tonemapRefined, this,
+            &MainWindow::refineLdrFrame);
     connect(m_TMWorker, SIGNAL(tonemapFailed(QString)), this,
             SLOT(tonemapFailed(QString)));
 
@@ -1698,11 +1703,22 @@ void MainWindow::tonemapImage(TonemappingOptions *opts) {
 #endif
         // CALL m_TMWorker->getTonemappedFrame(hdr_viewer->getHDRPfsFrame(),
         // opts);
-        QMetaObject::invokeMethod(
-            m_TMWorker, "computeTonemap", Qt::QueuedConnection,
-            Q_ARG(pfs::Frame *, hdr_viewer->getFrame()),
-            Q_ARG(TonemappingOptions *, opts),
-            Q_ARG(InterpolationMethod, m_interpolationMethod));
+        const int request = m_TMWorker->newRequest();
+        m_tonemapRequest = request;
+        if (LuminanceOptions().isProgressiveTonemapping()) {
+            QMetaObject::invokeMethod(
+                m_TMWorker, "computeTonemapProgressive", Qt::QueuedConnection,
+                Q_ARG(pfs::Frame *, hdr_viewer->getFrame()),
+                Q_ARG(TonemappingOptions *, opts),
+                Q_ARG(InterpolationMethod, m_interpolationMethod),
+                Q_ARG(int, request));
+        } else {
+            QMetaObject::invokeMethod(
+                m_TMWorker, "computeTonemap", Qt::QueuedConnection,
+                Q_ARG(pfs::Frame *, hdr_viewer->getFrame()),
+                Q_ARG(TonemappingOptions *, opts),
+                Q_ARG(InterpolationMethod, m_interpolationMethod));
+        }
     }
 }
 
@@ -1731,7 +1747,30 @@ void MainWindow::exportImage(TonemappingOptions *opts) {
 }
 
 void MainWindow::addLdrFrame(pfs::Frame *frame,
-                             TonemappingOptions *tm_options) {
+                             TonemappingOptions *tm_options, int request) {
+    // a progressive tonemapping superseded by a newer request
+    if (request != 0 && request != m_tonemapRequest) {
+        delete frame;
+        return;
+    }
+    showLdrFrame(frame, tm_options);
+    m_progressiveViewer = NULL;
+
+    m_PreviewPanel->setEnabled(true);
+}
+
+void MainWindow::refineLdrFrame(pfs::Frame *frame,
+                                TonemappingOptions *tm_options, int request) {
+    // queued before a newer request superseded it
+    if (request != m_tonemapRequest) {
+        delete frame;
+        return;
+    }
+    m_progressiveViewer = showLdrFrame(frame, tm_options);
+}
+
+GenericViewer *MainWindow::showLdrFrame(pfs::Frame *frame,
+                                        TonemappingOptions *tm_options) {
     if (m_tonemapPanel->doAutoLevels()) {
         float threshold, minL, maxL, gammaL;
         threshold = m_tonemapPanel->getAutoLevelsThreshold();
@@ -1742,7 +1781,10 @@ void MainWindow::addLdrFrame(pfs::Frame *frame,
 
     GenericViewer *n =
         static_cast<GenericViewer *>(m_tabwidget->currentWidget());
-    if (m_tonemapPanel->replaceLdr() && n != nullptr && !n->isHDR()) {
+    if (m_progressiveViewer) {
+        n = m_progressiveViewer;
+        n->setFrame(frame, tm_options);
+    } else if (m_tonemapPanel->replaceLdr() && n != nullptr && !n->isHDR()) {
         n->setFrame(frame, tm_options);
     } else {
         curr_num_ldr_open++;
@@ -1769,8 +1811,6 @@ void MainWindow::addLdrFrame(pfs::Frame *frame,
     }
     m_tabwidget->setCurrentWidget(n);
 
-    m_PreviewPanel->setEnabled(true);
-
     if (m_Ui->actionSoft_Proofing->isChecked()) {
         LdrViewer *viewer = static_cast<LdrViewer *>(n);
         viewer->doSoftProofing(false);
@@ -1778,6 +1818,7 @@ void MainWindow::addLdrFrame(pfs::Frame *frame,
         LdrViewer *viewer = static_cast<LdrViewer *>(n);
         viewer->doSoftProofing(true);
     }
+    return n;
 }
 
 void MainWindow::tonemapFailed(const QString &error_msg) {
@@ -1789,6 +1830,7 @@ void MainWindow::tonemapFailed(const QString &error_msg) {
     m_tonemapPanel->setEnabled(true);
     m_PreviewPanel->setEnabled(true);
     m_TMProgressBar->hide();
+    m_progressiveViewer = NULL;
 }
 
 /*
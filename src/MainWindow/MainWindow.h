@@ -38,6 +38,7 @@
 #include <QFutureWatcher>
 #include <QMainWindow>
 #include <QMap>
+#include <QPointer>
 #include <QProgressBar>
 #include <QScopedPointer>
 #include <QScrollArea>
@@ -191,7 +192,9 @@ class MainWindow : public QMainWindow {
     void tonemapEnd();
     void tonemapImage(TonemappingOptions *opts);
     void exportImage(TonemappingOptions *opts);
-    void addLdrFrame(pfs::Frame *, TonemappingOptions *);
+    void addLdrFrame(pfs::Frame *, TonemappingOptions *, int request);
+    //! \brief show a proxy of the frame being tonemapped progressively
+    void refineLdrFrame(pfs::Frame *, TonemappingOptions *, int request);
     // void addLDRResult(QImage*, quint16*);
     void tonemapFailed(const QString &);
 
@@ -313,6 +316,10 @@ class MainWindow : public QMainWindow {
     void setRealtimePreviewsActive(bool);
     void setPreviewPanelActive(bool b);
 
+    //! \brief show a tonemapped frame, in the viewer of the progressive
+    //! tonemapping in progress if any
+    GenericViewer *showLdrFrame(pfs::Frame *, TonemappingOptions *);
+
     // Preview Panel
     QScrollArea *m_PreviewscrollArea;
     PreviewPanel *m_PreviewPanel;
@@ -333,6 +340,10 @@ class MainWindow : public QMainWindow {
     QThread *m_TMThread;
     TMWorker *m_TMWorker;
     TMOProgressIndicator *m_TMProgressBar;
+    // shows the proxies of a progressive tonemapping, until the final frame
+    QPointer<GenericViewer> m_progressiveViewer;
+    // last request queued on m_TMWorker (see TMWorker::newRequest)
+    int m_tonemapRequest;
 
     // Export queue
     QThread *m_QueueThread;
@@ -194,6 +194,8 @@ void PreferencesDialog::on_okButton_clicked() {
     }
 
     luminance_options.setTempDir(m_Ui->lineEditTempPath->text());
+    luminance_options.setTraceFile(m_Ui->lineEditTraceFile->text());
+    luminance_options.applyTracing();
 
     luminance_options.setPreviewWidth(m_Ui->previewsWidthSpinBox->value());
     luminance_options.setPreviewPanelActive(
@@ -207,6 +209,8 @@ void PreferencesDialog::on_okButton_clicked() {
 
     // --- Batch TM
     luminance_options.setBatchTmNumThreads(m_Ui->numThreadspinBox->value());
+    luminance_options.setBatchMemoryBudget(
+        m_Ui->batchMemoryBudgetSpinBox->value());
 
     // --- Other Parameters
 
@@ -576,8 +580,11 @@ void PreferencesDialog::from_options_to_gui() {
 
     // Temp directory
     m_Ui->lineEditTempPath->setText(luminance_options.getTempDir());
+    m_Ui->lineEditTraceFile->setText(luminance_options.getTraceFile());
 
     m_Ui->numThreadspinBox->setValue(luminance_options.getBatchTmNumThreads());
+    m_Ui->batchMemoryBudgetSpinBox->setValue(
+        luminance_options.getBatchMemoryBudget());
 
     m_Ui->aisParamsLineEdit->setText(
         luminance_options.getAlignImageStackOptions().join(
@@ -730,6 +737,15 @@ void PreferencesDialog::on_chooseCachePathButton_clicked() {
     }
 }
 
+void PreferencesDialog::on_chooseTraceFileButton_clicked() {
+    QString file = QFileDialog::getSaveFileName(
+        this, tr("Choose a trace file"), QDir::currentPath(),
+        tr("Chrome trace (*.json)"));
+    if (!file.isEmpty()) {
+        m_Ui->lineEditTraceFile->setText(file);
+    }
+}
+
 void PreferencesDialog::enterWhatsThis() { QWhatsThis::enterWhatsThisMode(); }
 
 void PreferencesDialog::on_camera_toolButton_clicked() {
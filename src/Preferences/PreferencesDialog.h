@@ -61,6 +61,7 @@ class PreferencesDialog : public QDialog {
     void on_okButton_clicked();
     void on_cancelButton_clicked();
     void on_chooseCachePathButton_clicked();
+    void on_chooseTraceFileButton_clicked();
     void enterWhatsThis();
 
     void on_user_qual_comboBox_currentIndexChanged(int);
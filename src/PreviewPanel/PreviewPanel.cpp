@@ -21,18 +21,22 @@
  * @author Franco Comida <fcomida@users.sourceforge.net>
  */
 
+#include <QAtomicInt>
 #include <QDebug>
+#include <QPointer>
+#include <QRunnable>
 #include <QSharedPointer>
-#include <QtConcurrentMap>
+#include <QThreadPool>
 
 #include "PreviewPanel.h"
 
 #include "Libpfs/frame.h"
-#include "Libpfs/manip/copy.h"
 #include "Libpfs/manip/gamma_levels.h"
 #include "Libpfs/manip/resize.h"
+#include "Libpfs/utils/parallel.h"
 
 #include "Core/TMWorker.h"
+#include "Core/TonemapCache.h"
 #include "Libpfs/tm/TonemapOperator.h"
 
 #include "Fileformat/pfsoutldrimage.h"
@@ -57,62 +61,48 @@ void resetTonemappingOptions(TonemappingOptions *tm_options,
     tm_options->tonemapSelection = false;
 }
 
-class PreviewLabelUpdater {
+//! \brief tonemaps one preview in a thread of the pool of the panel
+//! The job works on a copy of the options of the label, taken when it is
+//! queued, and on the reference frame shared by all the jobs of a refresh,
+//! which is only read. It stops as soon as the token of its label moves
+//! past the generation it was queued with: a newer job paints the label.
+class PreviewLabelUpdater : public QRunnable {
    public:
-    explicit PreviewLabelUpdater(QSharedPointer<pfs::Frame> reference_frame)
+    PreviewLabelUpdater(QSharedPointer<pfs::Frame> reference_frame,
+                        PreviewLabel *to_update,
+                        QSharedPointer<QAtomicInt> token)
         : m_doAutolevels(false),
           m_autolevelThreshold(0.985f),
-          m_ReferenceFrame(reference_frame) {}
+          m_ReferenceFrame(reference_frame),
+          m_PreviewLabel(to_update),
+          m_TMOptions(*to_update->getTonemappingOptions()),
+          m_token(token),
+          m_generation(token->load()) {}
 
     void setAutolevels(bool al, float th) {
         m_doAutolevels = al;
         m_autolevelThreshold = th;
     }
-    //! \brief QRunnable::run() definition
-    //! \caption I use shared pointer in this function, so I don't have to worry
-    //! about memory allocation
-    //! in case something wrong happens, it shouldn't leak
-    void operator()(PreviewLabel *to_update) {
-#ifdef QT_DEBUG
-// qDebug() << QThread::currentThread() << "running...";
-#endif
-
-        // retrieve TM parameters
-        TonemappingOptions *tm_options = to_update->getTonemappingOptions();
-        resetTonemappingOptions(tm_options, m_ReferenceFrame.data());
 
-        if (m_ReferenceFrame.isNull()) {
-#ifdef QT_DEBUG
-            qDebug() << "operator()() for TM"
-                     << static_cast<int>(tm_options->tmoperator)
-                     << " received a NULL pointer";
-            return;
-#endif
-        }
+    void run() {
+        // outdated while queued
+        if (isOutdated()) return;
 
-        // Copy Reference Frame
-        QSharedPointer<pfs::Frame> temp_frame(
-            pfs::copy(m_ReferenceFrame.data()));
+        // the previews share the thread budget with each other and with the
+        // other jobs running
+        pfs::utils::ConcurrentJob job;
 
-        // Tone Mapping
-        // QScopedPointer<TonemapOperator> tm_operator(
-        // TonemapOperator::getTonemapOperator(tm_options->tmoperator));
-        // tm_operator->tonemapFrame(temp_frame.data(), tm_options,
-        // fake_progress_helper);
+        TMWorker tmWorker;
+        tmWorker.setCache(&TonemapCache::instance());
+        tmWorker.setGenerationToken(m_token.data(), m_generation);
+        QSharedPointer<pfs::Frame> frame(tmWorker.computeTonemap(
+            m_ReferenceFrame.data(), &m_TMOptions, BilinearInterp));
 
-        // try { //Since nothing here actually throws this isn't useful, i need
-        // to
-        // check if returned frame != NULL
-        QScopedPointer<TMWorker> tmWorker(new TMWorker);
-        QSharedPointer<pfs::Frame> frame(tmWorker->computeTonemap(
-            temp_frame.data(), tm_options, BilinearInterp));
+        // canceled, or finished after a newer request
+        if (isOutdated()) return;
 
+        QSharedPointer<QImage> qimage;
         if (!frame.isNull()) {
-            // Create QImage from pfs::Frame into QSharedPointer, and I give it
-            // to the
-            // preview panel
-            // QSharedPointer<QImage>
-            // qimage(fromLDRPFStoQImage(temp_frame.data()));
             if (m_doAutolevels) {
                 QSharedPointer<QImage> temp_qimage(
                     fromLDRPFStoQImage(frame.data()));
@@ -121,53 +111,43 @@ class PreviewLabelUpdater {
                                   minL, maxL, gammaL);
                 pfs::gammaAndLevels(frame.data(), minL, maxL, 0.f, 1.f, gammaL);
             }
-
-            QSharedPointer<QImage> qimage(fromLDRPFStoQImage(frame.data()));
-
-            //! \note I cannot use these 2 functions, because setPixmap must run
-            //! in
-            //! the GUI thread
-            // m_PreviewLabel->setPixmap( QPixmap::fromImage(*qimage) );
-            // m_PreviewLabel->adjustSize();
-            //! \note So I queue a SLOT request on the m_PreviewPanel
-            QMetaObject::invokeMethod(to_update, "assignNewQImage",
-                                      Qt::QueuedConnection,
-                                      Q_ARG(QSharedPointer<QImage>, qimage));
+            qimage = QSharedPointer<QImage>(fromLDRPFStoQImage(frame.data()));
         } else {
-            QSharedPointer<QImage> qimage(
+            qimage = QSharedPointer<QImage>(
                 new QImage(PREVIEW_WIDTH, PREVIEW_HEIGHT,
                            QImage::Format_ARGB32_Premultiplied));
             qimage->fill(QColor(
                 255, 0,
                 0));  // TODO Tonemapping failed, let's show a RED preview...
-            QMetaObject::invokeMethod(to_update, "assignNewQImage",
-                                      Qt::QueuedConnection,
-                                      Q_ARG(QSharedPointer<QImage>, qimage));
         }
-/*
-}
-catch (...) {
-    qDebug() << "PreviewLabelUpdater: caught exception";
-    QSharedPointer<QImage> qimage(new QImage);
-    QMetaObject::invokeMethod(to_update, "assignNewQImage",
-Qt::QueuedConnection,
-                              Q_ARG(QSharedPointer<QImage>, qimage));
-}
-*/
-#ifdef QT_DEBUG
-// qDebug() << QThread::currentThread() << "done!";
-#endif
+
+        //! \note setPixmap must run in the GUI thread, so I queue a SLOT
+        //! request on the label, unless it has been destroyed meanwhile
+        PreviewLabel *label = m_PreviewLabel.data();
+        if (label == NULL) return;
+        QMetaObject::invokeMethod(label, "assignNewQImage",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(QSharedPointer<QImage>, qimage));
     }
 
    private:
+    bool isOutdated() const { return m_token->load() != m_generation; }
+
     bool m_doAutolevels;
     float m_autolevelThreshold;
     QSharedPointer<pfs::Frame> m_ReferenceFrame;
+    QPointer<PreviewLabel> m_PreviewLabel;
+    TonemappingOptions m_TMOptions;
+    QSharedPointer<QAtomicInt> m_token;
+    const int m_generation;
 };
 }
 
 PreviewPanel::PreviewPanel(QWidget *parent)
-    : QWidget(parent), m_original_width_frame(0), m_doAutolevels(false) {
+    : QWidget(parent),
+      m_original_width_frame(0),
+      m_doAutolevels(false),
+      m_referenceGeneration(0) {
     //! \note I need to register the new object to pass this class as parameter
     //! inside invokeMethod()
     //! see run() inside PreviewLabelUpdater
@@ -297,9 +277,20 @@ PreviewPanel::PreviewPanel(QWidget *parent)
     flowLayout->addWidget(labelMai);
 
     setLayout(flowLayout);
+
+    for (int idx = 0; idx < m_ListPreviewLabel.size(); ++idx) {
+        m_tokens.append(QSharedPointer<QAtomicInt>(new QAtomicInt(0)));
+    }
 }
 
 PreviewPanel::~PreviewPanel() {
+    // the jobs still queued or running are not needed anymore: drop the
+    // former and wait for the latter, which stop at their next check
+    foreach (const QSharedPointer<QAtomicInt> &token, m_tokens) {
+        token->fetchAndAddOrdered(1);
+    }
+    m_pool.clear();
+    m_pool.waitForDone();
 #ifdef QT_DEBUG
     qDebug() << "PreviewPanel::~PreviewPanel()";
 #endif
@@ -318,27 +309,31 @@ void PreviewPanel::updatePreviews(pfs::Frame *frame, int index) {
         float ratio = ((float)frame_width) / frame_height;
         resized_width = PREVIEW_HEIGHT * ratio;
     }
-    // 1. make a resized copy
-    QSharedPointer<pfs::Frame> current_frame(
-        pfs::resize(frame, resized_width, BilinearInterp));
-
-    // 2. (non concurrent) for each PreviewLabel, call
-    // PreviewLabelUpdater::operator()
-    if (index == -1) {
-        foreach (PreviewLabel *current_label, m_ListPreviewLabel) {
-            PreviewLabelUpdater updater(current_frame);
-            updater.setAutolevels(m_doAutolevels, m_autolevelThreshold);
-            updater(current_label);
-        }
-    } else {
-        PreviewLabelUpdater updater(current_frame);
-        updater.setAutolevels(m_doAutolevels, m_autolevelThreshold);
-        updater(m_ListPreviewLabel.at(index));
+    // 1. make a resized copy, kept as long as the frame does not change so
+    // that the previews already computed are found in the cache
+    if (m_reference.isNull() ||
+        m_referenceGeneration != frame->getGeneration() ||
+        static_cast<int>(m_reference->getWidth()) != resized_width) {
+        m_reference = QSharedPointer<pfs::Frame>(
+            pfs::resize(frame, resized_width, BilinearInterp));
+        m_referenceGeneration = frame->getGeneration();
+    }
+
+    // 2. (concurrent) for each PreviewLabel to refresh, outdate the jobs
+    // still running for it and queue a new one
+    const int first = (index == -1) ? 0 : index;
+    const int last = (index == -1) ? m_ListPreviewLabel.size() - 1 : index;
+    for (int idx = first; idx <= last; ++idx) {
+        PreviewLabel *current_label = m_ListPreviewLabel.at(idx);
+        resetTonemappingOptions(current_label->getTonemappingOptions(),
+                                m_reference.data());
+
+        m_tokens.at(idx)->fetchAndAddOrdered(1);
+        PreviewLabelUpdater *updater = new PreviewLabelUpdater(
+            m_reference, current_label, m_tokens.at(idx));
+        updater->setAutolevels(m_doAutolevels, m_autolevelThreshold);
+        m_pool.start(updater);
     }
-    // 2. (concurrent) for each PreviewLabel, call
-    // PreviewLabelUpdater::operator()
-    // QtConcurrent::map (m_ListPreviewLabel, PreviewLabelUpdater(current_frame)
-    // );
 }
 
 void PreviewPanel::tonemapPreview(TonemappingOptions *opts) {
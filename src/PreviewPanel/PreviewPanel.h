@@ -24,7 +24,11 @@
 #ifndef PREVIEWPANEL_IMPL_H
 #define PREVIEWPANEL_IMPL_H
 
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QThreadPool>
 #include <QWidget>
+#include <stdint.h>
 
 // forward declaration
 namespace pfs {
@@ -62,5 +66,13 @@ class PreviewPanel : public QWidget {
     bool m_doAutolevels;
     float m_autolevelThreshold;
     QList<PreviewLabel *> m_ListPreviewLabel;
+    // downscaled copy of the frame with generation m_referenceGeneration,
+    // shared read-only by the jobs tonemapping the previews
+    QSharedPointer<pfs::Frame> m_reference;
+    uint64_t m_referenceGeneration;
+    // one per label, bumped to outdate the jobs running for it
+    QList<QSharedPointer<QAtomicInt>> m_tokens;
+    // runs the jobs tonemapping the previews, drained by the destructor
+    QThreadPool m_pool;
 };
 #endif
@@ -160,6 +160,7 @@ void PreviewSettings::updatePreviews(pfs::Frame *frame) {
     // 1. make a resized copy
     QSharedPointer<pfs::Frame> current_frame(
         pfs::resize(frame, resized_width, BilinearInterp));
+    current_frame->endWrite();
 
     // 2. (non concurrent) for each PreviewLabel, call
     // PreviewLabelUpdater::operator()
@@ -30,16 +30,19 @@
 #include "Libpfs/frame.h"
 #include "Libpfs/manip/projection.h"
 
-static void worker(pfs::Frame *original, pfs::Frame *transformed, int xSize,
+static void worker(const pfs::Frame *original, pfs::Frame *transformed, int xSize,
                    int ySize, TransformInfo *transforminfo) {
     const pfs::ChannelContainer &channels = original->getChannels();
 
+    std::vector<const pfs::Array2Df *> in;
+    std::vector<pfs::Array2Df *> out;
     for (pfs::ChannelContainer::const_iterator it = channels.begin();
          it != channels.end(); ++it) {
-        pfs::Channel *newCh = transformed->createChannel((*it)->getName());
-
-        transformArray(*it, newCh, transforminfo);
+        in.push_back(*it);
+        out.push_back(transformed->createChannel((*it)->getName()));
     }
+    // all the channels in a single pass
+    transformArrays(in, out, *transforminfo);
 
     pfs::copyTags(original, transformed);
 }
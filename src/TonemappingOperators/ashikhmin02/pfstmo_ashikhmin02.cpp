@@ -36,6 +36,7 @@
 #include "Libpfs/colorspace/colorspace.h"
 #include "Libpfs/frame.h"
 #include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
 
 #include "tmo_ashikhmin02.h"
 #include "../../sleef.c"
@@ -50,7 +51,7 @@ void calculateLuminance(pfs::Array2Df *Y, float &avLum, float &maxLum,
     minLum = 0.0f;
 
 #ifdef _OPENMP
-#pragma omp parallel
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
 #endif
 {
     float maxLumThr = 0.f;
@@ -137,7 +138,7 @@ void pfstmo_ashikhmin02(pfs::Frame &frame, bool simple_flag, float lc_value,
 
     // TODO: this section can be rewritten using SSE Function
 #ifdef _OPENMP
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 #endif
     for (int y = 0; y < h; y++) {
         for (int x = 0; x < w; x++) {
@@ -32,6 +32,7 @@
 
 #include <Libpfs/array2d.h>
 #include <Libpfs/array2d_fwd.h>
+#include <Libpfs/utils/parallel.h>
 
 using namespace pfs;
 
@@ -160,7 +161,7 @@ class GaussianPyramid {
             initializeNewLevel(i, new_w, new_h, new_kernel_size, lambda * p[bottom].lambda);
 
 #ifdef _OPENMP
-            #pragma omp parallel for schedule(dynamic,16)
+            #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(dynamic,16)
 #endif
             for (int y = 0; y < p[i].height; y++) {
                 for (int x = 0; x < p[i].width; x++) {
@@ -219,7 +220,7 @@ class GaussianPyramid {
         // apply 5*5 kernel
         int X, Y;
 #ifdef _OPENMP
-        #pragma omp parallel for private(X,Y)
+        #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) private(X,Y)
 #endif
         for (int y = 0; y < h; y++) {
             for (int x = 0; x < w; x++) {
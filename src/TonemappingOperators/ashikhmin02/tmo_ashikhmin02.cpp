@@ -33,6 +33,7 @@
 #include "Libpfs/array2d.h"
 #include "Libpfs/frame.h"
 #include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
 #include "pyramid.h"
 #include "tmo_ashikhmin02.h"
 #include "../../sleef.c"
@@ -136,7 +137,7 @@ void getMaxMin(pfs::Array2Df *lum_map, float &maxLum, float &minLum) {
     maxLum = minLum = 0.0;
 
 #ifdef _OPENMP
-    #pragma omp parallel for reduction(min:minLum) reduction(max:maxLum)
+    #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) reduction(min:minLum) reduction(max:maxLum)
 #endif
     for (unsigned int i = 0; i < lum_map->getCols() * lum_map->getRows(); i++) {
         maxLum = ((*lum_map)(i) > maxLum) ? (*lum_map)(i) : maxLum;
@@ -149,7 +150,7 @@ void Normalize(pfs::Array2Df *lum_map, int nrows, int ncols) {
     getMaxMin(lum_map, maxLum, minLum);
     float range = maxLum - minLum;
 #ifdef _OPENMP
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 #endif
     for (int y = 0; y < nrows; y++)
         for (int x = 0; x < ncols; x++)
@@ -180,7 +181,7 @@ int tmo_ashikhmin02(pfs::Array2Df *Y, pfs::Array2Df *L, float maxLum,
         div = div != 0 ? div : EPSILON;
 
 #ifdef _OPENMP
-        #pragma omp parallel for
+        #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 #endif
         for (unsigned int y = 0; y < nrows; y++)
             for (unsigned int x = 0; x < ncols; x++) {
@@ -200,68 +201,50 @@ int tmo_ashikhmin02(pfs::Array2Df *Y, pfs::Array2Df *L, float maxLum,
 
     // LAL calculation
     pfs::Array2Df la(ncols, nrows);
-    int progress = 0;
-    int progressSteps = std::max(nrows / 80, 1u);
-    int phVal = 0;
-    ph.setValue(phVal);
-
-#ifdef _OPENMP
-    #pragma omp parallel for schedule(dynamic,16)
-#endif
-    for (unsigned int y = 0; y < nrows; y++) {
-        for (unsigned int x = 0; x < ncols; x++) {
-            float lal = LAL(myPyramid, x, y, lc_value);
-            la(x, y) = lal == 0 ? EPSILON : lal;
-        }
-#ifdef _OPENMP
-        #pragma omp critical
-#endif
-        {
-            progress += 1;
-            if((progress % progressSteps) == 0) {
-                phVal ++;
-                ph.setValue(std::min(phVal,80));
+    bool completed = pfs::utils::parallelFor(
+        0, nrows, 16, ph, 0, 80, [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (ptrdiff_t y = begin; y < end; y++) {
+                for (unsigned int x = 0; x < ncols; x++) {
+                    float lal = LAL(myPyramid, x, y, lc_value);
+                    la(x, y) = lal == 0 ? EPSILON : lal;
+                }
             }
-        }
-    }
+        });
 
     delete myPyramid;
+    if (!completed) {
+        return 0;
+    }
 
     // TM function
     float div = C(maxLum) - C(minLum);
     div = div != 0 ? div : EPSILON;
-    progressSteps = std::max(nrows / 20, 1u);
     // final computation for each pixel
-#ifdef _OPENMP
-    #pragma omp parallel for schedule(dynamic,16)
-#endif
-    for (unsigned int y = 0; y < nrows; y++) {
-        for (unsigned int x = 0; x < ncols; x++) {
-            switch (eq) {
-                case 2:
-                    (*L)(x, y) = (*Y)(x, y) * TM(la(x, y), minLum, div) / la(x, y);
-                    break;
-                case 4:
-                    (*L)(x, y) =
-                        TM(la(x, y), minLum, div) +
-                        C(TM(la(x, y), minLum, div)) / C(la(x, y)) * ((*Y)(x, y) - la(x, y));
-                    break;
+    completed = pfs::utils::parallelFor(
+        0, nrows, 16, ph, 80, 100, [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (ptrdiff_t y = begin; y < end; y++) {
+                for (unsigned int x = 0; x < ncols; x++) {
+                    switch (eq) {
+                        case 2:
+                            (*L)(x, y) = (*Y)(x, y) *
+                                         TM(la(x, y), minLum, div) / la(x, y);
+                            break;
+                        case 4:
+                            (*L)(x, y) = TM(la(x, y), minLum, div) +
+                                         C(TM(la(x, y), minLum, div)) /
+                                             C(la(x, y)) *
+                                             ((*Y)(x, y) - la(x, y));
+                            break;
+                    }
+
+                    //!! FIX:
+                    // to keep output values in range 0.01 - 1
+                    //(*L)(x,y) /= 100.0f;
+                }
             }
-
-            //!! FIX:
-            // to keep output values in range 0.01 - 1
-            //(*L)(x,y) /= 100.0f;
-        }
-#ifdef _OPENMP
-        #pragma omp critical
-#endif
-        {
-            progress += 1;
-            if((progress % progressSteps) == 0) {
-                phVal ++;
-                ph.setValue(std::min(phVal,100));
-            }
-        }
+        });
+    if (!completed) {
+        return 0;
     }
 
     Normalize(L, nrows, ncols);
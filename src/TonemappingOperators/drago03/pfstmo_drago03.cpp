@@ -37,6 +37,7 @@
 #include "Libpfs/exception.h"
 #include "Libpfs/frame.h"
 #include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
 #include "tmo_drago03.h"
 #include "../../opthelper.h"
 
@@ -76,9 +77,12 @@ void pfstmo_drago03(pfs::Frame &frame, float opt_biasValue, pfs::Progress &ph) {
     } catch (...) {
         throw pfs::Exception("Tonemapping Failed!");
     }
+    if (ph.canceled()) {
+        return;
+    }
 
-#pragma omp parallel for
-    for (int y = 0; y < h; y++) {
+    pfs::utils::parallelFor(0, h, 16, [&](ptrdiff_t begin, ptrdiff_t end) {
+    for (int y = begin; y < end; y++) {
         int x = 0;
 #ifdef __SSE2__
         for (; x < w - 3; x+=4) {
@@ -101,6 +105,7 @@ void pfstmo_drago03(pfs::Frame &frame, float opt_biasValue, pfs::Progress &ph) {
             Zr(x, y) = Zr(x, y) * scale;
         }
     }
+    });
 
     if (!ph.canceled()) {
         ph.setValue(100);
@@ -38,6 +38,7 @@
 
 #include "Libpfs/frame.h"
 #include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
 #include "TonemappingOperators/pfstmo.h"
 #include "../../opthelper.h"
 #include "../../sleef.c"
@@ -62,7 +63,7 @@ void calculateLuminance(unsigned int width, unsigned int height, const float *Y,
     vfloat avLumv = ZEROV;
 #endif // __SSE2__
 
-#pragma omp parallel
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
 {
     float eps = 1e-4f;
     float avLumThr = 0.f;
@@ -118,10 +119,10 @@ void tmo_drago03(const pfs::Array2Df &Y, pfs::Array2Df &L, float maxLum,
     float logmaxLum = log(maxLum);
 
     // Normal tone mapping of every pixel
-    #pragma omp parallel
-    {
-    int yEnd = Y.getRows();
-    int xEnd = Y.getCols();
+    const int yEnd = Y.getRows();
+    const int xEnd = Y.getCols();
+    pfs::utils::parallelFor(0, yEnd, 16, ph, 0, 90, [&](ptrdiff_t begin,
+                                                        ptrdiff_t end) {
 #ifdef __SSE2__
     vfloat avLumv = F2V(avLum);
     vfloat onev = F2V(1.f);
@@ -131,8 +132,7 @@ void tmo_drago03(const pfs::Array2Df &Y, pfs::Array2Df &L, float maxLum,
     vfloat logmaxLumv = F2V(logmaxLum);
     vfloat dividerv = F2V(divider);
 #endif
-    #pragma omp for
-    for (int y = 0; y < yEnd; y++) {
+    for (int y = begin; y < end; y++) {
         int x = 0;
 #ifdef __SSE2__
         for (; x < xEnd - 3; x+=4) {
@@ -149,5 +149,5 @@ void tmo_drago03(const pfs::Array2Df &Y, pfs::Array2Df &L, float maxLum,
             assert(!boost::math::isnan(L(x, y)));
         }
     }
-    }
+    });
 }
@@ -34,6 +34,7 @@
 
 #include "Libpfs/array2d.h"
 #include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
 #include "TonemappingOperators/pfstmo.h"
 
 #ifdef BRANCH_PREDICTION
@@ -102,39 +103,40 @@ void bilateralFilter(const pfs::Array2Df *I, pfs::Array2Df *J, float sigma_s,
     gaussianKernel(&sKernel, sigma_s);
     GaussLookup gauss(sigma_r, 256);
 
-    for (unsigned int y = 0; y < I->getRows(); y++) {
-        ph.setValue(y * 100 / I->getRows());
-
-        for (unsigned int x = 0; x < I->getCols(); x++) {
-            float val = 0;
-            float k = 0;
-            float I_s = (*X1)(x, y);  //!! previously 'I' not 'X1'
-
-            if (unlikely(!boost::math::isfinite(I_s))) I_s = 0.0f;
-
-            for (int py = max(0, y - sKernelSize_2),
-                     pymax = min(I->getRows(), y + sKernelSize_2);
-                 py < pymax; py++) {
-                for (int px = max(0, x - sKernelSize_2),
-                         pxmax = min(I->getCols(), x + sKernelSize_2);
-                     px < pxmax; px++) {
-                    float I_p = (*X1)(px, py);  //!! previously 'I' not 'X1'
-                    if (unlikely(!boost::math::isfinite(I_p))) I_p = 0.0f;
-
-                    float mult = sKernel(px - x + sKernelSize_2,
-                                         py - y + sKernelSize_2) *
-                                 gauss.getValue(I_p - I_s);
-
-                    float Ixy = (*I)(px, py);
-                    if (unlikely(!boost::math::isfinite(Ixy))) Ixy = 0.0f;
-
-                    val += Ixy * mult;  //!! but here we want 'I'
-                    k += mult;
+    pfs::utils::parallelFor(
+        0, I->getRows(), 4, ph, 0, 100, [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (int y = begin; y < end; y++) {
+                for (unsigned int x = 0; x < I->getCols(); x++) {
+                    float val = 0;
+                    float k = 0;
+                    float I_s = (*X1)(x, y);  //!! previously 'I' not 'X1'
+
+                    if (unlikely(!boost::math::isfinite(I_s))) I_s = 0.0f;
+
+                    for (int py = max(0, y - sKernelSize_2),
+                             pymax = min(I->getRows(), y + sKernelSize_2);
+                         py < pymax; py++) {
+                        for (int px = max(0, x - sKernelSize_2),
+                                 pxmax = min(I->getCols(), x + sKernelSize_2);
+                             px < pxmax; px++) {
+                            float I_p = (*X1)(px, py);  //!! previously 'I' not 'X1'
+                            if (unlikely(!boost::math::isfinite(I_p))) I_p = 0.0f;
+
+                            float mult = sKernel(px - x + sKernelSize_2,
+                                                 py - y + sKernelSize_2) *
+                                         gauss.getValue(I_p - I_s);
+
+                            float Ixy = (*I)(px, py);
+                            if (unlikely(!boost::math::isfinite(Ixy))) Ixy = 0.0f;
+
+                            val += Ixy * mult;  //!! but here we want 'I'
+                            k += mult;
+                        }
+                    }
+                    // avoid division by 0 when k is close to 0
+                    //         (*J)(x,y) = fabs(k) > 0.00000001 ? val/k : 0.;
+                    (*J)(x, y) = val / k;
                 }
             }
-            // avoid division by 0 when k is close to 0
-            //         (*J)(x,y) = fabs(k) > 0.00000001 ? val/k : 0.;
-            (*J)(x, y) = val / k;
-        }
-    }
+        });
 }
@@ -28,9 +28,11 @@
  */
 
 #include <cmath>
+#include <utility>
 
 #include <Libpfs/array2d.h>
 #include <Libpfs/progress.h>
+#include <Libpfs/utils/parallel.h>
 #include "fastbilateral.h"
 
 #ifdef BRANCH_PREDICTION
@@ -163,68 +165,75 @@ void fastBilateralFilter(const pfs::Array2Df &I, pfs::Array2Df &J,
     int size = w * h;
 
     // find range of values in the input array
-    float maxI = I(0);
-    float minI = I(0);
-#ifdef _OPENMP
-    #pragma omp parallel for reduction(min:minI) reduction(max:maxI)
-#endif
-    for (int i = 0; i < size; i++) {
-        float v = I(i);
-        maxI = std::max(maxI, v);
-        minI = std::min(minI, v);
-        J(i) = 0.0f;  // zero output
-    }
+    typedef std::pair<float, float> Range;
+    const Range range = pfs::utils::parallelReduce(
+        0, size, 1 << 16, Range(I(0), I(0)),
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            Range r(I(begin), I(begin));
+            for (ptrdiff_t i = begin; i < end; i++) {
+                float v = I(i);
+                r.first = std::min(r.first, v);
+                r.second = std::max(r.second, v);
+                J(i) = 0.0f;  // zero output
+            }
+            return r;
+        },
+        [](const Range &a, const Range &b) {
+            return Range(std::min(a.first, b.first),
+                         std::max(a.second, b.second));
+        });
+    const float minI = range.first;
+    const float maxI = range.second;
 
-    pfs::Array2Df jJ(w, h);
     pfs::Array2Df jG(w, h);
     pfs::Array2Df jH(w, h);
 
     const int NB_SEGMENTS = (int)ceil((maxI - minI) / sigma_r);
     float stepI = (maxI - minI) / NB_SEGMENTS;
 
-    // piecewise bilateral
+    // piecewise bilateral: the loops on the pixels of a segment stop at the
+    // next chunk once the filter is canceled
     for (int j = 0; j < NB_SEGMENTS; j++) {
-        ph.setValue(j * 100 / NB_SEGMENTS);
-        if (ph.canceled()) break;
+        const int fromValue = j * 100 / NB_SEGMENTS;
+        const int toValue = (j + 1) * 100 / NB_SEGMENTS;
+        const int midValue = (fromValue + toValue) / 2;
 
         float jI = minI + j * stepI;  // current intensity value
 
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-{
+        bool completed = pfs::utils::parallelFor(
+            0, h, 16, ph, fromValue, midValue,
+            [&](ptrdiff_t begin, ptrdiff_t end) {
 #ifdef __SSE2__
-        vfloat sqrsigma_rv = F2V(sigma_r * sigma_r);
-        vfloat jIv = F2V(jI);
+                vfloat sqrsigma_rv = F2V(sigma_r * sigma_r);
+                vfloat jIv = F2V(jI);
 #endif
-#ifdef _OPENMP
-        #pragma omp for
-#endif
-        for (int i = 0; i < h; i++) {
-            int j = 0;
+                for (int i = begin; i < end; i++) {
+                    int j = 0;
 #ifdef __SSE2__
-            for (; j < w-3; j+=4) {
-                vfloat Iv = LVFU(I(j, i));
-                vfloat dIv = Iv - jIv;
-                vfloat jGv = xexpf(-(dIv * dIv) / sqrsigma_rv);
-                STVFU(jG(j, i), jGv);
-                STVFU(jH(j, i), jGv * Iv);
-            }
+                    for (; j < w-3; j+=4) {
+                        vfloat Iv = LVFU(I(j, i));
+                        vfloat dIv = Iv - jIv;
+                        vfloat jGv = xexpf(-(dIv * dIv) / sqrsigma_rv);
+                        STVFU(jG(j, i), jGv);
+                        STVFU(jH(j, i), jGv * Iv);
+                    }
 #endif
-            for (; j < w; j++) {
-                float dI = I(j, i) - jI;
-                jG(j, i) = xexpf(-(dI * dI) / (sigma_r * sigma_r));
-                jH(j, i) = jG(j, i) * I(j, i);
-            }
-        }
-}
+                    for (; j < w; j++) {
+                        float dI = I(j, i) - jI;
+                        jG(j, i) = xexpf(-(dI * dI) / (sigma_r * sigma_r));
+                        jH(j, i) = jG(j, i) * I(j, i);
+                    }
+                }
+            });
+        if (!completed) break;
+
         float* gaussRows[h];
 
         gaussRows[0] = jG.data();
         for(int i = 1; i < h; ++i)
             gaussRows[i] = gaussRows[i - 1] + w;
 #ifdef _OPENMP
-        #pragma omp parallel
+        #pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
 #endif
         gaussianBlur(gaussRows, gaussRows, w, h, sigma_s);
 
@@ -232,55 +241,45 @@ void fastBilateralFilter(const pfs::Array2Df &I, pfs::Array2Df &J,
         for(int i = 1; i < h; ++i)
             gaussRows[i] = gaussRows[i - 1] + w;
 #ifdef _OPENMP
-        #pragma omp parallel
+        #pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
 #endif
         gaussianBlur(gaussRows, gaussRows, w, h, sigma_s);
 
-#ifdef _OPENMP
-        #pragma omp parallel for
-#endif
-        for (int i = 0; i < h; i++) {
-            for (int j = 0; j < w; j++) {
-                float temp = jG(j, i);
-                jJ(j, i) = temp != 0.f ? jH(j, i) / temp : 0.f;
-            }
-        }
+        if (ph.canceled()) break;
 
-        if (j == 0) {
-            // if the first segment - to account for the range boundary
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-            for (int i = 0; i < size; i++) {
-                if (likely(I(i) > jI + stepI)) continue;  // wi = 0;
-                if (likely(I(i) > jI)) {
-                    float wi = (stepI - (I(i) - jI)) / stepI;
-                    J(i) += jJ(i)*wi;
-                } else
-                    J(i) += jJ(i);
-            }
-        } else if (j == NB_SEGMENTS - 1) {
-            // if the last segment - to account for the range boundary
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-            for (int i = 0; i < size; i++) {
-                if (I(i) < jI - stepI) continue;  // wi = 0;
-                if (likely(I(i) < jI)) {
-                    float wi = (stepI - (jI - I(i))) / stepI;
-                    J(i) += jJ(i)*wi;
-                } else
-                    J(i) += jJ(i);
-            }
-        } else {
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-            for (int i = 0; i < size; i++) {
-                float wi = stepI - fabs(I(i) - jI);// / stepI;
-                if (unlikely(wi > 0.0f)) J(i) += jJ(i)*(wi/stepI);
-            }
-        }
+        // normalize (jJ = jH / jG) and add the segment, weighted by the
+        // distance of the pixel from its intensity
+        completed = pfs::utils::parallelFor(
+            0, h, 16, ph, midValue, toValue,
+            [&](ptrdiff_t begin, ptrdiff_t end) {
+                for (int i = begin * w; i < end * w; i++) {
+                    float wi;
+                    if (j == 0) {
+                        // if the first segment - to account for the range
+                        // boundary
+                        if (likely(I(i) > jI + stepI)) continue;  // wi = 0;
+                        wi = likely(I(i) > jI)
+                                 ? (stepI - (I(i) - jI)) / stepI
+                                 : 1.f;
+                    } else if (j == NB_SEGMENTS - 1) {
+                        // if the last segment - to account for the range
+                        // boundary
+                        if (I(i) < jI - stepI) continue;  // wi = 0;
+                        wi = likely(I(i) < jI)
+                                 ? (stepI - (jI - I(i))) / stepI
+                                 : 1.f;
+                    } else {
+                        wi = stepI - fabs(I(i) - jI);  // / stepI;
+                        if (likely(!(wi > 0.0f))) continue;
+                        wi /= stepI;
+                    }
+
+                    float temp = jG(i);
+                    float jJ = temp != 0.f ? jH(i) / temp : 0.f;
+                    J(i) += jJ * wi;
+                }
+            });
+        if (!completed) break;
     }
     //  delete Iz;
     //  if( downsample != 1 )
@@ -39,6 +39,7 @@
 #include "Libpfs/exception.h"
 #include "Libpfs/frame.h"
 #include "Libpfs/progress.h"
+#include "TonemappingOperators/pfstmo.h"
 #include "tmo_durand02.h"
 
 namespace {
@@ -57,6 +58,12 @@ const bool original_algorithm = false;
 
 void pfstmo_durand02(pfs::Frame &frame, float sigma_s, float sigma_r,
                      float baseContrast, pfs::Progress &ph) {
+    pfstmo_durand02(frame, sigma_s, sigma_r, baseContrast, NULL, ph);
+}
+
+void pfstmo_durand02(pfs::Frame &frame, float sigma_s, float sigma_r,
+                     float baseContrast, Durand02BaseLayer *baseLayer,
+                     pfs::Progress &ph) {
 #ifndef NDEBUG
     std::stringstream ss;
 
@@ -84,8 +91,21 @@ void pfstmo_durand02(pfs::Frame &frame, float sigma_s, float sigma_r,
     }
 
     try {
-        tmo_durand02(*X, *Y, *Z, sigma_s, sigma_r, baseContrast, downsample,
-                     !original_algorithm, ph);
+        if (baseLayer == NULL) {
+            tmo_durand02(*X, *Y, *Z, sigma_s, sigma_r, baseContrast,
+                         downsample, !original_algorithm, ph);
+        } else {
+            // the base layer of the previous call is still valid for this frame
+            if (!baseLayer->matches(Y->getCols(), Y->getRows(), sigma_s,
+                                    sigma_r, downsample)) {
+                durand02BaseLayer(*X, *Y, *Z, sigma_s, sigma_r, downsample,
+                                  *baseLayer, ph);
+            }
+            if (!ph.canceled()) {
+                tmo_durand02(*X, *Y, *Z, *baseLayer, baseContrast,
+                             !original_algorithm, ph);
+            }
+        }
     } catch (...) {
         throw pfs::Exception("Tonemapping Failed!");
     }
@@ -40,9 +40,12 @@
 #include "Libpfs/array2d.h"
 #include "Libpfs/rt_algo.h"
 #include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
+#include "Libpfs/utils/trace.h"
 #include "TonemappingOperators/pfstmo.h"
 
 #include "fastbilateral.h"
+#include "tmo_durand02.h"
 
 #include "../../sleef.c"
 #include "../../opthelper.h"
@@ -99,13 +102,39 @@ R output = r*exp(log(output intensity)), etc.
 void tmo_durand02(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
                   float sigma_s, float sigma_r, float baseContrast,
                   int downsample, bool color_correction, pfs::Progress &ph) {
+    Durand02BaseLayer layer;
+    durand02BaseLayer(R, G, B, sigma_s, sigma_r, downsample, layer, ph);
+    if (ph.canceled()) {
+        return;
+    }
+
+    tmo_durand02(R, G, B, layer, baseContrast, color_correction, ph);
+}
+
+bool Durand02BaseLayer::matches(size_t width, size_t height, float sigma_s,
+                                float sigma_r, int downsample) const {
+    return valid && base.getCols() == width && base.getRows() == height &&
+           this->sigma_s == sigma_s && this->sigma_r == sigma_r &&
+           this->downsample == downsample;
+}
+
+void durand02BaseLayer(const pfs::Array2Df &R, const pfs::Array2Df &G,
+                       const pfs::Array2Df &B, float sigma_s, float sigma_r,
+                       int downsample, Durand02BaseLayer &layer,
+                       pfs::Progress &ph) {
+    PFS_TRACE_SPAN("Durand02 base layer", "tonemap");
 
     int w = R.getCols();
     int h = R.getRows();
-    int size = w * h;
+
+    layer.valid = false;
+    layer.sigma_s = sigma_s;
+    layer.sigma_r = sigma_r;
+    layer.downsample = downsample;
 
     pfs::Array2Df I(w, h);       // intensities
-    pfs::Array2Df BASE(w, h);    // base layer
+    pfs::Array2Df &BASE = layer.base;    // base layer
+    BASE.resize(w, h);
 
     float min_pos = 1e10f;  // minimum positive value (to avoid log(0))
 #ifdef __SSE2__
@@ -113,7 +142,7 @@ void tmo_durand02(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
 #endif
 
 #ifdef _OPENMP
-#pragma omp parallel
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
 #endif
 {
     float min_posthr = 1e10f;
@@ -161,7 +190,7 @@ void tmo_durand02(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
 #endif
 
 #ifdef _OPENMP
-#pragma omp parallel
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
 #endif
 {
 #ifdef __SSE2__
@@ -177,6 +206,60 @@ void tmo_durand02(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
             vfloat Lv = LVFU(I(j, i));
             Lv = vmaxf(Lv, min_posv);
 
+            STVFU(I(j, i), xlogf(Lv));
+        }
+#endif
+        for (; j < w; j++) {
+            float L = I(j, i);
+            L = std::max(L, min_pos);
+
+            I(j, i) = xlogf(L);
+        }
+    }
+}
+
+    fastBilateralFilter(I, BASE, sigma_s, sigma_r, downsample, ph);
+
+    layer.minPos = min_pos;
+    lhdrengine::findMinMaxPercentile(BASE.data(), w * h, 0.01f, layer.minB,
+                                     0.99f, layer.maxB, true);
+    layer.valid = !ph.canceled();
+}
+
+void tmo_durand02(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
+                  const Durand02BaseLayer &layer, float baseContrast,
+                  bool color_correction, pfs::Progress &ph) {
+    PFS_TRACE_SPAN("Durand02 compression", "tonemap");
+
+    int w = R.getCols();
+    int h = R.getRows();
+    int size = w * h;
+
+    pfs::Array2Df I(w, h);                  // log intensities
+    const pfs::Array2Df &BASE = layer.base;  // base layer
+    const float min_pos = layer.minPos;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
+#endif
+{
+#ifdef __SSE2__
+    vfloat min_posv = F2V(min_pos);
+    vfloat onev = F2V(1.f);
+    vfloat c61v = F2V(61.f);
+    vfloat c20v = F2V(20.f);
+    vfloat c40v = F2V(40.f);
+#endif
+#ifdef _OPENMP
+    #pragma omp for
+#endif
+    for (int i = 0; i < h; i++) {
+        int j = 0;
+#ifdef __SSE2__
+        for (; j < w-3; j+=4) {
+            vfloat Lv = onev / c61v * (c20v * LVFU(R(j, i)) + c40v * LVFU(G(j, i)) + LVFU(B(j,i)));
+            Lv = vmaxf(Lv, min_posv);
+
             STVFU(R(j, i), LVFU(R(j, i)) / Lv);
             STVFU(G(j, i), LVFU(G(j, i)) / Lv);
             STVFU(B(j, i), LVFU(B(j, i)) / Lv);
@@ -185,7 +268,7 @@ void tmo_durand02(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
         }
 #endif
         for (; j < w; j++) {
-            float L = I(j, i);
+            float L = 1.0f / 61.0f * (20.0f * R(j, i) + 40.0f * G(j, i) + B(j, i));
             L = std::max(L, min_pos);
 
             R(j, i) /= L;
@@ -197,12 +280,8 @@ void tmo_durand02(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
     }
 }
 
-    fastBilateralFilter(I, BASE, sigma_s, sigma_r, downsample, ph);
-
-    //!! FIX: find minimum and maximum luminance, but skip 1% of outliers
-    float maxB;
-    float minB;
-    lhdrengine::findMinMaxPercentile(BASE.data(), w * h, 0.01f, minB, 0.99f, maxB, true);
+    const float minB = layer.minB;
+    const float maxB = layer.maxB;
 
     float compressionfactor = baseContrast / (maxB - minB);
     float compressionfactorm1 = compressionfactor - 1.f;
@@ -216,7 +295,7 @@ void tmo_durand02(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
     if (color_correction) {
 
 #ifdef _OPENMP
-#pragma omp parallel
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
 #endif
 {
 #ifdef __SSE2__
@@ -268,7 +347,7 @@ void tmo_durand02(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
 }
     } else {
 #ifdef _OPENMP
-        #pragma omp parallel for
+        #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 #endif
         for (int i = 0; i < size; i++) {
             float Ii = BASE(i) * compressionfactorm1 + I(i);
@@ -35,7 +35,8 @@
 #ifndef TMO_DURAND02_H
 #define TMO_DURAND02_H
 
-#include <Libpfs/array2d_fwd.h>
+#include <Libpfs/array2d.h>
+#include <cstddef>
 
 namespace pfs {
 class Progress;
@@ -61,4 +62,45 @@ void tmo_durand02(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
                   int downsample, bool color_correction /*= true*/,
                   pfs::Progress &ph);
 
+//! \brief Stages of \c tmo_durand02 that do not depend on baseContrast: the
+//! base layer (bilateral filter of the log intensities) and its range
+struct Durand02BaseLayer {
+    Durand02BaseLayer()
+        : valid(false),
+          sigma_s(0.f),
+          sigma_r(0.f),
+          downsample(0),
+          minPos(0.f),
+          minB(0.f),
+          maxB(0.f) {}
+
+    //! \brief true if the layer has been built for a \a width x \a height
+    //! frame with the same parameters
+    bool matches(size_t width, size_t height, float sigma_s, float sigma_r,
+                 int downsample) const;
+
+    bool valid;
+    float sigma_s;
+    float sigma_r;
+    int downsample;
+    pfs::Array2Df base;
+    //! minimum positive intensity
+    float minPos;
+    //! range of the base layer, without the outliers
+    float minB;
+    float maxB;
+};
+
+//! \brief build the base layer of \c tmo_durand02 (\a R, \a G and \a B are
+//! not modified)
+void durand02BaseLayer(const pfs::Array2Df &R, const pfs::Array2Df &G,
+                       const pfs::Array2Df &B, float sigma_s, float sigma_r,
+                       int downsample, Durand02BaseLayer &layer,
+                       pfs::Progress &ph);
+
+//! \brief \c tmo_durand02 from the base layer built by \c durand02BaseLayer
+void tmo_durand02(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
+                  const Durand02BaseLayer &layer, float baseContrast,
+                  bool color_correction, pfs::Progress &ph);
+
 #endif  // TMO_DURAND02_H
@@ -39,11 +39,13 @@
 #include <stdlib.h>
 #include <cassert>
 #include <iostream>
+#include <vector>
 
 #include "Libpfs/array2d.h"
 #include "Libpfs/manip/copy.h"
 #include "Libpfs/progress.h"
 #include "Libpfs/utils/numeric.h"
+#include "Libpfs/utils/parallel.h"
 #include "Libpfs/utils/sse.h"
 
 #include "TonemappingOperators/pfstmo.h"
@@ -115,24 +117,35 @@ static void restrict(const pfs::Array2Df *in, pfs::Array2Df *out) {
 
     const float filterSize = 0.5;
 
+    // the sample positions are accumulated as in the serial loop, so that
+    // the rows can be split among the threads
+    std::vector<float> sxs(outCols);
+    std::vector<float> sys(outRows);
     float sx, sy;
     int x, y;
-
-    for (y = 0, sy = dy / 2 - 0.5; y < outRows; y++, sy += dy) {
-        for (x = 0, sx = dx / 2 - 0.5; x < outCols; x++, sx += dx) {
-            float pixVal = 0;
-            float w = 0;
-            for (float ix = max(0, ceilf(sx - dx * filterSize));
-                 ix <= min(floorf(sx + dx * filterSize), inCols - 1); ix++)
-                for (float iy = max(0, ceilf(sy - dx * filterSize));
-                     iy <= min(floorf(sy + dx * filterSize), inRows - 1);
-                     iy++) {
-                    pixVal += (*in)((int)ix, (int)iy);
-                    w += 1;
-                }
-            (*out)(x, y) = pixVal / w;
+    for (x = 0, sx = dx / 2 - 0.5; x < outCols; x++, sx += dx) sxs[x] = sx;
+    for (y = 0, sy = dy / 2 - 0.5; y < outRows; y++, sy += dy) sys[y] = sy;
+
+    pfs::utils::parallelFor(0, outRows, 16, [&](ptrdiff_t begin,
+                                                ptrdiff_t end) {
+        for (int y = begin; y < end; y++) {
+            const float sy = sys[y];
+            for (int x = 0; x < outCols; x++) {
+                const float sx = sxs[x];
+                float pixVal = 0;
+                float w = 0;
+                for (float ix = max(0, ceilf(sx - dx * filterSize));
+                     ix <= min(floorf(sx + dx * filterSize), inCols - 1); ix++)
+                    for (float iy = max(0, ceilf(sy - dx * filterSize));
+                         iy <= min(floorf(sy + dx * filterSize), inRows - 1);
+                         iy++) {
+                        pixVal += (*in)((int)ix, (int)iy);
+                        w += 1;
+                    }
+                (*out)(x, y) = pixVal / w;
+            }
         }
-    }
+    });
 }
 
 // from_level>to_level, from_size>to_size
@@ -179,29 +192,42 @@ static void prolongate(const pfs::Array2Df *in, pfs::Array2Df *out) {
 
     const float filterSize = 1;
 
+    // sample positions accumulated as in restrict()
+    std::vector<float> sxs(outCols);
+    std::vector<float> sys(outRows);
     float sx, sy;
     int x, y;
-    for (y = 0, sy = -dy / 2; y < outRows; y++, sy += dy)
-        for (x = 0, sx = -dx / 2; x < outCols; x++, sx += dx) {
-            float pixVal = 0;
-            float weight = 0;
-
-            for (float ix = max(0, ceilf(sx - filterSize));
-                 ix <= min(floorf(sx + filterSize), inCols - 1); ix++)
-                for (float iy = max(0, ceilf(sy - filterSize));
-                     iy <= min(floorf(sy + filterSize), inRows - 1); iy++) {
-                    float fx = fabs(sx - ix);
-                    float fy = fabs(sy - iy);
-
-                    const float fval = (1 - fx) * (1 - fy);
-
-                    pixVal += (*in)((int)ix, (int)iy) * fval;
-                    weight += fval;
-                }
-
-            assert(weight != 0);
-            (*out)(x, y) = pixVal / weight;
+    for (x = 0, sx = -dx / 2; x < outCols; x++, sx += dx) sxs[x] = sx;
+    for (y = 0, sy = -dy / 2; y < outRows; y++, sy += dy) sys[y] = sy;
+
+    pfs::utils::parallelFor(0, outRows, 16, [&](ptrdiff_t begin,
+                                                ptrdiff_t end) {
+        for (int y = begin; y < end; y++) {
+            const float sy = sys[y];
+            for (int x = 0; x < outCols; x++) {
+                const float sx = sxs[x];
+                float pixVal = 0;
+                float weight = 0;
+
+                for (float ix = max(0, ceilf(sx - filterSize));
+                     ix <= min(floorf(sx + filterSize), inCols - 1); ix++)
+                    for (float iy = max(0, ceilf(sy - filterSize));
+                         iy <= min(floorf(sy + filterSize), inRows - 1);
+                         iy++) {
+                        float fx = fabs(sx - ix);
+                        float fy = fabs(sy - iy);
+
+                        const float fval = (1 - fx) * (1 - fy);
+
+                        pixVal += (*in)((int)ix, (int)iy) * fval;
+                        weight += fval;
+                    }
+
+                assert(weight != 0);
+                (*out)(x, y) = pixVal / weight;
+            }
         }
+    });
 }
 
 static void exact_sollution(pfs::Array2Df * /*F*/, pfs::Array2Df *U) {
@@ -305,17 +331,20 @@ static void calculate_defect(pfs::Array2Df *D, const pfs::Array2Df *U,
 
     // h2i = 1;
 
-    for (int y = 0; y < sy; y++)
-        for (int x = 0; x < sx; x++) {
-            int w, n, e, s;
-            w = (x == 0 ? 0 : x - 1);
-            n = (y == 0 ? 0 : y - 1);
-            s = (y + 1 == sy ? y : y + 1);
-            e = (x + 1 == sx ? x : x + 1);
-
-            (*D)(x, y) = (*F)(x, y) - ((*U)(e, y) + (*U)(w, y) + (*U)(x, n) +
-                                       (*U)(x, s) - 4.0 * (*U)(x, y));
-        }
+    pfs::utils::parallelFor(0, sy, 16, [&](ptrdiff_t begin, ptrdiff_t end) {
+        for (int y = begin; y < end; y++)
+            for (int x = 0; x < sx; x++) {
+                int w, n, e, s;
+                w = (x == 0 ? 0 : x - 1);
+                n = (y == 0 ? 0 : y - 1);
+                s = (y + 1 == sy ? y : y + 1);
+                e = (x + 1 == sx ? x : x + 1);
+
+                (*D)(x, y) =
+                    (*F)(x, y) - ((*U)(e, y) + (*U)(w, y) + (*U)(x, n) +
+                                  (*U)(x, s) - 4.0 * (*U)(x, y));
+            }
+    });
 }
 
 static void add_correction(pfs::Array2Df *U, const pfs::Array2Df *C) {
@@ -324,7 +353,11 @@ static void add_correction(pfs::Array2Df *U, const pfs::Array2Df *C) {
     int sx = C->getCols();
     int sy = C->getRows();
 
-    for (int i = 0; i < sx * sy; i++) (*U)(i) += (*C)(i);
+    pfs::utils::parallelFor(0, sx * sy, 1 << 16,
+                            [&](ptrdiff_t begin, ptrdiff_t end) {
+                                for (ptrdiff_t i = begin; i < end; i++)
+                                    (*U)(i) += (*C)(i);
+                            });
 }
 
 void solve_pde_multigrid(pfs::Array2Df *F, pfs::Array2Df *U,
@@ -380,6 +413,8 @@ void solve_pde_multigrid(pfs::Array2Df *F, pfs::Array2Df *U,
     // 3. nested iterations
     for (k = levels - 1; k >= 0; k--) {
         ph.setValue(20 + 70 * (levels - k) / (levels + 1));
+        // the solution is left as it is: the caller drops it
+        if (ph.canceled()) break;
         // 4. interpolate sollution from last coarse-grid to finer-grid
         // interpolate from level k+1 to level k (finer-grid)
         prolongate(IU[k + 1], IU[k]);
@@ -389,7 +424,7 @@ void solve_pde_multigrid(pfs::Array2Df *F, pfs::Array2Df *U,
         pfs::copy(RHS[k], VF[k]);
 
         // 5. V-cycle (twice repeated)
-        for (int cycle = 0; cycle < V_CYCLE; cycle++) {
+        for (int cycle = 0; cycle < V_CYCLE && !ph.canceled(); cycle++) {
             // 6. downward stroke of V
             for (k2 = k; k2 < levels; k2++) {
                 // 7. pre-smoothing of initial sollution using target function
@@ -496,7 +531,7 @@ static void asolve(const float b[], float x[], int rows, int cols) {
 #define idx(R, C) ((R)*cols + (C))
 
 static void atimes(const float x[], float res[], int rows, int cols) {
-#pragma omp parallel for shared(x, res) if (rows *cols > OMP_THRESHOLD) \
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) shared(x, res) if (rows *cols > OMP_THRESHOLD) \
                                                 schedule(static)
     for (int r = 1; r < rows - 1; r++)
         for (int c = 1; c < cols - 1; c++) {
@@ -535,7 +570,7 @@ static void atimes(const float x[], float res[], int rows, int cols) {
 static float snrm(unsigned long n, const float sx[]) {
     float ans = 0.0f;
 
-#pragma omp parallel for shared(sx) \
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) shared(sx) \
     reduction(+ : ans) if (n > OMP_THRESHOLD) schedule(static)
     for (long i = 0; i < static_cast<long>(n); i++) {
         ans += sx[i] * sx[i];
@@ -577,7 +612,7 @@ static void linbcg(unsigned long n, const float b[], float x[], float tol,
         // zm1nrm=znrm;
         asolve(rr, zz, rows, cols);
         bknum = 0.0;
-#pragma omp parallel for shared(z, rr) reduction( \
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) shared(z, rr) reduction( \
     + : bknum) if (n > OMP_THRESHOLD) schedule(static)
         for (long j = 0; j < static_cast<long>(n); j++) {
             bknum += z[j] * rr[j];
@@ -597,7 +632,7 @@ static void linbcg(unsigned long n, const float b[], float x[], float tol,
         bkden = bknum;
         atimes(p, z, rows, cols);
         akden = 0.0;
-#pragma omp parallel for shared(z, pp) reduction( \
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) shared(z, pp) reduction( \
     + : akden) if (n > OMP_THRESHOLD) schedule(static)
         for (long j = 0; j < static_cast<long>(n); j++) {
             akden += z[j] * pp[j];
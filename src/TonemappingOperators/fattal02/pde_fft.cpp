@@ -81,6 +81,7 @@
 #include <Common/init_fftw.h>
 #include <Libpfs/array2d.h>
 #include <Libpfs/progress.h>
+#include <Libpfs/utils/parallel.h>
 #include "pde.h"
 
 using namespace std;
@@ -259,7 +260,7 @@ void solve_pde_fft(pfs::Array2Df &F, pfs::Array2Df &U, pfs::Array2Df &F_tr, pfs:
     // DEBUG_STR << "solve_pde_fft: solve in eigenvector space" << std::endl;
     std::vector<double> l1 = get_lambda(height);
     std::vector<double> l2 = get_lambda(width);
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
             F_tr(x, y) = F_tr(x, y) / (l1[y] + l2[x]);
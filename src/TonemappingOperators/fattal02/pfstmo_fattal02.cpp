@@ -42,6 +42,8 @@
 #include "Libpfs/exception.h"
 #include "Libpfs/frame.h"
 #include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
+#include "TonemappingOperators/pfstmo.h"
 #include "../../opthelper.h"
 #include "../../sleef.c"
 #define pow_F(a,b) (xexpf(b*xlogf(a)))
@@ -53,6 +55,14 @@ const float epsilon = 1e-4f;
 void pfstmo_fattal02(pfs::Frame &frame, float opt_alpha, float opt_beta,
                      float opt_saturation, float opt_noise, bool newfattal,
                      bool fftsolver, int detail_level, pfs::Progress &ph) {
+    pfstmo_fattal02(frame, opt_alpha, opt_beta, opt_saturation, opt_noise,
+                    newfattal, fftsolver, detail_level, NULL, ph);
+}
+
+void pfstmo_fattal02(pfs::Frame &frame, float opt_alpha, float opt_beta,
+                     float opt_saturation, float opt_noise, bool newfattal,
+                     bool fftsolver, int detail_level,
+                     Fattal02Pyramid *pyramid, pfs::Progress &ph) {
 
     if (fftsolver) {
         // opt_alpha = 1.f;
@@ -93,8 +103,20 @@ void pfstmo_fattal02(pfs::Frame &frame, float opt_alpha, float opt_beta,
     pfs::transformRGB2Y(R, G, B, &Yr);
 
     try {
-        tmo_fattal02(w, h, Yr, L, opt_alpha, opt_beta, opt_noise, newfattal,
-                     fftsolver, detail_level, ph);
+        if (pyramid == NULL) {
+            tmo_fattal02(w, h, Yr, L, opt_alpha, opt_beta, opt_noise,
+                         newfattal, fftsolver, detail_level, ph);
+        } else {
+            // the pyramid of the previous call is still valid for this frame
+            if (!pyramid->matches(w, h, fftsolver)) {
+                fattal02Pyramid(Yr, fftsolver, *pyramid, ph);
+            }
+            if (!ph.canceled()) {
+                tmo_fattal02(w, h, *pyramid, L, opt_alpha, opt_beta,
+                             opt_noise, newfattal, fftsolver, detail_level,
+                             ph);
+            }
+        }
     } catch (...) {
         throw pfs::Exception("Tonemapping Failed!");
     }
@@ -108,7 +130,7 @@ void pfstmo_fattal02(pfs::Frame &frame, float opt_alpha, float opt_beta,
         const vfloat epsilonv = F2V(epsilon);
         const vfloat opt_saturationv = F2V(opt_saturation);
 #endif
-        #pragma omp parallel for
+        #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
         for (int i = 0; i < h; ++i) {
             int j = 0;
 #ifdef __SSE2__
@@ -42,7 +42,8 @@
 #include "Libpfs/array2d.h"
 #include "Libpfs/rt_algo.h"
 #include "Libpfs/progress.h"
-#include "Libpfs/utils/msec_timer.h"
+#include "Libpfs/utils/parallel.h"
+#include "Libpfs/utils/trace.h"
 #include "TonemappingOperators/pfstmo.h"
 #include "../../sleef.c"
 #ifdef _OPENMP
@@ -96,7 +97,7 @@ void gaussianBlur(const pfs::Array2Df &I, pfs::Array2Df &L) {
     pfs::Array2Df T(width, height);
 
     //--- X blur
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 
     for ( int y = 0 ; y < height ; y++ ) {
         for ( int x = 1 ; x < width - 1 ; x++ ) {
@@ -111,7 +112,7 @@ void gaussianBlur(const pfs::Array2Df &I, pfs::Array2Df &L) {
     }
 
     //--- Y blur
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
 
     for ( int x = 0 ; x < width - 7 ; x += 8 ) {
         for ( int y = 1 ; y < height - 1 ; y++ ) {
@@ -174,7 +175,7 @@ float calculateGradients(pfs::Array2Df &H, pfs::Array2Df &G, int k) {
     const float divider = pow(2.0f, k + 1);
     double avgGrad = 0.0f; // use double precision for large summations
 
-    #pragma omp parallel for reduction(+:avgGrad)
+    #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) reduction(+:avgGrad)
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
             float gx, gy;
@@ -209,7 +210,7 @@ void upSample(const pfs::Array2Df &A, pfs::Array2Df &B) {
     const int awidth = A.getCols();
     const int aheight = A.getRows();
 
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
             int ax = static_cast<int>(x * 0.5f);  // x / 2.f;
@@ -222,8 +223,9 @@ void upSample(const pfs::Array2Df &A, pfs::Array2Df &B) {
     }
 }
 
-void calculateFiMatrix(pfs::Array2Df &FI, pfs::Array2Df *gradients[],
-                       float avgGrad[], int nlevels, int detail_level,
+void calculateFiMatrix(pfs::Array2Df &FI,
+                       const pfs::Array2Df *const gradients[],
+                       const float avgGrad[], int nlevels, int detail_level,
                        float alfa, float beta, float noise, bool newfattal) {
 
     int width = gradients[nlevels - 1]->getCols();
@@ -244,7 +246,7 @@ void calculateFiMatrix(pfs::Array2Df &FI, pfs::Array2Df *gradients[],
         // only apply gradients to levels>=detail_level but at least to the
         // coarsest
         if (k >= detail_level || k == nlevels - 1 || newfattal == false) {
-            #pragma omp parallel for
+            #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
             for (int y = 0; y < height; y++) {
                 for (int x = 0; x < width; x++) {
                     float grad = ((*gradients[k])(x, y) < 1e-4f)
@@ -286,16 +288,31 @@ void tmo_fattal02(size_t width, size_t height, const pfs::Array2Df &Y,
                   pfs::Array2Df &L, float alfa, float beta, float noise,
                   bool newfattal, bool fftsolver, int detail_level,
                   pfs::Progress &ph) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
-    static const float black_point = 0.1f;
-    static const float white_point = 0.5f;
-    static const float gamma = 1.0f;  // 0.8f;
-    // static const int   detail_level = 3;
-    if (detail_level < 0) detail_level = 0;
-    if (detail_level > 3) detail_level = 3;
+    Fattal02Pyramid pyramid;
+    fattal02Pyramid(Y, fftsolver, pyramid, ph);
+    if (ph.canceled()) {
+        return;
+    }
+
+    tmo_fattal02(width, height, pyramid, L, alfa, beta, noise, newfattal,
+                 fftsolver, detail_level, ph);
+}
+
+bool Fattal02Pyramid::matches(size_t width, size_t height,
+                              bool fftsolver) const {
+    return !gradients.empty() && H.getCols() == width &&
+           H.getRows() == height && this->fftsolver == fftsolver;
+}
+
+void fattal02Pyramid(const pfs::Array2Df &Y, bool fftsolver,
+                     Fattal02Pyramid &pyramid, pfs::Progress &ph) {
+    PFS_TRACE_SPAN("Fattal02 pyramid", "tonemap");
+    const size_t width = Y.getCols();
+    const size_t height = Y.getRows();
+
+    pyramid.fftsolver = fftsolver;
+    pyramid.gradients.clear();
+    pyramid.avgGrad.clear();
 
     ph.setValue(2);
     if (ph.canceled()) return;
@@ -311,36 +328,42 @@ void tmo_fattal02(size_t width, size_t height, const pfs::Array2Df &Y,
 
     size_t size = width * height;
 
-    // find max & min values, normalize to range 0..100 and take logarithm
-    float minLum = Y(0, 0);
-    float maxLum = Y(0, 0);
-
-    for (size_t i = 0; i < size; i++) {
-        minLum = (Y(i) < minLum) ? Y(i) : minLum;
-        maxLum = (Y(i) > maxLum) ? Y(i) : maxLum;
-    }
+    // find max value, normalize to range 0..100 and take logarithm
+    const float maxLum = pfs::utils::parallelReduce(
+        0, size, 1 << 16, Y(0, 0),
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            float m = Y(begin);
+            for (ptrdiff_t i = begin; i < end; i++) {
+                m = (Y(i) > m) ? Y(i) : m;
+            }
+            return m;
+        },
+        [](float a, float b) { return (b > a) ? b : a; });
 
-    pfs::Array2Df H(width, height);
+    pfs::Array2Df &H = pyramid.H;
+    H.resize(width, height);
 
 #ifdef __SSE2__
     const vfloat maxLumv = F2V(maxLum);
     const vfloat c100v = F2V(100.f);
     const vfloat epsv = F2V(1e-4f);
 #endif
-        #pragma omp parallel for
-        for (size_t i = 0; i < height; ++i) {
-            size_t j = 0;
+    const bool completed = pfs::utils::parallelFor(
+        0, height, 16, ph, 2, 4, [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (size_t i = begin; i < size_t(end); ++i) {
+                size_t j = 0;
 #ifdef __SSE2__
-            for (; j < width - 3; j += 4) {
-                STVFU(H(j, i), xlogf(c100v * LVFU(Y(j, i)) / maxLumv + epsv));
-            }
+                for (; j < width - 3; j += 4) {
+                    STVFU(H(j, i),
+                          xlogf(c100v * LVFU(Y(j, i)) / maxLumv + epsv));
+                }
 #endif
-            for (; j < width; ++j) {
-                H(j, i) = xlogf(100.0f * Y(j, i) / maxLum + 1e-4f);
+                for (; j < width; ++j) {
+                    H(j, i) = xlogf(100.0f * Y(j, i) / maxLum + 1e-4f);
+                }
             }
-        }
-
-    ph.setValue(4);
+        });
+    if (!completed) return;
 
     // create gaussian pyramids
     int mins = (width < height) ? width : height;  // smaller dimension
@@ -359,26 +382,44 @@ void tmo_fattal02(size_t width, size_t height, const pfs::Array2Df &Y,
     ph.setValue(8);
 
     // calculate gradients and its average values on pyramid levels
-    pfs::Array2Df **gradients = new pfs::Array2Df *[nlevels];
-    float avgGrad[nlevels];
+    pyramid.avgGrad.resize(nlevels);
     for (int k = 0; k < nlevels; k++) {
-        gradients[k] = new pfs::Array2Df(pyramids[k]->getCols(), pyramids[k]->getRows());
-        avgGrad[k] = calculateGradients(*pyramids[k], *gradients[k], k);
+        pyramid.gradients.push_back(std::unique_ptr<pfs::Array2Df>(
+            new pfs::Array2Df(pyramids[k]->getCols(), pyramids[k]->getRows())));
+        pyramid.avgGrad[k] =
+            calculateGradients(*pyramids[k], *pyramid.gradients[k], k);
+        if (k != 0) {  // pyramids[0] is H, kept by the pyramid
+            delete pyramids[k];
+        }
     }
+    delete[] pyramids;
     ph.setValue(12);
+}
+
+void tmo_fattal02(size_t width, size_t height, const Fattal02Pyramid &pyramid,
+                  pfs::Array2Df &L, float alfa, float beta, float noise,
+                  bool newfattal, bool fftsolver, int detail_level,
+                  pfs::Progress &ph) {
+    PFS_TRACE_SPAN("Fattal02 compression", "tonemap");
+    static const float black_point = 0.1f;
+    static const float white_point = 0.5f;
+    static const float gamma = 1.0f;  // 0.8f;
+    // static const int   detail_level = 3;
+    if (detail_level < 0) detail_level = 0;
+    if (detail_level > 3) detail_level = 3;
+
+    const pfs::Array2Df &H = pyramid.H;
+    const int nlevels = pyramid.gradients.size();
+    std::vector<const pfs::Array2Df *> gradients(nlevels);
+    for (int k = 0; k < nlevels; k++) {
+        gradients[k] = pyramid.gradients[k].get();
+    }
 
     // calculate fi matrix
     pfs::Array2Df FI(width, height);
-    calculateFiMatrix(FI, gradients, avgGrad, nlevels, detail_level, alfa, beta,
-                      noise, newfattal);
+    calculateFiMatrix(FI, gradients.data(), pyramid.avgGrad.data(), nlevels,
+                      detail_level, alfa, beta, noise, newfattal);
 
-    for (int i = 0; i < nlevels; i++) {
-        if(i != 0) // pyramids[0] is H. Will be deleted later
-            delete pyramids[i];
-        delete gradients[i];
-    }
-    delete[] pyramids;
-    delete[] gradients;
     ph.setValue(16);
     if (ph.canceled()) {
         return;
@@ -393,58 +434,64 @@ void tmo_fattal02(size_t width, size_t height, const pfs::Array2Df &Y,
     // side accordingly (basically fft solver assumes U(-1) = U(1), whereas zero
     // Neumann conditions assume U(-1)=U(0)), see also divergence calculation
 
-    if (fftsolver)
-        #pragma omp parallel for
-        for (size_t y = 0; y < height; y++)
-            for (size_t x = 0; x < width; x++) {
-                // sets index+1 based on the boundary assumption H(N+1)=H(N-1)
-                unsigned int yp1 = (y + 1 >= height ? height - 2 : y + 1);
-                unsigned int xp1 = (x + 1 >= width ? width - 2 : x + 1);
-                // forward differences in H, so need to use between-points
-                // approx of FI
-                Gx(x, y) =
-                    (H(xp1, y) - H(x, y)) * 0.5 * (FI(xp1, y) + FI(x, y));
-                Gy(x, y) =
-                    (H(x, yp1) - H(x, y)) * 0.5 * (FI(x, yp1) + FI(x, y));
-            }
-    else
-        #pragma omp parallel for
-        for (size_t y = 0; y < height; y++)
-            for (size_t x = 0; x < width; x++) {
-                int s, e;
-                s = (y + 1 == height ? y : y + 1);
-                e = (x + 1 == width ? x : x + 1);
-
-                Gx(x, y) = (H(e, y) - H(x, y)) * FI(x, y);
-                Gy(x, y) = (H(x, s) - H(x, y)) * FI(x, y);
+    bool completed = pfs::utils::parallelFor(
+        0, height, 16, ph, 16, 18, [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (size_t y = begin; y < size_t(end); y++) {
+                if (fftsolver) {
+                    for (size_t x = 0; x < width; x++) {
+                        // sets index+1 based on the boundary assumption
+                        // H(N+1)=H(N-1)
+                        unsigned int yp1 =
+                            (y + 1 >= height ? height - 2 : y + 1);
+                        unsigned int xp1 = (x + 1 >= width ? width - 2 : x + 1);
+                        // forward differences in H, so need to use
+                        // between-points approx of FI
+                        Gx(x, y) = (H(xp1, y) - H(x, y)) * 0.5 *
+                                   (FI(xp1, y) + FI(x, y));
+                        Gy(x, y) = (H(x, yp1) - H(x, y)) * 0.5 *
+                                   (FI(x, yp1) + FI(x, y));
+                    }
+                } else {
+                    for (size_t x = 0; x < width; x++) {
+                        int s, e;
+                        s = (y + 1 == height ? y : y + 1);
+                        e = (x + 1 == width ? x : x + 1);
+
+                        Gx(x, y) = (H(e, y) - H(x, y)) * FI(x, y);
+                        Gy(x, y) = (H(x, s) - H(x, y)) * FI(x, y);
+                    }
+                }
             }
-
-    ph.setValue(18);
+        });
+    if (!completed) {
+        return;
+    }
 
     // calculate divergence
 
     pfs::Array2Df DivG(width, height);
-    #pragma omp parallel for
-    for (size_t y = 0; y < height; ++y) {
-        for (size_t x = 0; x < width; ++x) {
-            DivG(x, y) = Gx(x, y) + Gy(x, y);
-            if (x > 0) DivG(x, y) -= Gx(x - 1, y);
-            if (y > 0) DivG(x, y) -= Gy(x, y - 1);
-
-            if (fftsolver) {
-                if (x == 0) DivG(x, y) += Gx(x, y);
-                if (y == 0) DivG(x, y) += Gy(x, y);
+    completed = pfs::utils::parallelFor(
+        0, height, 16, ph, 18, 20, [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (size_t y = begin; y < size_t(end); ++y) {
+                for (size_t x = 0; x < width; ++x) {
+                    DivG(x, y) = Gx(x, y) + Gy(x, y);
+                    if (x > 0) DivG(x, y) -= Gx(x - 1, y);
+                    if (y > 0) DivG(x, y) -= Gy(x, y - 1);
+
+                    if (fftsolver) {
+                        if (x == 0) DivG(x, y) += Gx(x, y);
+                        if (y == 0) DivG(x, y) += Gy(x, y);
+                    }
+                }
             }
-        }
-    }
-
-    ph.setValue(20);
-    if (ph.canceled()) {
+        });
+    if (!completed) {
         return;
     }
 
     // solve pde and exponentiate (ie recover compressed image)
     {
+        PFS_TRACE_SPAN("Fattal02 pde", "tonemap");
         pfs::Array2Df U(width, height);
         if (fftsolver) {
             solve_pde_fft(DivG, U, Gx, ph);
@@ -462,40 +509,42 @@ void tmo_fattal02(size_t width, size_t height, const pfs::Array2Df &Y,
 #ifdef __SSE2__
         const vfloat gammav = F2V(gamma);
 #endif
-        #pragma omp parallel for
-        for (size_t i = 0; i < height; ++i) {
-            size_t j = 0;
+        completed = pfs::utils::parallelFor(
+            0, height, 16, ph, 90, 95, [&](ptrdiff_t begin, ptrdiff_t end) {
+                for (size_t i = begin; i < size_t(end); ++i) {
+                    size_t j = 0;
 #ifdef __SSE2__
-            for (; j < width - 3; j += 4) {
-                STVFU(L(j, i), xexpf(gammav * LVFU(U(j, i))));
-            }
+                    for (; j < width - 3; j += 4) {
+                        STVFU(L(j, i), xexpf(gammav * LVFU(U(j, i))));
+                    }
 #endif
-            for (; j < width; ++j) {
-                L(j, i) = xexpf(gamma * U(j, i));
-            }
+                    for (; j < width; ++j) {
+                        L(j, i) = xexpf(gamma * U(j, i));
+                    }
+                }
+            });
+        if (!completed) {
+            return;
         }
     }
-    ph.setValue(95);
 
     // remove percentile of min and max values and renormalize
+    float minLum;
+    float maxLum;
     float cut_min = 0.01f * black_point;
     float cut_max = 1.0f - 0.01f * white_point;
     assert(cut_min >= 0.0f && (cut_max <= 1.0f) && (cut_min < cut_max));
     lhdrengine::findMinMaxPercentile(L.data(), width * height, cut_min, minLum, cut_max, maxLum, true);
 
-    for (size_t idx = 0; idx < height * width; ++idx) {
-        L(idx) = (L(idx) - minLum) / (maxLum - minLum);
-        if (L(idx) <= 0.0f) {
-            L(idx) = 0.0;
-        }
-        // note, we intentionally do not cut off values > 1.0
-    }
-
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    cout << endl;
-    cout << "tmo_fattal02 = " << stop_watch.get_time() << " msec" << endl;
-#endif
-
-    ph.setValue(96);
+    pfs::utils::parallelFor(
+        0, height * width, 1 << 16, ph, 95, 96,
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (ptrdiff_t idx = begin; idx < end; ++idx) {
+                L(idx) = (L(idx) - minLum) / (maxLum - minLum);
+                if (L(idx) <= 0.0f) {
+                    L(idx) = 0.0;
+                }
+                // note, we intentionally do not cut off values > 1.0
+            }
+        });
 }
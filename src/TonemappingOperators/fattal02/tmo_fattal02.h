@@ -33,8 +33,10 @@
 #ifndef TMO_FATTAL02_H
 #define TMO_FATTAL02_H
 
-#include <Libpfs/array2d_fwd.h>
+#include <Libpfs/array2d.h>
 #include <cstddef>
+#include <memory>
+#include <vector>
 
 namespace pfs {
 class Progress;
@@ -59,4 +61,30 @@ void tmo_fattal02(size_t width, size_t height,
                   float beta, float noise, bool newfattal, bool fftsolver,
                   int detail_level, pfs::Progress &ph);
 
+//! \brief Stages of \c tmo_fattal02 that do not depend on alfa, beta, noise
+//! and detail_level: the logarithm of the luminance and the gradients of its
+//! Gaussian pyramid, with their average on each level
+struct Fattal02Pyramid {
+    Fattal02Pyramid() : fftsolver(false) {}
+
+    //! \brief true if the pyramid has been built for a \a width x \a height
+    //! luminance with \a fftsolver
+    bool matches(size_t width, size_t height, bool fftsolver) const;
+
+    bool fftsolver;
+    pfs::Array2Df H;
+    std::vector<std::unique_ptr<pfs::Array2Df> > gradients;
+    std::vector<float> avgGrad;
+};
+
+//! \brief build the parameter independent stages of \c tmo_fattal02
+void fattal02Pyramid(const pfs::Array2Df &Y, bool fftsolver,
+                     Fattal02Pyramid &pyramid, pfs::Progress &ph);
+
+//! \brief \c tmo_fattal02 from the stages built by \c fattal02Pyramid
+void tmo_fattal02(size_t width, size_t height, const Fattal02Pyramid &pyramid,
+                  pfs::Array2Df &L, float alfa, float beta, float noise,
+                  bool newfattal, bool fftsolver, int detail_level,
+                  pfs::Progress &ph);
+
 #endif
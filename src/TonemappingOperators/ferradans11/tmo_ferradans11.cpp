@@ -53,8 +53,8 @@
 #include <Common/init_fftw.h>
 #include <Libpfs/array2d.h>
 #include <Libpfs/progress.h>
-#include <Libpfs/utils/msec_timer.h>
 #include <Libpfs/utils/numeric.h>
+#include <Libpfs/utils/parallel.h>
 #include <TonemappingOperators/pfstmo.h>
 #include "Common/LuminanceOptions.h"
 #include "tmo_ferradans11.h"
@@ -209,7 +209,7 @@ float MSE(float Im1[], float Im2[], int largo, float escala) {
     float res = 0.f;
     float v = 1.f / escala;
     float v2 = 1.f;
-#pragma omp parallel for reduction(+ : res)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) reduction(+ : res)
     for (int i = 0; i < largo; i++) {
         float tmp = (Im1[i]) * v - (Im2[i]) * v2;
         tmp = fabs(tmp);
@@ -222,7 +222,7 @@ void producto(fftwf_complex *A, const fftwf_complex *B, int fil, int col) {
 
     int length = fil * col;
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int i = 0; i < length; i++) {
         float a1 = (A[i][0] * B[i][1] + A[i][1] * B[i][0]);
         A[i][0] = (A[i][0] * B[i][0] - A[i][1] * B[i][1]);
@@ -235,7 +235,7 @@ void nucleo_gaussiano(float res[], int fil, int col, float sigma) {
         1.0 / (sqrt(2 * boost::math::double_constants::pi) * sigma + 1e-6);
     int mitfil = fil / 2;
     int mitcol = col / 2;
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int i = 0; i < fil; i++)
         for (int j = 0; j < col; j++)
             res[i * col + j] = normaliza * xexpf(-((i - mitfil) * (i - mitfil) +
@@ -246,14 +246,14 @@ void nucleo_gaussiano(float res[], int fil, int col, float sigma) {
 void escala(float a[], int largo, float maxv, float minv) {
     float M = a[0];
     float m = a[0];
-#pragma omp parallel for reduction(max:M) reduction(min:m)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) reduction(max:M) reduction(min:m)
     for (int i = 1; i < largo; i++) {
         M = std::max(M, a[i]);
         m = std::min(m, a[i]);
     }
 
     float s = (maxv - minv) / (M - m);
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int i = 0; i < largo; i++) {
         float R = a[i];
         a[i] = minv + s * (R - m);
@@ -264,7 +264,7 @@ void escala(float a[], int largo, float maxv, float minv) {
 void fftshift(float a[], int fil, int col) {
     float tmp;
 
-#pragma omp parallel for private(tmp)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) private(tmp)
     for (int i = 0; i < fil / 2; i++)
         for (int j = 0; j < col / 2; j++) {
             tmp = a[i * col + j];
@@ -280,11 +280,6 @@ void fftshift(float a[], int fil, int col) {
 void tmo_ferradans11(pfs::Array2Df &imR, pfs::Array2Df &imG, pfs::Array2Df &imB,
                      float rho, float invalpha, pfs::Progress &ph) {
 
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
-
     init_fftw();
 
     ph.setValue(0);
@@ -301,17 +296,23 @@ void tmo_ferradans11(pfs::Array2Df &imR, pfs::Array2Df &imG, pfs::Array2Df &imB,
     RGBorig[1] = new float[length];
     RGBorig[2] = new float[length];
 
-#pragma omp parallel for
-    for (int i = 0; i < length; i++) {
-        RGBorig[0][i] = (float)max(imR(i), 0.f);
-        RGBorig[1][i] = (float)max(imG(i), 0.f);
-        RGBorig[2][i] = (float)max(imB(i), 0.f);
+    const bool completed = pfs::utils::parallelFor(
+        0, length, 1 << 14, ph, 0, 10, [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (ptrdiff_t i = begin; i < end; i++) {
+                RGBorig[0][i] = (float)max(imR(i), 0.f);
+                RGBorig[1][i] = (float)max(imG(i), 0.f);
+                RGBorig[2][i] = (float)max(imB(i), 0.f);
+            }
+        });
+    if (!completed) {
+        delete[] RGBorig[0];
+        delete[] RGBorig[1];
+        delete[] RGBorig[2];
+        return;
     }
 
     ///////////////////////////////////////////
 
-    ph.setValue(10);
-
     float *RGB[3];
     RGB[0] = new float[length];
     RGB[1] = new float[length];
@@ -379,15 +380,17 @@ void tmo_ferradans11(pfs::Array2Df &imR, pfs::Array2Df &imG, pfs::Array2Df &imB,
 // mix W-F and N-R
 
         float ln10 = log(10.f);
-#pragma omp parallel for
-        for (int i = 0; i < length; i++) {
-            if (RGBorig[k][i] <= Ir) {
-                RGB[k][i] = K_ * xlogf(RGBorig[k][i] + I0) / ln10 + mKlogc;
-            } else {
-                float In = pow_F(RGBorig[k][i], n);
-                RGB[k][i] = In / (In + sigma_n);
+        pfs::utils::parallelFor(0, length, 1 << 14, [&](ptrdiff_t begin,
+                                                        ptrdiff_t end) {
+            for (ptrdiff_t i = begin; i < end; i++) {
+                if (RGBorig[k][i] <= Ir) {
+                    RGB[k][i] = K_ * xlogf(RGBorig[k][i] + I0) / ln10 + mKlogc;
+                } else {
+                    float In = pow_F(RGBorig[k][i], n);
+                    RGB[k][i] = In / (In + sigma_n);
+                }
             }
-        }
+        });
 
         float minmez = *min_element(RGB[k], RGB[k] + length);
         vsadd(RGB[k], -minmez, RGB[k], length);
@@ -407,7 +410,7 @@ void tmo_ferradans11(pfs::Array2Df &imR, pfs::Array2Df &imG, pfs::Array2Df &imB,
         return;
     }
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int color = 0; color < colors; color++) {
         copy(RGB[color], RGB[color] + length, RGBorig[color]);
         med[color] = medval(RGB[color], length);
@@ -606,15 +609,17 @@ void tmo_ferradans11(pfs::Array2Df &imR, pfs::Array2Df &imG, pfs::Array2Df &imB,
             producto(U7, G, fil, col);
             fftwf_execute(pinvU7);
 
-#pragma omp parallel for
-            for (int i = 0; i < length; i++) {
-                // compute contrast component
-                u0[i] = apply_arctg_slope10(u0[i], norm * iu[i], norm * u2[i], norm * u3[i],
-                                            norm * u4[i], norm * u5[i], norm * u6[i], norm * u7[i]);
+            pfs::utils::parallelFor(0, length, 1 << 14, [&](ptrdiff_t begin,
+                                                            ptrdiff_t end) {
+                for (ptrdiff_t i = begin; i < end; i++) {
+                    // compute contrast component
+                    u0[i] = apply_arctg_slope10(u0[i], norm * iu[i], norm * u2[i], norm * u3[i],
+                                                norm * u4[i], norm * u5[i], norm * u6[i], norm * u7[i]);
 
-                // project onto the interval [-1,1]
-                u0[i] = max(min(u0[i], 1.f), -1.f);
-            }
+                    // project onto the interval [-1,1]
+                    u0[i] = max(min(u0[i], 1.f), -1.f);
+                }
+            });
 
             // normalizing R term to estandarize results
             //
@@ -624,12 +629,14 @@ void tmo_ferradans11(pfs::Array2Df &imR, pfs::Array2Df &imG, pfs::Array2Df &imB,
 
             float norm1 = (1.0 + dt * (1.0 + 255.0 / 253.0));  // assuming alpha=255/253,beta=1
 
-#pragma omp parallel for
-            for (int i = 0; i < length; i++) {
-                RGB[color][i] = (RGB[color][i] + dt * (RGBorig[color][i] + multiplier * u0[i] + 255.f / 253.f * med[color])) / norm1;
-                // project onto the interval [0,1]
-                RGB[color][i] = max(min(RGB[color][i], 1.f), 0.f);
-            }
+            pfs::utils::parallelFor(0, length, 1 << 14, [&](ptrdiff_t begin,
+                                                            ptrdiff_t end) {
+                for (ptrdiff_t i = begin; i < end; i++) {
+                    RGB[color][i] = (RGB[color][i] + dt * (RGBorig[color][i] + multiplier * u0[i] + 255.f / 253.f * med[color])) / norm1;
+                    // project onto the interval [0,1]
+                    RGB[color][i] = max(min(RGB[color][i], 1.f), 0.f);
+                }
+            });
 
             float mse = MSE(RGB0, RGB[color], length, 1.f);
             difference += mse;
@@ -697,9 +704,4 @@ void tmo_ferradans11(pfs::Array2Df &imR, pfs::Array2Df &imG, pfs::Array2Df &imB,
     FFTW_MUTEX::fftw_mutex_free.lock();
     fftwf_free(G);
     FFTW_MUTEX::fftw_mutex_free.unlock();
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    cout << endl;
-    cout << "tmo_ferradans11 = " << stop_watch.get_time() << " msec" << endl;
-#endif
 }
@@ -41,8 +41,10 @@
 #include <string.h>
 #include <algorithm>
 #include <iostream>
+#include <mutex>
+#include <vector>
 
-#include "Libpfs/utils/msec_timer.h"
+#include "Libpfs/utils/parallel.h"
 #include "compression_tmo.h"
 
 #ifdef BRANCH_PREDICTION
@@ -149,30 +151,27 @@ class ImgHistogram {
         std::fill(bins, bins + bin_count, 0);
 
         int pp_count = 0;
+        std::mutex binsMutex;
+
+        pfs::utils::parallelFor(0, pixel_count, 1 << 16, [&](ptrdiff_t begin,
+                                                             ptrdiff_t end) {
+            std::vector<int> binsThr(bin_count, 0);
+
+            int pp_countThr = 0;
+            for (ptrdiff_t pp = begin; pp < end; pp++) {
+                int bin_index = (img[pp] - L_min) / delta;
+                // ignore anything outside the range
+                if (bin_index < 0 || bin_index >= bin_count) continue;
+                binsThr[bin_index]++;
+                pp_countThr++;
+            }
 
-#pragma omp parallel
-{
-        int *binsThr = new int[bin_count];
-        std::fill(binsThr, binsThr + bin_count, 0);
-
-        int pp_countThr = 0;
-        #pragma omp for nowait
-        for (size_t pp = 0; pp < pixel_count; pp++) {
-            int bin_index = (img[pp] - L_min) / delta;
-            // ignore anything outside the range
-            if (bin_index < 0 || bin_index >= bin_count) continue;
-            binsThr[bin_index]++;
-            pp_countThr++;
-        }
-        #pragma omp critical
-        {
+            std::lock_guard<std::mutex> lock(binsMutex);
             pp_count += pp_countThr;
             for (int bb = 0; bb < bin_count; bb++) {
                 bins[bb] += binsThr[bb];
             }
-            delete [] binsThr;
-        }
-}
+        });
         for (int bb = 0; bb < bin_count; bb++) {
             p[bb] = (double)bins[bb] / (double)pp_count;
         }
@@ -193,10 +192,6 @@ void CompressionTMO::tonemap(const float *R_in, const float *G_in, float *B_in,
                              int width, int height, float *R_out, float *G_out,
                              float *B_out, const float *L_in,
                              pfs::Progress &ph) {
-#ifdef TIMER_PROFILING
-    msec_timer stop_watch;
-    stop_watch.start();
-#endif
     const size_t pix_count = width * height;
 
     ph.setValue(0);
@@ -206,21 +201,30 @@ void CompressionTMO::tonemap(const float *R_in, const float *G_in, float *B_in,
 #ifdef __SSE2__
     const vfloat log10v = F2V(0.43429448190325182765112891891661f);
     const vfloat minv = F2V(1e-5f);
-    #pragma omp parallel for
-    for (size_t pp = 0; pp < pix_count - 3; pp += 4) {
-        STVFU(logL[pp], safelog10f(LVFU(L_in[pp]), log10v, minv));
-    }
+    // whole groups of 4 pixels, so that every chunk stays vector aligned
+    bool completed = pfs::utils::parallelFor(
+        0, pix_count / 4, 1 << 14, ph, 0, 33, [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (size_t pp = 4 * begin; pp < 4 * size_t(end); pp += 4) {
+                STVFU(logL[pp], safelog10f(LVFU(L_in[pp]), log10v, minv));
+            }
+        });
 
     for (size_t pp = pix_count - (pix_count % 4); pp < pix_count; pp++) {
         logL[pp] = safelog10f(L_in[pp]);
     }
 #else
-    #pragma omp parallel for
-    for (size_t pp = 0; pp < pix_count; pp++) {
-        logL[pp] = safelog10f(L_in[pp]);
-    }
+    bool completed = pfs::utils::parallelFor(
+        0, pix_count, 1 << 16, ph, 0, 33, [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (ptrdiff_t pp = begin; pp < end; pp++) {
+                logL[pp] = safelog10f(L_in[pp]);
+            }
+        });
 
 #endif
+    if (!completed) {
+        delete[] logL;
+        return;
+    }
     ImgHistogram H;
     H.compute(logL, pix_count);
 
@@ -243,7 +247,6 @@ void CompressionTMO::tonemap(const float *R_in, const float *G_in, float *B_in,
             s[bb] = cbrt(H.p[bb]) / d;
         }
     }
-    ph.setValue(33);
 
 #if 0
     // TODO: Handling of degenerated cases, e.g. when an image contains uniform color
@@ -274,31 +277,25 @@ void CompressionTMO::tonemap(const float *R_in, const float *G_in, float *B_in,
 
 // Apply the tone-curve
 
-#pragma omp parallel for
-    for (int pp = 0; pp < static_cast<int>(pix_count); pp++) {
+    pfs::utils::parallelFor(
+        0, pix_count, 1 << 14, ph, 66, 99, [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (ptrdiff_t pp = begin; pp < end; pp++) {
 #ifdef __SSE2__
-        vfloat rgbv = _mm_set_ps(R_in[pp], G_in[pp], B_in[pp], 0);
-        rgbv = safelog10f(rgbv, log10v, minv);
-        float temp[4];
-        STVFU(temp[0], rgbv);
-        R_out[pp] = lut.interp(temp[3]);
-        G_out[pp] = lut.interp(temp[2]);
-        B_out[pp] = lut.interp(temp[1]);
+                vfloat rgbv = _mm_set_ps(R_in[pp], G_in[pp], B_in[pp], 0);
+                rgbv = safelog10f(rgbv, log10v, minv);
+                float temp[4];
+                STVFU(temp[0], rgbv);
+                R_out[pp] = lut.interp(temp[3]);
+                G_out[pp] = lut.interp(temp[2]);
+                B_out[pp] = lut.interp(temp[1]);
 #else
-        R_out[pp] = lut.interp(safelog10f(R_in[pp]));
-        G_out[pp] = lut.interp(safelog10f(G_in[pp]));
-        B_out[pp] = lut.interp(safelog10f(B_in[pp]));
+                R_out[pp] = lut.interp(safelog10f(R_in[pp]));
+                G_out[pp] = lut.interp(safelog10f(G_in[pp]));
+                B_out[pp] = lut.interp(safelog10f(B_in[pp]));
 #endif
-    }
-    ph.setValue(99);
+            }
+        });
     delete[] s;
     delete[] logL;
-
-#ifdef TIMER_PROFILING
-    stop_watch.stop_and_update();
-    std::cout << std::endl;
-    std::cout << "tmo_mai11 = " << stop_watch.get_time() << " msec"
-              << std::endl;
-#endif
 }
 }
@@ -65,6 +65,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <iostream>
 #include <vector>
 
@@ -85,9 +86,10 @@
 #include "Libpfs/progress.h"
 #include "Libpfs/utils/dotproduct.h"
 #include "Libpfs/utils/minmax.h"
-#include "Libpfs/utils/msec_timer.h"
 #include "Libpfs/utils/numeric.h"
+#include "Libpfs/utils/parallel.h"
 #include "Libpfs/utils/sse.h"
+#include "Libpfs/utils/trace.h"
 #include "Libpfs/rt_algo.h"
 
 using namespace pfs;
@@ -112,6 +114,41 @@ void multiplyA(PyramidT &px, const PyramidT &pC, const Array2Df &x,
 //
 namespace {
 const int NUM_BACKWARDS_CEILING = 3;
+// elements per chunk of the vector operations of lincg
+const ptrdiff_t LINCG_GRAIN = 1 << 14;
+
+// a . b, whose chunks are skipped once the operation is canceled
+float dotProduct(const float *a, const float *b, size_t n,
+                 const Progress &ph) {
+    return static_cast<float>(utils::parallelReduce(
+        0, n, LINCG_GRAIN, 0.0,
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            double sum = 0.0;
+            if (ph.canceled()) return sum;
+            for (ptrdiff_t idx = begin; idx < end; idx++) {
+                sum = sum + (a[idx] * b[idx]);
+            }
+            return sum;
+        },
+        std::plus<double>()));
+}
+
+// r = r - alpha Ap, returning r . r (canceled like dotProduct)
+float subtractAndNorm(float *r, float alpha, const float *Ap, size_t n,
+                      const Progress &ph) {
+    return static_cast<float>(utils::parallelReduce(
+        0, n, LINCG_GRAIN, 0.0,
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            double sum = 0.0;
+            if (ph.canceled()) return sum;
+            for (ptrdiff_t idx = begin; idx < end; idx++) {
+                r[idx] = r[idx] - (alpha * Ap[idx]);
+                sum = sum + (r[idx] * r[idx]);
+            }
+            return sum;
+        },
+        std::plus<double>()));
+}
 }
 
 void lincg(PyramidT &pyramid, PyramidT &pC, const Array2Df &b, Array2Df &x,
@@ -166,14 +203,16 @@ void lincg(PyramidT &pyramid, PyramidT &pC, const Array2Df &b, Array2Df &x,
         multiplyA(pyramid, pC, p, Ap);
 
         // alpha = r.r / (p . Ap)
-        alpha = rdotr_curr / utils::dotProduct(p.data(), Ap.data(), n);
-
-        // r = r - alpha Ap
-        utils::vsubs(r.data(), alpha, Ap.data(), r.data(), n);
-
-        // rdotr = r.r
+        const float pdotAp = dotProduct(p.data(), Ap.data(), n, ph);
+        if (ph.canceled()) break;
+        alpha = rdotr_curr / pdotAp;
+
+        // r = r - alpha Ap, rdotr = r.r
+        // a canceled iteration stops here, leaving x as it was
+        const float rdotr = subtractAndNorm(r.data(), alpha, Ap.data(), n, ph);
+        if (ph.canceled()) break;
         rdotr_prev = rdotr_curr;
-        rdotr_curr = utils::dotProduct(r.data(), n);
+        rdotr_curr = rdotr;
 
         // Have we gone unstable?
         if (rdotr_curr > rdotr_prev) {
@@ -189,7 +228,12 @@ void lincg(PyramidT &pyramid, PyramidT &pC, const Array2Df &b, Array2Df &x,
         }
 
         // x = x + alpha * p
-        utils::vadds(x.data(), alpha, p.data(), x.data(), n);
+        utils::parallelFor(0, n, LINCG_GRAIN,
+                           [&](ptrdiff_t begin, ptrdiff_t end) {
+                               for (ptrdiff_t idx = begin; idx < end; idx++) {
+                                   x(idx) = x(idx) + (alpha * p(idx));
+                               }
+                           });
 
         // Exit if we're done
         // fprintf(stderr, "iter:%d err:%f\n", iter+1, sqrtf(rdotr/bnrm2));
@@ -214,7 +258,12 @@ void lincg(PyramidT &pyramid, PyramidT &pC, const Array2Df &b, Array2Df &x,
         } else {
             // p = r + beta * p
             beta = rdotr_curr / rdotr_prev;
-            utils::vadds(r.data(), beta, p.data(), p.data(), n);
+            utils::parallelFor(
+                0, n, LINCG_GRAIN, [&](ptrdiff_t begin, ptrdiff_t end) {
+                    for (ptrdiff_t idx = begin; idx < end; idx++) {
+                        p(idx) = r(idx) + (beta * p(idx));
+                    }
+                });
         }
     }
 
@@ -246,6 +295,7 @@ void lincg(PyramidT &pyramid, PyramidT &pC, const Array2Df &b, Array2Df &x,
 
 void transformToLuminance(PyramidT &pp, Array2Df &Y, const int itmax,
                           const float tol, Progress &ph) {
+    PFS_TRACE_SPAN("Mantiuk06 solve", "tonemap");
     PyramidT pC = pp;  // copy ctor
 
     pp.computeScaleFactors(pC);
@@ -282,6 +332,7 @@ struct HistDataCompareIndex {
 };
 
 void contrastEqualization(PyramidT &pp, const float contrastFactor) {
+    PFS_TRACE_SPAN("Mantiuk06 contrast equalization", "tonemap");
     // Count size
     size_t totalPixels = 0;
     for (PyramidT::const_iterator itCurr = pp.begin(), itEnd = pp.end();
@@ -351,7 +402,7 @@ void normalizeLuminanceAndRGB(Array2Df &R, Array2Df &G, Array2Df &B,
 
 // std::cout << "clip_min = " << clip_min << std::endl;
 // std::cout << "Ymax = " << Ymax << std::endl;
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int idx = 0; idx < static_cast<int>(Y.size()); idx++) {
         if (R(idx) < clip_min) R(idx) = clip_min;
         if (G(idx) < clip_min) G(idx) = clip_min;
@@ -376,7 +427,7 @@ void denormalizeLuminance(Array2Df &Y) {
 
     const float lumRange = 1.f / (lumMax - lumMin) * DISP_DYN_RANGE;
 
-#pragma omp parallel for  // shared(lumRange, lumMin)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())  // shared(lumRange, lumMin)
     for (int j = 0; j < static_cast<int>(size); j++) {
         Y(j) = (Y(j) - lumMin) * lumRange - DISP_DYN_RANGE;  // x scaled
     }
@@ -415,7 +466,7 @@ void denormalizeRGB(Array2Df &R, Array2Df &G, Array2Df &B, const Array2Df &Y,
 
 #endif
 /* Transform to sRGB */
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (size_t i = 0; i < Y.getRows(); ++i) {
         size_t j = 0;
 #ifdef __SSE2__
@@ -458,11 +509,14 @@ int tmo_mantiuk06_contmap(Array2Df &R, Array2Df &G, Array2Df &B, Array2Df &Y,
     PyramidT pp(r, c);
     ph.setValue(6);
 
-    // calculate gradients for pyramid (Y won't be changed)
-    pp.computeGradients(Y);
+    {
+        PFS_TRACE_SPAN("Mantiuk06 pyramid", "tonemap");
+        // calculate gradients for pyramid (Y won't be changed)
+        pp.computeGradients(Y);
 
-    // transform gradients to R
-    pp.transformToR(detailfactor);
+        // transform gradients to R
+        pp.transformToR(detailfactor);
+    }
     ph.setValue(13);
 
     // Contrast map
@@ -480,8 +534,11 @@ int tmo_mantiuk06_contmap(Array2Df &R, Array2Df &G, Array2Df &B, Array2Df &Y,
 
     // transform gradients to luminance Y (pp -> Y)
     transformToLuminance(pp, Y, itmax, tol, ph);
-    denormalizeLuminance(Y);
-    denormalizeRGB(R, G, B, Y, saturationFactor);
+    {
+        PFS_TRACE_SPAN("Mantiuk06 denormalize", "tonemap");
+        denormalizeLuminance(Y);
+        denormalizeRGB(R, G, B, Y, saturationFactor);
+    }
 
     return PFSTMO_OK;
 }
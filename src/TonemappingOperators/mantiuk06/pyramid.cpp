@@ -41,6 +41,7 @@
 
 #include "Libpfs/array2d.h"
 #include "Libpfs/utils/numeric.h"
+#include "Libpfs/utils/parallel.h"
 #include "Libpfs/utils/sse.h"
 #include "../../sleef.c"
 #define pow_F(a,b) (xexpf(b*xlogf(a)))
@@ -216,7 +217,7 @@ void PyramidT::computeScaleFactors(PyramidT &result) const {
     PyramidContainer::iterator outCurr = result.m_pyramid.begin();
 
     while (inCurr != inEnd) {
-        #pragma omp parallel for
+        #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
         for(size_t i = 0; i < inCurr->getRows(); i++) {
             PyramidS::const_iterator currGxy = inCurr->row_begin(i);
             PyramidS::const_iterator endGxy = inCurr->row_end(i);
@@ -239,7 +240,7 @@ void PyramidT::transformToR(float detailFactor) {
     PyramidContainer::iterator itEnd = m_pyramid.end();
 
     while (itCurr != itEnd) {
-        #pragma omp parallel for
+        #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
         for(size_t i = 0; i < itCurr->getRows(); i++) {
             PyramidS::iterator currGxy = itCurr->row_begin(i);
             PyramidS::iterator endGxy = itCurr->row_end(i);
@@ -259,7 +260,7 @@ void PyramidT::transformToG(float detailFactor) {
     PyramidContainer::iterator itEnd = m_pyramid.end();
 
     while (itCurr != itEnd) {
-        #pragma omp parallel for
+        #pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
         for(size_t i = 0; i < itCurr->getRows(); i++) {
             PyramidS::iterator currGxy = itCurr->row_begin(i);
             PyramidS::iterator endGxy = itCurr->row_end(i);
@@ -344,7 +345,7 @@ void matrixDownsampleFull(size_t inCols, size_t inRows, const float *inputData,
 // (fx1, fy1) is the fraction of the top left pixel showing.
 // (fx2, fy2) is the fraction of the bottom right pixel showing.
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int y = 0; y < static_cast<int>(outRows); y++) {
         const size_t iy1 = (y * inRows) / outRows;
         const size_t iy2 = ((y + 1) * inRows) / outRows;
@@ -401,7 +402,7 @@ void matrixDownsampleSimple(size_t inCols, size_t inRows,
 // for all of the boundary cases to be eliminated, reducing the
 // sampling to a simple average.
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int y = 0; y < static_cast<int>(outRows); y++) {
         const int iy1 = y * 2;
         const float *datap = inputData + iy1 * inCols;
@@ -446,7 +447,7 @@ void matrixUpsampleFull(const size_t outCols, const size_t outRows,
 // Theoretically, this should be the best.
 // const float factor = 1.0f;
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int y = 0; y < static_cast<int>(outRows); y++) {
         const float sy = y * dy;
         const int iy1 = (y * inRows) / outRows;
@@ -474,7 +475,7 @@ void matrixUpsampleFull(const size_t outCols, const size_t outRows,
 void matrixUpsampleSimple(const int outCols, const int outRows,
                           const float *const inputData,
                           float *const outputData) {
-#pragma omp parallel for
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob())
     for (int y = 0; y < outRows; y++) {
         const int iy1 = y / 2;
         float *outp = outputData + y * outCols;
@@ -500,7 +501,7 @@ void calculateGradients(const float *inputData, PyramidS &gradient) {
     const int COLS = gradient.getCols();
     const int ROWS = gradient.getRows();
 
-#pragma omp parallel  // shared(COLS, ROWS)
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())  // shared(COLS, ROWS)
     {
 #pragma omp for nowait
         for (int ky = 0; ky < (ROWS - 1); ++ky) {
@@ -563,7 +564,7 @@ void calculateAndAddDivergence(const PyramidS &G, float *divG) {
         divGy = G[0][kx].gY();
         divG[kx] += divGx + divGy;  // OUT
     }
-#pragma omp parallel for private(divGx, divGy)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) private(divGx, divGy)
     for (int ky = 1; ky < ROWS; ky++) {
         // kx = 0
         divGx = G[ky][0].gX();
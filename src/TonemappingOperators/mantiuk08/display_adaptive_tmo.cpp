@@ -34,8 +34,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #ifdef _OPENMP
@@ -56,6 +58,8 @@
 
 #include "Libpfs/array2d.h"
 #include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
+#include "Libpfs/utils/trace.h"
 
 #ifdef BRANCH_PREDICTION
 #define likely(x) __builtin_expect((x), 1)
@@ -296,37 +300,40 @@ static void compute_gaussian_level(const int width, const int height,
     float *temp_raw = temp.data();
     float *out_raw = out.data();
 
-// Filter rows
-#pragma omp parallel for default(none) shared(in_raw, temp_raw, kernel)
-    for (int r = 0; r < height; r++) {
-        for (int c = 0; c < width; c++) {
-            float sum = 0;
-            for (int j = 0; j < kernel_len; j++) {
-                int l = (j - kernel_len_2) * step + c;
-                if (unlikely(l < 0)) l = -l;
-                if (unlikely(l >= width)) l = 2 * width - 2 - l;
-                sum += in_raw[r * width + l] * kernel[j];
+    // Filter rows
+    pfs::utils::parallelFor(0, height, 16, [&](ptrdiff_t begin, ptrdiff_t end) {
+        for (int r = begin; r < end; r++) {
+            for (int c = 0; c < width; c++) {
+                float sum = 0;
+                for (int j = 0; j < kernel_len; j++) {
+                    int l = (j - kernel_len_2) * step + c;
+                    if (unlikely(l < 0)) l = -l;
+                    if (unlikely(l >= width)) l = 2 * width - 2 - l;
+                    sum += in_raw[r * width + l] * kernel[j];
+                }
+                temp_raw[r * width + c] = sum;
             }
-            temp_raw[r * width + c] = sum;
         }
-    }
-// Filter columns
-#pragma omp parallel for default(none) shared(temp_raw, out_raw, kernel)
+    });
+    // Filter columns
     // process 8 columns per iteration for better usage of cpu cache
-    for (int c = 0; c < width - 7; c+=8) {
-        for (int r = 0; r < height; r++) {
-            float sum[8] = {};
-            for(int cc = 0; cc < 8; ++cc) {
-                for (int j = 0; j < kernel_len; j++) {
-                    int l = (j - kernel_len_2) * step + r;
-                    if (unlikely(l < 0)) l = -l;
-                    if (unlikely(l >= height)) l = 2 * height - 2 - l;
-                    sum[cc] += temp_raw[l * width + c + cc] * kernel[j];
+    pfs::utils::parallelFor(0, width / 8, 4, [&](ptrdiff_t begin,
+                                                 ptrdiff_t end) {
+        for (int c = begin * 8; c < end * 8; c += 8) {
+            for (int r = 0; r < height; r++) {
+                float sum[8] = {};
+                for (int cc = 0; cc < 8; ++cc) {
+                    for (int j = 0; j < kernel_len; j++) {
+                        int l = (j - kernel_len_2) * step + r;
+                        if (unlikely(l < 0)) l = -l;
+                        if (unlikely(l >= height)) l = 2 * height - 2 - l;
+                        sum[cc] += temp_raw[l * width + c + cc] * kernel[j];
+                    }
+                    out_raw[r * width + c + cc] = sum[cc];
                 }
-                out_raw[r * width + c + cc] = sum[cc];
             }
         }
-    }
+    });
     // remaining columns
     for (int c = width - (width % 8); c < width; c++) {
         for (int r = 0; r < height; r++) {
@@ -419,6 +426,7 @@ double conditional_density::x_scale[X_COUNT] = {
 
 std::unique_ptr<datmoConditionalDensity> datmo_compute_conditional_density(
     int width, int height, const float *L, pfs::Progress &ph) {
+    PFS_TRACE_SPAN("Mantiuk08 conditional density", "tonemap");
     gsl_set_error_handler (my_gsl_error_handler);
     ph.setValue(0);
 
@@ -437,20 +445,20 @@ std::unique_ptr<datmoConditionalDensity> datmo_compute_conditional_density(
 
     const float min_val = std::max(min_positive(L, pix_count), MIN_PHVAL);
 
-// Compute log10 of an image
-#pragma omp parallel for default(none) shared(LP_high_raw, L)
-#ifndef __SSE2__
-    for (int i = 0; i < pix_count; i++)
-        LP_high_raw[i] = safe_log10(L[i], min_val);
-#else
-    for (int i = 0; i < pix_count - 3; i += 4)
-        STVFU(LP_high_raw[i], safe_log10(LVFU(L[i]), min_val));
-    // Remaining pixels
-    for (int i = pix_count - (pix_count % 4); i < pix_count; i++)
-        LP_high_raw[i] = safe_log10(L[i], min_val);
+    // Compute log10 of an image
+    pfs::utils::parallelFor(0, pix_count, 1 << 16, [&](ptrdiff_t begin,
+                                                       ptrdiff_t end) {
+        int i = begin;
+#ifdef __SSE2__
+        // the chunks start at multiples of 4, as the serial loop did
+        for (; i < end - 3; i += 4)
+            STVFU(LP_high_raw[i], safe_log10(LVFU(L[i]), min_val));
 #endif
+        // Remaining pixels
+        for (; i < end; i++) LP_high_raw[i] = safe_log10(L[i], min_val);
+    });
 
-    bool warn_out_of_range = false;
+    std::atomic<bool> warn_out_of_range(false);
     C->total = 0;
 
     for (int f = 0; f < C->f_count; f++) {
@@ -467,43 +475,42 @@ std::unique_ptr<datmoConditionalDensity> datmo_compute_conditional_density(
         const int gi_tn = C->g_count / 2 - 1;
         const int gi_t = C->g_count / 2;
 
-#pragma omp parallel
-{
-        double *Cthr = new double[C->x_count * C->g_count];
-        for(int c = 0; c < C->x_count * C->g_count; c++) {
-            Cthr[c] = 0;
-        }
-        #pragma omp for nowait
-        for (int i = 0; i < pix_count; i++) {
-            float g = (*LP_high)(i) - (*LP_low)(i);  // Compute band-pass
-            int x_i = round_int(((*LP_low)(i)-C->l_min) / C->delta);
-            if (unlikely(x_i < 0 || x_i >= C->x_count)) {
-                warn_out_of_range = true;
-                continue;
-            }
-            int g_i = round_int((g + C->g_max) / C->delta);
-            if (unlikely(g_i < 0 || g_i >= C->g_count)) continue;
-
-            if (g > thr && g < C->delta / 2) {
-                // above the threshold +
-                Cthr[gi_tp * C->x_count + x_i]++;
-            } else if (g < -thr && g > -C->delta / 2) {
-                // above the threshold -
-                Cthr[gi_tn * C->x_count + x_i]++;
-            } else {
-                Cthr[g_i * C->x_count + x_i]++;
-            }
-        }
-        #pragma omp critical
-        {
-            for(int g = 0; g < C->g_count; g++) {
-                for(int x = 0; x < C->x_count; x++) {
-                    (*C)(x, g, f) += Cthr[g * C->x_count + x];
+        // each chunk counts in a histogram of its own, added to C at its
+        // end: the counts are integers, so the order does not matter
+        std::mutex mutex;
+        const bool completed = pfs::utils::parallelFor(
+            0, pix_count, 1 << 16, ph, f * PROGRESS_CDF / C->f_count,
+            (f + 1) * PROGRESS_CDF / C->f_count,
+            [&](ptrdiff_t begin, ptrdiff_t end) {
+                std::vector<double> Cthr(C->x_count * C->g_count, 0.);
+                for (int i = begin; i < end; i++) {
+                    float g = (*LP_high)(i) - (*LP_low)(i);  // Compute band-pass
+                    int x_i = round_int(((*LP_low)(i)-C->l_min) / C->delta);
+                    if (unlikely(x_i < 0 || x_i >= C->x_count)) {
+                        warn_out_of_range = true;
+                        continue;
+                    }
+                    int g_i = round_int((g + C->g_max) / C->delta);
+                    if (unlikely(g_i < 0 || g_i >= C->g_count)) continue;
+
+                    if (g > thr && g < C->delta / 2) {
+                        // above the threshold +
+                        Cthr[gi_tp * C->x_count + x_i]++;
+                    } else if (g < -thr && g > -C->delta / 2) {
+                        // above the threshold -
+                        Cthr[gi_tn * C->x_count + x_i]++;
+                    } else {
+                        Cthr[g_i * C->x_count + x_i]++;
+                    }
                 }
-            }
-            delete [] Cthr;
-        }
-}
+                std::lock_guard<std::mutex> lock(mutex);
+                for (int g = 0; g < C->g_count; g++) {
+                    for (int x = 0; x < C->x_count; x++) {
+                        (*C)(x, g, f) += Cthr[g * C->x_count + x];
+                    }
+                }
+            });
+        if (!completed) break;
 
         for (int i = 0; i < C->x_count; i++) {
             // Special case: flat field and no gradients
@@ -526,7 +533,6 @@ std::unique_ptr<datmoConditionalDensity> datmo_compute_conditional_density(
         }
         std::swap(LP_low, LP_high);
 
-        ph.setValue((f + 1) * PROGRESS_CDF / C->f_count);
         if (ph.canceled()) break;
     }
 
@@ -761,6 +767,7 @@ static int optimize_tonecurve(datmoConditionalDensity *C_pub,
                               float enh_factor, double *y, const float white_y,
                               datmoVisualModel visual_model,
                               double scene_l_adapt, pfs::Progress &ph) {
+    PFS_TRACE_SPAN("Mantiuk08 tone curve", "tonemap");
     conditional_density *C = (conditional_density *)C_pub;
 
     double d_dr =
@@ -1080,6 +1087,7 @@ int datmo_apply_tone_curve_cc(float *R_out, float *G_out, float *B_out,
                               const float *L_in, datmoToneCurve *tc,
                               DisplayFunction *df,
                               const float saturation_factor) {
+    PFS_TRACE_SPAN("Mantiuk08 apply tone curve", "tonemap");
     // Create LUT: log10( lum factor ) -> pixel value
     UniformArrayLUT tc_lut(tc->size, tc->x_i);
     for (size_t i = 0; i < tc->size; i++) {
@@ -1107,33 +1115,34 @@ int datmo_apply_tone_curve_cc(float *R_out, float *G_out, float *B_out,
     cc_lut.y_i[tc->size - 1] = 1;
 
     const long pix_count = width * height;
-#pragma omp parallel for default(none) \
-    shared(R_in, G_in, B_in, L_in, R_out, G_out, B_out, tc_lut, cc_lut, df)
-    for (long i = 0; i < pix_count; i++) {
-        float L_fix = clamp_channel(L_in[i]);
-        const float l10 = log10(L_fix);
-        const float L_out = tc_lut.interp(l10);
-        const float s = cc_lut.interp(l10);  // color correction
+    pfs::utils::parallelFor(0, pix_count, 1 << 14, [&](ptrdiff_t begin,
+                                                       ptrdiff_t end) {
+        for (long i = begin; i < end; i++) {
+            float L_fix = clamp_channel(L_in[i]);
+            const float l10 = log10(L_fix);
+            const float L_out = tc_lut.interp(l10);
+            const float s = cc_lut.interp(l10);  // color correction
 #ifdef __SSE2__
-        vfloat vec = _mm_set_ps(R_in[i], G_in[i], B_in[i], 0) / F2V(L_fix);
-        vec = vmaxf(vec, F2V(MIN_PHVAL));
-        vec = pow_F(vec, F2V(s));
-        vec = vec * F2V(L_out);
-        vec = df->inv_display(vec);
-        float tmp[4];
-        STVFU(tmp[0], vec);
-        R_out[i] = tmp[3];
-        G_out[i] = tmp[2];
-        B_out[i] = tmp[1];
+            vfloat vec = _mm_set_ps(R_in[i], G_in[i], B_in[i], 0) / F2V(L_fix);
+            vec = vmaxf(vec, F2V(MIN_PHVAL));
+            vec = pow_F(vec, F2V(s));
+            vec = vec * F2V(L_out);
+            vec = df->inv_display(vec);
+            float tmp[4];
+            STVFU(tmp[0], vec);
+            R_out[i] = tmp[3];
+            G_out[i] = tmp[2];
+            B_out[i] = tmp[1];
 #else
-        R_out[i] =
-            df->inv_display(pow_F(clamp_channel(R_in[i] / L_fix), s) * L_out);
-        G_out[i] =
-            df->inv_display(pow_F(clamp_channel(G_in[i] / L_fix), s) * L_out);
-        B_out[i] =
-            df->inv_display(pow_F(clamp_channel(B_in[i] / L_fix), s) * L_out);
+            R_out[i] =
+                df->inv_display(pow_F(clamp_channel(R_in[i] / L_fix), s) * L_out);
+            G_out[i] =
+                df->inv_display(pow_F(clamp_channel(G_in[i] / L_fix), s) * L_out);
+            B_out[i] =
+                df->inv_display(pow_F(clamp_channel(B_in[i] / L_fix), s) * L_out);
 #endif
-    }
+        }
+    });
 
     return PFSTMO_OK;
 }
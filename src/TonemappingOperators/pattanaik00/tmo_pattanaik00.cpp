@@ -38,6 +38,7 @@
 #include "Libpfs/array2d.h"
 #include "Libpfs/pfs.h"
 #include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
 #include "TonemappingOperators/pfstmo.h"
 #include "../../sleef.c"
 #include "../../opthelper.h"
@@ -326,71 +327,63 @@ void tmo_pattanaik00(pfs::Array2Df &R, pfs::Array2Df &G, pfs::Array2Df &B,
 
     int im_width = Y.getCols();
     int im_height = Y.getRows();
-    int progress = 0;
-    const int progressSteps = std::max(im_height / 98, 1);
-    int phVal = 0;
-    ph.setValue(phVal);
     const float dsbydw = display_sigma / display_white;
 
-#ifdef _OPENMP
-    #pragma omp parallel for firstprivate(Bcone, Brod, sigma_cone, sigma_rod) schedule(dynamic,16)
-#endif
-    for (int y = 0; y < im_height; y++) {
-        for (int x = 0; x < im_width; x++) {
-            float l = Y(x, y);
-            float r = R(x, y) / l;
-            float g = G(x, y) / l;
-            float b = B(x, y) / l;
-
-            if (local) {
-                float adapt = calculateLocalAdaptation(Y, x, y);
-                Bcone = 2e6 / (2e6 + adapt);
-                Brod = 0.04f / (0.04f + adapt);
-
-                sigma_cone = sigma_response_cone(adapt);
-                sigma_rod = sigma_response_rod(adapt);
-            }
-
-            // receptor responses
-            float Rrod = Brod * model_response(l, sigma_rod);
-            float Rcone = Bcone * model_response(l, sigma_cone);
-            float Rlum = Rrod + Rcone;
-            if (Rlum > 0.0f) {
-                Rrod /= Rlum;
-                Rcone /= Rlum;
+    // each chunk works on its own copy of the adaptation state, which the
+    // local model updates for every pixel
+    pfs::utils::parallelFor(
+        0, im_height, 16, ph, 0, 98, [&](ptrdiff_t begin, ptrdiff_t end) {
+            float bcone = Bcone;
+            float brod = Brod;
+            float sigmaCone = sigma_cone;
+            float sigmaRod = sigma_rod;
+
+            for (ptrdiff_t y = begin; y < end; y++) {
+                for (int x = 0; x < im_width; x++) {
+                    float l = Y(x, y);
+                    float r = R(x, y) / l;
+                    float g = G(x, y) / l;
+                    float b = B(x, y) / l;
+
+                    if (local) {
+                        float adapt = calculateLocalAdaptation(Y, x, y);
+                        bcone = 2e6 / (2e6 + adapt);
+                        brod = 0.04f / (0.04f + adapt);
+
+                        sigmaCone = sigma_response_cone(adapt);
+                        sigmaRod = sigma_response_rod(adapt);
+                    }
+
+                    // receptor responses
+                    float Rrod = brod * model_response(l, sigmaRod);
+                    float Rcone = bcone * model_response(l, sigmaCone);
+                    float Rlum = Rrod + Rcone;
+                    if (Rlum > 0.0f) {
+                        Rrod /= Rlum;
+                        Rcone /= Rlum;
+                    }
+
+                    float Scolor = (bcone * pow_F(sigmaCone, n) * n * pow_F(l, n)) / pow2(pow_F(l, n) + pow_F(sigmaCone, n));
+                    Scolor /= S_d;
+
+                    // appearance model
+                    float Ra = (Rlum - disp_x) * disp_y + disp_z;
+                    Ra = (Ra < 1.0f) ? ((Ra > 0.0f) ? Ra : 0.0f) : 0.9999999f;
+
+                    // inverse display model
+                    float I = dsbydw * pow_F(Ra / (1.0f - Ra), 1.0f / n);
+
+                    // apply new luminance
+                    r = I * (pow_F(r, Scolor) * Rcone + Rrod);
+                    g = I * (pow_F(g, Scolor) * Rcone + Rrod);
+                    b = I * (pow_F(b, Scolor) * Rcone + Rrod);
+
+                    R(x, y) = (r < 1.0f) ? ((r > 0.0f) ? r : 0.0f) : 1.0f;
+                    G(x, y) = (g < 1.0f) ? ((g > 0.0f) ? g : 0.0f) : 1.0f;
+                    B(x, y) = (b < 1.0f) ? ((b > 0.0f) ? b : 0.0f) : 1.0f;
+                }
             }
-
-            float Scolor = (Bcone * pow_F(sigma_cone, n) * n * pow_F(l, n)) / pow2(pow_F(l, n) + pow_F(sigma_cone, n));
-            Scolor /= S_d;
-
-            // appearance model
-            float Ra = (Rlum - disp_x) * disp_y + disp_z;
-            Ra = (Ra < 1.0f) ? ((Ra > 0.0f) ? Ra : 0.0f) : 0.9999999f;
-
-            // inverse display model
-            float I = dsbydw * pow_F(Ra / (1.0f - Ra), 1.0f / n);
-
-            // apply new luminance
-            r = I * (pow_F(r, Scolor) * Rcone + Rrod);
-            g = I * (pow_F(g, Scolor) * Rcone + Rrod);
-            b = I * (pow_F(b, Scolor) * Rcone + Rrod);
-
-            R(x, y) = (r < 1.0f) ? ((r > 0.0f) ? r : 0.0f) : 1.0f;
-            G(x, y) = (g < 1.0f) ? ((g > 0.0f) ? g : 0.0f) : 1.0f;
-            B(x, y) = (b < 1.0f) ? ((b > 0.0f) ? b : 0.0f) : 1.0f;
-        }
-#ifdef _OPENMP
-    #pragma omp critical
-#endif
-    {
-        progress += 1;
-        if((progress % progressSteps) == 0) {
-            phVal ++;
-            ph.setValue(std::min(phVal,98));
-        }
-    }
-
-    }
+        });
     ph.setValue(98);
 }
 
@@ -495,7 +488,7 @@ float VisualAdaptationModel::calculateLogAvgLuminance(const pfs::Array2Df &Y) {
 
     size_t size = Y.getCols() * Y.getRows();
 #ifdef _OPENMP
-    #pragma omp parallel
+    #pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
 #endif
 {
     float avLumThr = 0.f;
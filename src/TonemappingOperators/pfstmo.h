@@ -33,6 +33,9 @@ namespace pfs {
 class Frame;
 class Progress;
 }
+struct Durand02BaseLayer;
+struct Fattal02Pyramid;
+struct Reinhard02Convolutions;
 
 #ifdef BRANCH_PREDICTION
 #define likely(x) __builtin_expect((x), 1)
@@ -73,4 +76,19 @@ void pfstmo_reinhard05(pfs::Frame &frame, float brightness,
                        float chromaticadaptation, float lightadaptation,
                        pfs::Progress &ph);
 
+/* Variants used by the sweeps (see TonemapOperator::tonemapSweep): the stages
+ * not depending on the swept parameters are taken from the cache when it is
+ * valid for the frame, and computed and stored into it otherwise */
+void pfstmo_durand02(pfs::Frame &frame, float sigma_s, float sigma_r,
+                     float baseContrast, Durand02BaseLayer *baseLayer,
+                     pfs::Progress &ph);
+void pfstmo_fattal02(pfs::Frame &frame, float opt_alpha, float opt_beta,
+                     float opt_saturation, float opt_noise, bool newfattal,
+                     bool fftsolver, int detail_level,
+                     Fattal02Pyramid *pyramid, pfs::Progress &ph);
+void pfstmo_reinhard02(pfs::Frame &frame, float key, float phi, int num,
+                       int low, int high, bool use_scales,
+                       Reinhard02Convolutions *convolutions,
+                       pfs::Progress &ph);
+
 #endif
@@ -38,11 +38,20 @@
 #include "Libpfs/exception.h"
 #include "Libpfs/frame.h"
 #include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
+#include "TonemappingOperators/pfstmo.h"
 #include "tmo_reinhard02.h"
 #include "../../opthelper.h"
 
 void pfstmo_reinhard02(pfs::Frame &frame, float key, float phi, int num,
                        int low, int high, bool use_scales, pfs::Progress &ph) {
+    pfstmo_reinhard02(frame, key, phi, num, low, high, use_scales, NULL, ph);
+}
+
+void pfstmo_reinhard02(pfs::Frame &frame, float key, float phi, int num,
+                       int low, int high, bool use_scales,
+                       Reinhard02Convolutions *convolutions,
+                       pfs::Progress &ph) {
 
     //--- default tone mapping parameters;
     // float key = 0.18;
@@ -76,7 +85,7 @@ void pfstmo_reinhard02(pfs::Frame &frame, float key, float phi, int num,
     pfs::Array2Df L(w, h);
 
     Reinhard02 tmoperator(Y, &L, use_scales, key, phi, num, low, high,
-                          temporal_coherent, ph);
+                          temporal_coherent, ph, convolutions);
 
     try {
         tmoperator.tmo_reinhard02();
@@ -84,32 +93,35 @@ void pfstmo_reinhard02(pfs::Frame &frame, float key, float phi, int num,
         throw pfs::Exception("Tonemapping Failed!");
     }
 
+    if (ph.canceled()) return;
+
     // TODO: this section can be rewritten using SSE Function
     // DONE
 
-    #pragma omp parallel for
-    for (size_t y = 0; y < h; y++) {
-        size_t x = 0;
+    pfs::utils::parallelFor(0, h, 16, [&](ptrdiff_t begin, ptrdiff_t end) {
+        for (size_t y = begin; y < size_t(end); y++) {
+            size_t x = 0;
 #ifdef __SSE2__
-        for (; x < w - 3; x+=4) {
-            vfloat yrv = LVFU((*Y)(x, y));
-            vmask selmask = vmaskf_eq(yrv, ZEROV);
-            vfloat scalev = vselfnotzero(selmask, LVFU(L(x, y)) / yrv);
+            for (; x < w - 3; x+=4) {
+                vfloat yrv = LVFU((*Y)(x, y));
+                vmask selmask = vmaskf_eq(yrv, ZEROV);
+                vfloat scalev = vselfnotzero(selmask, LVFU(L(x, y)) / yrv);
 
-            STVFU((*Y)(x, y), yrv * scalev);
-            STVFU((*X)(x, y), LVFU((*X)(x, y)) * scalev);
-            STVFU((*Z)(x, y), LVFU((*Z)(x, y)) * scalev);
-        }
+                STVFU((*Y)(x, y), yrv * scalev);
+                STVFU((*X)(x, y), LVFU((*X)(x, y)) * scalev);
+                STVFU((*Z)(x, y), LVFU((*Z)(x, y)) * scalev);
+            }
 #endif
-        for (; x < w; x++) {
-            float yr = (*Y)(x, y);
-            float scale = yr != 0.f ? L(x, y) / yr : 0.f;
+            for (; x < w; x++) {
+                float yr = (*Y)(x, y);
+                float scale = yr != 0.f ? L(x, y) / yr : 0.f;
 
-            (*Y)(x, y) *= scale;
-            (*X)(x, y) *= scale;
-            (*Z)(x, y) *= scale;
+                (*Y)(x, y) *= scale;
+                (*X)(x, y) *= scale;
+                (*Z)(x, y) *= scale;
+            }
         }
-    }
+    });
 
     if (!ph.canceled()) {
         ph.setValue(100);
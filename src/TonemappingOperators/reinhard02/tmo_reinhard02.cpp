@@ -49,15 +49,12 @@
 #include <Libpfs/array2d.h>
 #include <Libpfs/array2d_fwd.h>
 #include <Libpfs/progress.h>
-#include <Libpfs/utils/msec_timer.h>
+#include <Libpfs/utils/parallel.h>
+#include <Libpfs/utils/trace.h>
 #include <TonemappingOperators/pfstmo.h>
 #include "Common/LuminanceOptions.h"
 #include "../../sleef.c"
 #include "../../opthelper.h"
-#ifdef TIMER_PROFILING
-#define BENCHMARK
-#endif
-#include "../../StopWatch.h"
 
 /*
 static int       width, height, scale;
@@ -81,7 +78,7 @@ static CVTS      cvts             = {0, 0};
 static bool temporal_coherent;
 */
 #define pow_F(a,b) (xexpf(b*xlogf(a)))
-#define V1(x, y, i) (m_convolved_image[i][y][x])
+#define V1(x, y, i) (m_convolution_scale * m_convolved_image[i][y][x])
 
 #define SIGMA_I(i) \
     (m_sigma_0 + ((float)i / (float)m_range) * (m_sigma_1 - m_sigma_0))
@@ -142,17 +139,19 @@ void Reinhard02::gaussian_filter(fftwf_complex *filter, float scale, float k) {
     const float a = 1.f / (k * scale);
     constexpr float c = 1.f / 4.f;
 
-#pragma omp parallel for
-    for (int y = 0; y < m_cvts.ymax; y++) {
-        float y1 = (y >= m_cvts.ymax / 2) ? y - m_cvts.ymax : y;
-        float s = erf(a * (y1 - .5f)) - erf(a * (y1 + .5f));
-        for (int x = 0; x < m_cvts.xmax; x++) {
-            float x1 = (x >= m_cvts.xmax / 2) ? x - m_cvts.xmax : x;
-            filter[y * m_cvts.xmax + x][0] =
-                s * (erf(a * (x1 - .5f)) - erf(a * (x1 + .5f))) * c;
-            filter[y * m_cvts.xmax + x][1] = 0.f;
+    pfs::utils::parallelFor(0, m_cvts.ymax, 16, [&](ptrdiff_t begin,
+                                                    ptrdiff_t end) {
+        for (int y = begin; y < end; y++) {
+            float y1 = (y >= m_cvts.ymax / 2) ? y - m_cvts.ymax : y;
+            float s = erf(a * (y1 - .5f)) - erf(a * (y1 + .5f));
+            for (int x = 0; x < m_cvts.xmax; x++) {
+                float x1 = (x >= m_cvts.xmax / 2) ? x - m_cvts.xmax : x;
+                filter[y * m_cvts.xmax + x][0] =
+                    s * (erf(a * (x1 - .5f)) - erf(a * (x1 + .5f))) * c;
+                filter[y * m_cvts.xmax + x][1] = 0.f;
+            }
         }
-    }
+    });
 }
 
 void Reinhard02::build_gaussian_fft() {
@@ -165,6 +164,7 @@ void Reinhard02::build_gaussian_fft() {
 #endif
 
         m_ph.setValue(30 + 40 * scale / m_range);
+        if (m_ph.canceled()) break;
         fftwf_plan p;
         FFTW_MUTEX::fftw_mutex_plan.lock();
         // test for available wisdom
@@ -219,10 +219,12 @@ void Reinhard02::build_image_fft() {
     }
     FFTW_MUTEX::fftw_mutex_plan.unlock();
 
-    #pragma omp parallel for
-    for (int y = 0; y < m_cvts.ymax; y++)
-        for (int x = 0; x < m_cvts.xmax; x++)
-            m_image_fft[y * m_cvts.xmax + x][0] = m_image[y][x];
+    pfs::utils::parallelFor(0, m_cvts.ymax, 16, [&](ptrdiff_t begin,
+                                                    ptrdiff_t end) {
+        for (int y = begin; y < end; y++)
+            for (int x = 0; x < m_cvts.xmax; x++)
+                m_image_fft[y * m_cvts.xmax + x][0] = m_image[y][x];
+    });
 
     fftwf_execute(p);
 
@@ -253,13 +255,15 @@ void Reinhard02::convolve_filter(int scale, fftwf_complex *convolution_fft) {
     int length = m_cvts.xmax * m_cvts.ymax;
     float fft_scale = 1.f / (float)length;
 
-    #pragma omp parallel for
-    for (int i = 0; i < m_cvts.xmax * m_cvts.ymax; i++) {
-        convolution_fft[i][0] = fft_scale * (m_image_fft[i][0] * m_filter_fft[scale][i][0] +
-                                             m_image_fft[i][1] * m_filter_fft[scale][i][1]);
-        convolution_fft[i][1] = fft_scale * (m_image_fft[i][0] * m_filter_fft[scale][i][1] +
-                                             m_image_fft[i][1] * m_filter_fft[scale][i][0]);
-    }
+    pfs::utils::parallelFor(0, length, 1 << 14, [&](ptrdiff_t begin,
+                                                    ptrdiff_t end) {
+        for (ptrdiff_t i = begin; i < end; i++) {
+            convolution_fft[i][0] = fft_scale * (m_image_fft[i][0] * m_filter_fft[scale][i][0] +
+                                                 m_image_fft[i][1] * m_filter_fft[scale][i][1]);
+            convolution_fft[i][1] = fft_scale * (m_image_fft[i][0] * m_filter_fft[scale][i][1] +
+                                                 m_image_fft[i][1] * m_filter_fft[scale][i][0]);
+        }
+    });
 
     fftwf_execute(p);
 
@@ -267,13 +271,16 @@ void Reinhard02::convolve_filter(int scale, fftwf_complex *convolution_fft) {
     fftwf_destroy_plan(p);
     FFTW_MUTEX::fftw_mutex_destroy_plan.unlock();
 
-#pragma omp parallel for
-    for (int y = 0; y < m_cvts.ymax; y++)
-        for (int x = 0, i = y * m_cvts.xmax; x < m_cvts.xmax; x++, i++)
-            m_convolved_image[scale][y][x] = m_convolution_fft[i][0];
+    pfs::utils::parallelFor(0, m_cvts.ymax, 16, [&](ptrdiff_t begin,
+                                                    ptrdiff_t end) {
+        for (int y = begin; y < end; y++)
+            for (int x = 0, i = y * m_cvts.xmax; x < m_cvts.xmax; x++, i++)
+                m_convolved_image[scale][y][x] = m_convolution_fft[i][0];
+    });
 }
 
 void Reinhard02::compute_fourier_convolution() {
+    PFS_TRACE_SPAN("Reinhard02 convolutions", "tonemap");
 
     // activate parallel execution of fft routines
     init_fftw();
@@ -288,6 +295,7 @@ void Reinhard02::compute_fourier_convolution() {
                     (char)13);
 #endif
         m_ph.setValue(70 + 28 * scale / m_range);
+        if (m_ph.canceled()) break;
         convolve_filter(scale, m_convolution_fft);
     }
 #ifndef NDEBUG
@@ -295,24 +303,54 @@ void Reinhard02::compute_fourier_convolution() {
 #endif
 }
 
+bool Reinhard02Convolutions::matches(size_t width, size_t height, int range,
+                                     int low, int high) const {
+    return this->range == range && this->low == low && this->high == high &&
+           scales.size() == static_cast<size_t>(range) && range > 0 &&
+           scales[0].getCols() == width && scales[0].getRows() == height;
+}
+
+void Reinhard02::store_convolutions() {
+    // convolutions of the image scaled to a key of 1
+    m_convolutions->scales.resize(m_range);
+    const float inv_key = 1.f / m_key;
+    for (int scale = 0; scale < m_range; scale++) {
+        pfs::Array2Df &convolution = m_convolutions->scales[scale];
+        convolution.resize(m_cvts.xmax, m_cvts.ymax);
+        pfs::utils::parallelFor(0, m_cvts.ymax, 16, [&](ptrdiff_t begin,
+                                                        ptrdiff_t end) {
+            for (int y = begin; y < end; y++)
+                for (int x = 0; x < m_cvts.xmax; x++)
+                    convolution(x, y) = inv_key * m_convolved_image[scale][y][x];
+        });
+    }
+    m_convolutions->range = m_range;
+    m_convolutions->low = m_scale_low;
+    m_convolutions->high = m_scale_high;
+}
+
 //
 // Tonemapping routines
 //
 
 float Reinhard02::get_maxvalue() {
 
-    float max = 0.;
-
-    #pragma omp parallel for reduction(max:max)
-    for (int y = 0; y < m_cvts.ymax; y++) {
-        for (int x = 0; x < m_cvts.xmax; x++) {
-            max = (max < m_image[y][x]) ? m_image[y][x] : max;
-        }
-    }
-    return max;
+    return pfs::utils::parallelReduce(
+        0, m_cvts.ymax, 16, 0.f,
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            float max = 0.;
+            for (int y = begin; y < end; y++) {
+                for (int x = 0; x < m_cvts.xmax; x++) {
+                    max = (max < m_image[y][x]) ? m_image[y][x] : max;
+                }
+            }
+            return max;
+        },
+        [](float a, float b) { return std::max(a, b); });
 }
 
 void Reinhard02::tonemap_image() {
+    PFS_TRACE_SPAN("Reinhard02 mapping", "tonemap");
 
     float Lmax2;
 
@@ -323,22 +361,24 @@ void Reinhard02::tonemap_image() {
         Lmax2 *= Lmax2;
     }
 
-#pragma omp parallel for
-    for (int y = 0; y < m_cvts.ymax; y++)
-        for (int x = 0; x < m_cvts.xmax; x++) {
-            if (m_use_scales) {
-                int prefscale = m_range - 1;
-                for (int scale = 0; scale < m_range - 1; scale++)
-                    if (fabs(ACTIVITY(x, y, scale)) > m_threshold) {
-                        prefscale = scale;
-                        break;
-                    }
-                m_image[y][x] /= 1.f + V1(x, y, prefscale);
-            } else
-                m_image[y][x] = m_image[y][x] *
-                                   (1.f + (m_image[y][x] / Lmax2)) /
-                                   (1.f + m_image[y][x]);
-        }
+    pfs::utils::parallelFor(0, m_cvts.ymax, 16, [&](ptrdiff_t begin,
+                                                    ptrdiff_t end) {
+        for (int y = begin; y < end; y++)
+            for (int x = 0; x < m_cvts.xmax; x++) {
+                if (m_use_scales) {
+                    int prefscale = m_range - 1;
+                    for (int scale = 0; scale < m_range - 1; scale++)
+                        if (fabs(ACTIVITY(x, y, scale)) > m_threshold) {
+                            prefscale = scale;
+                            break;
+                        }
+                    m_image[y][x] /= 1.f + V1(x, y, prefscale);
+                } else
+                    m_image[y][x] = m_image[y][x] *
+                                       (1.f + (m_image[y][x] / Lmax2)) /
+                                       (1.f + m_image[y][x]);
+            }
+    });
 }
 
 //
@@ -347,35 +387,33 @@ void Reinhard02::tonemap_image() {
 
 float Reinhard02::log_average() {
 
-    float sum = 0.;
-
-#pragma omp parallel
-{
-    float sumthr = 0.;
+    // partial sums are combined in row order, so the result does not depend
+    // on the thread count
+    const float sum = pfs::utils::parallelReduce(
+        0, m_cvts.ymax, 16, 0.f,
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            float sumthr = 0.;
 #ifdef __SSE2__
-    vfloat sumthrv = ZEROV;
-    vfloat c1v = F2V(0.00001f);
+            vfloat sumthrv = ZEROV;
+            vfloat c1v = F2V(0.00001f);
 #endif
-#pragma omp for
-    for (int y = 0; y < m_cvts.ymax; y++) {
-        int x = 0;
+            for (int y = begin; y < end; y++) {
+                int x = 0;
 #ifdef __SSE2__
-        for (; x < m_cvts.xmax - 3; x+=4) {
-            sumthrv += xlogf(c1v + LVFU(m_image[y][x]));
-        }
+                for (; x < m_cvts.xmax - 3; x+=4) {
+                    sumthrv += xlogf(c1v + LVFU(m_image[y][x]));
+                }
 #endif
-        for (; x < m_cvts.xmax; x++) {
-            sumthr += xlogf(0.00001f + m_image[y][x]);
-        }
-    }
-#pragma omp critical
-{
-    sum += sumthr;
+                for (; x < m_cvts.xmax; x++) {
+                    sumthr += xlogf(0.00001f + m_image[y][x]);
+                }
+            }
 #ifdef __SSE2__
-    sum += vhadd(sumthrv);
+            sumthr += vhadd(sumthrv);
 #endif
-}
-}
+            return sumthr;
+        },
+        [](float a, float b) { return a + b; });
     return expf(sum / (float)(m_cvts.xmax * m_cvts.ymax));
 }
 
@@ -389,23 +427,25 @@ void Reinhard02::scale_to_midtone() {
     int hh = m_cvts.ymax >> 1;
 
     float scale_factor = 1.0f / log_average();
-    #pragma omp parallel for
-    for (int y = 0; y < m_cvts.ymax; y++) {
-        for (int x = 0; x < m_cvts.xmax; x++) {
-            float factor;
-            if (m_use_border) {
-                int u = (x > hw) ? m_cvts.xmax - x : x;
-                int v = (y > hh) ? m_cvts.ymax - y : y;
-                int d = (u < v) ? u : v;
-                factor =
-                    (d < border_size)
-                        ? (m_key - low_tone) * kaiserbessel(border_size - d, 0, border_size) + low_tone
-                        : m_key;
-            } else
-                factor = m_key;
-            m_image[y][x] *= scale_factor * factor;
+    pfs::utils::parallelFor(0, m_cvts.ymax, 16, m_ph, 10, 30, [&](ptrdiff_t begin,
+                                                                  ptrdiff_t end) {
+        for (int y = begin; y < end; y++) {
+            for (int x = 0; x < m_cvts.xmax; x++) {
+                float factor;
+                if (m_use_border) {
+                    int u = (x > hw) ? m_cvts.xmax - x : x;
+                    int v = (y > hh) ? m_cvts.ymax - y : y;
+                    int d = (u < v) ? u : v;
+                    factor =
+                        (d < border_size)
+                            ? (m_key - low_tone) * kaiserbessel(border_size - d, 0, border_size) + low_tone
+                            : m_key;
+                } else
+                    factor = m_key;
+                m_image[y][x] *= scale_factor * factor;
+            }
         }
-    }
+    });
 }
 
 /*
@@ -423,7 +463,8 @@ void Reinhard02::scale_to_midtone() {
 
 Reinhard02::Reinhard02(const pfs::Array2Df *Y, pfs::Array2Df *L,
                        bool use_scales, float key, float phi, int num, int low,
-                       int high, bool temporal_coherent, pfs::Progress &ph)
+                       int high, bool temporal_coherent, pfs::Progress &ph,
+                       Reinhard02Convolutions *convolutions)
     : m_cvts(CVTS()),
       m_sigma_0(0),
       m_sigma_1(0),
@@ -444,7 +485,10 @@ Reinhard02::Reinhard02(const pfs::Array2Df *Y, pfs::Array2Df *L,
       m_bbeta(0.f),
       m_threshold(0.05f),
       m_k(1.f / (2.f * 1.4142136f)),
-      m_ph(ph)
+      m_ph(ph),
+      m_convolution_scale(1.f),
+      m_convolutions(convolutions),
+      m_reuse_convolutions(false)
 {
 
     m_cvts.xmax = m_Y->getCols();
@@ -461,7 +505,20 @@ Reinhard02::Reinhard02(const pfs::Array2Df *Y, pfs::Array2Df *L,
     for (int y = 0; y < m_cvts.ymax; y++) {
         m_image[y] = &(*m_L)(0,y);
     }
-    if (use_scales) {
+    if (use_scales && m_convolutions != NULL &&
+        m_convolutions->matches(m_cvts.xmax, m_cvts.ymax, m_range,
+                                m_scale_low, m_scale_high)) {
+        // the convolutions of a previous run on the same luminance, read in
+        // place: they only need the key as a factor
+        m_reuse_convolutions = true;
+        m_convolution_scale = m_key;
+        m_convolved_image = (float ***)malloc(m_range * sizeof(float **));
+        for (int scale = 0; scale < m_range; scale++) {
+            m_convolved_image[scale] = (float **)malloc(m_cvts.ymax * sizeof(float *));
+            for (int y = 0; y < m_cvts.ymax; y++)
+                m_convolved_image[scale][y] = &m_convolutions->scales[scale](0, y);
+        }
+    } else if (use_scales) {
         m_convolved_image = (float ***)malloc(m_range * sizeof(float **));
         FFTW_MUTEX::fftw_mutex_alloc.lock();
         m_image_fft = (fftwf_complex *)fftwf_alloc_complex(length);
@@ -480,7 +537,12 @@ Reinhard02::Reinhard02(const pfs::Array2Df *Y, pfs::Array2Df *L,
 
 Reinhard02::~Reinhard02() {
     free(m_image);
-    if (m_use_scales) {
+    if (m_use_scales && m_reuse_convolutions) {
+        for (int scale = 0; scale < m_range; scale++) {
+            free(m_convolved_image[scale]);
+        }
+        free(m_convolved_image);
+    } else if (m_use_scales) {
         FFTW_MUTEX::fftw_mutex_free.lock();
         for (int scale = 0; scale < m_range; scale++) {
             fftwf_free(m_filter_fft[scale]);
@@ -490,31 +552,33 @@ Reinhard02::~Reinhard02() {
         FFTW_MUTEX::fftw_mutex_free.unlock();
         for (int scale = 0; scale < m_range; scale++) {
             free(m_convolved_image[scale][0]);
+            free(m_convolved_image[scale]);
         }
         free(m_convolved_image);
     }
 }
 
 void Reinhard02::tmo_reinhard02() {
-BENCHFUN
     m_ph.setValue(0);
 
     // reading image
-    #pragma omp parallel for
-    for (int y = 0; y < m_cvts.ymax; y++)
-        for (int x = 0; x < m_cvts.xmax; x++)
-            m_image[y][x] = (*m_Y)(x, y);
-
-    m_ph.setValue(10);
+    pfs::utils::parallelFor(0, m_cvts.ymax, 16, m_ph, 0, 10, [&](ptrdiff_t begin,
+                                                                 ptrdiff_t end) {
+        for (int y = begin; y < end; y++)
+            for (int x = 0; x < m_cvts.xmax; x++)
+                m_image[y][x] = (*m_Y)(x, y);
+    });
     if (m_ph.canceled()) goto end;
 
     scale_to_midtone();
-
-    m_ph.setValue(30);
     if (m_ph.canceled()) goto end;
 
-    if (m_use_scales) {
+    if (m_use_scales && !m_reuse_convolutions) {
         compute_fourier_convolution();
+        if (m_ph.canceled()) goto end;
+        if (m_convolutions != NULL && m_key > 0.f) {
+            store_convolutions();
+        }
     }
 
     tonemap_image();
@@ -35,7 +35,10 @@
 #include <fftw3.h>
 #include <boost/thread/mutex.hpp>
 
-#include <Libpfs/array2d_fwd.h>
+#include <cstddef>
+#include <vector>
+
+#include <Libpfs/array2d.h>
 
 namespace pfs {
 class Progress;
@@ -48,6 +51,24 @@ typedef float COLOR[3]; /* red, green, blue (or X,Y,Z) */
 
 //--- end of defines.h
 
+//! \brief Convolutions of the luminance with the Gaussian of each scale, for
+//! a key of 1: the activity of the local version does not depend on the key
+//! and on phi, and the convolutions scale linearly with the key (the image
+//! is scaled uniformly, as the border is not used)
+struct Reinhard02Convolutions {
+    Reinhard02Convolutions() : range(0), low(0), high(0) {}
+
+    //! \brief true if the convolutions have been computed for a \a width x
+    //! \a height frame with the same scales
+    bool matches(size_t width, size_t height, int range, int low,
+                 int high) const;
+
+    int range;
+    int low;
+    int high;
+    std::vector<pfs::Array2Df> scales;
+};
+
 /*
  * @brief Photographic tone-reproduction
  *
@@ -64,9 +85,12 @@ typedef float COLOR[3]; /* red, green, blue (or X,Y,Z) */
  */
 class Reinhard02 {
    public:
+    //! \param convolutions if not NULL, the convolutions are taken from it
+    //! when it is valid for \a Y, and stored into it otherwise
     Reinhard02(const pfs::Array2Df *Y, pfs::Array2Df *L, bool use_scales,
                float key, float phi, int num, int low, int high,
-               bool temporal_coherent, pfs::Progress &ph);
+               bool temporal_coherent, pfs::Progress &ph,
+               Reinhard02Convolutions *convolutions = NULL);
 
     ~Reinhard02();
 
@@ -93,6 +117,11 @@ class Reinhard02 {
     fftwf_complex *m_image_fft;
     fftwf_complex *m_convolution_fft;
     float ***m_convolved_image;
+    //! factor of the values of m_convolved_image
+    float m_convolution_scale;
+    Reinhard02Convolutions *m_convolutions;
+    //! m_convolved_image points into m_convolutions
+    bool m_reuse_convolutions;
 
     float bessel(float);
     float kaiserbessel(float, float, float);
@@ -105,5 +134,6 @@ class Reinhard02 {
     void build_image_fft();
     void convolve_filter(int, fftwf_complex *);
     void compute_fourier_convolution();
+    void store_convolutions();
 };
 #endif // TMO_REINHARD02_H
@@ -32,6 +32,7 @@
 
 #include "tmo_reinhard05.h"
 #include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
 #include "TonemappingOperators/pfstmo.h"
 
 #include <assert.h>
@@ -48,18 +49,28 @@ using namespace std;
 
 namespace {
 
-void computeAverage(const float *samples, size_t width, size_t height, float &average) {
-
-    double summation = 0.0; // always use double precision for large summations
-#ifdef _OPENMP
-    #pragma omp parallel for reduction(+:summation)
-#endif
-    for (size_t y = 0; y < height; ++y) {
-        for (size_t x = 0; x < width; ++x) {
-            summation += samples[y * width + x];
-        }
-    }
+// rows per chunk of the parallel loops
+const ptrdiff_t ROWS_PER_CHUNK = 16;
+
+bool computeAverage(const float *samples, size_t width, size_t height,
+                    float &average, pfs::Progress &ph, int fromValue,
+                    int toValue) {
+
+    // always use double precision for large summations
+    const double summation = pfs::utils::parallelReduce(
+        0, height, ROWS_PER_CHUNK, ph, fromValue, toValue, 0.0,
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            double partial = 0.0;
+            for (ptrdiff_t y = begin; y < end; ++y) {
+                for (size_t x = 0; x < width; ++x) {
+                    partial += samples[y * width + x];
+                }
+            }
+            return partial;
+        },
+        [](double a, double b) { return a + b; });
     average = summation / (width * height);
+    return !ph.canceled();
 }
 
 struct LuminanceProperties {
@@ -72,74 +83,79 @@ struct LuminanceProperties {
     float imageBrightness;
 };
 
-void computeLuminanceProperties(const float *samples, size_t width, size_t height,
-                                LuminanceProperties &luminanceProperties,
-                                const Reinhard05Params &params) {
-
-    // equalization parameters for the Luminance Channel
-    float min_lum = numeric_limits<float>::max();
-    float max_lum = -numeric_limits<float>::max();
-    float avg_lum = 0.f;
-    float adapted_lum = 0.f;
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-{
-    float min_lumthr = numeric_limits<float>::max();
-    float max_lumthr = -numeric_limits<float>::max();
-    float avg_lumthr = 0.f;
-    float adapted_lumthr = 0.f;
+//! \brief partial statistics of the luminance over some rows
+struct LuminanceSums {
+    float min;
+    float max;
+    double sum;
+    double logSum;
+};
 
+bool computeLuminanceProperties(const float *samples, size_t width,
+                                size_t height,
+                                LuminanceProperties &luminanceProperties,
+                                const Reinhard05Params &params,
+                                pfs::Progress &ph, int fromValue,
+                                int toValue) {
+
+    const LuminanceSums identity = {numeric_limits<float>::max(),
+                                    -numeric_limits<float>::max(), 0.0, 0.0};
+    const LuminanceSums sums = pfs::utils::parallelReduce(
+        0, height, ROWS_PER_CHUNK, ph, fromValue, toValue, identity,
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            float min_lum = identity.min;
+            float max_lum = identity.max;
+            float avg_lum = 0.f;
+            float adapted_lum = 0.f;
 #ifdef __SSE2__
-    vfloat min_lumv = F2V(min_lum);
-    vfloat max_lumv = F2V(max_lum);
-    vfloat avg_lumv = ZEROV;
-    vfloat adapted_lumv = ZEROV;
-    vfloat c1v = F2V(2.3e-5f);
+            vfloat min_lumv = F2V(min_lum);
+            vfloat max_lumv = F2V(max_lum);
+            vfloat avg_lumv = ZEROV;
+            vfloat adapted_lumv = ZEROV;
+            vfloat c1v = F2V(2.3e-5f);
 #endif
-#ifdef _OPENMP
-    #pragma omp for nowait
-#endif
-    for (size_t y = 0; y < height; ++y) {
-        size_t x = 0;
+            for (ptrdiff_t y = begin; y < end; ++y) {
+                size_t x = 0;
 #ifdef __SSE2__
-        for (; x < width - 3; x += 4) {
-            vfloat value = LVFU(samples[y * width + x]);
-            min_lumv = vminf(min_lumv, value);
-            max_lumv = vmaxf(max_lumv, value);
-            avg_lumv += value;
-            adapted_lumv += xlogf(c1v + value);
-        }
-#endif
-        for (; x < width; ++x) {
-            float value = samples[y * width + x];
-            min_lum = std::min(min_lum, value);
-            max_lum = std::max(max_lum, value);
-            avg_lum += value;
-            adapted_lum += xlogf(2.3e-5f + value);
-        }
-    }
-#ifdef _OPENMP
-#pragma omp critical
+                for (; x + 3 < width; x += 4) {
+                    vfloat value = LVFU(samples[y * width + x]);
+                    min_lumv = vminf(min_lumv, value);
+                    max_lumv = vmaxf(max_lumv, value);
+                    avg_lumv += value;
+                    adapted_lumv += xlogf(c1v + value);
+                }
 #endif
-{
-    min_lum = std::min(min_lum, min_lumthr);
-    max_lum = std::max(max_lum, max_lumthr);
-    avg_lum += avg_lumthr;
-    adapted_lum += adapted_lumthr;
+                for (; x < width; ++x) {
+                    float value = samples[y * width + x];
+                    min_lum = std::min(min_lum, value);
+                    max_lum = std::max(max_lum, value);
+                    avg_lum += value;
+                    adapted_lum += xlogf(2.3e-5f + value);
+                }
+            }
 #ifdef __SSE2__
-    min_lum = std::min(min_lum, vhmin(min_lumv));
-    max_lum = std::max(max_lum, vhmax(max_lumv));
-    avg_lum += vhadd(avg_lumv);
-    adapted_lum += vhadd(adapted_lumv);
+            min_lum = std::min(min_lum, vhmin(min_lumv));
+            max_lum = std::max(max_lum, vhmax(max_lumv));
+            avg_lum += vhadd(avg_lumv);
+            adapted_lum += vhadd(adapted_lumv);
 #endif
-}
-}
-
-    luminanceProperties.max = xlogf(max_lum);
-    luminanceProperties.min = xlogf(min_lum);
-    luminanceProperties.adaptedAverage = adapted_lum / (width * height);
-    luminanceProperties.average = avg_lum / (width * height);
+            const LuminanceSums partial = {min_lum, max_lum, avg_lum,
+                                           adapted_lum};
+            return partial;
+        },
+        [](const LuminanceSums &a, const LuminanceSums &b) {
+            const LuminanceSums result = {std::min(a.min, b.min),
+                                          std::max(a.max, b.max),
+                                          a.sum + b.sum,
+                                          a.logSum + b.logSum};
+            return result;
+        });
+    if (ph.canceled()) return false;
+
+    luminanceProperties.max = xlogf(sums.max);
+    luminanceProperties.min = xlogf(sums.min);
+    luminanceProperties.adaptedAverage = sums.logSum / (width * height);
+    luminanceProperties.average = sums.sum / (width * height);
 
     // image key (k)
     luminanceProperties.imageKey =
@@ -150,113 +166,130 @@ void computeLuminanceProperties(const float *samples, size_t width, size_t heigh
         0.3f + 0.7f * std::pow(luminanceProperties.imageKey, 1.4f);
     // image brightness (m?)
     luminanceProperties.imageBrightness = std::exp(-params.m_brightness);
+    return true;
 }
 
-void transformChannel(const float *samplesChannel,
-                             const float *samplesLuminance,
-                             float *outputSamples, size_t width, size_t height,
-                             float channelAverage,
-                             const Reinhard05Params &params,
-                             const LuminanceProperties &lumProps,
-                             float &minSample, float &maxSample) {
+//! \brief range of the transformed samples
+struct SampleRange {
+    float min;
+    float max;
+};
 
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-{
-    float minSampleThr = minSample;
-    float maxSampleThr = maxSample;
+bool transformChannel(const float *samplesChannel,
+                      const float *samplesLuminance, float *outputSamples,
+                      size_t width, size_t height, float channelAverage,
+                      const Reinhard05Params &params,
+                      const LuminanceProperties &lumProps, float &minSample,
+                      float &maxSample, pfs::Progress &ph, int fromValue,
+                      int toValue) {
+
+    // the range found so far is the starting point of every chunk
+    const SampleRange identity = {minSample, maxSample};
+    const SampleRange range = pfs::utils::parallelReduce(
+        0, height, ROWS_PER_CHUNK, ph, fromValue, toValue, identity,
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            float minSampleThr = identity.min;
+            float maxSampleThr = identity.max;
 #ifdef __SSE2__
-    vfloat onev = F2V(1.f);
-    vfloat m_chromaticAdaptationv = F2V(params.m_chromaticAdaptation);
-    vfloat m_lightAdaptationv = F2V(params.m_lightAdaptation);
-    vfloat channelAveragev = F2V(channelAverage);
-    vfloat laveragev = F2V(lumProps.average);
-    vfloat limageBrightnessv = F2V(lumProps.imageBrightness);
-    vfloat limageContrastv = F2V(lumProps.imageContrast);
-    vfloat minSamplev = F2V(minSample);
-    vfloat maxSamplev = F2V(maxSample);
-#endif
-#ifdef _OPENMP
-    #pragma omp for
+            vfloat onev = F2V(1.f);
+            vfloat m_chromaticAdaptationv = F2V(params.m_chromaticAdaptation);
+            vfloat m_lightAdaptationv = F2V(params.m_lightAdaptation);
+            vfloat channelAveragev = F2V(channelAverage);
+            vfloat laveragev = F2V(lumProps.average);
+            vfloat limageBrightnessv = F2V(lumProps.imageBrightness);
+            vfloat limageContrastv = F2V(lumProps.imageContrast);
+            vfloat minSamplev = F2V(identity.min);
+            vfloat maxSamplev = F2V(identity.max);
 #endif
-    for (size_t y = 0; y < height; ++y) {
-        size_t x = 0;
+            for (ptrdiff_t y = begin; y < end; ++y) {
+                size_t x = 0;
 #ifdef __SSE2__
-        for (; x < width - 3; x+=4) {
-            vfloat chval = LVFU(samplesChannel[y * width + x]);
-            vfloat oldchval = chval;
-            vfloat yval = LVFU(samplesLuminance[y * width + x]);
-            vmask selmask = vandm(vmaskf_neq(chval, ZEROV), vmaskf_neq(yval, ZEROV));
-            // local light adaptation
-            vfloat Il = (m_chromaticAdaptationv * chval) +
-                       ((onev - m_chromaticAdaptationv) * yval);
-            // global light adaptation
-            vfloat Ig =
-                (m_chromaticAdaptationv * channelAveragev) +
-                ((onev - m_chromaticAdaptationv) * laveragev);
-            // interpolated light adaptation
-            vfloat Ia = (m_lightAdaptationv * Il) +
-                       ((onev - m_lightAdaptationv) * Ig);
-            // photoreceptor equation
-            chval /= chval + pow_F(limageBrightnessv * Ia, limageContrastv);
-
-            maxSamplev = vself(selmask, vmaxf(chval, maxSamplev), maxSamplev);
-            minSamplev = vself(selmask, vminf(chval, minSamplev), minSamplev);
-            chval = vself(selmask, chval, oldchval);
-            STVFU(outputSamples[y * width + x], chval);
-        }
+                for (; x + 3 < width; x += 4) {
+                    vfloat chval = LVFU(samplesChannel[y * width + x]);
+                    vfloat oldchval = chval;
+                    vfloat yval = LVFU(samplesLuminance[y * width + x]);
+                    vmask selmask = vandm(vmaskf_neq(chval, ZEROV),
+                                          vmaskf_neq(yval, ZEROV));
+                    // local light adaptation
+                    vfloat Il = (m_chromaticAdaptationv * chval) +
+                                ((onev - m_chromaticAdaptationv) * yval);
+                    // global light adaptation
+                    vfloat Ig = (m_chromaticAdaptationv * channelAveragev) +
+                                ((onev - m_chromaticAdaptationv) * laveragev);
+                    // interpolated light adaptation
+                    vfloat Ia = (m_lightAdaptationv * Il) +
+                                ((onev - m_lightAdaptationv) * Ig);
+                    // photoreceptor equation
+                    chval /=
+                        chval + pow_F(limageBrightnessv * Ia, limageContrastv);
+
+                    maxSamplev =
+                        vself(selmask, vmaxf(chval, maxSamplev), maxSamplev);
+                    minSamplev =
+                        vself(selmask, vminf(chval, minSamplev), minSamplev);
+                    chval = vself(selmask, chval, oldchval);
+                    STVFU(outputSamples[y * width + x], chval);
+                }
 #endif
-        for (; x < width; ++x) {
-            float chval = samplesChannel[y * width + x];
-            float yval = samplesLuminance[y * width + x];
-            if (yval != 0.0f && chval != 0.0f) {
-                // local light adaptation
-                float Il = (params.m_chromaticAdaptation * chval) +
-                           ((1.f - params.m_chromaticAdaptation) * yval);
-                // global light adaptation
-                float Ig =
-                    (params.m_chromaticAdaptation * channelAverage) +
-                    ((1.f - params.m_chromaticAdaptation) * lumProps.average);
-                // interpolated light adaptation
-                float Ia = (params.m_lightAdaptation * Il) +
-                           ((1.f - params.m_lightAdaptation) * Ig);
-                // photoreceptor equation
-                chval /= chval + pow_F(lumProps.imageBrightness * Ia,
-                                                  lumProps.imageContrast);
-
-                maxSampleThr = std::max(chval, maxSampleThr);
-                minSampleThr = std::min(chval, minSampleThr);
+                for (; x < width; ++x) {
+                    float chval = samplesChannel[y * width + x];
+                    float yval = samplesLuminance[y * width + x];
+                    if (yval != 0.0f && chval != 0.0f) {
+                        // local light adaptation
+                        float Il = (params.m_chromaticAdaptation * chval) +
+                                   ((1.f - params.m_chromaticAdaptation) * yval);
+                        // global light adaptation
+                        float Ig =
+                            (params.m_chromaticAdaptation * channelAverage) +
+                            ((1.f - params.m_chromaticAdaptation) *
+                             lumProps.average);
+                        // interpolated light adaptation
+                        float Ia = (params.m_lightAdaptation * Il) +
+                                   ((1.f - params.m_lightAdaptation) * Ig);
+                        // photoreceptor equation
+                        chval /= chval + pow_F(lumProps.imageBrightness * Ia,
+                                               lumProps.imageContrast);
+
+                        maxSampleThr = std::max(chval, maxSampleThr);
+                        minSampleThr = std::min(chval, minSampleThr);
+                    }
+                    outputSamples[y * width + x] = chval;
+                }
             }
-            outputSamples[y * width + x] = chval;
-        }
-    }
-#ifdef _OPENMP
-#pragma omp critical
-#endif
-{
-    minSample = std::min(minSampleThr, minSample);
-    maxSample = std::max(maxSampleThr, maxSample);
 #ifdef __SSE2__
-    minSample = std::min(minSample, vhmin(minSamplev));
-    maxSample = std::max(maxSample, vhmax(maxSamplev));
+            minSampleThr = std::min(minSampleThr, vhmin(minSamplev));
+            maxSampleThr = std::max(maxSampleThr, vhmax(maxSamplev));
 #endif
-}
-}
+            const SampleRange partial = {minSampleThr, maxSampleThr};
+            return partial;
+        },
+        [](const SampleRange &a, const SampleRange &b) {
+            const SampleRange result = {std::min(a.min, b.min),
+                                        std::max(a.max, b.max)};
+            return result;
+        });
+
+    minSample = range.min;
+    maxSample = range.max;
+    return !ph.canceled();
 }
 
-void normalizeChannel(float *samples, size_t width, size_t height, float min, float max) {
+void normalizeChannels(float *samplesR, float *samplesG, float *samplesB,
+                       size_t width, size_t height, float min, float max,
+                       pfs::Progress &ph, int fromValue, int toValue) {
 
     float dividor = max - min;
-#ifdef _OPENMP
-    #pragma omp parallel for
-#endif
-    for (size_t y = 0; y < height; ++y) {
-        // manual vectorization of this simple loop gives no speedup. Most likely compiler auto-vectorizes this well
-        for (size_t x = 0; x < width; ++x) {
-            samples[y * width + x] = (samples[y * width + x] - min) / (dividor);
-        }
-    }
+    pfs::utils::parallelFor(
+        0, height, ROWS_PER_CHUNK, ph, fromValue, toValue,
+        [&](ptrdiff_t begin, ptrdiff_t end) {
+            for (float *samples : {samplesR, samplesG, samplesB}) {
+                // manual vectorization of this simple loop gives no speedup.
+                // Most likely compiler auto-vectorizes this well
+                for (size_t idx = begin * width; idx < end * width; ++idx) {
+                    samples[idx] = (samples[idx] - min) / (dividor);
+                }
+            }
+        });
 }
 
 }
@@ -267,46 +300,38 @@ void tmo_reinhard05(size_t width, size_t height, float *nR, float *nG,
 
     float Cav[] = {0.0f, 0.0f, 0.0f};
 
-    computeAverage(nR, width, height, Cav[0]);
-    ph.setValue(2);
-
-    computeAverage(nG, width, height, Cav[1]);
-    ph.setValue(4);
-
-    computeAverage(nB, width, height, Cav[2]);
-    ph.setValue(6);
+    if (!computeAverage(nR, width, height, Cav[0], ph, 0, 2)) return;
+    if (!computeAverage(nG, width, height, Cav[1], ph, 2, 4)) return;
+    if (!computeAverage(nB, width, height, Cav[2], ph, 4, 6)) return;
 
     LuminanceProperties luminanceProperties;
-    computeLuminanceProperties(nY, width, height, luminanceProperties, params);
-    ph.setValue(11);
+    if (!computeLuminanceProperties(nY, width, height, luminanceProperties,
+                                    params, ph, 6, 11)) {
+        return;
+    }
 
     // output
     float max_col = std::numeric_limits<float>::min();
     float min_col = std::numeric_limits<float>::max();
 
-
     // transform Red Channel
-    transformChannel(nR, nY, nR, width, height, Cav[0], params, luminanceProperties,
-                     min_col, max_col);
-    ph.setValue(38);
+    if (!transformChannel(nR, nY, nR, width, height, Cav[0], params,
+                          luminanceProperties, min_col, max_col, ph, 11, 38)) {
+        return;
+    }
 
     // transform Green Channel
-    transformChannel(nG, nY, nG, width, height, Cav[1], params, luminanceProperties,
-                     min_col, max_col);
-    ph.setValue(58);
+    if (!transformChannel(nG, nY, nG, width, height, Cav[1], params,
+                          luminanceProperties, min_col, max_col, ph, 38, 58)) {
+        return;
+    }
 
     // transform Blue Channel
-    transformChannel(nB, nY, nB, width, height, Cav[2], params, luminanceProperties,
-                     min_col, max_col);
-    ph.setValue(78);
+    if (!transformChannel(nB, nY, nB, width, height, Cav[2], params,
+                          luminanceProperties, min_col, max_col, ph, 58, 78)) {
+        return;
+    }
 
     //--- normalize intensities
-    // normalize RED channel
-    normalizeChannel(nR, width, height, min_col, max_col);
-
-    // normalize GREEN channel
-    normalizeChannel(nG, width, height, min_col, max_col);
-
-    // normalize BLUE channel
-    normalizeChannel(nB, width, height, min_col, max_col);
+    normalizeChannels(nR, nG, nB, width, height, min_col, max_col, ph, 78, 100);
 }
@@ -29,6 +29,8 @@
 #include <cassert>
 #include <cmath>
 
+#include "Libpfs/utils/parallel.h"
+
 #include "UI/GammaAndLevels.h"
 #include "UI/ui_GammaAndLevels.h"
 
@@ -193,7 +195,7 @@ void GammaAndLevels::refreshLUT() {
                         QImage::Format_RGB32);
     QRgb *dst = reinterpret_cast<QRgb *>(previewimage.bits());
 
-#pragma omp parallel for shared(src, dst)
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) shared(src, dst)
     for (int i = 0; i < m_ReferenceQImage.width() * m_ReferenceQImage.height();
          ++i) {
         float red = static_cast<float>(qRed(src[i])) / 255.f;
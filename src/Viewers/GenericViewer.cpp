@@ -89,12 +89,8 @@ GenericViewer::GenericViewer(pfs::Frame *frame, QWidget *parent, bool ns)
     mVBL->addWidget(mView);
     mView->show();
 
-    mPixmap = new IGraphicsPixmapItem();
-    mScene->addItem(mPixmap);
-    connect(mPixmap, &IGraphicsPixmapItem::selectionReady, this,
-            &GenericViewer::selectionReady);
-    connect(mPixmap, &IGraphicsPixmapItem::startDragging, this,
-            &GenericViewer::startDragging);
+    mPixmap = NULL;
+    setPixmapItem(new IGraphicsPixmapItem());
 }
 
 GenericViewer::~GenericViewer() {
@@ -110,6 +106,18 @@ void GenericViewer::changeEvent(QEvent *event) {
     QWidget::changeEvent(event);
 }
 
+void GenericViewer::setPixmapItem(IGraphicsPixmapItem *item) {
+    // the destructor removes the item from the scene
+    delete mPixmap;
+
+    mPixmap = item;
+    mScene->addItem(mPixmap);
+    connect(mPixmap, &IGraphicsPixmapItem::selectionReady, this,
+            &GenericViewer::selectionReady);
+    connect(mPixmap, &IGraphicsPixmapItem::startDragging, this,
+            &GenericViewer::startDragging);
+}
+
 void GenericViewer::fitToWindow(bool /* checked */) {
     // DO NOT de-comment: this line is not an optimization, it's a nice way to
     // stop everything working correctly!
@@ -274,10 +282,9 @@ bool GenericViewer::hasSelection(void) { return mPixmap->hasSelection(); }
 void GenericViewer::slotCornerButtonPressed() {
     mPanIconWidget = new PanIconWidget(this);
 
-    // is there a way to avoid this call?
-    // how expensive is to call this function?
-    QImage image = this->getQImage();
-    mPanIconWidget->setImage(&image);
+    // the pixmap can be smaller than the frame (see HdrTileItem)
+    QImage image = mPixmap->pixmap().toImage();
+    mPanIconWidget->setImage(&image, QSize(getWidth(), getHeight()));
 
     float zf = this->getScaleFactor();
     float leftviewpos = (float)(mView->horizontalScrollBar()->value());
@@ -383,10 +390,11 @@ pfs::Frame *GenericViewer::getFrame() const { return mFrame.get(); }
 void GenericViewer::startDragging() {
     QDrag *drag = new QDrag(this);
     QMimeData *mimeData = new QMimeData;
-    mimeData->setImageData(mPixmap->pixmap().toImage());
+    const QImage image = getQImage();
+    mimeData->setImageData(image);
     drag->setMimeData(mimeData);
     drag->setPixmap(
-        mPixmap->pixmap().scaledToHeight(mPixmap->pixmap().height() / 10));
+        QPixmap::fromImage(image.scaledToHeight(image.height() / 10)));
 
     /*Qt::DropAction dropAction =*/drag->exec();
 }
@@ -144,7 +144,7 @@ class GenericViewer : public QWidget {
     virtual QString getExifComment() = 0;
 
     //! \brief returns a QImage that reflects the content of the viewerport
-    QImage getQImage() const;
+    virtual QImage getQImage() const;
 
     //! \brief set new QImage
     void setQImage(const QImage &qimage);
@@ -176,6 +176,10 @@ class GenericViewer : public QWidget {
     virtual void retranslateUi();
     virtual void changeEvent(QEvent *event);
 
+    //! \brief replace the item showing the frame (the previous one gets
+    //! deleted)
+    void setPixmapItem(IGraphicsPixmapItem *item);
+
     QToolBar *mToolBar;
     QToolButton *mCornerButton;
     PanIconWidget *mPanIconWidget;
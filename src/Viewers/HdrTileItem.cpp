@@ -0,0 +1,219 @@
+/**
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ *
+ * @author agent <agent@local>
+ *
+ */
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+
+#include "Libpfs/array2d.h"
+#include "Libpfs/colorspace/kernels.h"
+#include "Libpfs/frame.h"
+#include "Libpfs/manip/pyramid.h"
+#include "Libpfs/utils/parallel.h"
+#include "Libpfs/utils/trace.h"
+#include "Viewers/HdrTileItem.h"
+
+namespace {
+// 128 MB of remapped tiles
+const int TILE_CACHE_COST = 128 * 1024;
+}
+
+const int HdrTileItem::TILE_SIZE;
+
+HdrTileItem::HdrTileItem(QGraphicsItem *parent)
+    : QGraphicsPixmapItem(parent),
+      IGraphicsPixmapItem(parent),
+      m_width(0),
+      m_height(0),
+      m_minValue(0.f),
+      m_maxValue(1.f),
+      m_mappingType(MAP_GAMMA2_2),
+      m_tiles(TILE_CACHE_COST) {
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+HdrTileItem::~HdrTileItem() {}
+
+void HdrTileItem::setFrame(const pfs::Frame *frame) {
+    prepareGeometryChange();
+
+    m_tiles.clear();
+    if (frame != NULL && frame->isValid()) {
+        m_pyramid.reset(new pfs::FramePyramid(*frame, TILE_SIZE));
+        m_width = static_cast<int>(frame->getWidth());
+        m_height = static_cast<int>(frame->getHeight());
+    } else {
+        m_pyramid.reset();
+        m_width = 0;
+        m_height = 0;
+    }
+    updateOverview();
+}
+
+void HdrTileItem::setMapping(float minValue, float maxValue,
+                             RGBMappingType mappingType) {
+    m_minValue = minValue;
+    m_maxValue = maxValue;
+    m_mappingType = mappingType;
+
+    updateOverview();
+}
+
+void HdrTileItem::updateOverview() {
+    if (!m_pyramid) {
+        setPixmap(QPixmap());
+        return;
+    }
+
+    // the coarsest level is a single tile
+    const HdrTileKey key = {static_cast<int>(m_pyramid->getLevels()) - 1,
+                            0,
+                            0,
+                            m_minValue,
+                            m_maxValue,
+                            m_mappingType};
+    QScopedPointer<QImage> overview(renderTile(key));
+    // setPixmap() calls update()
+    setPixmap(QPixmap::fromImage(*overview));
+}
+
+QRectF HdrTileItem::boundingRect() const {
+    return QRectF(offset(), QSizeF(m_width, m_height));
+}
+
+QPainterPath HdrTileItem::shape() const {
+    QPainterPath path;
+    path.addRect(boundingRect());
+    return path;
+}
+
+bool HdrTileItem::contains(const QPointF &point) const {
+    return boundingRect().contains(point);
+}
+
+QImage *HdrTileItem::renderTile(const HdrTileKey &key) const {
+    PFS_TRACE_SPAN("HdrTileItem::renderTile", "display");
+    const size_t level = key.level;
+    const pfs::Array2Df &X = m_pyramid->getChannel(level, 0);
+    const pfs::Array2Df &Y = m_pyramid->getChannel(level, 1);
+    const pfs::Array2Df &Z = m_pyramid->getChannel(level, 2);
+
+    const int x0 = key.x * TILE_SIZE;
+    const int y0 = key.y * TILE_SIZE;
+    const int width =
+        std::min<int>(TILE_SIZE, m_pyramid->getWidth(level) - x0);
+    const int height =
+        std::min<int>(TILE_SIZE, m_pyramid->getHeight(level) - y0);
+
+    QImage *tile = new QImage(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        const size_t offset = (y0 + y) * X.getCols() + x0;
+        pfs::colorspace::kernels::remapToRGB32(
+            X.data() + offset, Y.data() + offset, Z.data() + offset,
+            reinterpret_cast<uint32_t *>(tile->scanLine(y)), key.minValue,
+            key.maxValue, static_cast<RGBMappingType>(key.mappingType),
+            width);
+    }
+    return tile;
+}
+
+void HdrTileItem::paint(QPainter *painter,
+                        const QStyleOptionGraphicsItem *option,
+                        QWidget * /*widget*/) {
+    if (!m_pyramid) return;
+
+    const QRectF exposed = option->exposedRect.intersected(boundingRect());
+    if (exposed.isEmpty()) return;
+
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+        painter->worldTransform());
+    const size_t level = m_pyramid->levelForScale(lod);
+    const int levelWidth = static_cast<int>(m_pyramid->getWidth(level));
+    const int levelHeight = static_cast<int>(m_pyramid->getHeight(level));
+    // size of a sample of the level, in frame coordinates
+    const qreal sx = qreal(m_width) / levelWidth;
+    const qreal sy = qreal(m_height) / levelHeight;
+
+    const int tx0 = static_cast<int>((exposed.left() - offset().x()) / sx) /
+                    TILE_SIZE;
+    const int ty0 =
+        static_cast<int>((exposed.top() - offset().y()) / sy) / TILE_SIZE;
+    const int tx1 = std::min(
+        static_cast<int>(std::ceil((exposed.right() - offset().x()) / sx)),
+        levelWidth - 1) / TILE_SIZE;
+    const int ty1 = std::min(
+        static_cast<int>(std::ceil((exposed.bottom() - offset().y()) / sy)),
+        levelHeight - 1) / TILE_SIZE;
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform,
+                           transformationMode() == Qt::SmoothTransformation);
+
+    // draw what is in cache, collect what is not
+    QVector<HdrTileKey> missing;
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            const HdrTileKey key = {static_cast<int>(level), tx, ty,
+                                    m_minValue, m_maxValue, m_mappingType};
+            const QImage *tile = m_tiles.object(key);
+            if (tile) {
+                painter->drawImage(
+                    QRectF(offset().x() + tx * TILE_SIZE * sx,
+                           offset().y() + ty * TILE_SIZE * sy,
+                           tile->width() * sx, tile->height() * sy),
+                    *tile);
+            } else {
+                missing.push_back(key);
+            }
+        }
+    }
+
+    // tiles are independent: remap them in parallel
+    QVector<QImage *> rendered(missing.size());
+    const HdrTileKey *keys = missing.constData();
+    QImage **tiles = rendered.data();
+#pragma omp parallel for num_threads(pfs::utils::getThreadsPerJob()) schedule(dynamic)
+    for (int i = 0; i < missing.size(); ++i) {
+        tiles[i] = renderTile(keys[i]);
+    }
+
+    // draw before caching, so the insertions cannot evict a tile in use
+    for (int i = 0; i < missing.size(); ++i) {
+        const QImage *tile = rendered[i];
+        painter->drawImage(QRectF(offset().x() + missing[i].x * TILE_SIZE * sx,
+                                  offset().y() + missing[i].y * TILE_SIZE * sy,
+                                  tile->width() * sx, tile->height() * sy),
+                           *tile);
+    }
+    for (int i = 0; i < missing.size(); ++i) {
+        m_tiles.insert(missing[i], rendered[i],
+                       qMax(1, rendered[i]->byteCount() / 1024));
+    }
+
+    painter->restore();
+}
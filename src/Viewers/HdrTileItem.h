@@ -0,0 +1,112 @@
+/**
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ *
+ * @author agent <agent@local>
+ *
+ */
+
+#ifndef HDRTILEITEM_H
+#define HDRTILEITEM_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QPainterPath>
+#include <QScopedPointer>
+
+#include "Libpfs/colorspace/rgbremapper_fwd.h"
+#include "Viewers/IGraphicsPixmapItem.h"
+
+namespace pfs {
+class Frame;
+class FramePyramid;
+}
+
+//! \brief identifies a tile of the pyramid, remapped with a given mapping
+struct HdrTileKey {
+    int level;
+    int x;
+    int y;
+    float minValue;
+    float maxValue;
+    int mappingType;
+
+    bool operator==(const HdrTileKey &other) const {
+        return level == other.level && x == other.x && y == other.y &&
+               minValue == other.minValue && maxValue == other.maxValue &&
+               mappingType == other.mappingType;
+    }
+};
+
+inline uint qHash(const HdrTileKey &key, uint seed = 0) {
+    return qHash(key.level, seed) ^ qHash(key.x, seed) * 31u ^
+           qHash(key.y, seed) * 131u ^ qHash(key.minValue, seed) * 1031u ^
+           qHash(key.maxValue, seed) * 10007u ^
+           qHash(key.mappingType, seed) * 100003u;
+}
+
+//! \brief Pixmap item drawing an HDR frame through a float mip pyramid
+//!
+//! Only the tiles covering the exposed area are remapped to 8 bits, from the
+//! pyramid level matching the current zoom, and kept in an LRU cache keyed by
+//! the mapping parameters: changing the luminance range or the mapping
+//! method costs as much as the visible pixels on screen, whatever the size
+//! of the frame, and going back to a previous setting is free.
+//! The bounding rect is the one of the full resolution frame; the pixmap
+//! holds an overview (the coarsest level), cheap to hand to the pan icon.
+class HdrTileItem : public IGraphicsPixmapItem {
+   public:
+    static const int TILE_SIZE = 256;
+
+    HdrTileItem(QGraphicsItem *parent = 0);
+    ~HdrTileItem();
+
+    //! \brief build the pyramid of \a frame, and drop every cached tile
+    //! \note the pyramid is a snapshot of \a frame (see \c pfs::FramePyramid):
+    //! call it again to show the frame once it has been written
+    void setFrame(const pfs::Frame *frame);
+
+    //! \brief map the samples in [\a minValue, \a maxValue] with
+    //! \a mappingType: the tiles on screen are remapped on the next paint
+    void setMapping(float minValue, float maxValue, RGBMappingType mappingType);
+
+    QRectF boundingRect() const;
+    QPainterPath shape() const;
+    bool contains(const QPointF &point) const;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget);
+
+   private:
+    QImage *renderTile(const HdrTileKey &key) const;
+    void updateOverview();
+
+    QScopedPointer<pfs::FramePyramid> m_pyramid;
+    int m_width;
+    int m_height;
+
+    float m_minValue;
+    float m_maxValue;
+    RGBMappingType m_mappingType;
+
+    // cost in KB
+    QCache<HdrTileKey, QImage> m_tiles;
+};
+
+#endif  // HDRTILEITEM_H
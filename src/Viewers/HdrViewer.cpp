@@ -37,7 +37,7 @@
 #include "Common/global.h"
 
 #include "Fileformat/pfsoutldrimage.h"
-#include "Viewers/IGraphicsPixmapItem.h"
+#include "Viewers/HdrTileItem.h"
 #include "Viewers/LuminanceRangeWidget.h"
 
 #include "Libpfs/array2d.h"
@@ -46,19 +46,6 @@
 #include "Libpfs/utils/msec_timer.h"
 #include "Libpfs/utils/sse.h"
 
-namespace  // anonymous namespace
-{
-// Implementation details stay inside an anonymous namespace
-// In this way, we let know the compiler it can mess up as much as it wants with
-// the code,
-// because it will only used inside this compilation unit
-
-const pfs::Array2Df *getPrimaryChannel(const pfs::Frame &frame) {
-    return frame.getChannel("Y");
-}
-
-}  // end anonymous namespace
-
 HdrViewer::HdrViewer(pfs::Frame *frame, QWidget *parent, bool ns)
     : GenericViewer(frame, parent, ns),
       m_mappingMethod(MAP_GAMMA2_2),
@@ -66,12 +53,18 @@ HdrViewer::HdrViewer(pfs::Frame *frame, QWidget *parent, bool ns)
       m_maxValue(1.f) {
     initUi();
 
+    m_tileItem = new HdrTileItem();
+    setPixmapItem(m_tileItem);
+
     if (frame != nullptr)
     {
+    // from now on the frame is only read (tiles, histogram, copies)
+    frame->endWrite();
+
     // I prefer to do everything by hand, so the flow of the calls is clear
     m_lumRange->blockSignals(true);
 
-    m_lumRange->setHistogramImage(getPrimaryChannel(*getFrame()));
+    m_lumRange->setHistogramFrame(getFrame());
     m_lumRange->fitToDynamicRange();
 
     m_mappingMethod =
@@ -79,8 +72,8 @@ HdrViewer::HdrViewer(pfs::Frame *frame, QWidget *parent, bool ns)
     m_minValue = powf(10.0f, m_lumRange->getRangeWindowMin());
     m_maxValue = powf(10.0f, m_lumRange->getRangeWindowMax());
 
-    QScopedPointer<QImage> qImage(mapFrameToImage(getFrame()));
-    mPixmap->setPixmap(QPixmap::fromImage(*qImage));
+    m_tileItem->setMapping(m_minValue, m_maxValue, m_mappingMethod);
+    m_tileItem->setFrame(getFrame());
 
     updateView();
     m_lumRange->blockSignals(false);
@@ -135,12 +128,8 @@ void HdrViewer::retranslateUi() {
 }
 
 void HdrViewer::refreshPixmap() {
-    setCursor(Qt::WaitCursor);
-
-    QScopedPointer<QImage> qImage(mapFrameToImage(getFrame()));
-    mPixmap->setPixmap(QPixmap::fromImage(*qImage));
-
-    unsetCursor();
+    // only the tiles on screen get remapped
+    m_tileItem->setMapping(m_minValue, m_maxValue, m_mappingMethod);
 }
 
 void HdrViewer::updatePixmap() {
@@ -150,10 +139,14 @@ void HdrViewer::updatePixmap() {
 
     m_lumRange->blockSignals(true);
 
+    if (getFrame() != nullptr) {
+        getFrame()->endWrite();
+    }
+    m_tileItem->setFrame(getFrame());
     refreshPixmap();
 
     // I need to set the histogram again during the setFrame function
-    m_lumRange->setHistogramImage(getPrimaryChannel(*getFrame()));
+    m_lumRange->setHistogramFrame(getFrame());
     m_lumRange->fitToDynamicRange();
     m_lumRange->blockSignals(false);
 }
@@ -204,7 +197,14 @@ RGBMappingType HdrViewer::getLuminanceMappingMethod() {
     return m_mappingMethod;
 }
 
-QImage *HdrViewer::mapFrameToImage(pfs::Frame *in_frame) {
+QImage HdrViewer::getQImage() const {
+    if (getFrame() == NULL) return QImage();
+
+    QScopedPointer<QImage> qImage(mapFrameToImage(getFrame()));
+    return *qImage;
+}
+
+QImage *HdrViewer::mapFrameToImage(pfs::Frame *in_frame) const {
     return fromLDRPFStoQImage(in_frame, m_minValue, m_maxValue,
                               m_mappingMethod);
 }
@@ -45,6 +45,7 @@ namespace pfs {
 class Frame;
 }
 
+class HdrTileItem;
 class LuminanceRangeWidget;
 
 class HdrViewer : public GenericViewer {
@@ -71,6 +72,9 @@ class HdrViewer : public GenericViewer {
 
     RGBMappingType getLuminanceMappingMethod();
 
+    //! \brief full resolution frame, remapped with the current settings
+    QImage getQImage() const;
+
    public Q_SLOTS:
     void updateRangeWindow();
     int getLumMappingMethod();
@@ -99,7 +103,10 @@ class HdrViewer : public GenericViewer {
     float m_minValue;
     float m_maxValue;
 
-    QImage *mapFrameToImage(pfs::Frame *in_frame);
+    // owned by the scene
+    HdrTileItem *m_tileItem;
+
+    QImage *mapFrameToImage(pfs::Frame *in_frame) const;
 };
 
 inline bool HdrViewer::isHDR() { return true; }
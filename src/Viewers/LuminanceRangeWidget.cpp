@@ -38,9 +38,8 @@
 #include <QMouseEvent>
 #include <cassert>
 
-#include <Libpfs/array2d.h>
-
-#include "Histogram.h"
+#include <Libpfs/frame.h>
+#include <Libpfs/histogram.h>
 
 static const float exposureStep = 0.25f;
 static const float shrinkStep = 0.1f;
@@ -57,8 +56,7 @@ LuminanceRangeWidget::LuminanceRangeWidget(QWidget *parent)
       dragMode(DRAG_NO),
       showVP(false),
       valuePointer(0.f),
-      histogram(NULL),
-      histogramImage(NULL)
+      histogramFrame(NULL)
 
 {
     setFrameStyle(QFrame::Panel | QFrame::Sunken);
@@ -73,7 +71,7 @@ LuminanceRangeWidget::LuminanceRangeWidget(QWidget *parent)
     dragShift = 0;
 }
 
-LuminanceRangeWidget::~LuminanceRangeWidget() { delete histogram; }
+LuminanceRangeWidget::~LuminanceRangeWidget() {}
 
 QSize LuminanceRangeWidget::sizeHint() const { return QSize(300, 22); }
 
@@ -102,25 +100,24 @@ void LuminanceRangeWidget::paintEvent(QPaintEvent * /*pe */) {
     }
 
     // Paint histogram
-    if (histogramImage != NULL) {
-        if (histogram == NULL || histogram->getBins() != fRect.width()) {
-            delete histogram;
-            // Build histogram from at least 5000 pixels
-            int accuracy =
-                histogramImage->getRows() * histogramImage->getCols() / 5000;
-            //       int accuracy =1;
-            if (accuracy < 1) accuracy = 1;
-            histogram = new Histogram(fRect.width(), accuracy);
-            histogram->computeLog(histogramImage, minValue, maxValue);
+    if (histogramFrame != NULL) {
+        if (!histogram || histogram->getBins() != size_t(fRect.width())) {
+            // Build histogram from at least 5000 pixels (cached on the frame)
+            size_t step = histogramFrame->size() / 5000;
+            if (step < 1) step = 1;
+            histogram = pfs::getHistogram(
+                *histogramFrame, "Y",
+                pfs::HistogramParams(fRect.width(), minValue, maxValue,
+                                     pfs::HISTOGRAM_LOG10, step));
         }
 
-        float maxP = histogram->getMaxP();
-        int i = 0;
+        float maxCount = histogram->getMaxCount();
+        size_t i = 0;
         p.setPen(Qt::green);
         for (int x = fRect.left(); i < histogram->getBins(); x++, i++) {
-            if (histogram->getP(i) > 0) {
-                int barSize =
-                    (int)((float)fRect.height() * histogram->getP(i) / maxP);
+            if (histogram->getCount(i) > 0) {
+                int barSize = (int)((float)fRect.height() *
+                                    histogram->getCount(i) / maxCount);
                 p.drawLine(x, fRect.bottom(), x, fRect.bottom() - barSize);
             }
         }
@@ -254,26 +251,18 @@ void LuminanceRangeWidget::shrinkRange() {
     emit updateRangeWindow();
 }
 
-void LuminanceRangeWidget::setHistogramImage(const pfs::Array2Df *image) {
-    histogramImage = image;
-    delete histogram;
-    histogram = NULL;
+void LuminanceRangeWidget::setHistogramFrame(const pfs::Frame *frame) {
+    histogramFrame = frame;
+    histogram.reset();
     update();
 }
 
 void LuminanceRangeWidget::fitToDynamicRange() {
-    if (histogramImage != NULL) {
-        float min = 99999999.0f;
-        float max = -99999999.0f;
-
-        int size = histogramImage->getRows() * histogramImage->getCols();
-        for (int i = 0; i < size; i++) {
-            float v = (*histogramImage)(i);
-            if (v > max)
-                max = v;
-            else if (v < min)
-                min = v;
-        }
+    if (histogramFrame != NULL) {
+        const std::pair<float, float> range = pfs::getHistogramRange(
+            *histogramFrame, "Y", pfs::HISTOGRAM_LINEAR);
+        float min = range.first;
+        float max = range.second;
 
         if (min <= 0.000001f)
             min = 0.000001f;  // If data contains negative values
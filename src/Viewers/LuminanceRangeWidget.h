@@ -28,8 +28,12 @@
 #define LUMINANCERANGE_WIDGET_H
 
 #include <QFrame>
-#include "Libpfs/array2d_fwd.h"
-#include "Viewers/Histogram.h"
+#include <memory>
+
+namespace pfs {
+class Frame;
+class Histogram;
+}
 
 class LuminanceRangeWidget : public QFrame {
     Q_OBJECT
@@ -74,8 +78,8 @@ class LuminanceRangeWidget : public QFrame {
     bool showVP;
     float valuePointer;
 
-    Histogram *histogram;
-    const pfs::Array2Df *histogramImage;
+    std::shared_ptr<const pfs::Histogram> histogram;
+    const pfs::Frame *histogramFrame;
 
     QRect getPaintRect() const;
 
@@ -85,7 +89,8 @@ class LuminanceRangeWidget : public QFrame {
 
     void setRangeWindowMinMax(float min, float max);
 
-    void setHistogramImage(const pfs::Array2Df *image);
+    //! \brief show the histogram of the luminance (Y) of \a frame
+    void setHistogramFrame(const pfs::Frame *frame);
 
     void showValuePointer(float value);
     void hideValuePointer();
@@ -32,7 +32,10 @@ class PanIconWidget : public QFrame {
    public:
     PanIconWidget(QWidget *parent = 0, Qt::WindowFlags flags = Qt::Popup);
     ~PanIconWidget();
-    void setImage(const QImage *fullsize_zoomed_image);
+    //! \brief \a originalSize is the size of the image the selection refers
+    //! to, when larger than \a fullsize_zoomed_image
+    void setImage(const QImage *fullsize_zoomed_image,
+                  const QSize &originalSize = QSize());
     void popup(const QPoint &pos);
     void setRegionSelection(QRect regionSelection);
     void setMouseFocus(void);
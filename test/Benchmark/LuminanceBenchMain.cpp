@@ -0,0 +1,608 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+
+//! \brief luminance-bench: performance of the tone mapping operators, the
+//! fusion, the alignment, the geometric transformations and the file formats
+//!
+//! Every case runs on deterministic synthetic scenes (see SyntheticScene.h)
+//! of several sizes, with several thread budgets, and is repeated a few
+//! times. The report is written as JSON: for each case, size and thread
+//! count, the time of every run, the throughput of the best run, the speedup
+//! over a single thread and the peak resident memory.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <boost/program_options.hpp>
+#include <chrono>
+
+#include "Common/global.h"
+#include "Core/TonemappingOptions.h"
+#include "HdrCreation/fusionoperator.h"
+#include "HdrCreation/mtb_alignment.h"
+#include "Libpfs/colorspace/kernels.h"
+#include "Libpfs/frame.h"
+#include "Libpfs/io/framereader.h"
+#include "Libpfs/io/framereaderfactory.h"
+#include "Libpfs/io/framewriter.h"
+#include "Libpfs/io/framewriterfactory.h"
+#include "Libpfs/manip/projection.h"
+#include "Libpfs/manip/resize.h"
+#include "Libpfs/manip/rotate.h"
+#include "Libpfs/params.h"
+#include "Libpfs/progress.h"
+#include "Libpfs/tm/TonemapOperator.h"
+#include "Libpfs/utils/parallel.h"
+
+#include "SyntheticScene.h"
+
+using namespace libhdr::fusion;
+using namespace bench;
+
+namespace po = boost::program_options;
+
+namespace {
+//! \brief the inputs shared by all the cases of a size
+struct Inputs {
+    pfs::FramePtr scene;
+    std::vector<FrameEnhanced> brackets;
+};
+
+class Timer {
+   public:
+    Timer() : m_elapsed(0.) {}
+
+    void start() { m_start = std::chrono::steady_clock::now(); }
+    void stop() {
+        m_elapsed += std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - m_start)
+                         .count();
+    }
+    double elapsed() const { return m_elapsed; }
+
+   private:
+    std::chrono::steady_clock::time_point m_start;
+    double m_elapsed;
+};
+
+//! \brief one run of a case: the set up is not timed, the work between
+//! \c Timer::start() and \c Timer::stop() is
+typedef std::function<void(const Inputs &, Timer &)> CaseBody;
+
+struct Case {
+    Case(const std::string &group_, const std::string &name_,
+         const CaseBody &body_)
+        : group(group_), name(group_ + "/" + name_), body(body_) {}
+
+    std::string group;
+    std::string name;
+    CaseBody body;
+};
+
+struct Result {
+    std::string name;
+    std::string group;
+    size_t width;
+    size_t height;
+    size_t threads;
+    std::vector<double> runs;
+    double peakRss;
+    std::string error;
+
+    double megapixels() const { return width * height / 1e6; }
+    double best() const { return *std::min_element(runs.begin(), runs.end()); }
+    double median() const {
+        std::vector<double> sorted(runs);
+        std::sort(sorted.begin(), sorted.end());
+        const size_t middle = sorted.size() / 2;
+        return (sorted.size() % 2) ? sorted[middle]
+                                   : 0.5 * (sorted[middle - 1] + sorted[middle]);
+    }
+};
+
+// -- peak resident memory ---------------------------------------------------
+
+//! \brief true if the peak can be reset, so that it is measured per case
+//! rather than since the start of the process
+bool peakRssPerCase() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    return static_cast<bool>(status);
+#else
+    return false;
+#endif
+}
+
+void resetPeakRss() {
+#if defined(__linux__)
+    // resets VmHWM to the current resident set size (Linux >= 4.0)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+#endif
+}
+
+//! \brief peak resident memory, in MB
+double peakRss() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                             sizeof(counters))) {
+        return counters.PeakWorkingSetSize / (1024. * 1024.);
+    }
+    return 0.;
+#else
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::atof(line.c_str() + 6) / 1024.;  // kB
+        }
+    }
+#endif
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / (1024. * 1024.);  // bytes
+#else
+    return usage.ru_maxrss / 1024.;  // kB
+#endif
+#endif
+}
+
+// -- cases ------------------------------------------------------------------
+
+struct TonemapOperatorName {
+    TMOperator type;
+    const char *name;
+};
+
+const TonemapOperatorName TONEMAP_OPERATORS[] = {
+    {mantiuk06, "mantiuk06"},   {mantiuk08, "mantiuk08"},
+    {fattal, "fattal02"},       {ferradans, "ferradans11"},
+    {drago, "drago03"},         {durand, "durand02"},
+    {reinhard02, "reinhard02"}, {reinhard05, "reinhard05"},
+    {ashikhmin, "ashikhmin02"}, {pattanaik, "pattanaik00"},
+    {mai, "mai11"}};
+
+struct FusionOperatorName {
+    FusionOperator type;
+    const char *name;
+};
+
+const FusionOperatorName FUSION_OPERATORS[] = {
+    {DEBEVEC, "debevec"},
+    {ROBERTSON, "robertson"},
+    {ROBERTSON_AUTO, "robertson-auto"}};
+
+struct FileFormat {
+    const char *name;
+    const char *extension;
+    int tiffMode;  //!< -1 if not a TIFF
+    bool ldr;      //!< written from an exposure rather than the HDR scene
+};
+
+const FileFormat FILE_FORMATS[] = {
+    {"exr", "exr", -1, false},       {"hdr", "hdr", -1, false},
+    {"pfs", "pfs", -1, false},       {"lhc", "lhc", -1, false},
+    {"tiff-float", "tif", 2, false}, {"tiff-logluv", "tif", 3, false},
+    {"tiff-16", "tif", 1, true},     {"tiff-8", "tif", 0, true},
+    {"jpeg", "jpg", -1, true},       {"png", "png", -1, true}};
+
+void tonemapCase(TMOperator type, const Inputs &inputs, Timer &timer) {
+    std::unique_ptr<pfs::Frame> frame(privateCopy(*inputs.scene));
+    TonemappingOptions options;
+    options.tmoperator = type;
+    options.origxsize = options.xsize = static_cast<int>(frame->getWidth());
+    std::unique_ptr<TonemapOperator> tmo(
+        TonemapOperator::getTonemapOperator(type));
+    pfs::Progress progress;
+
+    timer.start();
+    tmo->tonemapFrame(*frame, &options, progress);
+    timer.stop();
+}
+
+void fusionCase(FusionOperator type, const Inputs &inputs, Timer &timer) {
+    ResponseCurve response(RESPONSE_SRGB);
+    WeightFunction weight(WEIGHT_TRIANGULAR);
+    FusionOperatorPtr fusionOperator = IFusionOperator::build(type);
+
+    timer.start();
+    std::unique_ptr<pfs::Frame> hdr(
+        fusionOperator->computeFusion(response, weight, inputs.brackets));
+    timer.stop();
+}
+
+void mtbCase(const Inputs &inputs, Timer &timer) {
+    std::vector<pfs::FramePtr> frames;
+    for (size_t idx = 0; idx < inputs.brackets.size(); ++idx) {
+        frames.push_back(
+            pfs::FramePtr(privateCopy(*inputs.brackets[idx].frame())));
+    }
+
+    timer.start();
+    libhdr::mtb_alignment(frames);
+    timer.stop();
+}
+
+void resizeCase(InterpolationMethod method, const Inputs &inputs, Timer &timer) {
+    const int width = static_cast<int>(inputs.scene->getWidth() / 2);
+
+    timer.start();
+    std::unique_ptr<pfs::Frame> resized(
+        pfs::resize(inputs.scene.get(), width, method));
+    timer.stop();
+}
+
+void rotateCase(const Inputs &inputs, Timer &timer) {
+    timer.start();
+    std::unique_ptr<pfs::Frame> rotated(pfs::rotate(inputs.scene.get(), true));
+    timer.stop();
+}
+
+void projectionCase(const Inputs &inputs, Timer &timer) {
+    const pfs::Channel *R, *G, *B;
+    inputs.scene->getXYZChannels(R, G, B);
+    // same number of pixels as the input
+    const size_t side = static_cast<size_t>(std::sqrt(
+        static_cast<double>(inputs.scene->getWidth()) *
+        inputs.scene->getHeight()));
+    pfs::Array2Df outR(side, side);
+    pfs::Array2Df outG(side, side);
+    pfs::Array2Df outB(side, side);
+
+    std::vector<const pfs::Array2Df *> in;
+    in.push_back(R);
+    in.push_back(G);
+    in.push_back(B);
+    std::vector<pfs::Array2Df *> out;
+    out.push_back(&outR);
+    out.push_back(&outG);
+    out.push_back(&outB);
+
+    TransformInfo info;
+    info.srcProjection = &PolarProjection::singleton;
+    info.dstProjection = &MirrorBallProjection::singleton;
+    info.yRotate = 30;
+
+    timer.start();
+    transformArrays(in, out, info);
+    timer.stop();
+}
+
+std::string filenameFor(const FileFormat &format, const std::string &tmpdir) {
+    return tmpdir + "/luminance-bench-" + format.name + "." + format.extension;
+}
+
+void writeFile(const FileFormat &format, const Inputs &inputs,
+               const std::string &filename, Timer *timer) {
+    pfs::Params params;
+    if (format.tiffMode >= 0) {
+        params.set("tiff_mode", format.tiffMode);
+    }
+    const pfs::Frame &frame = format.ldr
+                                  ? *inputs.brackets[inputs.brackets.size() / 2]
+                                         .frame()
+                                  : *inputs.scene;
+
+    pfs::io::FrameWriterPtr writer =
+        pfs::io::FrameWriterFactory::open(filename, params);
+    if (timer) timer->start();
+    writer->write(frame, params);
+    if (timer) timer->stop();
+}
+
+void writeCase(const FileFormat &format, const std::string &tmpdir,
+           const Inputs &inputs, Timer &timer) {
+    const std::string filename = filenameFor(format, tmpdir);
+    writeFile(format, inputs, filename, &timer);
+    std::remove(filename.c_str());
+}
+
+void readCase(const FileFormat &format, const std::string &tmpdir,
+          const Inputs &inputs, Timer &timer) {
+    const std::string filename = filenameFor(format, tmpdir);
+    writeFile(format, inputs, filename, NULL);
+
+    pfs::Frame frame;
+    timer.start();
+    pfs::io::FrameReaderPtr reader =
+        pfs::io::FrameReaderFactory::open(filename);
+    reader->read(frame, pfs::Params());
+    reader->close();
+    timer.stop();
+    std::remove(filename.c_str());
+}
+
+std::vector<Case> allCases(const std::string &tmpdir) {
+    using std::placeholders::_1;
+    using std::placeholders::_2;
+
+    std::vector<Case> cases;
+    for (const TonemapOperatorName &op : TONEMAP_OPERATORS) {
+        cases.push_back(
+            Case("tonemap", op.name, std::bind(tonemapCase, op.type, _1, _2)));
+    }
+    for (const FusionOperatorName &op : FUSION_OPERATORS) {
+        cases.push_back(
+            Case("fusion", op.name, std::bind(fusionCase, op.type, _1, _2)));
+    }
+    cases.push_back(Case("align", "mtb", mtbCase));
+    cases.push_back(Case("manip", "resize-lanczos",
+                         std::bind(resizeCase, LanczosInterp, _1, _2)));
+    cases.push_back(Case("manip", "resize-bilinear",
+                         std::bind(resizeCase, BilinearInterp, _1, _2)));
+    cases.push_back(Case("manip", "rotate", rotateCase));
+    cases.push_back(Case("manip", "projection", projectionCase));
+    for (const FileFormat &format : FILE_FORMATS) {
+        cases.push_back(Case("io", std::string(format.name) + "-write",
+                             std::bind(writeCase, format, tmpdir, _1, _2)));
+        cases.push_back(Case("io", std::string(format.name) + "-read",
+                             std::bind(readCase, format, tmpdir, _1, _2)));
+    }
+    return cases;
+}
+
+// -- report -----------------------------------------------------------------
+
+void writeString(std::ostream &out, const std::string &str) {
+    out << '"';
+    for (size_t idx = 0; idx < str.size(); ++idx) {
+        const unsigned char c = static_cast<unsigned char>(str[idx]);
+        if (c == '"' || c == '\\') {
+            out << '\\' << str[idx];
+        } else if (c < 0x20) {
+            out << ' ';
+        } else {
+            out << str[idx];
+        }
+    }
+    out << '"';
+}
+
+void writeReport(std::ostream &out, const std::vector<Result> &results,
+                 size_t repeat) {
+    // best time with a single thread, for the speedups
+    std::map<std::pair<std::string, size_t>, double> serial;
+    for (const Result &result : results) {
+        if (result.threads == 1 && result.error.empty()) {
+            serial[std::make_pair(result.name, result.width)] = result.best();
+        }
+    }
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"benchmark\": \"luminance-bench\",\n";
+    out << "  \"simd\": ";
+    writeString(out, pfs::colorspace::kernels::simdLevel());
+    out << ",\n  \"processors\": " << pfs::utils::getConcurrency() << ",\n";
+    out << "  \"repeat\": " << repeat << ",\n";
+    out << "  \"peak_rss_scope\": \""
+        << (peakRssPerCase() ? "case" : "process") << "\",\n";
+    out << "  \"results\": [";
+    for (size_t idx = 0; idx < results.size(); ++idx) {
+        const Result &r = results[idx];
+        out << (idx ? ",\n" : "\n") << "    {\"name\": ";
+        writeString(out, r.name);
+        out << ", \"group\": ";
+        writeString(out, r.group);
+        out << ", \"width\": " << r.width << ", \"height\": " << r.height
+            << ", \"megapixels\": " << r.megapixels()
+            << ", \"threads\": " << r.threads;
+        if (!r.error.empty()) {
+            out << ", \"error\": ";
+            writeString(out, r.error);
+            out << "}";
+            continue;
+        }
+        out << ", \"runs_ms\": [";
+        for (size_t run = 0; run < r.runs.size(); ++run) {
+            out << (run ? ", " : "") << r.runs[run];
+        }
+        out << "], \"best_ms\": " << r.best()
+            << ", \"median_ms\": " << r.median()
+            << ", \"mp_per_s\": " << r.megapixels() / (r.best() / 1000.)
+            << ", \"speedup\": ";
+        std::map<std::pair<std::string, size_t>, double>::const_iterator it =
+            serial.find(std::make_pair(r.name, r.width));
+        if (it != serial.end()) {
+            out << it->second / r.best();
+        } else {
+            out << "null";
+        }
+        out << ", \"peak_rss_mb\": " << r.peakRss << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+// -- command line -----------------------------------------------------------
+
+template <typename Type>
+std::vector<Type> parseList(const std::string &list) {
+    std::vector<Type> values;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        std::istringstream itemIn(item);
+        Type value;
+        if (!(itemIn >> value)) {
+            throw po::error("invalid value in list: " + list);
+        }
+        values.push_back(value);
+    }
+    return values;
+}
+
+//! \brief powers of two up to the number of processors, and the latter
+std::string defaultThreads() {
+    const size_t processors = pfs::utils::getConcurrency();
+    std::ostringstream threads;
+    for (size_t n = 1; n < processors; n *= 2) {
+        threads << n << ",";
+    }
+    threads << processors;
+    return threads.str();
+}
+}
+
+int main(int argc, char **argv) {
+    std::string sizesList;
+    std::string threadsList;
+    size_t repeat;
+    std::string filter;
+    std::string output;
+    std::string tmpdir;
+
+    po::options_description desc("luminance-bench options");
+    desc.add_options()("help,h", "print this help")(
+        "list,l", "print the names of the cases and exit")(
+        "sizes,s", po::value<std::string>(&sizesList)->default_value("2,12,50"),
+        "comma separated sizes of the scenes, in megapixels")(
+        "threads,t",
+        po::value<std::string>(&threadsList)->default_value(defaultThreads()),
+        "comma separated thread budgets (the scaling curve)")(
+        "repeat,r", po::value<size_t>(&repeat)->default_value(3),
+        "runs of each case")(
+        "filter,f", po::value<std::string>(&filter),
+        "run only the cases whose name contains this string (e.g. tonemap/, "
+        "io/exr)")(
+        "output,o", po::value<std::string>(&output)->default_value("-"),
+        "JSON report (- for the standard output)")(
+        "tmpdir", po::value<std::string>(&tmpdir)->default_value("."),
+        "directory for the files of the I/O cases");
+
+    std::vector<double> sizes;
+    std::vector<size_t> threads;
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+        sizes = parseList<double>(sizesList);
+        threads = parseList<size_t>(threadsList);
+    } catch (std::exception &ex) {
+        std::cerr << ex.what() << "\n" << desc << "\n";
+        return -1;
+    }
+    if (vm.count("help")) {
+        std::cout << desc << "\n";
+        return 0;
+    }
+
+    std::vector<Case> cases;
+    for (const Case &c : allCases(tmpdir)) {
+        if (filter.empty() || c.name.find(filter) != std::string::npos) {
+            cases.push_back(c);
+        }
+    }
+    if (vm.count("list")) {
+        for (const Case &c : cases) {
+            std::cout << c.name << "\n";
+        }
+        return 0;
+    }
+    repeat = std::max<size_t>(repeat, 1);
+
+    const size_t processors = pfs::utils::getConcurrency();
+    std::vector<Result> results;
+    for (double megapixels : sizes) {
+        Inputs inputs;
+        size_t width, height;
+        sceneSize(megapixels, width, height);
+
+        pfs::utils::setConcurrency(processors);
+        inputs.scene = createScene(width, height);
+        std::vector<float> evs;
+        evs.push_back(-4.f);
+        evs.push_back(0.f);
+        evs.push_back(4.f);
+        inputs.brackets = createBrackets(*inputs.scene, evs);
+
+        for (const Case &c : cases) {
+            for (size_t threadCount : threads) {
+                pfs::utils::setConcurrency(threadCount);
+
+                Result result;
+                result.name = c.name;
+                result.group = c.group;
+                result.width = width;
+                result.height = height;
+                result.threads = pfs::utils::getConcurrency();
+
+                resetPeakRss();
+                try {
+                    for (size_t run = 0; run < repeat; ++run) {
+                        Timer timer;
+                        c.body(inputs, timer);
+                        result.runs.push_back(timer.elapsed());
+                    }
+                } catch (std::exception &ex) {
+                    result.error = ex.what();
+                }
+                result.peakRss = peakRss();
+
+                std::cerr << c.name << " " << std::fixed
+                          << std::setprecision(1) << result.megapixels()
+                          << " MP, " << result.threads << " threads: ";
+                if (result.error.empty()) {
+                    std::cerr << result.best() << " ms ("
+                              << result.megapixels() / (result.best() / 1000.)
+                              << " MP/s)\n";
+                } else {
+                    std::cerr << "failed: " << result.error << "\n";
+                }
+                results.push_back(result);
+            }
+        }
+    }
+    pfs::utils::setConcurrency(processors);
+
+    if (output == "-") {
+        writeReport(std::cout, results, repeat);
+    } else {
+        std::ofstream out(output.c_str());
+        if (!out) {
+            std::cerr << "cannot write " << output << "\n";
+            return -1;
+        }
+        writeReport(out, results, repeat);
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+
+//! \brief Deterministic synthetic scenes for the benchmarks
+
+#include "SyntheticScene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+
+#include "Libpfs/manip/copy.h"
+
+namespace bench {
+
+namespace {
+uint32_t hash(uint32_t x, uint32_t y, uint32_t seed) {
+    uint32_t h = (x * 0x8da6b343u) ^ (y * 0xd8163841u) ^ (seed * 0xcb1ab31fu);
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    h *= 0x297a2d39u;
+    h ^= h >> 15;
+    return h;
+}
+
+//! \brief uniform in [0, 1)
+float lattice(int x, int y, uint32_t seed) {
+    return (hash(static_cast<uint32_t>(x), static_cast<uint32_t>(y), seed) >>
+            8) *
+           (1.f / 16777216.f);
+}
+
+//! \brief smooth noise in [0, 1), with features of about \a cell pixels
+float valueNoise(size_t x, size_t y, float cell, uint32_t seed) {
+    const float fx = x / cell;
+    const float fy = y / cell;
+    const int ix = static_cast<int>(fx);
+    const int iy = static_cast<int>(fy);
+    float tx = fx - ix;
+    float ty = fy - iy;
+    tx = tx * tx * (3.f - 2.f * tx);
+    ty = ty * ty * (3.f - 2.f * ty);
+
+    const float top = lattice(ix, iy, seed) +
+                      tx * (lattice(ix + 1, iy, seed) - lattice(ix, iy, seed));
+    const float bottom =
+        lattice(ix, iy + 1, seed) +
+        tx * (lattice(ix + 1, iy + 1, seed) - lattice(ix, iy + 1, seed));
+    return top + ty * (bottom - top);
+}
+
+const float HORIZON = 0.6f;
+const int LAMPS = 6;
+
+//! \brief linear RGB radiance of the scene at (\a x, \a y)
+void radiance(size_t x, size_t y, size_t width, size_t height, float &r,
+              float &g, float &b) {
+    const float u = static_cast<float>(x) / width;
+    const float v = static_cast<float>(y) / height;
+    const float texture = (0.6f + 0.8f * valueNoise(x, y, 16.f, 1)) *
+                          (0.7f + 0.6f * valueNoise(x, y, 128.f, 2));
+
+    if (v < HORIZON) {
+        // sky, brighter towards the zenith, with clouds
+        const float sky = (2.f + 10.f * (1.f - v / HORIZON)) *
+                          (0.5f + 0.5f * valueNoise(x, y, 256.f, 3));
+        r = 0.8f * sky;
+        g = 0.9f * sky;
+        b = 1.2f * sky;
+    } else {
+        // ground, with a deep shadow on the bottom left
+        float ground = 0.2f * texture;
+        if (u < 0.3f && v > 0.75f) {
+            ground *= 0.02f;
+        }
+        r = 1.0f * ground;
+        g = 0.9f * ground;
+        b = 0.7f * ground;
+    }
+
+    // sun
+    const float sunX = 0.75f * width;
+    const float sunY = 0.2f * height;
+    const float sunRadius = std::max(0.02f * height, 1.f);
+    const float d2 = (x - sunX) * (x - sunX) + (y - sunY) * (y - sunY);
+    const float sun = 2e4f * std::exp(-d2 / (2.f * sunRadius * sunRadius));
+    r += sun;
+    g += sun;
+    b += 0.9f * sun;
+
+    // lamps along the horizon
+    const float lampSize = std::max(0.01f * height, 1.f);
+    for (int idx = 0; idx < LAMPS; ++idx) {
+        const float lampX = (idx + 0.5f) / LAMPS * width;
+        const float lampY = (HORIZON + 0.1f) * height;
+        if (std::fabs(x - lampX) < lampSize &&
+            std::fabs(y - lampY) < lampSize) {
+            r += 600.f;
+            g += 500.f;
+            b += 300.f;
+        }
+    }
+}
+
+float srgbEncode(float linear) {
+    linear = std::min(std::max(linear, 0.f), 1.f);
+    if (linear <= 0.0031308f) return 12.92f * linear;
+    return 1.055f * std::pow(linear, 1.f / 2.4f) - 0.055f;
+}
+
+float quantize8(float value) {
+    return std::floor(value * 255.f + 0.5f) / 255.f;
+}
+}
+
+void sceneSize(double megapixels, size_t &width, size_t &height) {
+    const double pixels = std::max(megapixels, 1e-3) * 1e6;
+    height = std::max<size_t>(
+        static_cast<size_t>(std::sqrt(pixels * 2. / 3.) + 0.5), 2);
+    width = std::max<size_t>(static_cast<size_t>(pixels / height + 0.5), 2);
+}
+
+pfs::FramePtr createScene(size_t width, size_t height) {
+    pfs::FramePtr scene(new pfs::Frame(width, height));
+    pfs::Channel *R, *G, *B;
+    scene->createXYZChannels(R, G, B);
+
+#pragma omp parallel for
+    for (int y = 0; y < static_cast<int>(height); ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            radiance(x, y, width, height, (*R)(x, y), (*G)(x, y), (*B)(x, y));
+        }
+    }
+    return scene;
+}
+
+std::vector<libhdr::fusion::FrameEnhanced> createBrackets(
+    const pfs::Frame &scene, const std::vector<float> &evs) {
+    const int width = static_cast<int>(scene.getWidth());
+    const int height = static_cast<int>(scene.getHeight());
+    const pfs::Channel *R, *G, *B;
+    scene.getXYZChannels(R, G, B);
+
+    std::vector<libhdr::fusion::FrameEnhanced> brackets;
+    const int middle = static_cast<int>(evs.size()) / 2;
+    for (int idx = 0; idx < static_cast<int>(evs.size()); ++idx) {
+        const float exposure = std::pow(2.f, evs[idx]);
+        const int dx = 3 * (idx - middle);
+        const int dy = -2 * (idx - middle);
+
+        pfs::FramePtr frame(new pfs::Frame(width, height));
+        pfs::Channel *outR, *outG, *outB;
+        frame->createXYZChannels(outR, outG, outB);
+
+#pragma omp parallel for
+        for (int y = 0; y < height; ++y) {
+            const int sy = std::min(std::max(y + dy, 0), height - 1);
+            for (int x = 0; x < width; ++x) {
+                const int sx = std::min(std::max(x + dx, 0), width - 1);
+                (*outR)(x, y) =
+                    quantize8(srgbEncode((*R)(sx, sy) * exposure));
+                (*outG)(x, y) =
+                    quantize8(srgbEncode((*G)(sx, sy) * exposure));
+                (*outB)(x, y) =
+                    quantize8(srgbEncode((*B)(sx, sy) * exposure));
+            }
+        }
+        brackets.push_back(libhdr::fusion::FrameEnhanced(frame, exposure));
+    }
+    return brackets;
+}
+
+pfs::Frame *privateCopy(const pfs::Frame &frame) {
+    pfs::Frame *copy = pfs::copy(&frame);
+    // retrieving the channels for writing detaches them
+    copy->getChannels();
+    return copy;
+}
+
+}  // bench
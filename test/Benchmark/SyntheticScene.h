@@ -0,0 +1,63 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+
+//! \brief Deterministic synthetic scenes for the benchmarks
+//!
+//! The scenes are generated from integer hashes only, so that every run (and
+//! every machine) processes exactly the same samples. They cover about 7
+//! orders of magnitude of luminance: a sun, a few lamps, a bright sky, a
+//! ground in shadow and textures at two scales, which gives the operators
+//! and the alignment real gradients to work on.
+
+#ifndef LUMINANCE_BENCH_SYNTHETICSCENE_H
+#define LUMINANCE_BENCH_SYNTHETICSCENE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "HdrCreation/fusionoperator.h"
+#include "Libpfs/frame.h"
+
+namespace bench {
+
+//! \brief width and height of a 3:2 frame of about \a megapixels
+void sceneSize(double megapixels, size_t &width, size_t &height);
+
+//! \brief HDR scene of \a width x \a height pixels, linear RGB
+pfs::FramePtr createScene(size_t width, size_t height);
+
+//! \brief LDR exposures of \a scene, one for each value of \a evs: sRGB
+//! encoded and quantized to 8 bits, as read from a camera JPEG. The i-th
+//! exposure is shifted by a few pixels from the middle one, so that the
+//! alignment has something to find
+//! \note the average luminance of each exposure is 2^ev, as expected by the
+//! fusion operators
+std::vector<libhdr::fusion::FrameEnhanced> createBrackets(
+    const pfs::Frame &scene, const std::vector<float> &evs);
+
+//! \brief copy of \a frame with channels of its own, so that the cost of
+//! copy-on-write does not end up in the timings
+pfs::Frame *privateCopy(const pfs::Frame &frame);
+
+}  // bench
+
+#endif  // LUMINANCE_BENCH_SYNTHETICSCENE_H
@@ -0,0 +1,124 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "Libpfs/colorspace/kernels.h"
+#include "Libpfs/colorspace/rgbremapper.h"
+#include "Libpfs/utils/fastmath.h"
+
+using namespace pfs;
+
+TEST(TestFastMath, PowError)
+{
+    const float exponents[] = {1.f/1.4f, 1.f/1.8f, 1.f/2.2f, 1.f/2.4f,
+                               1.f/2.6f, 2.2f, 2.4f, -0.6f};
+
+    for (size_t idx = 0; idx < sizeof(exponents)/sizeof(exponents[0]); ++idx)
+    {
+        EXPECT_GT(2e-6f, utils::fastPowMaxError(exponents[idx], 1e-6f, 1.f, 100000))
+            << "exponent " << exponents[idx];
+        EXPECT_GT(2e-6f, utils::fastPowMaxError(exponents[idx], 1.f, 50.f, 100000))
+            << "exponent " << exponents[idx];
+    }
+}
+
+TEST(TestFastMath, RemapToRGB32)
+{
+    const size_t size = 100000;
+    const float minValue = 0.1f;
+    const float maxValue = 0.9f;
+
+    std::vector<float> r(size), g(size), b(size);
+    std::vector<uint32_t> out(size);
+    srand(7);
+    for (size_t idx = 0; idx < size; ++idx)
+    {
+        r[idx] = static_cast<float>(rand())/RAND_MAX;
+        g[idx] = static_cast<float>(rand())/RAND_MAX;
+        b[idx] = static_cast<float>(rand())/RAND_MAX;
+    }
+
+    for (int m = MAP_LINEAR; m <= MAP_LOGARITHMIC; ++m)
+    {
+        RGBMappingType mapping = static_cast<RGBMappingType>(m);
+        colorspace::kernels::remapToRGB32(&r[0], &g[0], &b[0], &out[0],
+                                          minValue, maxValue, mapping, size);
+
+        // validation against the exact pow
+        const double exponent = mappingExponent(mapping);
+        size_t mismatches = 0;
+        for (size_t idx = 0; idx < size; ++idx)
+        {
+            const float samples[] = {r[idx], g[idx], b[idx]};
+            for (int c = 0; c < 3; ++c)
+            {
+                double v = (samples[c] - minValue)/(maxValue - minValue);
+                v = std::min(std::max(v, 0.0), 1.0);
+                const int exact = static_cast<int>(std::pow(v, exponent)*255.0 + 0.5);
+                const int computed = (out[idx] >> (16 - 8*c)) & 0xff;
+
+                ASSERT_GE(1, std::abs(exact - computed));
+                mismatches += (exact != computed);
+            }
+            ASSERT_EQ(0xff000000u, out[idx] & 0xff000000u);
+        }
+        // only the samples next to a rounding boundary can differ
+        EXPECT_GT(size/1000, mismatches) << "mapping " << m;
+    }
+}
+
+TEST(TestFastMath, GammaAndLevels)
+{
+    const size_t size = 10000;
+    const float gamma = 0.7f;
+
+    std::vector<float> r(size), g(size), b(size);
+    std::vector<float> outR(size), outG(size), outB(size);
+    srand(11);
+    for (size_t idx = 0; idx < size; ++idx)
+    {
+        r[idx] = static_cast<float>(rand())/RAND_MAX;
+        g[idx] = static_cast<float>(rand())/RAND_MAX;
+        b[idx] = static_cast<float>(rand())/RAND_MAX;
+    }
+
+    colorspace::kernels::gammaAndLevels(&r[0], &g[0], &b[0],
+                                        &outR[0], &outG[0], &outB[0],
+                                        0.1f, 0.8f, 0.05f, 0.95f, gamma, size);
+
+    for (size_t idx = 0; idx < size; ++idx)
+    {
+        const float l = 0.2126f*r[idx] + 0.7152f*g[idx] + 0.0722f*b[idx];
+        const float c = std::pow(l, gamma - 1.f);
+        const float in[] = {r[idx], g[idx], b[idx]};
+        const float out[] = {outR[idx], outG[idx], outB[idx]};
+        for (int k = 0; k < 3; ++k)
+        {
+            float v = 0.05f + (in[k] - 0.1f)/(0.8f - 0.1f)*c*(0.95f - 0.05f);
+            v = std::min(std::max(v, 0.f), 1.f);
+            ASSERT_NEAR(v, out[k], 10e-6f);
+        }
+    }
+}
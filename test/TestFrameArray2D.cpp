@@ -23,6 +23,9 @@
 
 #include <Libpfs/array2d.h>
 #include <Libpfs/frame.h>
+#include <Libpfs/manip/copy.h>
+
+#include <memory>
 
 #include "SeqInt.h"
 #include "CompareVector.h"
@@ -126,3 +129,190 @@ TEST(TestArray2D, Ctor)
         compareVectors(array2d_v2.data(), array2d_2.data(), array2d.size());
     }
 }
+
+TEST(TestArray2D, ShareAndDetach)
+{
+    typedef pfs::Array2D<int> array2d_int_t;
+
+    array2d_int_t array2d(5, 5);
+    std::generate(array2d.begin(), array2d.end(), SeqInt());
+    EXPECT_TRUE(array2d.hasWriteAccess());
+    array2d.endWrite();
+
+    array2d_int_t shared;
+    shared.share(array2d);
+    const array2d_int_t &cArray2d = array2d;
+    const array2d_int_t &cShared = shared;
+
+    EXPECT_TRUE(array2d.isShared());
+    EXPECT_TRUE(shared.isShared());
+    EXPECT_EQ(cShared.data(), cArray2d.data());
+
+    shared.detach();
+
+    EXPECT_FALSE(array2d.isShared());
+    EXPECT_FALSE(shared.isShared());
+    EXPECT_NE(cShared.data(), cArray2d.data());
+    compareVectors(cShared.data(), cArray2d.data(), array2d.size());
+
+    // fill() does not copy the elements it is going to overwrite
+    shared.share(array2d);
+    shared.fill(-1);
+
+    EXPECT_FALSE(array2d.isShared());
+    EXPECT_EQ(cArray2d(3, 3), 18);
+    EXPECT_EQ(cShared(3, 3), -1);
+}
+
+TEST(TestArray2D, WriteThroughEarlierPointer)
+{
+    typedef pfs::Array2D<int> array2d_int_t;
+
+    array2d_int_t array2d(5, 5);
+    array2d.fill(0);
+    int *elements = array2d.data();
+    array2d_int_t::iterator row = array2d.row_begin(2);
+
+    // pointers handed out before the copy can still be written through:
+    // the elements are copied rather than shared
+    array2d_int_t shared;
+    shared.share(array2d);
+    EXPECT_FALSE(array2d.isShared());
+
+    elements[3] = 7;
+    row[1] = 9;
+
+    const array2d_int_t &cShared = shared;
+    EXPECT_EQ(cShared(3, 0), 0);
+    EXPECT_EQ(cShared(1, 2), 0);
+    EXPECT_EQ(array2d(3, 0), 7);
+    EXPECT_EQ(array2d(1, 2), 9);
+
+    // the elements are shared once the writer gives up write access, and
+    // the next write detaches them
+    array2d.endWrite();
+    shared.share(array2d);
+    EXPECT_TRUE(array2d.isShared());
+
+    array2d(0, 0) = 5;
+    EXPECT_FALSE(array2d.isShared());
+    EXPECT_EQ(cShared(0, 0), 0);
+    EXPECT_EQ(cShared(3, 0), 7);
+}
+
+TEST(TestArray2D, ResizeShared)
+{
+    typedef pfs::Array2D<int> array2d_int_t;
+
+    array2d_int_t array2d(5, 5);
+    std::generate(array2d.begin(), array2d.end(), SeqInt());
+    array2d.endWrite();
+
+    // shrinking does not write into the elements of the other instance
+    array2d_int_t shared;
+    shared.share(array2d);
+    shared.resize(2, 2);
+    shared(1, 1) = -1;
+
+    const array2d_int_t &cArray2d = array2d;
+    const array2d_int_t &cShared = shared;
+    EXPECT_FALSE(array2d.isShared());
+    EXPECT_EQ(cArray2d(1, 0), 1);
+    EXPECT_EQ(cArray2d(3, 0), 3);
+    EXPECT_EQ(cShared(0, 0), 0);
+    EXPECT_EQ(cShared(1, 0), 1);
+    EXPECT_EQ(cShared(1, 1), -1);
+}
+
+TEST(TestFrame, CopyOnWrite)
+{
+    Frame frame(4, 3);
+    Channel* X;
+    Channel* Y;
+    Channel* Z;
+    frame.createXYZChannels(X, Y, Z);
+    X->fill(1.f);
+    Y->fill(2.f);
+    Z->fill(3.f);
+    frame.getTags().setTag("TAG", "VALUE");
+
+    std::unique_ptr<Frame> copied(pfs::copy(&frame));
+    EXPECT_EQ(copied->getTags().getTag("TAG"), "VALUE");
+
+    // read-only access keeps sharing the data
+    const Frame& constCopied = *copied;
+    const Channel* cY = constCopied.getChannel("Y");
+    const Channel* cY0 = Y;
+    ASSERT_TRUE(cY != NULL);
+    EXPECT_EQ(cY->data(), cY0->data());
+
+    // the first access for writing detaches the channel
+    Channel* Y2 = copied->getChannel("Y");
+    EXPECT_NE(static_cast<const Channel*>(Y2)->data(), cY0->data());
+    Y2->fill(5.f);
+
+    EXPECT_EQ((*cY0)(2, 2), 2.f);
+    EXPECT_EQ((*Y2)(2, 2), 5.f);
+
+    // the other channels are still shared
+    const Channel* cX = constCopied.getChannel("X");
+    EXPECT_EQ(cX->data(), static_cast<const Channel*>(X)->data());
+    EXPECT_TRUE(X->isShared());
+    EXPECT_FALSE(Y->isShared());
+}
+
+TEST(TestFrame, CopyWhileWriting)
+{
+    Frame frame(4, 3);
+    Channel* X;
+    Channel* Y;
+    Channel* Z;
+    frame.createXYZChannels(X, Y, Z);
+    frame.getXYZChannels(X, Y, Z);
+    float* y = Y->data();
+    std::fill(y, y + Y->size(), 1.f);
+    EXPECT_TRUE(frame.hasWriteAccess());
+
+    // the channels handed out for writing are copied, not shared
+    std::unique_ptr<Frame> copied(pfs::copy(&frame));
+    const Frame& constCopied = *copied;
+    EXPECT_FALSE(Y->isShared());
+    y[0] = 2.f;
+    EXPECT_EQ((*constCopied.getChannel("Y"))(0, 0), 1.f);
+
+    // done writing: the next copy shares them
+    frame.endWrite();
+    EXPECT_FALSE(frame.hasWriteAccess());
+    std::unique_ptr<Frame> shared(pfs::copy(&frame));
+    EXPECT_TRUE(Y->isShared());
+    EXPECT_EQ((*static_cast<const Frame&>(*shared).getChannel("Y"))(0, 0),
+              2.f);
+}
+
+TEST(TestFrame, Generation)
+{
+    Frame frame(4, 3);
+    Channel* X;
+    Channel* Y;
+    Channel* Z;
+    frame.createXYZChannels(X, Y, Z);
+    X->fill(1.f);
+
+    // read-only access keeps the generation
+    const uint64_t generation = frame.getGeneration();
+    const Frame& constFrame = frame;
+    constFrame.getChannel("X");
+    constFrame.getChannels();
+    EXPECT_EQ(frame.getGeneration(), generation);
+
+    // a copy has the same content, but is a different frame
+    std::unique_ptr<Frame> copied(pfs::copy(&frame));
+    EXPECT_NE(copied->getGeneration(), generation);
+
+    // any access for writing renews it
+    frame.getChannel("X");
+    const uint64_t written = frame.getGeneration();
+    EXPECT_NE(written, generation);
+    frame.getXYZChannels(X, Y, Z);
+    EXPECT_NE(frame.getGeneration(), written);
+}
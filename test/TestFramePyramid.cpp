@@ -0,0 +1,106 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include "Libpfs/channel.h"
+#include "Libpfs/frame.h"
+#include "Libpfs/manip/pyramid.h"
+
+#include "SeqInt.h"
+
+using namespace pfs;
+
+TEST(TestFramePyramid, Levels)
+{
+    Frame frame(1000, 300);
+    Channel *X, *Y, *Z;
+    frame.createXYZChannels(X, Y, Z);
+
+    FramePyramid pyramid(frame, 128);
+
+    // 1000, 500, 250, 125
+    ASSERT_EQ(4u, pyramid.getLevels());
+    // level 0 shares the channels of the frame
+    EXPECT_EQ(pyramid.getChannel(0, 1).data(),
+              static_cast<const Channel *>(Y)->data());
+    EXPECT_EQ(125u, pyramid.getWidth(3));
+    EXPECT_EQ(37u, pyramid.getHeight(3));
+
+    EXPECT_EQ(0u, pyramid.levelForScale(2.0));
+    EXPECT_EQ(0u, pyramid.levelForScale(0.6));
+    EXPECT_EQ(1u, pyramid.levelForScale(0.5));
+    EXPECT_EQ(2u, pyramid.levelForScale(0.2));
+    EXPECT_EQ(3u, pyramid.levelForScale(0.01));
+}
+
+TEST(TestFramePyramid, BoxFilter)
+{
+    const size_t cols = 7;
+    const size_t rows = 4;
+
+    Frame frame(cols, rows);
+    Channel *X, *Y, *Z;
+    frame.createXYZChannels(X, Y, Z);
+    std::generate(X->begin(), X->end(), SeqInt());
+    std::fill(Y->begin(), Y->end(), 1.f);
+    std::fill(Z->begin(), Z->end(), 0.f);
+
+    FramePyramid pyramid(frame, 1);
+
+    // 7x4, 3x2, 1x1
+    ASSERT_EQ(3u, pyramid.getLevels());
+    const Array2Df &level1 = pyramid.getChannel(1, 0);
+    for (size_t y = 0; y < level1.getRows(); ++y) {
+        for (size_t x = 0; x < level1.getCols(); ++x) {
+            const float expected = 0.25f * ((*X)(2 * x, 2 * y) +
+                                            (*X)(2 * x + 1, 2 * y) +
+                                            (*X)(2 * x, 2 * y + 1) +
+                                            (*X)(2 * x + 1, 2 * y + 1));
+            EXPECT_NEAR(expected, level1(x, y), 10e-5f);
+            EXPECT_NEAR(1.f, pyramid.getChannel(1, 1)(x, y), 10e-6f);
+        }
+    }
+    EXPECT_NEAR(0.f, pyramid.getChannel(2, 2)(0, 0), 10e-6f);
+}
+
+TEST(TestFramePyramid, Snapshot)
+{
+    Frame frame(16, 8);
+    Channel *X, *Y, *Z;
+    frame.createXYZChannels(X, Y, Z);
+    X->fill(1.f);
+    Y->fill(2.f);
+    Z->fill(3.f);
+
+    FramePyramid pyramid(frame, 4);
+
+    // writing into the frame, or dropping it, leaves the pyramid untouched
+    frame.getXYZChannels(X, Y, Z);
+    std::fill(Y->begin(), Y->end(), 5.f);
+    EXPECT_NEAR(2.f, pyramid.getChannel(0, 1)(3, 3), 10e-6f);
+
+    frame.resize(4, 4);
+    ASSERT_EQ(16u, pyramid.getWidth(0));
+    EXPECT_NEAR(1.f, pyramid.getChannel(0, 0)(15, 7), 10e-6f);
+    EXPECT_NEAR(2.f, pyramid.getChannel(1, 1)(7, 3), 10e-6f);
+}
@@ -0,0 +1,164 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include "Libpfs/array2d.h"
+#include "Libpfs/channel.h"
+#include "Libpfs/exception.h"
+#include "Libpfs/frame.h"
+#include "Libpfs/histogram.h"
+
+#include "SeqInt.h"
+
+using namespace pfs;
+
+TEST(TestHistogram, Linear)
+{
+    // 0, 1, ..., 99999
+    Array2Df data(1000, 100);
+    std::generate(data.begin(), data.end(), SeqInt());
+
+    Histogram histogram(HistogramParams(10, 0.f, 99999.f));
+    histogram.compute(data);
+
+    ASSERT_EQ(10u, histogram.getBins());
+    EXPECT_EQ(data.size(), histogram.getTotal());
+    for (size_t bin = 0; bin < histogram.getBins(); ++bin) {
+        EXPECT_NEAR(10000.f, histogram.getCount(bin), 1.f);
+    }
+    EXPECT_EQ(4u, histogram.getQuantileBin(0.5f));
+    EXPECT_NEAR(50000.f, histogram.getQuantile(0.5f), 10.f);
+
+    // one sample every 10: out of range samples are not counted
+    Histogram subsampled(HistogramParams(10, 0.f, 49999.f, HISTOGRAM_LINEAR, 10));
+    subsampled.compute(data);
+    EXPECT_EQ(5000u, subsampled.getTotal());
+}
+
+TEST(TestHistogram, Log10)
+{
+    Array2Df data(4, 1);
+    data(0) = 0.f;      // not counted
+    data(1) = 0.01f;
+    data(2) = 1.f;
+    data(3) = 100.f;
+
+    Histogram histogram(HistogramParams(4, -2.f, 2.f, HISTOGRAM_LOG10));
+    histogram.compute(data);
+
+    EXPECT_EQ(3u, histogram.getTotal());
+    EXPECT_EQ(1u, histogram.getCount(0));
+    EXPECT_EQ(1u, histogram.getCount(2));
+    EXPECT_EQ(1u, histogram.getCount(3));
+    // bin 2 covers [1, 10]: its center is sqrt(10)
+    EXPECT_NEAR(3.16228f, histogram.getBinValue(2), 10e-4f);
+
+    std::pair<float, float> range = computeHistogramRange(data, HISTOGRAM_LOG10);
+    EXPECT_NEAR(-2.f, range.first, 10e-5f);
+    EXPECT_NEAR(2.f, range.second, 10e-5f);
+}
+
+TEST(TestHistogram, FrameCache)
+{
+    Frame frame(100, 10);
+    Channel *X, *Y, *Z;
+    frame.createXYZChannels(X, Y, Z);
+    std::fill(Y->begin(), Y->end(), 0.5f);
+    frame.endWrite();
+
+    const HistogramParams params(8);
+    std::shared_ptr<const Histogram> first = getHistogram(frame, "Y", params);
+    EXPECT_EQ(1000u, first->getCount(4));
+    EXPECT_EQ(first, getHistogram(frame, "Y", params));
+
+    // writing into the channel needs an explicit invalidation
+    std::fill(Y->begin(), Y->end(), 0.f);
+    frame.invalidateHistograms();
+    std::shared_ptr<const Histogram> second = getHistogram(frame, "Y", params);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(1000u, second->getCount(0));
+    // the old histogram is still valid for whoever holds it
+    EXPECT_EQ(1000u, first->getCount(4));
+
+    // resizing invalidates
+    frame.resize(10, 10);
+    EXPECT_EQ(100u, getHistogram(frame, "Y", params)->getTotal());
+
+    EXPECT_THROW(getHistogram(frame, "W", params), pfs::Exception);
+}
+
+TEST(TestHistogram, FrameCacheWriteAccess)
+{
+    Frame frame(100, 10);
+    Channel *X, *Y, *Z;
+    frame.createXYZChannels(X, Y, Z);
+    std::fill(Y->begin(), Y->end(), 0.5f);
+
+    const HistogramParams params(8);
+    EXPECT_EQ(1000u, getHistogram(frame, "Y", params)->getCount(4));
+    EXPECT_NEAR(0.5f, getHistogramRange(frame, "Y", HISTOGRAM_LINEAR).second,
+                10e-5f);
+
+    // handing out the channels for writing is enough to drop the histograms
+    Channel *channel = frame.getChannel("Y");
+    std::fill(channel->begin(), channel->end(), 0.f);
+    EXPECT_EQ(1000u, getHistogram(frame, "Y", params)->getCount(0));
+    EXPECT_NEAR(0.f, getHistogramRange(frame, "Y", HISTOGRAM_LINEAR).second,
+                10e-5f);
+
+    frame.getXYZChannels(X, Y, Z);
+    std::fill(Y->begin(), Y->end(), 1.f);
+    EXPECT_EQ(1000u, getHistogram(frame, "Y", params)->getCount(7));
+
+    ChannelContainer &channels = frame.getChannels();
+    for (ChannelContainer::iterator it = channels.begin();
+         it != channels.end(); ++it) {
+        std::fill((*it)->begin(), (*it)->end(), 0.5f);
+    }
+    EXPECT_EQ(1000u, getHistogram(frame, "Y", params)->getCount(4));
+}
+
+TEST(TestHistogram, FrameCacheEarlierPointer)
+{
+    Frame frame(100, 10);
+    Channel *X, *Y, *Z;
+    frame.createXYZChannels(X, Y, Z);
+    Y = frame.getChannel("Y");
+    float *samples = Y->data();
+    std::fill(samples, samples + Y->size(), 0.5f);
+
+    const HistogramParams params(8);
+    EXPECT_EQ(1000u, getHistogram(frame, "Y", params)->getCount(4));
+
+    // writing through a pointer taken before the histogram was computed
+    std::fill(samples, samples + Y->size(), 1.f);
+    EXPECT_EQ(1000u, getHistogram(frame, "Y", params)->getCount(7));
+    EXPECT_NEAR(1.f, getHistogramRange(frame, "Y", HISTOGRAM_LINEAR).second,
+                10e-5f);
+
+    // the histograms are cached again once the writes are over
+    frame.endWrite();
+    std::shared_ptr<const Histogram> cached = getHistogram(frame, "Y", params);
+    EXPECT_EQ(cached, getHistogram(frame, "Y", params));
+    EXPECT_EQ(1000u, cached->getCount(7));
+}
@@ -0,0 +1,105 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <vector>
+
+#include <jpeglib.h>
+
+#include "Libpfs/frame.h"
+#include "Libpfs/io/jpegreader.h"
+
+using namespace pfs;
+
+namespace
+{
+const char* TEMP_FILE = "TestJpegReader.jpg";
+
+//! \brief writes a gray ramp of \a cols x \a rows pixels
+void writeTestJpeg(size_t cols, size_t rows)
+{
+    FILE* file = std::fopen(TEMP_FILE, "wb");
+    ASSERT_TRUE(file != NULL);
+
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    jpeg_stdio_dest(&cinfo, file);
+
+    cinfo.image_width = cols;
+    cinfo.image_height = rows;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_start_compress(&cinfo, TRUE);
+
+    std::vector<JSAMPLE> scanLine(cols * 3);
+    while (cinfo.next_scanline < cinfo.image_height) {
+        for (size_t x = 0; x < cols; ++x) {
+            const JSAMPLE v =
+                static_cast<JSAMPLE>((x + cinfo.next_scanline) % 256);
+            scanLine[3 * x] = scanLine[3 * x + 1] = scanLine[3 * x + 2] = v;
+        }
+        JSAMPROW row = scanLine.data();
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    std::fclose(file);
+}
+
+void checkSize(int scaleDenom, size_t cols, size_t rows)
+{
+    Frame frame;
+    io::JpegReader reader(TEMP_FILE);
+    reader.read(frame, Params("scale_denom", scaleDenom));
+
+    EXPECT_EQ(frame.getWidth(), cols) << "scale_denom " << scaleDenom;
+    EXPECT_EQ(frame.getHeight(), rows) << "scale_denom " << scaleDenom;
+
+    const Channel* X;
+    const Channel* Y;
+    const Channel* Z;
+    frame.getXYZChannels(X, Y, Z);
+    ASSERT_TRUE(X != NULL && Y != NULL && Z != NULL);
+}
+}
+
+TEST(TestJpegReader, ScaleDenom)
+{
+    writeTestJpeg(100, 60);
+
+    // libjpeg rounds the reduced size up
+    checkSize(1, 100, 60);
+    checkSize(2, 50, 30);
+    checkSize(4, 25, 15);
+    checkSize(8, 13, 8);
+
+    // unsupported factors fall back to the next smaller one
+    checkSize(3, 50, 30);
+    checkSize(16, 13, 8);
+    checkSize(0, 100, 60);
+
+    std::remove(TEMP_FILE);
+}
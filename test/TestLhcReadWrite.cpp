@@ -0,0 +1,116 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+
+#include "Libpfs/frame.h"
+#include "Libpfs/io/lhcreader.h"
+#include "Libpfs/io/lhcwriter.h"
+
+#include "SeqInt.h"
+
+using namespace pfs;
+
+namespace
+{
+const char* TEMP_FILE = "TestLhcReadWrite.lhc";
+
+void writeTestFrame(size_t cols, size_t rows, const Params& params)
+{
+    Frame frame(cols, rows);
+    Channel* X;
+    Channel* Y;
+    Channel* Z;
+    frame.createXYZChannels(X, Y, Z);
+
+    std::generate(X->begin(), X->end(), SeqInt());
+    std::fill(Y->begin(), Y->end(), 0.5f);
+    std::fill(Z->begin(), Z->end(), 1024.f);
+    frame.getTags().setTag("LUMINANCE", "RELATIVE");
+    Y->getTags().setTag("TAG", "VALUE");
+
+    io::LhcWriter writer(TEMP_FILE);
+    writer.write(frame, params);
+}
+}
+
+TEST(TestLhcReadWrite, Float)
+{
+    writeTestFrame(37, 23, Params());
+
+    Frame frame;
+    io::LhcReader reader(TEMP_FILE);
+    EXPECT_EQ(reader.width(), 37u);
+    EXPECT_EQ(reader.height(), 23u);
+    EXPECT_EQ(reader.levels(), 1u);
+    reader.read(frame, Params());
+
+    ASSERT_EQ(frame.getWidth(), 37u);
+    ASSERT_EQ(frame.getHeight(), 23u);
+    EXPECT_EQ(frame.getTags().getTag("LUMINANCE"), "RELATIVE");
+    EXPECT_EQ(frame.getChannel("Y")->getTags().getTag("TAG"), "VALUE");
+
+    const Channel* X = frame.getChannel("X");
+    for (size_t idx = 0; idx < X->size(); ++idx)
+    {
+        ASSERT_EQ((*X)(idx), static_cast<float>(idx));
+    }
+    std::remove(TEMP_FILE);
+}
+
+TEST(TestLhcReadWrite, HalfWithPreview)
+{
+    writeTestFrame(37, 23, Params("lhc.half", true)("lhc.preview_levels", 2));
+
+    io::LhcReader reader(TEMP_FILE);
+    EXPECT_EQ(reader.levels(), 3u);
+
+    Frame frame;
+    reader.read(frame, Params());
+    ASSERT_EQ(frame.getWidth(), 37u);
+    EXPECT_EQ((*frame.getChannel("X"))(100), 100.f);
+    EXPECT_EQ((*frame.getChannel("Y"))(100), 0.5f);
+
+    Frame preview;
+    reader.read(preview, Params("lhc.level", 2));
+    ASSERT_EQ(preview.getWidth(), 9u);
+    ASSERT_EQ(preview.getHeight(), 5u);
+    EXPECT_EQ((*preview.getChannel("Z"))(3, 3), 1024.f);
+
+    std::remove(TEMP_FILE);
+}
+
+#ifdef __linux__
+TEST(TestLhcReadWrite, ShortWrite)
+{
+    // every write to /dev/full fails with ENOSPC
+    Frame frame(16, 16);
+    Channel* X;
+    Channel* Y;
+    Channel* Z;
+    frame.createXYZChannels(X, Y, Z);
+
+    io::LhcWriter writer("/dev/full");
+    EXPECT_THROW(writer.write(frame, Params()), io::WriteException);
+}
+#endif
@@ -0,0 +1,281 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "Libpfs/progress.h"
+#include "Libpfs/utils/parallel.h"
+
+using namespace pfs::utils;
+
+namespace {
+//! \brief cancels the operation as soon as the value reaches a threshold
+class CancelAt : public pfs::Progress {
+   public:
+    explicit CancelAt(int threshold) : m_threshold(threshold) {}
+
+    void setValue(int value) {
+        pfs::Progress::setValue(value);
+        if (value >= m_threshold) {
+            cancel();
+        }
+    }
+
+   private:
+    int m_threshold;
+};
+
+//! \brief records whether the value ever went backwards
+class MonotonicCheck : public pfs::Progress {
+   public:
+    MonotonicCheck() : m_backwards(false) {}
+
+    void setValue(int value) {
+        if (value < pfs::Progress::value()) {
+            m_backwards = true;
+        }
+        pfs::Progress::setValue(value);
+    }
+
+    bool wentBackwards() const { return m_backwards; }
+
+   private:
+    std::atomic<bool> m_backwards;
+};
+}
+
+TEST(TestParallel, ForCoversRange)
+{
+    std::vector<int> visits(10007, 0);
+    parallelFor(3, 10007, 64, [&](ptrdiff_t begin, ptrdiff_t end) {
+        for (ptrdiff_t idx = begin; idx < end; ++idx) {
+            ++visits[idx];
+        }
+    });
+
+    for (size_t idx = 0; idx < visits.size(); ++idx) {
+        EXPECT_EQ(visits[idx], (idx < 3) ? 0 : 1);
+    }
+}
+
+TEST(TestParallel, NestedFor)
+{
+    const ptrdiff_t rows = 37;
+    const ptrdiff_t cols = 1001;
+    std::vector<int> visits(rows * cols, 0);
+
+    parallelFor(0, rows, 1, [&](ptrdiff_t rowBegin, ptrdiff_t rowEnd) {
+        for (ptrdiff_t r = rowBegin; r < rowEnd; ++r) {
+            parallelFor(0, cols, 100, [&](ptrdiff_t begin, ptrdiff_t end) {
+                for (ptrdiff_t c = begin; c < end; ++c) {
+                    ++visits[r * cols + c];
+                }
+            });
+        }
+    });
+
+    for (size_t idx = 0; idx < visits.size(); ++idx) {
+        EXPECT_EQ(visits[idx], 1);
+    }
+}
+
+TEST(TestParallel, Reduce)
+{
+    const double sum = parallelReduce(
+        0, 100000, 1000, 0.0,
+        [](ptrdiff_t begin, ptrdiff_t end) {
+            double partial = 0.0;
+            for (ptrdiff_t idx = begin; idx < end; ++idx) {
+                partial += 1.0 / (1 + idx);
+            }
+            return partial;
+        },
+        [](double a, double b) { return a + b; });
+
+    // same order of the additions, whatever the number of threads
+    const size_t concurrency = getConcurrency();
+    setConcurrency(1);
+    const double serialSum = parallelReduce(
+        0, 100000, 1000, 0.0,
+        [](ptrdiff_t begin, ptrdiff_t end) {
+            double partial = 0.0;
+            for (ptrdiff_t idx = begin; idx < end; ++idx) {
+                partial += 1.0 / (1 + idx);
+            }
+            return partial;
+        },
+        [](double a, double b) { return a + b; });
+    setConcurrency(concurrency);
+
+    EXPECT_EQ(sum, serialSum);
+    EXPECT_NEAR(sum, 12.0901461, 1e-6);
+}
+
+TEST(TestParallel, ConcurrentJobs)
+{
+    const size_t concurrency = getConcurrency();
+    setConcurrency(8);
+    EXPECT_EQ(getThreadsPerJob(), 8u);
+    {
+        ConcurrentJob job1;
+        EXPECT_EQ(getThreadsPerJob(), 8u);
+        {
+            ConcurrentJob job2;
+            ConcurrentJob job3;
+            EXPECT_EQ(getThreadsPerJob(), 2u);
+        }
+        EXPECT_EQ(getThreadsPerJob(), 8u);
+    }
+    setConcurrency(16);
+    {
+        ConcurrentJob jobs[32];
+        EXPECT_EQ(getThreadsPerJob(), 1u);
+    }
+    setConcurrency(concurrency);
+}
+
+#ifdef _OPENMP
+TEST(TestParallel, ConcurrentJobsTeamSize)
+{
+    const size_t concurrency = getConcurrency();
+    setConcurrency(8);
+
+    const int jobCount = 2;
+    std::atomic<int> started(0);
+    std::atomic<int> finished(0);
+    std::atomic<int> maxForTeam(0);
+    std::atomic<int> maxRegionTeam(0);
+
+    auto recordMax = [](std::atomic<int> &max, int value) {
+        int current = max.load();
+        while (value > current && !max.compare_exchange_weak(current, value)) {
+        }
+    };
+
+    // both jobs stay registered while either is working: the first one
+    // entered with the whole budget to itself
+    auto waitFor = [](std::atomic<int> &counter, int count) {
+        ++counter;
+        while (counter.load() < count) {
+            std::this_thread::yield();
+        }
+    };
+
+    auto job = [&]() {
+        ConcurrentJob concurrentJob;
+        waitFor(started, jobCount);
+
+        parallelFor(0, 64, 1, [&](ptrdiff_t, ptrdiff_t) {
+            recordMax(maxForTeam, omp_get_num_threads());
+        });
+
+#pragma omp parallel num_threads(pfs::utils::getThreadsPerJob())
+        recordMax(maxRegionTeam, omp_get_num_threads());
+
+        waitFor(finished, jobCount);
+    };
+
+    std::vector<std::thread> threads;
+    for (int idx = 0; idx < jobCount; ++idx) {
+        threads.push_back(std::thread(job));
+    }
+    for (size_t idx = 0; idx < threads.size(); ++idx) {
+        threads[idx].join();
+    }
+    setConcurrency(concurrency);
+
+    EXPECT_GE(maxForTeam.load(), 1);
+    EXPECT_LE(maxForTeam.load(), 8 / jobCount);
+    EXPECT_GE(maxRegionTeam.load(), 1);
+    EXPECT_LE(maxRegionTeam.load(), 8 / jobCount);
+}
+#endif
+
+TEST(TestParallel, ForProgress)
+{
+    pfs::Progress progress;
+    std::atomic<ptrdiff_t> processed(0);
+    EXPECT_TRUE(parallelFor(0, 1000, 7, progress, 20, 80,
+                            [&](ptrdiff_t begin, ptrdiff_t end) {
+                                processed += end - begin;
+                            }));
+
+    EXPECT_EQ(processed.load(), 1000);
+    EXPECT_EQ(progress.value(), 80);
+}
+
+TEST(TestParallel, ForProgressMonotonic)
+{
+    MonotonicCheck progress;
+    EXPECT_TRUE(parallelFor(0, 100000, 1, progress, 0, 100,
+                            [](ptrdiff_t, ptrdiff_t) {}));
+
+    EXPECT_FALSE(progress.wentBackwards());
+    EXPECT_EQ(progress.value(), 100);
+}
+
+TEST(TestParallel, ReduceProgress)
+{
+    const auto sumChunk = [](ptrdiff_t begin, ptrdiff_t end) {
+        double partial = 0.0;
+        for (ptrdiff_t idx = begin; idx < end; ++idx) {
+            partial += 1.0 / (1 + idx);
+        }
+        return partial;
+    };
+    const auto add = [](double a, double b) { return a + b; };
+
+    pfs::Progress progress;
+    const double sum =
+        parallelReduce(0, 100000, 1000, progress, 10, 60, 0.0, sumChunk, add);
+    EXPECT_EQ(sum, parallelReduce(0, 100000, 1000, 0.0, sumChunk, add));
+    EXPECT_EQ(progress.value(), 60);
+    EXPECT_FALSE(progress.canceled());
+
+    CancelAt canceled(10);
+    parallelReduce(0, 100000, 1000, canceled, 0, 100, 0.0, sumChunk, add);
+    EXPECT_TRUE(canceled.canceled());
+}
+
+TEST(TestParallel, ForCancel)
+{
+    // canceled before starting: nothing runs
+    pfs::Progress canceled;
+    canceled.cancel();
+    std::atomic<int> chunks(0);
+    EXPECT_FALSE(parallelFor(0, 1000, 1, canceled, 0, 100,
+                             [&](ptrdiff_t, ptrdiff_t) { ++chunks; }));
+    EXPECT_EQ(chunks.load(), 0);
+
+    // canceled at 10%: the chunks not started yet are skipped
+    CancelAt progress(10);
+    EXPECT_FALSE(parallelFor(0, 1000, 1, progress, 0, 100,
+                             [&](ptrdiff_t, ptrdiff_t) { ++chunks; }));
+    EXPECT_GE(chunks.load(), 100);
+    EXPECT_LT(chunks.load(), 1000);
+}
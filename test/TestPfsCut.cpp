@@ -21,8 +21,12 @@
 */
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <memory>
 
 #include "Libpfs/array2d.h"
+#include "Libpfs/channel.h"
+#include "Libpfs/frame.h"
+#include "Libpfs/frameview.h"
 #include "Libpfs/manip/cut.h"
 
 #include "SeqInt.h"
@@ -164,3 +168,40 @@ TEST(TestPfsCut, Crop_OneTwo_TwoOne)
         ASSERT_NEAR(ref[idx], outData[idx], 10e-5f);
     }
 }
+
+TEST(TestPfsCut, FrameView)
+{
+    size_t rows = 5;
+    size_t cols = 6;
+
+    Frame frame(cols, rows);
+    Channel *X, *Y, *Z;
+    frame.createXYZChannels(X, Y, Z);
+    std::generate(X->begin(), X->end(), SeqInt());
+
+    // same region as Crop_OneTwo_TwoOne, without copies
+    FrameView view = cut(FrameView(frame), 1, 2, cols - 2, rows - 1);
+    ASSERT_EQ(3u, view.getWidth());
+    ASSERT_EQ(2u, view.getHeight());
+
+    const Array2DView<const float> *viewX = view.getChannel("X");
+    ASSERT_TRUE(viewX != NULL);
+    EXPECT_EQ(X->data() + 13, viewX->data());
+    EXPECT_EQ(cols, viewX->getStride());
+    EXPECT_FALSE(viewX->isContiguous());
+    EXPECT_NEAR(21.f, (*viewX)(2, 1), 10e-5f);
+
+    // views of views
+    EXPECT_NEAR(20.f, view.sub(1, 1, 2, 1).getChannel("X")->data()[0], 10e-5f);
+
+    // materialize
+    std::unique_ptr<Frame> region(view.materialize());
+    ASSERT_EQ(3u, region->getWidth());
+    const float ref[] = { 13.f, 14.f, 15.f,
+                          19.f, 20.f, 21.f};
+    const float* outData = region->getChannel("X")->data();
+    for (size_t idx = 0; idx < region->size(); ++idx)
+    {
+        ASSERT_NEAR(ref[idx], outData[idx], 10e-5f);
+    }
+}
@@ -0,0 +1,128 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+
+#include "Libpfs/frame.h"
+#include "Libpfs/io/pfsreader.h"
+#include "Libpfs/io/pfswriter.h"
+
+#include "SeqInt.h"
+#include "CompareVector.h"
+
+using namespace pfs;
+
+namespace
+{
+const char* TEMP_FILE = "TestPfsReadWrite.pfs";
+
+void writeTestFrame(size_t cols, size_t rows)
+{
+    Frame frame(cols, rows);
+    Channel* X;
+    Channel* Y;
+    Channel* Z;
+    frame.createXYZChannels(X, Y, Z);
+
+    std::generate(X->begin(), X->end(), SeqInt());
+    std::generate(Y->begin(), Y->end(), SeqInt());
+    std::generate(Z->begin(), Z->end(), SeqInt());
+    frame.getTags().setTag("LUMINANCE", "RELATIVE");
+
+    io::PfsWriter writer(TEMP_FILE);
+    writer.write(frame, Params());
+}
+
+void checkFrame(const Frame& frame, size_t cols, size_t rows)
+{
+    ASSERT_EQ(frame.getWidth(), cols);
+    ASSERT_EQ(frame.getHeight(), rows);
+    ASSERT_EQ(frame.getChannels().size(), 3u);
+
+    // the alignment padding never reaches the user
+    EXPECT_TRUE(frame.getTags().getTag("PFS_PADDING").empty());
+
+    Array2Df reference(cols, rows);
+    std::generate(reference.begin(), reference.end(), SeqInt());
+    const float* ref = reference.data();
+
+    const Channel* X;
+    const Channel* Y;
+    const Channel* Z;
+    frame.getXYZChannels(X, Y, Z);
+    ASSERT_TRUE(X != NULL);
+    compareVectors(ref, X->data(), reference.size());
+    compareVectors(ref, Y->data(), reference.size());
+    compareVectors(ref, Z->data(), reference.size());
+}
+}
+
+TEST(TestPfsReadWrite, Buffered)
+{
+    writeTestFrame(31, 17);
+
+    Frame frame;
+    io::PfsReader reader(TEMP_FILE);
+    reader.read(frame, Params("pfs.mmap", false));
+
+    checkFrame(frame, 31, 17);
+    std::remove(TEMP_FILE);
+}
+
+TEST(TestPfsReadWrite, MemoryMapped)
+{
+    writeTestFrame(31, 17);
+
+    Frame frame;
+    {
+        io::PfsReader reader(TEMP_FILE);
+        reader.read(frame, Params());
+    }
+    checkFrame(frame, 31, 17);
+
+    // writes must stay private to the process
+    Channel* X = frame.getChannel("X");
+    X->fill(-1.f);
+
+    Frame frame2;
+    io::PfsReader reader(TEMP_FILE);
+    reader.read(frame2, Params("pfs.mmap", true));
+
+    checkFrame(frame2, 31, 17);
+    std::remove(TEMP_FILE);
+}
+
+TEST(TestPfsReadWrite, Probe)
+{
+    writeTestFrame(31, 17);
+
+    io::PfsReader reader(TEMP_FILE);
+    io::FrameInfo info = reader.probe();
+
+    EXPECT_EQ(info.width, 31u);
+    EXPECT_EQ(info.height, 17u);
+    EXPECT_EQ(info.channels, 3u);
+    EXPECT_EQ(info.bitDepth, 32u);
+    EXPECT_FALSE(info.exifData.isValid());
+    std::remove(TEMP_FILE);
+}
@@ -0,0 +1,106 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include "Libpfs/array2d.h"
+#include "Libpfs/manip/resize.h"
+
+#include "SeqInt.h"
+
+using namespace pfs;
+
+TEST(TestPfsResize, BoxWeights)
+{
+    ResampleWeights weights(10, 4, ResampleWeights::BOX);
+
+    // each output sample covers 2.5 input samples
+    EXPECT_EQ(0, weights.first(0));
+    EXPECT_EQ(3, weights.count(0));
+    EXPECT_NEAR(0.4f, weights.weights(0)[0], 10e-6f);
+    EXPECT_NEAR(0.4f, weights.weights(0)[1], 10e-6f);
+    EXPECT_NEAR(0.2f, weights.weights(0)[2], 10e-6f);
+
+    EXPECT_EQ(2, weights.first(1));
+    EXPECT_EQ(3, weights.count(1));
+    EXPECT_NEAR(0.2f, weights.weights(1)[0], 10e-6f);
+    EXPECT_NEAR(0.4f, weights.weights(1)[1], 10e-6f);
+    EXPECT_NEAR(0.4f, weights.weights(1)[2], 10e-6f);
+}
+
+TEST(TestPfsResize, AreaAverage)
+{
+    const size_t cols = 12;
+    const size_t rows = 9;
+    const size_t factor = 3;
+
+    Array2Df input(cols, rows);
+    std::generate(input.begin(), input.end(), SeqInt());
+
+    // large bilinear reductions average all the samples
+    Array2Df output(cols/factor, rows/factor);
+    resize(input, output, BilinearInterp);
+
+    for (size_t r = 0; r < output.getRows(); ++r)
+    {
+        for (size_t c = 0; c < output.getCols(); ++c)
+        {
+            float sum = 0.f;
+            for (size_t y = r*factor; y < (r + 1)*factor; ++y)
+                for (size_t x = c*factor; x < (c + 1)*factor; ++x)
+                    sum += input(x, y);
+
+            ASSERT_NEAR(sum/(factor*factor), output(c, r), 10e-4f);
+        }
+    }
+}
+
+TEST(TestPfsResize, LanczosConstant)
+{
+    Array2Df input(200, 120);
+    std::fill(input.begin(), input.end(), 0.25f);
+
+    // single stage
+    Array2Df half(100, 60);
+    resize(input, half, LanczosInterp);
+    for (Array2Df::const_iterator it = half.begin(); it != half.end(); ++it)
+    {
+        ASSERT_NEAR(0.25f, *it, 10e-6f);
+    }
+
+    // area average + Lanczos
+    Array2Df small(25, 15);
+    Resampler resampler(200, 120, 25, 15, LanczosInterp);
+    resampler(input, small);
+    for (Array2Df::const_iterator it = small.begin(); it != small.end(); ++it)
+    {
+        ASSERT_NEAR(0.25f, *it, 10e-6f);
+    }
+
+    // upscale
+    Array2Df large(300, 180);
+    resize(input, large, LanczosInterp);
+    for (Array2Df::const_iterator it = large.begin(); it != large.end(); ++it)
+    {
+        ASSERT_NEAR(0.25f, *it, 10e-6f);
+    }
+}
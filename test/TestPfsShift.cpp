@@ -200,3 +200,37 @@ TEST(TestPfsShift, StillStill)
         ASSERT_NEAR(ref[idx], outData[idx], 10e-5f);
     }
 }
+
+TEST(TestPfsShift, Overlap)
+{
+    size_t rows = 5;
+    size_t cols = 6;
+
+    Array2Df input(cols, rows);
+    std::generate(input.begin(), input.end(), SeqInt());
+    Array2Df output(cols, rows);
+    shift(input, 2, -1, output);
+
+    // the overlap is what shift() copies, the rest is zero
+    Array2DView<const float> in(input);
+    Array2DView<const float> out(output);
+    shiftOverlap(in, out, 2, -1);
+    ASSERT_EQ(4u, in.getCols());
+    ASSERT_EQ(4u, in.getRows());
+    EXPECT_EQ(input.data() + 2, in.data());
+    EXPECT_EQ(output.data() + cols, out.data());
+    for (size_t r = 0; r < in.getRows(); ++r)
+    {
+        for (size_t c = 0; c < in.getCols(); ++c)
+        {
+            ASSERT_NEAR(in(c, r), out(c, r), 10e-5f);
+        }
+    }
+
+    // shifting a view
+    Array2Df region(3, 2);
+    shift(makeView(input).sub(1, 1, 3, 2), 1, 0, region);
+    EXPECT_NEAR(8.f, region(0, 0), 10e-5f);
+    EXPECT_NEAR(15.f, region(1, 1), 10e-5f);
+    EXPECT_NEAR(0.f, region(2, 1), 10e-5f);
+}
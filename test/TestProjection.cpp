@@ -0,0 +1,165 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+
+#include "Libpfs/array2d.h"
+#include "Libpfs/manip/projection.h"
+
+using namespace pfs;
+
+namespace
+{
+// per sample evaluation of the transformation (one channel at the time)
+float referenceSample(const Array2Df& in, int x, int y, int outCols, int outRows,
+                      const TransformInfo& info)
+{
+    const double deg = M_PI / 180.;
+    const int os = info.oversampleFactor;
+    double pixVal = 0.;
+
+    for (int oy = 0; oy < os; ++oy)
+    {
+        for (int ox = 0; ox < os; ++ox)
+        {
+            Vector3D d = info.dstProjection->uvToDirection(
+                        (x + (ox + 0.5)/os) / outCols,
+                        (y + (oy + 0.5)/os) / outRows);
+
+            double a = -info.xRotate*deg;
+            double y2 = cos(a)*d.y - sin(a)*d.z;
+            double z2 = sin(a)*d.y + cos(a)*d.z;
+            d.y = y2; d.z = z2;
+
+            a = -info.yRotate*deg;
+            double x2 = cos(a)*d.x + sin(a)*d.z;
+            z2 = -sin(a)*d.x + cos(a)*d.z;
+            d.x = x2; d.z = z2;
+
+            a = -info.zRotate*deg;
+            x2 = cos(a)*d.x - sin(a)*d.y;
+            y2 = sin(a)*d.x + cos(a)*d.y;
+            d.x = x2; d.y = y2;
+
+            Point2D p = info.srcProjection->directionToUV(d);
+            double px = p.x*in.getCols();
+            double py = p.y*in.getRows();
+
+            int ix = (int)floor(px);
+            int iy = (int)floor(py);
+            double i = px - ix;
+            double j = py - iy;
+            ix = std::min(std::max(ix, 0), (int)in.getCols() - 1);
+            iy = std::min(std::max(iy, 0), (int)in.getRows() - 1);
+            int dx = std::min(ix + 1, (int)in.getCols() - 1);
+            int dy = std::min(iy + 1, (int)in.getRows() - 1);
+
+            pixVal += (1 - i)*(1 - j)*in(ix, iy) + i*(1 - j)*in(dx, iy) +
+                    i*j*in(dx, dy) + (1 - i)*j*in(ix, dy);
+        }
+    }
+    return pixVal/(os*os);
+}
+
+void fill(Array2Df& a, float phase)
+{
+    for (size_t r = 0; r < a.getRows(); ++r)
+        for (size_t c = 0; c < a.getCols(); ++c)
+            a(c, r) = 1.f + std::sin(phase + 0.05f*c)*std::cos(0.07f*r);
+}
+}
+
+TEST(TestProjection, PolarToMirrorBall)
+{
+    const size_t inCols = 64;
+    const size_t inRows = 32;
+    const size_t outSize = 48;
+
+    Array2Df in0(inCols, inRows);
+    Array2Df in1(inCols, inRows);
+    Array2Df in2(inCols, inRows);
+    fill(in0, 0.f);
+    fill(in1, 1.f);
+    fill(in2, 2.f);
+
+    Array2Df out0(outSize, outSize);
+    Array2Df out1(outSize, outSize);
+    Array2Df out2(outSize, outSize);
+
+    TransformInfo info;
+    info.srcProjection = &PolarProjection::singleton;
+    info.dstProjection = &MirrorBallProjection::singleton;
+    info.oversampleFactor = 2;
+    info.xRotate = 10;
+    info.yRotate = 20;
+    info.zRotate = 30;
+
+    std::vector<const Array2Df*> in;
+    in.push_back(&in0); in.push_back(&in1); in.push_back(&in2);
+    std::vector<Array2Df*> out;
+    out.push_back(&out0); out.push_back(&out1); out.push_back(&out2);
+
+    transformArrays(in, out, info);
+
+    for (size_t c = 0; c < in.size(); ++c)
+    {
+        for (int y = 0; y < (int)outSize; ++y)
+        {
+            for (int x = 0; x < (int)outSize; ++x)
+            {
+                if (!info.dstProjection->isValidPixel((x + 0.5)/outSize,
+                                                      (y + 0.5)/outSize))
+                {
+                    ASSERT_EQ(0.f, (*out[c])(x, y));
+                    continue;
+                }
+                ASSERT_NEAR(referenceSample(*in[c], x, y, outSize, outSize, info),
+                            (*out[c])(x, y), 1e-3f);
+            }
+        }
+    }
+}
+
+TEST(TestProjection, SingleChannel)
+{
+    Array2Df in(64, 32);
+    fill(in, 0.5f);
+
+    Array2Df out(64, 32);
+
+    TransformInfo info;
+    info.srcProjection = &PolarProjection::singleton;
+    info.dstProjection = &CylindricalProjection::singleton;
+    info.zRotate = 45;
+
+    transformArray(&in, &out, &info);
+
+    for (int y = 0; y < 32; ++y)
+    {
+        for (int x = 0; x < 64; ++x)
+        {
+            ASSERT_NEAR(referenceSample(in, x, y, 64, 32, info),
+                        out(x, y), 1e-3f);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * This file is a part of Luminance HDR package.
+ * ----------------------------------------------------------------------
+ * Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * ----------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "Libpfs/io/rawscale.h"
+
+using namespace pfs::io;
+
+TEST(TestRawScale, OptionMapping)
+{
+    // full size: demosaiced by LibRaw
+    EXPECT_FALSE(RawScale(0).halfSize);
+    EXPECT_FALSE(RawScale(1).halfSize);
+    EXPECT_EQ(1, RawScale(1).decimation);
+
+    // 1/2: LibRaw half size output alone
+    EXPECT_TRUE(RawScale(2).halfSize);
+    EXPECT_EQ(1, RawScale(2).decimation);
+    EXPECT_TRUE(RawScale(3).halfSize);
+    EXPECT_EQ(1, RawScale(3).decimation);
+
+    // 1/4 and 1/8: half size, then decimated
+    EXPECT_TRUE(RawScale(4).halfSize);
+    EXPECT_EQ(2, RawScale(4).decimation);
+    EXPECT_TRUE(RawScale(8).halfSize);
+    EXPECT_EQ(4, RawScale(8).decimation);
+    EXPECT_EQ(4, RawScale(16).decimation);
+}
+
+TEST(TestRawScale, Decimate)
+{
+    const int width = 10;
+    const int height = 6;
+    std::vector<uint16_t> rgb(width * height * 3);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint16_t *pixel = &rgb[(y * width + x) * 3];
+            pixel[0] = static_cast<uint16_t>(x);
+            pixel[1] = static_cast<uint16_t>(100 * y);
+            pixel[2] = 1000;
+        }
+    }
+
+    std::vector<uint16_t> out;
+    int outWidth = 0;
+    int outHeight = 0;
+    decimateRGB(rgb.data(), width, height, 2, out, outWidth, outHeight);
+    ASSERT_EQ(5, outWidth);
+    ASSERT_EQ(3, outHeight);
+    ASSERT_EQ(static_cast<size_t>(5 * 3 * 3), out.size());
+    for (int y = 0; y < outHeight; ++y) {
+        for (int x = 0; x < outWidth; ++x) {
+            const uint16_t *pixel = &out[(y * outWidth + x) * 3];
+            // (2x + 2x + 1) / 2, rounded down
+            EXPECT_EQ(2 * x, pixel[0]);
+            EXPECT_EQ(200 * y + 50, pixel[1]);
+            EXPECT_EQ(1000, pixel[2]);
+        }
+    }
+
+    // the columns and rows left over are dropped
+    decimateRGB(rgb.data(), width, height, 4, out, outWidth, outHeight);
+    ASSERT_EQ(2, outWidth);
+    ASSERT_EQ(1, outHeight);
+    EXPECT_EQ(5, out[3]);
+    EXPECT_EQ(150, out[4]);
+}
@@ -0,0 +1,113 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+
+#include "Libpfs/utils/trace.h"
+
+using namespace pfs::utils;
+
+namespace {
+void busyWork() {
+    PFS_TRACE_SPAN("busyWork", "test");
+    volatile int sum = 0;
+    for (int i = 0; i < 10000; ++i) {
+        sum += i;
+    }
+}
+}
+
+TEST(TestTrace, DisabledRecordsNothing) {
+    trace::setEnabled(false);
+    trace::clear();
+
+    busyWork();
+
+    EXPECT_TRUE(trace::events().empty());
+}
+
+TEST(TestTrace, NestedSpans) {
+    trace::clear();
+    trace::setEnabled(true);
+    {
+        PFS_TRACE_SPAN("outer", "test");
+        busyWork();
+        busyWork();
+    }
+    trace::setEnabled(false);
+
+    std::vector<trace::Event> events = trace::events();
+    ASSERT_EQ(events.size(), 3u);
+
+    // sorted by start time: the enclosing span comes first
+    EXPECT_STREQ(events[0].name, "outer");
+    EXPECT_STREQ(events[1].name, "busyWork");
+    EXPECT_STREQ(events[2].name, "busyWork");
+    EXPECT_LE(events[0].begin, events[1].begin);
+    EXPECT_GE(events[0].begin + events[0].duration,
+              events[2].begin + events[2].duration);
+    EXPECT_EQ(events[0].thread, trace::threadId());
+}
+
+TEST(TestTrace, ThreadIds) {
+    trace::clear();
+    trace::setEnabled(true);
+    busyWork();
+    std::thread other(busyWork);
+    other.join();
+    trace::setEnabled(false);
+
+    std::vector<trace::Event> events = trace::events();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_NE(events[0].thread, events[1].thread);
+}
+
+TEST(TestTrace, Export) {
+    trace::clear();
+    trace::setEnabled(true);
+    busyWork();
+    busyWork();
+    trace::setEnabled(false);
+
+    std::ostringstream json;
+    trace::writeChromeTrace(json);
+    EXPECT_EQ(json.str().find("{\"traceEvents\":["), 0u);
+    EXPECT_NE(json.str().find("\"name\":\"busyWork\",\"cat\":\"test\","
+                              "\"ph\":\"X\""),
+              std::string::npos);
+
+    std::ostringstream summary;
+    summary.precision(9);
+    trace::writeSummary(summary);
+    // the caller's stream state survives the table
+    EXPECT_EQ(summary.precision(), 9);
+    EXPECT_FALSE(summary.flags() & std::ios_base::fixed);
+    std::istringstream lines(summary.str());
+    std::string header, name, category;
+    size_t count = 0;
+    std::getline(lines, header);
+    lines >> name >> category >> count;
+    EXPECT_EQ(name, "busyWork");
+    EXPECT_EQ(category, "test");
+    EXPECT_EQ(count, 2u);
+}
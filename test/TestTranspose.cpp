@@ -0,0 +1,62 @@
+/**
+* This file is a part of LuminanceHDR package.
+* ----------------------------------------------------------------------
+* Copyright (C) 2026 agent
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* ----------------------------------------------------------------------
+*
+*/
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+#include <Libpfs/utils/transpose.h>
+
+#include "SeqInt.h"
+
+using namespace pfs::utils;
+
+TEST(TestTranspose, Float)
+{
+    const size_t cols = 131;
+    const size_t rows = 70;
+
+    std::vector<float> input(cols*rows);
+    std::generate(input.begin(), input.end(), SeqInt());
+    std::vector<float> output(cols*rows);
+
+    transpose(input.data(), output.data(), cols, rows);
+
+    for (size_t r = 0; r < rows; ++r)
+        for (size_t c = 0; c < cols; ++c)
+            ASSERT_EQ(input[r*cols + c], output[c*rows + r]);
+}
+
+TEST(TestTranspose, Int)
+{
+    const size_t cols = 67;
+    const size_t rows = 129;
+
+    std::vector<int> input(cols*rows);
+    std::generate(input.begin(), input.end(), SeqInt());
+    std::vector<int> output(cols*rows);
+
+    transpose(input.data(), output.data(), cols, rows);
+
+    for (size_t r = 0; r < rows; ++r)
+        for (size_t c = 0; c < cols; ++c)
+            ASSERT_EQ(input[r*cols + c], output[c*rows + r]);
+}